@@ -0,0 +1,57 @@
+#include "AllocationCounter.h"
+#include "../../resources/sqlite/sqlite3.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static atomic<size_t> allocations{ 0 };
+static atomic<size_t> sqliteAllocations{ 0 };
+
+// The allocator SQLite used before countSqliteAllocations wrapped it
+static sqlite3_mem_methods sqliteAllocator;
+
+void* operator new(size_t size) {
+	allocations.fetch_add(1, memory_order_relaxed);
+	void* memory = malloc(size == 0 ? 1 : size);
+	if (memory == nullptr) {
+		throw bad_alloc();
+	}
+	return memory;
+}
+
+void operator delete(void* memory) noexcept {
+	free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+	free(memory);
+}
+
+size_t AllocationCounter::count() {
+	return allocations.load(memory_order_relaxed);
+}
+
+static void* countedSqliteMalloc(int size) {
+	sqliteAllocations.fetch_add(1, memory_order_relaxed);
+	return sqliteAllocator.xMalloc(size);
+}
+
+static void* countedSqliteRealloc(void* memory, int size) {
+	sqliteAllocations.fetch_add(1, memory_order_relaxed);
+	return sqliteAllocator.xRealloc(memory, size);
+}
+
+void AllocationCounter::countSqliteAllocations() {
+	if (sqlite3_config(SQLITE_CONFIG_GETMALLOC, &sqliteAllocator) != SQLITE_OK) {
+		return;
+	}
+
+	sqlite3_mem_methods counted = sqliteAllocator;
+	counted.xMalloc = countedSqliteMalloc;
+	counted.xRealloc = countedSqliteRealloc;
+	sqlite3_config(SQLITE_CONFIG_MALLOC, &counted);
+}
+
+size_t AllocationCounter::sqliteCount() {
+	return sqliteAllocations.load(memory_order_relaxed);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+using namespace std;
+
+class AllocationCounter {
+public:
+
+	/*
+	* @brief - Returns the number of calls to the global operator new since the program started
+	* The command line tool replaces the global operators, so the benchmarks can count the allocations of the calls they measure
+	*/
+	static size_t count();
+
+
+	/*
+	* @brief - Counts the allocations SQLite makes from now on, must be called before SQLite is used
+	* SQLite allocates with malloc, so its allocations are counted apart, by wrapping the SQLite allocator
+	*/
+	static void countSqliteAllocations();
+
+
+	/*
+	* @brief - Returns the number of allocations SQLite made since countSqliteAllocations was called
+	*/
+	static size_t sqliteCount();
+};
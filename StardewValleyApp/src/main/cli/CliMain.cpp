@@ -0,0 +1,56 @@
+#include "AllocationCounter.h"
+#include "FishBench.h"
+#include "FishCli.h"
+#include "../repository/FishDBRepository.h"
+#include "../service/Service.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+    // => ARGUMENTS PARSING
+    vector<string> arguments(argv + 1, argv + argc);
+    if (arguments.empty() || arguments.front() == "--help" || arguments.front() == "-h") {
+        cout << FishCli::usage();
+        return arguments.empty() ? 2 : 0;
+    }
+
+    CliOptions options;
+    string error;
+    if (!FishCli::parseArguments(arguments, options, error)) {
+        cerr << error << "\n\n" << FishCli::usage();
+        return 2;
+    }
+    // <= END
+
+
+    // => DATABASE EXISTENCE ASSURING
+    if (!filesystem::exists(options.databasePath)) {
+        cerr << "Database file does not exist: " << options.databasePath << "\n";
+        return 1;
+    }
+    // <= END
+
+
+    // => SERVICE INITIALIZATION (the SQLite allocations are counted from the first connection on, for the benchmarks)
+    AllocationCounter::countSqliteAllocations();
+    FishDBRepository fishRepository(options.databasePath);
+    Service service(fishRepository);
+    // <= END
+
+
+    // => BENCHMARKS
+    if (options.command == "bench") {
+        FishBench bench(fishRepository, options.databasePath, cout, cerr);
+        return bench.run(options);
+    }
+    // <= END
+
+
+    FishCli cli(service, cout, cerr);
+    return cli.run(options);
+}
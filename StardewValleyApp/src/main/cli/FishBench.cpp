@@ -0,0 +1,563 @@
+#include "FishBench.h"
+#include "AllocationCounter.h"
+#include "../service/CatchQueryEngine.h"
+#include "../service/SaveFileImporter.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+// Formats a number with the given number of decimals
+static string formatNumber(const double value, const int decimals) {
+	char text[32];
+	snprintf(text, sizeof(text), "%.*f", decimals, value);
+	return text;
+}
+
+string FishBench::usage() {
+	return
+		"Usage: StardewValleyCli [options] bench <benchmark> [arguments]\n"
+		"\n"
+		"Benchmarks:\n"
+		"  model                          size of a fish, allocations to read, copy and walk the catalog\n"
+		"  rows                           allocations to map a row (ours and SQLite's), into a new fish and into the fish reused by forEach\n"
+		"  batch                          fish written per second by update and updateAll, findOne against findMany\n"
+		"  sweep                          every hour x season x weather x location through the catch query engine\n"
+		"  users [count]                  size of the progress and time of the progress queries with count users\n"
+		"  save [items [out] | file]      import of a save file, generated with items items (8000 by default) and written to out if given\n"
+		"\n"
+		"The --repeat count is the number of timed runs, the user is the first user of the database by default.\n";
+}
+
+int FishBench::run(CliOptions options) const {
+	if (options.arguments.empty()) {
+		err << usage();
+		return 2;
+	}
+	if (options.userId < 0) {
+		const vector<User> users = repository.findAllUsers();
+		if (users.empty()) {
+			err << "The database has no users\n";
+			return 1;
+		}
+		options.userId = users.front().getId();
+	}
+
+	const string& benchmark = options.arguments.front();
+	if (benchmark == "model") {
+		model(options.userId, options.repeat);
+	}
+	else if (benchmark == "rows") {
+		rows(options.userId, options.repeat);
+	}
+	else if (benchmark == "batch") {
+		batch(options.userId);
+	}
+	else if (benchmark == "sweep") {
+		sweep(options.userId);
+	}
+	else if (benchmark == "users") {
+		users(vector<string>(options.arguments.begin() + 1, options.arguments.end()));
+	}
+	else if (benchmark == "save") {
+		save(options.userId, vector<string>(options.arguments.begin() + 1, options.arguments.end()));
+	}
+	else {
+		err << "Unknown benchmark: " << benchmark << "\n\n" << usage();
+		return 2;
+	}
+	return 0;
+}
+
+void FishBench::model(const long userId, const int runs) const {
+	// The first read prepares the statements and interns the attribute names, it is not counted
+	repository.findAll(userId);
+
+	vector<Fish> fishList;
+	size_t before = AllocationCounter::count();
+	const auto start = chrono::steady_clock::now();
+	for (int i = 0; i < runs; i++) {
+		fishList = repository.findAll(userId);
+	}
+	const double readMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / runs;
+	const double readAllocations = double(AllocationCounter::count() - before) / runs;
+
+	before = AllocationCounter::count();
+	const vector<Fish> copy = fishList;
+	const size_t copyAllocations = AllocationCounter::count() - before;
+
+	// The sets hand out the interned names, walking them must not allocate
+	size_t names = 0;
+	before = AllocationCounter::count();
+	for (const Fish& fish : copy) {
+		for (const string& season : fish.getSeason()) {
+			names += !season.empty();
+		}
+		for (const string& weather : fish.getWeather()) {
+			names += !weather.empty();
+		}
+		for (const string& location : fish.getLocation()) {
+			names += !location.empty();
+		}
+	}
+	const size_t walkAllocations = AllocationCounter::count() - before;
+
+	writeValues({
+		{ "fish", to_string(fishList.size()) },
+		{ "sizeof_fish", to_string(sizeof(Fish)) },
+		{ "sizeof_fish_data", to_string(sizeof(FishData)) },
+		{ "find_all_ms", formatNumber(readMs, 3) },
+		{ "allocations_per_find_all", formatNumber(readAllocations, 0) },
+		{ "allocations_per_fish", formatNumber(fishList.empty() ? 0 : readAllocations / fishList.size(), 2) },
+		{ "allocations_to_copy_result", to_string(copyAllocations) },
+		{ "attribute_names_walked", to_string(names) },
+		{ "allocations_to_walk_attributes", to_string(walkAllocations) }
+	});
+}
+
+void FishBench::rows(const long userId, const int runs) const {
+	repository.findAll(userId);
+
+	// findAll maps every row into a new fish, as it keeps them all
+	size_t rowCount = 0;
+	size_t before = AllocationCounter::count();
+	size_t sqliteBefore = AllocationCounter::sqliteCount();
+	sqlite3_int64 sqliteBytes = 0;
+	sqlite3_int64 sqlitePeakBytes = 0;
+	sqlite3_status64(SQLITE_STATUS_MEMORY_USED, &sqliteBytes, &sqlitePeakBytes, 1);
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < runs; i++) {
+		rowCount += repository.findAll(userId).size();
+	}
+	const double collectMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / runs;
+	const size_t collectAllocations = AllocationCounter::count() - before;
+	const size_t collectSqliteAllocations = AllocationCounter::sqliteCount() - sqliteBefore;
+
+	// A visitor that keeps nothing lets the cursor map every row into the same fish
+	size_t visited = 0;
+	before = AllocationCounter::count();
+	sqliteBefore = AllocationCounter::sqliteCount();
+	start = chrono::steady_clock::now();
+	for (int i = 0; i < runs; i++) {
+		repository.forEach(userId, [&visited](const Fish& fish) { visited += fish.getId() > 0; });
+	}
+	const double streamMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / runs;
+	const size_t streamAllocations = AllocationCounter::count() - before;
+	const size_t streamSqliteAllocations = AllocationCounter::sqliteCount() - sqliteBefore;
+	sqlite3_status64(SQLITE_STATUS_MEMORY_USED, &sqliteBytes, &sqlitePeakBytes, 0);
+
+	const double rowsRead = max<double>(rowCount, 1);
+	writeValues({
+		{ "rows", to_string(rowCount / runs) },
+		{ "find_all_ms", formatNumber(collectMs, 3) },
+		{ "find_all_allocations", formatNumber(double(collectAllocations) / runs, 0) },
+		{ "allocations_per_row_new_fish", formatNumber(collectAllocations / rowsRead, 2) },
+		{ "sqlite_allocations_per_row_new_fish", formatNumber(collectSqliteAllocations / rowsRead, 2) },
+		{ "for_each_ms", formatNumber(streamMs, 3) },
+		{ "for_each_allocations", formatNumber(double(streamAllocations) / runs, 0) },
+		{ "allocations_per_row_reused_fish", formatNumber(streamAllocations / max<double>(visited, 1), 2) },
+		{ "sqlite_allocations_per_row_reused_fish", formatNumber(streamSqliteAllocations / max<double>(visited, 1), 2) },
+		{ "sqlite_memory_used_bytes", to_string(sqliteBytes) },
+		{ "sqlite_peak_memory_bytes", to_string(sqlitePeakBytes) }
+	});
+}
+
+void FishBench::batch(const long userId) const {
+	const string scratchPath = copyToScratch();
+	if (scratchPath.empty()) {
+		return;
+	}
+
+	{
+		FishDBRepository scratch(scratchPath);
+		const vector<Fish> all = scratch.findAll(userId);
+		if (all.empty()) {
+			err << "The database has no fish\n";
+		}
+		else {
+			out << "       N   update/s  updateAll/s  speedup\n";
+			for (const int count : { 1, 10, 100, 1000 }) {
+				// Every other fish flips its caught flag, so both runs write every row
+				vector<Fish> fishList;
+				for (int i = 0; i < count; i++) {
+					Fish fish = all[i % all.size()];
+					fish.setIsCaught(i % 2 == 0);
+					fishList.push_back(fish);
+				}
+
+				auto start = chrono::steady_clock::now();
+				for (const Fish& fish : fishList) {
+					scratch.update(fish, userId);
+				}
+				const double single = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+				start = chrono::steady_clock::now();
+				scratch.updateAll(fishList, userId);
+				const double batched = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+				char line[96];
+				snprintf(line, sizeof(line), "%8d %10.0f %12.0f %7.1fx\n", count, count / single, count / batched, single / batched);
+				out << line;
+			}
+
+			vector<long> ids;
+			for (const Fish& fish : all) {
+				ids.push_back(fish.getId());
+			}
+			auto start = chrono::steady_clock::now();
+			for (const long id : ids) {
+				scratch.findOne(id, userId);
+			}
+			const double findOneMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+			start = chrono::steady_clock::now();
+			const size_t found = scratch.findMany(ids, userId).size();
+			const double findManyMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+			vector<Fish> created(100);
+			for (size_t i = 0; i < created.size(); i++) {
+				created[i].setName("Bench fish " + to_string(i));
+			}
+			start = chrono::steady_clock::now();
+			scratch.saveAll(created);
+			const double saveAllMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+			writeValues({
+				{ "find_one_loop_ms", formatNumber(findOneMs, 2) + " (" + to_string(ids.size()) + " calls)" },
+				{ "find_many_ms", formatNumber(findManyMs, 2) + " (" + to_string(found) + " fish)" },
+				{ "save_all_100_ms", formatNumber(saveAllMs, 2) }
+			});
+		}
+	}
+	removeScratch(scratchPath);
+}
+
+void FishBench::sweep(const long userId) const {
+	const vector<Fish> all = repository.findAll(userId);
+	auto start = chrono::steady_clock::now();
+	const CatchQueryEngine engine(all);
+	const double buildMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+	const vector<string> seasons = repository.findAllSeasons();
+	const vector<string> weathers = repository.findAllWeathers();
+	const vector<string> locations = repository.findAllLocations();
+
+	// The reference scan matches a fish with All (or Any) values to every value, and a query for All to every fish, as the engine does
+	const uint64_t everySeason = everyValueBits(AttributeKind::Season);
+	const uint64_t everyWeather = everyValueBits(AttributeKind::Weather);
+	const uint64_t everyLocation = everyValueBits(AttributeKind::Location);
+	const uint64_t concreteSeasons = concreteValueBits(AttributeKind::Season, everySeason);
+	const uint64_t concreteWeathers = concreteValueBits(AttributeKind::Weather, everyWeather);
+	const uint64_t concreteLocations = concreteValueBits(AttributeKind::Location, everyLocation);
+	auto queriedBits = [](const AttributeKind kind, const string& name, const uint64_t everyValue, const uint64_t concrete) {
+		const int id = InternTable::of(kind).find(name);
+		return id < 0 || id >= 64 ? uint64_t(0) : expandBits(uint64_t(1) << id, everyValue, concrete);
+	};
+
+	size_t queries = 0;
+	size_t found = 0;
+	size_t mismatches = 0;
+	double engineSeconds = 0;
+	double scanSeconds = 0;
+	for (const string& season : seasons) {
+		for (int hour = 0; hour < 24; hour++) {
+			for (const string& weather : weathers) {
+				for (const string& location : locations) {
+					for (const bool uncaughtOnly : { false, true }) {
+						const int minute = hour * 60;
+						start = chrono::steady_clock::now();
+						const size_t catchable = engine.findCatchable(season, weather, location, minute, uncaughtOnly).size();
+						engineSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+						start = chrono::steady_clock::now();
+						const uint64_t seasonBits = queriedBits(AttributeKind::Season, season, everySeason, concreteSeasons);
+						const uint64_t weatherBits = queriedBits(AttributeKind::Weather, weather, everyWeather, concreteWeathers);
+						const uint64_t locationBits = queriedBits(AttributeKind::Location, location, everyLocation, concreteLocations);
+						size_t scanned = 0;
+						for (const Fish& fish : all) {
+							scanned += (expandBits(fish.getSeason().getBits(), everySeason, concreteSeasons) & seasonBits) != 0
+								&& (expandBits(fish.getWeather().getBits(), everyWeather, concreteWeathers) & weatherBits) != 0
+								&& (expandBits(fish.getLocation().getBits(), everyLocation, concreteLocations) & locationBits) != 0
+								&& fish.getCatchTimes().contains(minute) && (!uncaughtOnly || !fish.getIsCaught());
+						}
+						scanSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+						queries++;
+						found += catchable;
+						mismatches += catchable != scanned;
+					}
+				}
+			}
+		}
+	}
+
+	// The database answers the season, weather and location, the hour is left to the caller, so one call per cell is enough
+	size_t databaseQueries = 0;
+	start = chrono::steady_clock::now();
+	for (const string& season : seasons) {
+		for (const string& weather : weathers) {
+			for (const string& location : locations) {
+				repository.findAllBySeasonWeatherLocation(userId, season, weather, location);
+				databaseQueries++;
+			}
+		}
+	}
+	const double databaseSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	const double sweepQueries = max<double>(queries, 1);
+	writeValues({
+		{ "fish", to_string(all.size()) },
+		{ "buckets", to_string(engine.bucketCount()) },
+		{ "build_ms", formatNumber(buildMs, 3) },
+		{ "queries", to_string(queries) },
+		{ "results", to_string(found) },
+		{ "mismatches_against_scan", to_string(mismatches) },
+		{ "engine_us_per_query", formatNumber(engineSeconds / sweepQueries * 1e6, 2) },
+		{ "scan_us_per_query", formatNumber(scanSeconds / sweepQueries * 1e6, 2) },
+		{ "database_us_per_query", formatNumber(databaseSeconds / max<double>(databaseQueries, 1) * 1e6, 2) }
+	});
+}
+
+void FishBench::users(const vector<string>& arguments) const {
+	const long userCount = arguments.empty() ? 1000 : strtol(arguments[0].c_str(), nullptr, 10);
+	if (userCount < 1) {
+		err << "Usage: bench users [count]\n";
+		return;
+	}
+	const string scratchPath = copyToScratch();
+	if (scratchPath.empty()) {
+		return;
+	}
+
+	// The progress of every user is spread over the fish by their ids, so every run stores the same rows
+	sqlite3* db;
+	if (sqlite3_open(scratchPath.c_str(), &db) != SQLITE_OK) {
+		err << "Failed to open " << scratchPath << ": " << sqlite3_errmsg(db) << "\n";
+		sqlite3_close(db);
+		removeScratch(scratchPath);
+		return;
+	}
+	const string populate =
+		"BEGIN;"
+		"DELETE FROM Users_Fish;"
+		"DELETE FROM Users;"
+		"WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < " + to_string(userCount) + ") "
+		"INSERT INTO Users(id, name) SELECT i, 'user' || i FROM n;"
+		"INSERT INTO Users_Fish(user_id, fish_id, is_caught, is_favorite) "
+		"SELECT u.id, f.id, (u.id * 31 + f.id * 17) % 100 < 20, (u.id * 7 + f.id * 13) % 100 < 3 FROM Users u, Fish f "
+		"WHERE (u.id * 31 + f.id * 17) % 100 < 20 OR (u.id * 7 + f.id * 13) % 100 < 3;"
+		"COMMIT;"
+		"VACUUM;";
+	const bool populated = sqlite3_exec(db, populate.c_str(), nullptr, nullptr, nullptr) == SQLITE_OK;
+	if (!populated) {
+		err << "Failed to add the users: " << sqlite3_errmsg(db) << "\n";
+	}
+	sqlite3_close(db);
+
+	if (populated) {
+		error_code error;
+		const uintmax_t bytes = filesystem::file_size(scratchPath, error);
+
+		FishDBRepository scratch(scratchPath);
+		const long fishCount = scratch.findAllFishNumber();
+		double uncaughtSeconds = 0;
+		double caughtSeconds = 0;
+		double favoriteSeconds = 0;
+		size_t rows = 0;
+		long sampled = 0;
+		for (long userId = 1; userId <= userCount; userId += userCount / 20 + 1) {
+			auto start = chrono::steady_clock::now();
+			rows += scratch.findAllUncaught(userId).size();
+			uncaughtSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+			start = chrono::steady_clock::now();
+			rows += scratch.getCaughtFishNumber(userId);
+			caughtSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+			start = chrono::steady_clock::now();
+			rows += scratch.findAllFavorite(userId).size();
+			favoriteSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+			sampled++;
+		}
+
+		// A user without any row yet must keep the fish it catches
+		const long newUserId = userCount + 1;
+		Fish fish = scratch.findOne(1, newUserId);
+		fish.setIsCaught(true);
+		scratch.update(fish, newUserId);
+
+		sqlite3* counter;
+		long progressRows = 0;
+		if (sqlite3_open(scratchPath.c_str(), &counter) == SQLITE_OK) {
+			sqlite3_stmt* statement;
+			if (sqlite3_prepare_v2(counter, "SELECT COUNT(*) FROM Users_Fish", -1, &statement, nullptr) == SQLITE_OK && sqlite3_step(statement) == SQLITE_ROW) {
+				progressRows = sqlite3_column_int64(statement, 0);
+			}
+			sqlite3_finalize(statement);
+		}
+		sqlite3_close(counter);
+
+		writeValues({
+			{ "users", to_string(userCount) },
+			{ "fish", to_string(fishCount) },
+			{ "progress_rows", to_string(progressRows) },
+			{ "dense_rows", to_string(userCount * fishCount) },
+			{ "database_bytes", to_string(bytes) },
+			{ "uncaught_us", formatNumber(uncaughtSeconds / sampled * 1e6, 0) },
+			{ "caught_count_us", formatNumber(caughtSeconds / sampled * 1e6, 0) },
+			{ "favorite_us", formatNumber(favoriteSeconds / sampled * 1e6, 0) },
+			{ "checksum", to_string(rows) },
+			{ "new_user_keeps_catch", scratch.findOne(1, newUserId).getIsCaught() ? "yes" : "no" }
+		});
+	}
+	removeScratch(scratchPath);
+}
+
+void FishBench::save(const long userId, const vector<string>& arguments) const {
+	const bool generated = arguments.empty() || all_of(arguments[0].begin(), arguments[0].end(), [](const unsigned char c) { return isdigit(c) != 0; });
+	string xml;
+	if (generated) {
+		xml = generateSave(arguments.empty() ? 8000 : strtoul(arguments[0].c_str(), nullptr, 10));
+		if (arguments.size() > 1) {
+			ofstream file(arguments[1], ios::binary);
+			file << xml;
+			if (!file) {
+				err << "Failed to write the save to " << arguments[1] << "\n";
+				return;
+			}
+		}
+	}
+	else {
+		ifstream file(arguments[0], ios::binary);
+		stringstream content;
+		content << file.rdbuf();
+		if (!file) {
+			err << "Failed to read the save " << arguments[0] << "\n";
+			return;
+		}
+		xml = content.str();
+	}
+
+	// The save is read into memory first, so the times are the ones of the parser
+	const SaveFileImporter importer(repository.findAll(userId));
+	SaveFileImport import;
+	for (int i = 0; i < 5; i++) {
+		import = importer.readXml(xml);
+	}
+	if (!import.valid) {
+		err << "The save holds no player\n";
+		return;
+	}
+
+	// A handler that reads every element, so the whole file is parsed
+	struct CountingHandler : SaveFileImporter::SaxHandler {
+		size_t elements = 0;
+		bool startElement(const string_view) override { elements++; return true; }
+		bool endElement(const string_view) override { return true; }
+		bool characters(const string_view) override { return true; }
+	} counter;
+	size_t parsedBytes = 0;
+	auto start = chrono::steady_clock::now();
+	const bool parsed = SaveFileImporter::parseXml(xml, counter, &parsedBytes);
+	const double fullSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	double applyMs = 0;
+	size_t applied = 0;
+	const string scratchPath = copyToScratch();
+	if (!scratchPath.empty()) {
+		{
+			FishDBRepository scratch(scratchPath);
+			vector<Fish> caught = scratch.findMany(import.caughtFishIds, userId);
+			for (Fish& fish : caught) {
+				fish.setIsCaught(true);
+			}
+			start = chrono::steady_clock::now();
+			applied = scratch.updateAll(caught, userId).size();
+			applyMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		}
+		removeScratch(scratchPath);
+	}
+
+	writeValues({
+		{ "save_bytes", to_string(xml.size()) },
+		{ "entries", to_string(import.entries) },
+		{ "matched_fish", to_string(import.caughtFishIds.size()) },
+		{ "unknown_items", to_string(import.unknownItems.size()) },
+		{ "import_parsed_bytes", to_string(import.bytes) },
+		{ "import_ms", formatNumber(import.seconds * 1e3, 2) },
+		{ "import_mb_per_second", formatNumber(import.megabytesPerSecond(), 0) },
+		{ "full_parse", parsed ? to_string(counter.elements) + " elements" : "failed" },
+		{ "full_parse_ms", formatNumber(fullSeconds * 1e3, 2) },
+		{ "full_parse_mb_per_second", formatNumber(fullSeconds > 0 ? parsedBytes / fullSeconds / (1024.0 * 1024.0) : 0, 0) },
+		{ "apply_ms", formatNumber(applyMs, 2) + " (" + to_string(applied) + " fish)" }
+	});
+}
+
+string FishBench::generateSave(const size_t items) {
+	// The keys of the caught fish: 1.6 "(O)id" strings, an older bare name, and items that are not fish
+	const char* caughtKeys[] = {
+		"(O)128", "(O)129", "(O)130", "(O)131", "(O)132", "(O)136", "(O)137", "(O)138", "(O)139", "(O)140",
+		"(O)141", "(O)142", "(O)143", "(O)144", "(O)145", "(O)146", "(O)147", "(O)148", "(O)149", "(O)150",
+		"(O)151", "(O)154", "(O)155", "(O)156", "(O)158", "(O)164", "(O)165", "(O)267", "(O)269", "(O)698",
+		"(O)699", "(O)700", "(O)701", "(O)702", "(O)704", "(O)705", "(O)706", "(O)707", "(O)708", "(O)734",
+		"(O)795", "(O)796", "(O)836", "(O)837", "(O)838", "Goby", "(O)372", "(O)715", "(O)16", "(O)388"
+	};
+	minstd_rand random(1);
+
+	string xml =
+		"<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+		"<SaveGame xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" xmlns:xsd=\"http://www.w3.org/2001/XMLSchema\">\n"
+		"<player>\n<name>Farmer</name>\n<items>\n";
+	for (size_t i = 0; i < items; i++) {
+		const string index = to_string(i % 900);
+		xml += "<Item xsi:type=\"Object\"><isLostItem>false</isLostItem><category>-75</category><hasBeenInInventory>true</hasBeenInInventory>"
+			"<name>Parsnip &amp; co</name><parentSheetIndex>" + index + "</parentSheetIndex><itemId>(O)" + index + "</itemId>"
+			"<specialItem>false</specialItem><stack>" + to_string(i % 99) + "</stack><quality>0</quality><price>35</price><edibility>10</edibility>"
+			"<!-- comment --><tileLocation><X>0</X><Y>0</Y></tileLocation><name2 attr=\"a>b\" /></Item>\n";
+	}
+	xml += "</items>\n<fishCaught>\n";
+	for (const char* key : caughtKeys) {
+		xml += string("<item><key><string>") + key + "</string></key><value><ArrayOfInt><int>" + to_string(random() % 6)
+			+ "</int><int>" + to_string(5 + random() % 36) + "</int></ArrayOfInt></value></item>\n";
+	}
+	xml += "</fishCaught>\n</player>\n<locations>\n";
+	for (size_t i = 0; i < items * 8; i++) {
+		xml += "<GameLocation><name>Loc" + to_string(i) + "</name><objects><item><key><Vector2><X>" + to_string(i)
+			+ "</X><Y>3</Y></Vector2></key><value><Object><name>Stone</name></Object></value></item></objects></GameLocation>\n";
+	}
+
+	// A farmhand's catches come after the locations, they must not be counted for the player
+	xml += "</locations>\n<farmhands><Farmer><fishCaught><item><key><string>(O)163</string></key><value><ArrayOfInt><int>1</int></ArrayOfInt></value></item></fishCaught></Farmer></farmhands>\n</SaveGame>\n";
+	return xml;
+}
+
+string FishBench::copyToScratch() const {
+	const string scratchPath = databasePath + ".bench";
+	removeScratch(scratchPath);
+	if (!repository.backupTo(scratchPath, -1, chrono::milliseconds(0)).succeeded) {
+		err << "Failed to copy the database to " << scratchPath << "\n";
+		return "";
+	}
+	return scratchPath;
+}
+
+void FishBench::removeScratch(const string& scratchPath) const {
+	error_code error;
+	for (const char* suffix : { "", "-wal", "-shm", ".images", ".images.idx" }) {
+		filesystem::remove(scratchPath + suffix, error);
+	}
+}
+
+void FishBench::writeValues(const vector<pair<string, string>>& values) const {
+	size_t width = 0;
+	for (const auto& [name, value] : values) {
+		width = max(width, name.size());
+	}
+	for (const auto& [name, value] : values) {
+		out << name << string(width - name.size() + 2, ' ') << value << "\n";
+	}
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "FishCli.h"
+#include "../repository/FishDBRepository.h"
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+class FishBench {
+
+private:
+	FishDBRepository& repository;
+	string databasePath;
+	ostream& out;
+	ostream& err;
+
+	/*
+	* Measure the size of a fish, and the allocations of reading the catalog, copying it and walking its seasons, weathers and locations
+	* @param userId - the id of the user
+	* @param runs - the number of timed reads of the catalog
+	*/
+	void model(const long userId, const int runs) const;
+
+	/*
+	* Measure the allocations of mapping the rows of the catalog, into a new fish for every row and into one fish reused by the cursor
+	* @param userId - the id of the user
+	* @param runs - the number of timed passes over the catalog
+	*/
+	void rows(const long userId, const int runs) const;
+
+	/*
+	* Measure the fish written per second by update in a loop and by one updateAll, then findOne in a loop against one findMany
+	* The writes go to a scratch copy of the database
+	* @param userId - the id of the user
+	*/
+	void batch(const long userId) const;
+
+	/*
+	* Sweep every hour, season, weather and location, with and without the caught fish, through the catch query engine
+	* Every answer is checked against a scan of the fish, and a sample of the sweep is run against the database
+	* @param userId - the id of the user
+	*/
+	void sweep(const long userId) const;
+
+	/*
+	* Measure the size of the sparse progress and the time of the progress queries, for many users
+	* The users are added to a scratch copy of the database, with 20% of the fish caught and 3% favorite
+	* @param arguments - the number of users, 1000 by default
+	*/
+	void users(const vector<string>& arguments) const;
+
+	/*
+	* Measure the import of a save file: the parse up to the caught fish, the parse of the whole file, and the update of the caught fish
+	* The update goes to a scratch copy of the database
+	* @param userId - the id of the user
+	* @param arguments - a save file, or the number of items of the save generated for the benchmark and the path it is written to, both optional
+	*/
+	void save(const long userId, const vector<string>& arguments) const;
+
+	/*
+	* Generate a large save file: the items of the player, the fish the player caught, then the locations that make up most of a real save
+	* The same number of items always gives the same save
+	* @param items - the number of items of the player, there are eight locations for every item
+	* @return the XML of the save
+	*/
+	static string generateSave(const size_t items);
+
+	/*
+	* Copy the database into a scratch file next to it, for the benchmarks that write
+	* @return the path to the copy, or an empty string if it could not be made
+	*/
+	string copyToScratch() const;
+
+	// Remove the scratch copy of the database and the files next to it
+	void removeScratch(const string& scratchPath) const;
+
+	// Write named values, one on every line, their names aligned
+	void writeValues(const vector<pair<string, string>>& values) const;
+
+public:
+
+	/*
+	* Benchmarks of the repository and the engines behind the service, run by the bench command of the command line tool
+	* @param repository - the repository of the database
+	* @param databasePath - the path to the database
+	* @param out - the stream the measures are written to
+	* @param err - the stream the errors are written to
+	*/
+	FishBench(FishDBRepository& repository, const string& databasePath, ostream& out, ostream& err) noexcept
+		: repository{ repository }, databasePath{ databasePath }, out{ out }, err{ err } {}
+
+	FishBench(const FishBench& other) = delete;
+	FishBench() = delete;
+
+
+	/*
+	* Get the usage text of the benchmarks
+	*/
+	static string usage();
+
+
+	/*
+	* Run the benchmark named by the first argument of the command
+	* @param options - the parsed options, the repeat count is the number of timed runs
+	* @return the exit code: 0 on success, 1 if the benchmark failed, 2 if it is unknown
+	*/
+	int run(CliOptions options) const;
+};
@@ -0,0 +1,499 @@
+#include "FishCli.h"
+#include "../service/BackupManager.h"
+#include "../service/FishQuery.h"
+#include "../utils/CaseFolding.h"
+#include "../utils/JsonWriter.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+
+static string joinArguments(const vector<string>& arguments, const string& separator) {
+	string joined;
+	for (size_t i = 0; i < arguments.size(); i++) {
+		joined += (i == 0 ? "" : separator) + arguments[i];
+	}
+	return joined;
+}
+
+static bool isNumber(const string& text) {
+	return !text.empty() && all_of(text.begin(), text.end(), [](const unsigned char c) { return isdigit(c) != 0; });
+}
+
+// Quotes a CSV cell if it holds a separator, a quote or a line break (RFC 4180)
+static string escapeCsv(const string& text) {
+	if (text.find_first_of(",\"\r\n") == string::npos) {
+		return text;
+	}
+	string escaped = "\"";
+	for (const char c : text) {
+		escaped += c == '"' ? "\"\"" : string(1, c);
+	}
+	return escaped + "\"";
+}
+
+bool FishCli::parseArguments(const vector<string>& arguments, CliOptions& options, string& error) {
+	for (size_t i = 0; i < arguments.size(); i++) {
+		const string& argument = arguments[i];
+		const bool hasValue = i + 1 < arguments.size();
+
+		if (argument == "--db" || argument == "--user" || argument == "--format" || argument == "--repeat") {
+			if (!hasValue) {
+				error = "Missing value of " + argument;
+				return false;
+			}
+			const string& value = arguments[++i];
+			if (argument == "--db") {
+				options.databasePath = value;
+			}
+			else if (argument == "--user") {
+				if (!isNumber(value)) {
+					error = "The user must be an id: " + value;
+					return false;
+				}
+				options.userId = strtol(value.c_str(), nullptr, 10);
+			}
+			else if (argument == "--format") {
+				if (value == "table") {
+					options.format = OutputFormat::Table;
+				}
+				else if (value == "json") {
+					options.format = OutputFormat::Json;
+				}
+				else if (value == "csv") {
+					options.format = OutputFormat::Csv;
+				}
+				else {
+					error = "Unknown format: " + value;
+					return false;
+				}
+			}
+			else {
+				options.repeat = isNumber(value) ? atoi(value.c_str()) : 0;
+				if (options.repeat < 1) {
+					error = "The repeat count must be a positive number: " + value;
+					return false;
+				}
+			}
+		}
+		else if (argument == "--timing") {
+			options.timing = true;
+		}
+		else if (options.command.empty()) {
+			options.command = argument;
+		}
+		else {
+			options.arguments.push_back(argument);
+		}
+	}
+
+	if (options.command.empty()) {
+		error = "Missing command";
+		return false;
+	}
+	return true;
+}
+
+string FishCli::usage() {
+	return
+		"Usage: StardewValleyCli [options] <command> [arguments]\n"
+		"\n"
+		"Commands:\n"
+		"  list [all|uncaught|favorite]   list the fish\n"
+		"  filter <query>                 list the fish matching a filter query, like: season:summer -caught difficulty>70\n"
+		"  search <text>                  list the fish whose name, season, weather or location contains the text\n"
+		"  mark-caught <fish>...          mark fish as caught, by id or by name\n"
+		"  stats                          count the fish, the caught fish and the favorite fish\n"
+		"  backup [dir [pages-per-step]]  snapshot the database into dir (backups next to the database by default), keeping the newest 7\n"
+		"  restore <snapshot>             replace the database with a snapshot\n"
+		"  bench <benchmark> [arguments]  run a benchmark of the repository, bench alone lists them\n"
+		"\n"
+		"Options:\n"
+		"  --db <path>                    the database, stardewValleyDatabase.db by default\n"
+		"  --user <id>                    the user, the first user of the database by default\n"
+		"  --format table|json|csv        the format of the results, table by default\n"
+		"  --repeat <count>               run the command <count> times, the results are written once\n"
+		"  --timing                       write the latency of the runs and the result cache counters to the error stream\n";
+}
+
+int FishCli::run(CliOptions options) const {
+	if (options.userId < 0) {
+		const vector<User> users = service.getAllUsers();
+		if (users.empty()) {
+			err << "The database has no users\n";
+			return 1;
+		}
+		options.userId = users.front().getId();
+	}
+
+	// Every run is timed, but only the results of the last one are written
+	vector<chrono::nanoseconds> durations;
+	durations.reserve(options.repeat);
+	CommandResult result;
+	for (int i = 0; i < options.repeat; i++) {
+		const auto start = chrono::steady_clock::now();
+		result = runOnce(options);
+		durations.push_back(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start));
+		if (result.failed) {
+			return 1;
+		}
+	}
+
+	if (result.isFish) {
+		writeFish(result.fish, options.format);
+	}
+	else {
+		writeValues(result.values, options.format);
+	}
+	if (options.timing) {
+		writeTiming(durations);
+		writeCacheStats();
+		writeConnectionStats();
+	}
+	return 0;
+}
+
+FishCli::CommandResult FishCli::runOnce(const CliOptions& options) const {
+	const long userId = options.userId;
+	const string& command = options.command;
+	CommandResult result;
+
+	if (command == "list") {
+		const string which = options.arguments.empty() ? "all" : options.arguments.front();
+		if (options.arguments.size() > 1 || (which != "all" && which != "uncaught" && which != "favorite")) {
+			err << "Usage: list [all|uncaught|favorite]\n";
+			result.failed = true;
+		}
+		else if (which == "uncaught") {
+			result.fish = service.getAllUncaughtFish(userId);
+		}
+		else if (which == "favorite") {
+			result.fish = service.getAllFavoriteFish(userId);
+		}
+		else {
+			result.fish = service.getAllFish(userId);
+		}
+	}
+	else if (command == "filter") {
+		// The query is compiled on every run, as the search box compiles it on every change of its text
+		const FishQuery query = FishQuery::compile(joinArguments(options.arguments, " "));
+		for (const string& error : query.getErrors()) {
+			err << error << "\n";
+		}
+		result.failed = !query.getErrors().empty();
+		if (!result.failed) {
+			result.fish = service.getFishMatching(userId, query);
+		}
+	}
+	else if (command == "search") {
+		result.fish = service.getAllFishFiltered(userId, joinArguments(options.arguments, " "));
+	}
+	else if (command == "mark-caught") {
+		result = markCaught(userId, options.arguments);
+	}
+	else if (command == "stats") {
+		result = stats(userId);
+	}
+	else if (command == "backup") {
+		result = backup(options.databasePath, options.arguments);
+	}
+	else if (command == "restore") {
+		result = restore(options.arguments);
+	}
+	else {
+		err << "Unknown command: " << command << "\n\n" << usage();
+		result.failed = true;
+	}
+	return result;
+}
+
+FishCli::CommandResult FishCli::markCaught(const long userId, const vector<string>& fishNames) const {
+	CommandResult result;
+	if (fishNames.empty()) {
+		err << "Usage: mark-caught <fish>...\n";
+		result.failed = true;
+		return result;
+	}
+
+	const vector<Fish> fishList = service.getAllFish(userId);
+	unordered_map<string, size_t> fishByName;
+	unordered_map<long, size_t> fishById;
+	for (size_t i = 0; i < fishList.size(); i++) {
+		fishByName[CaseFolding::toLower(fishList[i].getName())] = i;
+		fishById[fishList[i].getId()] = i;
+	}
+
+	// All the fish are resolved before any is written, so an unknown fish leaves the others untouched
+	vector<Fish> requested;
+	for (const string& name : fishNames) {
+		auto byId = isNumber(name) ? fishById.find(strtol(name.c_str(), nullptr, 10)) : fishById.end();
+		auto byName = fishByName.find(CaseFolding::toLower(name));
+		if (byId != fishById.end()) {
+			requested.push_back(fishList[byId->second]);
+		}
+		else if (byName != fishByName.end()) {
+			requested.push_back(fishList[byName->second]);
+		}
+		else {
+			err << "Unknown fish: " << name << "\n";
+			result.failed = true;
+		}
+	}
+	if (result.failed) {
+		return result;
+	}
+
+	vector<Fish> uncaught;
+	for (const Fish& fish : requested) {
+		if (!fish.getIsCaught()) {
+			Fish caught = fish;
+			caught.setIsCaught(true);
+			uncaught.push_back(caught);
+		}
+	}
+	if (!uncaught.empty() && service.updateAllFish(uncaught, userId).empty()) {
+		err << "Failed to mark the fish as caught\n";
+		result.failed = true;
+		return result;
+	}
+
+	for (Fish& fish : requested) {
+		fish.setIsCaught(true);
+	}
+	result.fish = move(requested);
+	return result;
+}
+
+FishCli::CommandResult FishCli::stats(const long userId) const {
+	const long fishNumber = service.getAllFishNumber();
+	const long caughtNumber = service.getCaughtFishNumber(userId);
+	const long favoriteNumber = service.getFavoriteFishNumber(userId);
+
+	char percent[16];
+	snprintf(percent, sizeof(percent), "%.1f", fishNumber > 0 ? 100.0 * caughtNumber / fishNumber : 0.0);
+
+	CommandResult result;
+	result.isFish = false;
+	result.values = {
+		{ "user", to_string(userId) },
+		{ "fish", to_string(fishNumber) },
+		{ "caught", to_string(caughtNumber) },
+		{ "uncaught", to_string(fishNumber - caughtNumber) },
+		{ "favorite", to_string(favoriteNumber) },
+		{ "caught_percent", percent }
+	};
+	return result;
+}
+
+FishCli::CommandResult FishCli::backup(const string& databasePath, const vector<string>& arguments) const {
+	CommandResult result;
+	result.isFish = false;
+	if (arguments.size() > 2 || (arguments.size() == 2 && (!isNumber(arguments[1]) || atoi(arguments[1].c_str()) < 1))) {
+		err << "Usage: backup [directory [pages-per-step]]\n";
+		result.failed = true;
+		return result;
+	}
+
+	const string directory = arguments.empty() ? BackupManager::defaultDirectory(databasePath) : arguments[0];
+	BackupManager manager(service, databasePath, directory, 7, arguments.size() == 2 ? atoi(arguments[1].c_str()) : 64);
+	manager.start();
+	const BackupReport report = manager.wait();
+	if (!report.succeeded) {
+		err << "The backup failed\n";
+		result.failed = true;
+		return result;
+	}
+
+	char seconds[32];
+	char throughput[32];
+	char stall[32];
+	snprintf(seconds, sizeof(seconds), "%.3f", report.seconds);
+	snprintf(throughput, sizeof(throughput), "%.2f", report.megabytesPerSecond());
+	snprintf(stall, sizeof(stall), "%.3f", report.longestStallMs);
+
+	result.values = {
+		{ "snapshot", report.path },
+		{ "pages", to_string(report.pages) },
+		{ "steps", to_string(report.steps) },
+		{ "bytes", to_string(report.bytes) },
+		{ "seconds", seconds },
+		{ "megabytes_per_second", throughput },
+		{ "longest_writer_stall_ms", stall },
+		{ "snapshots_kept", to_string(manager.getSnapshots().size()) }
+	};
+	return result;
+}
+
+FishCli::CommandResult FishCli::restore(const vector<string>& arguments) const {
+	CommandResult result;
+	result.isFish = false;
+	if (arguments.size() != 1) {
+		err << "Usage: restore <snapshot>\n";
+		result.failed = true;
+		return result;
+	}
+
+	if (!service.restoreDatabase(arguments[0])) {
+		err << "The restore failed\n";
+		result.failed = true;
+		return result;
+	}
+	result.values = { { "restored", arguments[0] } };
+	return result;
+}
+
+void FishCli::writeFish(const vector<Fish>& fishList, const OutputFormat format) const {
+	if (format == OutputFormat::Json) {
+		// One fish on every line, so the output can also be read and diffed
+		string json = "[";
+		for (size_t i = 0; i < fishList.size(); i++) {
+			json += i == 0 ? "\n  " : ",\n  ";
+			JsonWriter(json).fish(fishList[i]);
+		}
+		out << json << (fishList.empty() ? "]\n" : "\n]\n");
+		return;
+	}
+
+	if (format == OutputFormat::Csv) {
+		out << "id,name,category,seasons,weathers,locations,start,end,difficulty,movement,caught,favorite\n";
+		for (const Fish& fish : fishList) {
+			out << fish.getId()
+				<< "," << escapeCsv(fish.getName())
+				<< "," << escapeCsv(fish.getCategory())
+				<< "," << escapeCsv(joinArguments(fish.getSeason().toStrings(), ";"))
+				<< "," << escapeCsv(joinArguments(fish.getWeather().toStrings(), ";"))
+				<< "," << escapeCsv(joinArguments(fish.getLocation().toStrings(), ";"))
+				<< "," << escapeCsv(fish.getStartCatchingHour())
+				<< "," << escapeCsv(fish.getEndCatchingHour())
+				<< "," << fish.getDifficulty()
+				<< "," << escapeCsv(fish.getMovement())
+				<< "," << (fish.getIsCaught() ? 1 : 0)
+				<< "," << (fish.getIsFavorite() ? 1 : 0) << "\n";
+		}
+		return;
+	}
+
+	// The table columns are as wide as their longest cell
+	vector<vector<string>> rows = { { "Id", "Name", "Season", "Weather", "Location", "Hours", "Difficulty", "Caught", "Favorite" } };
+	for (const Fish& fish : fishList) {
+		rows.push_back({
+			to_string(fish.getId()),
+			fish.getName(),
+			joinArguments(fish.getSeason().toStrings(), ", "),
+			joinArguments(fish.getWeather().toStrings(), ", "),
+			joinArguments(fish.getLocation().toStrings(), ", "),
+			fish.getStartCatchingHour() + " - " + fish.getEndCatchingHour(),
+			to_string(fish.getDifficulty()),
+			fish.getIsCaught() ? "Yes" : "No",
+			fish.getIsFavorite() ? "Yes" : "No"
+		});
+	}
+	vector<size_t> widths(rows.front().size(), 0);
+	for (const auto& row : rows) {
+		for (size_t column = 0; column < row.size(); column++) {
+			widths[column] = max(widths[column], row[column].size());
+		}
+	}
+	for (const auto& row : rows) {
+		string line;
+		for (size_t column = 0; column < row.size(); column++) {
+			line += row[column];
+			if (column + 1 < row.size()) {
+				line += string(widths[column] - row[column].size() + 2, ' ');
+			}
+		}
+		out << line << "\n";
+	}
+	out << fishList.size() << " fish\n";
+}
+
+void FishCli::writeValues(const vector<pair<string, string>>& values, const OutputFormat format) const {
+	// The values are all numbers, so they are written without quotes in JSON
+	if (format == OutputFormat::Json) {
+		out << "{";
+		for (size_t i = 0; i < values.size(); i++) {
+			string name;
+			JsonWriter::escape(name, values[i].first);
+			out << (i == 0 ? "" : ",") << name << ":" << values[i].second;
+		}
+		out << "}\n";
+	}
+	else if (format == OutputFormat::Csv) {
+		for (size_t i = 0; i < values.size(); i++) {
+			out << (i == 0 ? "" : ",") << values[i].first;
+		}
+		out << "\n";
+		for (size_t i = 0; i < values.size(); i++) {
+			out << (i == 0 ? "" : ",") << values[i].second;
+		}
+		out << "\n";
+	}
+	else {
+		size_t width = 0;
+		for (const auto& [name, value] : values) {
+			width = max(width, name.size());
+		}
+		for (const auto& [name, value] : values) {
+			out << name << string(width - name.size() + 2, ' ') << value << "\n";
+		}
+	}
+}
+
+void FishCli::writeTiming(vector<chrono::nanoseconds> durations) const {
+	if (durations.empty()) {
+		return;
+	}
+	auto milliseconds = [](const chrono::nanoseconds duration) {
+		char text[32];
+		snprintf(text, sizeof(text), "%.3f ms", duration.count() / 1e6);
+		return string(text);
+	};
+
+	// The first run is written apart, it is the only one that reads the fish before the in-memory index is built
+	const chrono::nanoseconds first = durations.front();
+	chrono::nanoseconds total(0);
+	for (const auto duration : durations) {
+		total += duration;
+	}
+	sort(durations.begin(), durations.end());
+	const size_t count = durations.size();
+	const size_t p95 = min(count - 1, (count * 95 + 99) / 100 - 1);
+
+	err << "runs " << count
+		<< ", first " << milliseconds(first)
+		<< ", min " << milliseconds(durations.front())
+		<< ", median " << milliseconds(durations[(count - 1) / 2])
+		<< ", p95 " << milliseconds(durations[p95])
+		<< ", max " << milliseconds(durations.back())
+		<< ", mean " << milliseconds(total / static_cast<long long>(count)) << "\n";
+}
+
+void FishCli::writeCacheStats() const {
+	const FishResultCacheStats stats = service.getResultCacheStats();
+	char hitRatio[16];
+	snprintf(hitRatio, sizeof(hitRatio), "%.1f%%", stats.hitRatio() * 100);
+
+	err << "result cache: hits " << stats.hits
+		<< ", misses " << stats.misses
+		<< ", hit ratio " << hitRatio
+		<< ", invalidations " << stats.invalidations
+		<< ", evictions " << stats.evictions
+		<< ", entries " << stats.entries << "/" << stats.capacity
+		<< ", bytes " << stats.bytes
+		<< ", catalog fish " << stats.catalogFish << "\n";
+}
+
+void FishCli::writeConnectionStats() const {
+	for (const ConnectionPoolStats& stats : service.getConnectionStats()) {
+		char times[160];
+		snprintf(times, sizeof(times), "wait mean %.3f ms, p95 %.3f ms, max %.3f ms, hold mean %.3f ms, p95 %.3f ms, max %.3f ms",
+			stats.meanWaitMs, stats.p95WaitMs, stats.maxWaitMs, stats.meanHoldMs, stats.p95HoldMs, stats.maxHoldMs);
+
+		err << stats.name << " connections: " << stats.connections
+			<< ", acquired " << stats.acquired
+			<< ", waited " << stats.waited
+			<< ", timed out " << stats.timedOut
+			<< ", max queue " << stats.maxQueueDepth
+			<< ", " << times << "\n";
+	}
+}
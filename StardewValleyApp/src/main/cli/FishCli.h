@@ -0,0 +1,136 @@
+#pragma once
+
+#include "../model/Fish.h"
+#include "../service/Service.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// The formats the results of a command can be written in
+enum class OutputFormat { Table, Json, Csv };
+
+
+// The options given before the command
+struct CliOptions {
+	string databasePath = "stardewValleyDatabase.db";
+
+	// The id of the user the command runs for, or -1 for the first user of the database
+	long userId = -1;
+
+	OutputFormat format = OutputFormat::Table;
+
+	// Number of times the command is run, its results are written once
+	int repeat = 1;
+
+	// True to write the latency of the runs to the error stream
+	bool timing = false;
+
+	string command;
+	vector<string> arguments;
+};
+
+
+class FishCli {
+
+private:
+	Service& service;
+	ostream& out;
+	ostream& err;
+
+	// The result of one run of a command: either fish or named values
+	struct CommandResult {
+		vector<Fish> fish;
+		vector<pair<string, string>> values;
+		bool isFish = true;
+		bool failed = false;
+	};
+
+	/*
+	* Run a command once
+	* @param options - the parsed options, with the user resolved
+	* @return the result of the command
+	*/
+	CommandResult runOnce(const CliOptions& options) const;
+
+	/*
+	* Mark the given fish as caught, in one transaction
+	* @param userId - the id of the user
+	* @param fishNames - the ids or names of the fish
+	* @return the fish updated
+	*/
+	CommandResult markCaught(const long userId, const vector<string>& fishNames) const;
+
+	/*
+	* Get the number of fish, caught fish and favorite fish of a user
+	* @param userId - the id of the user
+	*/
+	CommandResult stats(const long userId) const;
+
+	/*
+	* Take a dated snapshot of the database on the backup thread, and keep only the newest snapshots
+	* @param databasePath - the path to the database
+	* @param arguments - the directory of the snapshots and the number of pages copied by every step, both optional
+	*/
+	CommandResult backup(const string& databasePath, const vector<string>& arguments) const;
+
+	/*
+	* Replace the database with a snapshot
+	* @param arguments - the path of the snapshot
+	*/
+	CommandResult restore(const vector<string>& arguments) const;
+
+	void writeFish(const vector<Fish>& fishList, const OutputFormat format) const;
+	void writeValues(const vector<pair<string, string>>& values, const OutputFormat format) const;
+
+	/*
+	* Write the minimum, median, 95th percentile, maximum and mean of the run times to the error stream
+	* @param durations - the time of every run, in the order they were run
+	*/
+	void writeTiming(vector<chrono::nanoseconds> durations) const;
+
+	// Write the counters of the result cache of the service to the error stream
+	void writeCacheStats() const;
+
+	// Write the queue depth, wait and hold times of the connection pools of the database to the error stream
+	void writeConnectionStats() const;
+
+public:
+
+	/*
+	* Command line front end of the service, for scripting and measuring the queries without the windows
+	* @param service - the service the commands run on
+	* @param out - the stream the results are written to
+	* @param err - the stream the errors and the timings are written to
+	*/
+	FishCli(Service& service, ostream& out, ostream& err) noexcept : service{ service }, out{ out }, err{ err } {}
+
+	FishCli(const FishCli& other) = delete;
+	FishCli() = delete;
+
+
+	/*
+	* Parse the arguments of the command line
+	* @param arguments - the arguments, without the name of the program
+	* @param options - receives the parsed options
+	* @param error - receives the reason the arguments are not valid
+	* @return true if the arguments are valid
+	*/
+	static bool parseArguments(const vector<string>& arguments, CliOptions& options, string& error);
+
+
+	/*
+	* Get the usage text of the tool
+	*/
+	static string usage();
+
+
+	/*
+	* Run a command as many times as asked, then write its results and timings
+	* @param options - the parsed options
+	* @return the exit code: 0 on success, 1 if the command failed
+	*/
+	int run(CliOptions options) const;
+};
@@ -9,14 +9,14 @@ CreateUserWindow::CreateUserWindow(QWidget *parent, Service& service)
 	setFixedSize(400, 700);
 }
 
-void CreateUserWindow::setImageCache(QMap<QString, QPixmap> images) {
+void CreateUserWindow::setImageCache(const SpriteAtlas& images) {
 	imageCache = images;
 }
 
 void CreateUserWindow::setupLayout()
 {
-	QPixmap pixmap = imageCache.value("Vertical_Panel");
-	BackgroundWidget* centralWidget = new BackgroundWidget(pixmap, this);
+	Sprite sprite = imageCache.value("Vertical_Panel");
+	BackgroundWidget* centralWidget = new BackgroundWidget(sprite, this);
 
 	QVBoxLayout* mainLayout = new QVBoxLayout(centralWidget);
 	mainLayout->setAlignment(Qt::AlignTop);
@@ -31,7 +31,7 @@ void CreateUserWindow::setupLayout()
 	const QSize hoveredButtonSize(50, 50);
 
 	HoverButton* closeButton = new HoverButton(this, originalButtonSize, hoveredButtonSize);
-	QPixmap closeButtonImage = imageCache.value("Uncheckmark");
+	QPixmap closeButtonImage = imageCache.pixmap("Uncheckmark");
 	closeButton->setStyleSheet("background: transparent; border: none;");
 	closeButton->setIcon(closeButtonImage);
 	connect(closeButton, &HoverButton::clicked, this, &CreateUserWindow::close);
@@ -17,10 +17,10 @@ public:
 	~CreateUserWindow();
 
 	void setupLayout();
-	void setImageCache(QMap<QString, QPixmap> images);
+	void setImageCache(const SpriteAtlas& images);
 
 private:
 	const Service& service;
 
-	QMap<QString, QPixmap> imageCache;
+	SpriteAtlas imageCache;
 };
@@ -1,6 +1,6 @@
 #include "FishDetailsWindow.h"
 
-FishDetailsWindow::FishDetailsWindow(QWidget *parent, Service& service, Fish fish, const long userId, const QPixmap& backgroundImage)
+FishDetailsWindow::FishDetailsWindow(QWidget *parent, Service& service, Fish fish, const long userId, const Sprite& backgroundImage)
 	: BackgroundWidget(backgroundImage, parent), service(service), fish(fish), userId(userId), isDragging(false)
 {
 	qDebug() << "Fish ID in FishDetailsWindow: " << fish.toString();
@@ -13,7 +13,7 @@ FishDetailsWindow::FishDetailsWindow(QWidget *parent, Service& service, Fish fis
 	setCornerRadius(0);
 }
 
-void FishDetailsWindow::setImageCache(QMap<QString, QPixmap> images) {
+void FishDetailsWindow::setImageCache(const SpriteAtlas& images) {
 	imageCache = images;
 }
 
@@ -34,11 +34,9 @@ void FishDetailsWindow::setupLayout()
 
 	// => MAIN LAYOUT WIDGETS
 	imageLabel = new QLabel();
-	QPixmap pixmap;
-	pixmap.loadFromData(reinterpret_cast<const uchar*>(fish.getImage().data()), fish.getImage().size());
-	imageLabel->setPixmap(pixmap);
-	imageLabel->setScaledContents(true);
 	imageLabel->setFixedSize(60, 60);
+	imageLabel->setAlignment(Qt::AlignCenter);
+	imageLabel->setPixmap(ThumbnailCache::thumbnail(fish, 60, imageLabel->devicePixelRatioF()));
 
 
 	QVBoxLayout* titleLayout = new QVBoxLayout();
@@ -79,30 +77,30 @@ void FishDetailsWindow::setupLayout()
 	setSeasons(fish.getSeason());
 	setWeather(fish.getWeather());
 	setLocations(fish.getLocation());
-	setTime(fish.getStartCatchingHour(), fish.getEndCatchingHour());
+	setTime(fish.getCatchTimes());
 	setDifficulty(fish.getDifficulty(), fish.getMovement());
 
 
 
 	// => CUSTOM CHECKBOXES FOR FAVORITE AND CAUGHT
-	QPixmap uncheckmarkPixmap = imageCache.value("Uncheckmark");
-	QPixmap checkmarkPixmap = imageCache.value("Checkmark");
-	QPixmap emptyHeartPixmap = imageCache.value("Empty_Heart");
-	QPixmap heartPixmap = imageCache.value("Heart");
-	QPixmap horizontalPanelPixmap = imageCache.value("Horizontal_Panel");
+	Sprite uncheckmarkSprite = imageCache.value("Uncheckmark");
+	Sprite checkmarkSprite = imageCache.value("Checkmark");
+	Sprite emptyHeartSprite = imageCache.value("Empty_Heart");
+	Sprite heartSprite = imageCache.value("Heart");
+	Sprite horizontalPanelSprite = imageCache.value("Horizontal_Panel");
 
 	// Caught Checkbox
-	caughtCheckbox = new CustomCheckBox(this, horizontalPanelPixmap);
+	caughtCheckbox = new CustomCheckBox(this, horizontalPanelSprite);
 	caughtCheckbox->setFixedSize(40, 40);
 	caughtCheckbox->setToolTipText(QString("Mark as Caught"));
-	caughtCheckbox->setImages(checkmarkPixmap, uncheckmarkPixmap);
+	caughtCheckbox->setImages(checkmarkSprite, uncheckmarkSprite);
 	caughtCheckbox->setChecked(fish.getIsCaught());
 
 	// Favorite Checkbox
-	favoriteCheckbox = new CustomCheckBox(this, horizontalPanelPixmap);
+	favoriteCheckbox = new CustomCheckBox(this, horizontalPanelSprite);
 	favoriteCheckbox->setFixedSize(40, 40);
 	favoriteCheckbox->setToolTipText(QString("Mark as Favorite"));
-	favoriteCheckbox->setImages(heartPixmap, emptyHeartPixmap);
+	favoriteCheckbox->setImages(heartSprite, emptyHeartSprite);
 	favoriteCheckbox->setChecked(fish.getIsFavorite());
 	// <= END
 
@@ -119,6 +117,7 @@ void FishDetailsWindow::setupLayout()
 	connect(closeButton, &QPushButton::clicked, this, &FishDetailsWindow::on_closeButton_clicked);
 	connect(caughtCheckbox, &CustomCheckBox::stateChanged, this, &FishDetailsWindow::onCheckBoxStateChanged);
 	connect(favoriteCheckbox, &CustomCheckBox::stateChanged, this, &FishDetailsWindow::onCheckBoxStateChanged);
+	connect(&service.getChangeBus(), &ChangeBus::fishFlagsChanged, this, &FishDetailsWindow::onFishFlagsChanged);
 
 
 
@@ -147,7 +146,7 @@ void FishDetailsWindow::setupLayout()
 
 
 
-void FishDetailsWindow::setSeasons(const vector<string>& seasons) {
+void FishDetailsWindow::setSeasons(const SeasonSet& seasons) {
 	QString seasonText = "<span style=\"color:red;\">Seasons: </span><br>";
 	for (const auto& season : seasons) {
 		seasonText += QString::fromStdString(season) + "<br>";
@@ -158,7 +157,7 @@ void FishDetailsWindow::setSeasons(const vector<string>& seasons) {
 	seasonsLabel->setText(seasonText);
 }
 
-void FishDetailsWindow::setWeather(const vector<string>& weathers) {
+void FishDetailsWindow::setWeather(const WeatherSet& weathers) {
 	QString weatherText = "<span style=\"color:blue;\">Weather: </span>";
 	for (const auto& weather : weathers) {
 		weatherText += QString::fromStdString(weather) + ", ";
@@ -168,7 +167,7 @@ void FishDetailsWindow::setWeather(const vector<string>& weathers) {
 	weatherLabel->setText(weatherText);
 }
 
-void FishDetailsWindow::setLocations(const vector<string>& locations) {
+void FishDetailsWindow::setLocations(const LocationSet& locations) {
 	QString locationText = "<span style=\"color:green;\">Locations: </span><br>";
 	for (const auto& location : locations) {
 		locationText += QString::fromStdString(location) + "<br>";
@@ -179,24 +178,9 @@ void FishDetailsWindow::setLocations(const vector<string>& locations) {
 	locationsLabel->setText(locationText);
 }
 
-void FishDetailsWindow::setTime(const string& start, const string& end) {
+void FishDetailsWindow::setTime(const CatchTimes& catchTimes) {
 	QString timeText = "<span style=\"color:white;\">Time: </span>";
-	if (start == "Any") {
-		timeLabel->setText(timeText + "Any");
-	}
-	else {
-		QStringList startSplit = QString::fromStdString(start).split(", ");
-		QStringList endSplit = QString::fromStdString(end).split(", ");
-		qDebug() << startSplit << endSplit;
-
-		if (startSplit.size() == 2 && endSplit.size() == 2) {
-			timeLabel->setText(timeText + startSplit[0] + "-" + endSplit[0] + " and " + startSplit[1] + "-" + endSplit[1]);
-		}
-		else {
-			timeLabel->setText(timeText + QString::fromStdString(start) + "-" + QString::fromStdString(end));
-		}
-
-	}
+	timeLabel->setText(timeText + QString::fromStdString(catchTimes.toString()));
 }
 
 void FishDetailsWindow::setDifficulty(int difficulty, const string& movement) {
@@ -242,10 +226,22 @@ void FishDetailsWindow::onCheckBoxStateChanged(bool checked) {
 		fish.setIsFavorite(checked);
 	}
 
+	// The other windows showing the fish are patched by the change notifications of the update
 	service.updateFish(fish, userId);
+}
 
-	qDebug() << "Emitting fishDetailsUpdated signal with fish ID: " << fish.getId();
-	emit fishDetailsUpdated(fish.getId());
+void FishDetailsWindow::onFishFlagsChanged(long changedUserId, const Fish& changedFish, bool wasCaught, bool wasFavorite) {
+	if (changedUserId != userId || changedFish.getId() != fish.getId()) {
+		return;
+	}
+
+	// The fish was changed somewhere else, the checkboxes follow it without updating it again
+	fish.setIsCaught(changedFish.getIsCaught());
+	fish.setIsFavorite(changedFish.getIsFavorite());
+	const QSignalBlocker caughtBlocker(caughtCheckbox);
+	const QSignalBlocker favoriteBlocker(favoriteCheckbox);
+	caughtCheckbox->setChecked(fish.getIsCaught());
+	favoriteCheckbox->setChecked(fish.getIsFavorite());
 }
 
 FishDetailsWindow::~FishDetailsWindow()
@@ -4,6 +4,7 @@
 #include "../service/Service.h"
 #include "../utils/BackgroundWidget.h"
 #include "../utils/CustomCheckBox.h"
+#include "../utils/ThumbnailCache.h"
 #include <QLabel>
 #include <QCheckBox>
 #include <QMainWindow>
@@ -14,6 +15,7 @@
 #include <QPixmap>
 #include <QVBoxLayout>
 #include <QPushButton>
+#include <QSignalBlocker>
 #include <string>
 #include <vector>
 #include "ui_FishDetailsWindow.h"
@@ -25,9 +27,9 @@ class FishDetailsWindow : public BackgroundWidget
 	Q_OBJECT
 
 public:
-	explicit FishDetailsWindow(QWidget* parent, Service& service, Fish fish, const long userId, const QPixmap& backgroundImage);
+	explicit FishDetailsWindow(QWidget* parent, Service& service, Fish fish, const long userId, const Sprite& backgroundImage);
 	~FishDetailsWindow() override;
-	void setImageCache(QMap<QString, QPixmap> images);
+	void setImageCache(const SpriteAtlas& images);
 	void setupLayout();
 
 private:
@@ -55,12 +57,12 @@ private:
 	QLabel* timeLabel;
 	QLabel* difficultyLabel;
 
-	QMap<QString, QPixmap> imageCache;
+	SpriteAtlas imageCache;
 
-	void setSeasons(const vector<string>& seasons);
-	void setWeather(const vector<string>& weather);
-	void setLocations(const vector<string>& locations);
-	void setTime(const string& start, const string& end);
+	void setSeasons(const SeasonSet& seasons);
+	void setWeather(const WeatherSet& weather);
+	void setLocations(const LocationSet& locations);
+	void setTime(const CatchTimes& catchTimes);
 	void setDifficulty(int difficulty, const string& movement);
 
 private slots:
@@ -69,7 +71,5 @@ private slots:
 	void mouseReleaseEvent(QMouseEvent* event);
 	void on_closeButton_clicked();
 	void onCheckBoxStateChanged(bool checked);
-
-signals:
-	void fishDetailsUpdated(long fishId);
+	void onFishFlagsChanged(long changedUserId, const Fish& changedFish, bool wasCaught, bool wasFavorite);
 };
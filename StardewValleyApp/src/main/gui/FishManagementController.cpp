@@ -15,7 +15,7 @@ FishManagementController::FishManagementController(QWidget *parent, const string
     vector<Fish> fishList = service.getAllFish(userId);
 }
 
-void FishManagementController::setImageCache(QMap<QString, QPixmap> images) {
+void FishManagementController::setImageCache(const SpriteAtlas& images) {
     imageCache = images;
 }
 
@@ -28,46 +28,71 @@ void FishManagementController::setupLayout() {
     ui.filtersLayout->setSpacing(10);
     ui.filtersLayout->setContentsMargins(0, 0, 0, 0);
 
-    checkmarkPixmap = imageCache.value("Checkmark_Little");
-    favoritePixmap = imageCache.value("Favorite_Little");
+    checkmarkSprite = imageCache.value("Checkmark_Little");
+    favoriteSprite = imageCache.value("Favorite_Little");
 
 
     // => CREATING FILTER BOXES
-    pixmap = imageCache.value("DescriptionPanel");
-    seasonDetailBox = new DetailBox("Filter by Season", pixmap);
+    sprite = imageCache.value("DescriptionPanel");
+    seasonDetailBox = new DetailBox("Filter by Season", sprite);
     seasonDetailBox->setCornerRadius(0);
     seasonDetailBox->addButton("All (No Filter)");
     seasonDetailBox->addButton("Spring");
     seasonDetailBox->addButton("Summer");
     seasonDetailBox->addButton("Fall");
     seasonDetailBox->addButton("Winter");
-    ComplexHoverButton* seasonButtonFilter = new ComplexHoverButton(pixmap, "S", 70, 70, seasonDetailBox);
+    ComplexHoverButton* seasonButtonFilter = new ComplexHoverButton(sprite, "S", 70, 70, seasonDetailBox);
     ui.filtersLayout->addWidget(seasonButtonFilter);
 
     connect(seasonDetailBox, &DetailBox::buttonClicked, this, &FishManagementController::handleDetailBoxButtonClicked);
 
-    weatherDetailBox = new DetailBox("Filter by Weather", pixmap);
+    weatherDetailBox = new DetailBox("Filter by Weather", sprite);
     weatherDetailBox->setCornerRadius(0);
     weatherDetailBox->addButton("All (No Filter)");
     weatherDetailBox->addButton("Sun");
     weatherDetailBox->addButton("Rain");
     weatherDetailBox->addButton("Wind");
-    ComplexHoverButton* weatherButtonFilter = new ComplexHoverButton(pixmap, "W", 70, 70, weatherDetailBox);
+    ComplexHoverButton* weatherButtonFilter = new ComplexHoverButton(sprite, "W", 70, 70, weatherDetailBox);
     ui.filtersLayout->addWidget(weatherButtonFilter);
 
     connect(weatherDetailBox, &DetailBox::buttonClicked, this, &FishManagementController::handleDetailBoxButtonClicked);
 
-    locationDetailBox = new DetailBox("Filter by Location", pixmap);
+    locationDetailBox = new DetailBox("Filter by Location", sprite);
     locationDetailBox->setCornerRadius(0);
     vector<string> locations = service.getAllLocations();
     locationDetailBox->addButton("All (No Filter)");
     for (const string& location : locations) {
         locationDetailBox->addButton(location);
     }
-    ComplexHoverButton* locationButtonFilter = new ComplexHoverButton(pixmap, "L", 70, 70, locationDetailBox);
+    ComplexHoverButton* locationButtonFilter = new ComplexHoverButton(sprite, "L", 70, 70, locationDetailBox);
     ui.filtersLayout->addWidget(locationButtonFilter);
 
     connect(locationDetailBox, &DetailBox::buttonClicked, this, &FishManagementController::handleDetailBoxButtonClicked);
+
+    // One option for every hour of the fishing day, from 6am to 2am
+    timeDetailBox = new DetailBox("Filter by Time", sprite);
+    timeDetailBox->setCornerRadius(0);
+    timeDetailBox->addButton("All (No Filter)");
+    for (int hour = 6; hour <= 26; hour++) {
+        timeDetailBox->addButton(CatchTimes::formatTime(hour * 60));
+    }
+    ComplexHoverButton* timeButtonFilter = new ComplexHoverButton(sprite, "T", 70, 70, timeDetailBox);
+    ui.filtersLayout->addWidget(timeButtonFilter);
+
+    connect(timeDetailBox, &DetailBox::buttonClicked, this, &FishManagementController::handleTimeBoxButtonClicked);
+
+    sortDetailBox = new DetailBox("Sort by", sprite);
+    sortDetailBox->setCornerRadius(0);
+    sortDetailBox->addButton("Name (A-Z)");
+    sortDetailBox->addButton("Name (Z-A)");
+    sortDetailBox->addButton("Difficulty (Easy first)");
+    sortDetailBox->addButton("Difficulty (Hard first)");
+    sortDetailBox->addButton("Category (A-Z)");
+    sortDetailBox->addButton("Category (Z-A)");
+    ComplexHoverButton* sortButton = new ComplexHoverButton(sprite, "Sort", 70, 70, sortDetailBox);
+    ui.filtersLayout->addWidget(sortButton);
+
+    connect(sortDetailBox, &DetailBox::buttonClicked, this, &FishManagementController::handleSortBoxButtonClicked);
     // <= END
 
     
@@ -77,8 +102,8 @@ void FishManagementController::setupLayout() {
         "border: none;"
         "}");
 
-    pixmap = imageCache.value("Label");
-    BackgroundWidget* lineEditWidget = new BackgroundWidget(pixmap);
+    sprite = imageCache.value("Label");
+    BackgroundWidget* lineEditWidget = new BackgroundWidget(sprite);
     lineEditWidget->setCornerRadius(0);
     QVBoxLayout* lineEditLayout = new QVBoxLayout();
     lineEditWidget->setLayout(lineEditLayout);
@@ -92,8 +117,8 @@ void FishManagementController::setupLayout() {
 
 
     // => TEXT EDIT WIDGET
-    pixmap = imageCache.value("LargePanel");
-    BackgroundWidget* rightWidget = new BackgroundWidget(pixmap);
+    sprite = imageCache.value("LargePanel");
+    BackgroundWidget* rightWidget = new BackgroundWidget(sprite);
     QVBoxLayout* rightLayout = new QVBoxLayout(rightWidget);
     rightLayout->setContentsMargins(10, 10, 10, 10);
     rightLayout->setAlignment(Qt::AlignTop);
@@ -126,15 +151,23 @@ void FishManagementController::setupLayout() {
     locationText->setAlignment(Qt::AlignCenter);
     locationText->setHtml("<div style='text-align: center;'>Location:<br/>?</div>");
 
+    timeText = new QTextEdit();
+    timeText->setMaximumSize(120, 50);
+    timeText->setStyleSheet(styleSheet);
+    timeText->setAlignment(Qt::AlignCenter);
+    timeText->setHtml("<div style='text-align: center;'>Time:<br/>?</div>");
+
     filterChoosesLayout = new QVBoxLayout();
     
     
     filterChoosesLayout->addWidget(seasonText);
     filterChoosesLayout->addWidget(weatherText);
     filterChoosesLayout->addWidget(locationText);
+    filterChoosesLayout->addWidget(timeText);
     seasonText->hide();
     weatherText->hide();
     locationText->hide();
+    timeText->hide();
 
     connect(seasonDetailBox, &DetailBox::buttonClicked, this, &FishManagementController::handleDetailBoxButtonClicked);
     connect(weatherDetailBox, &DetailBox::buttonClicked, this, &FishManagementController::handleDetailBoxButtonClicked);
@@ -150,20 +183,20 @@ void FishManagementController::setupLayout() {
     filterCheckboxLayout->setAlignment(Qt::AlignBottom);
 
     // => Checkboxes
-    QPixmap uncheckmarkPixmap = imageCache.value("Uncheckmark_Panel");
-    QPixmap checkmarkPixmap = imageCache.value("Checkmark_Panel");
-    QPixmap horizontalPanelPixmap = imageCache.value("Horizontal_Panel");
+    Sprite uncheckmarkPanelSprite = imageCache.value("Uncheckmark_Panel");
+    Sprite checkmarkPanelSprite = imageCache.value("Checkmark_Panel");
+    Sprite horizontalPanelSprite = imageCache.value("Horizontal_Panel");
 
-    singleCheckbox = new CustomCheckBox(this, horizontalPanelPixmap);
+    singleCheckbox = new CustomCheckBox(this, horizontalPanelSprite);
     singleCheckbox->setFixedSize(100, 20);
     singleCheckbox->setStyleSheet("font-size: 13px;");
-    singleCheckbox->setImages(checkmarkPixmap, uncheckmarkPixmap);
+    singleCheckbox->setImages(checkmarkPanelSprite, uncheckmarkPanelSprite);
     singleCheckbox->setText("Single Filters");
 
-    multipleCheckbox = new CustomCheckBox(this, horizontalPanelPixmap);
+    multipleCheckbox = new CustomCheckBox(this, horizontalPanelSprite);
     multipleCheckbox->setFixedSize(120, 20);
     multipleCheckbox->setStyleSheet("font-size: 13px;");
-    multipleCheckbox->setImages(checkmarkPixmap, uncheckmarkPixmap);
+    multipleCheckbox->setImages(checkmarkPanelSprite, uncheckmarkPanelSprite);
     multipleCheckbox->setText("Multiple Filters");
 
     QButtonGroup* checkboxGroup = new QButtonGroup(this);
@@ -180,23 +213,23 @@ void FishManagementController::setupLayout() {
     // <= END
 
     // => Caught Fish Checkbox
-    uncaughtFishCheckbox = new CustomCheckBox(this, horizontalPanelPixmap);
+    uncaughtFishCheckbox = new CustomCheckBox(this, horizontalPanelSprite);
     uncaughtFishCheckbox->setFixedSize(130, 20);
     uncaughtFishCheckbox->setStyleSheet("font-size: 13px;");
-    uncaughtFishCheckbox->setImages(checkmarkPixmap, uncheckmarkPixmap);
+    uncaughtFishCheckbox->setImages(checkmarkPanelSprite, uncheckmarkPanelSprite);
     uncaughtFishCheckbox->setText("Show Uncaught");
     // <= END
 
     // => Favorite Fish Checkbox
-    favoriteFishCheckbox = new CustomCheckBox(this, horizontalPanelPixmap);
+    favoriteFishCheckbox = new CustomCheckBox(this, horizontalPanelSprite);
     favoriteFishCheckbox->setFixedSize(130, 20);
     favoriteFishCheckbox->setStyleSheet("font-size: 13px;");
-    favoriteFishCheckbox->setImages(checkmarkPixmap, uncheckmarkPixmap);
+    favoriteFishCheckbox->setImages(checkmarkPanelSprite, uncheckmarkPanelSprite);
     favoriteFishCheckbox->setText("Show Favorite");
     // <= END
 
     // => Refresh Button
-    QPixmap refreshPixmap = imageCache.value("refreshButton");
+    QPixmap refreshPixmap = imageCache.pixmap("refreshButton");
     refreshButton = new QPushButton("");
     refreshButton->setIcon(QIcon(refreshPixmap));
     refreshButton->setIconSize(QSize(50, 50));
@@ -204,6 +237,45 @@ void FishManagementController::setupLayout() {
     refreshButton->setCursor(Qt::PointingHandCursor);
     // <= END
 
+    // => Page Buttons
+    QHBoxLayout* pageLayout = new QHBoxLayout();
+    pageLayout->setSpacing(5);
+
+    previousPageButton = new QPushButton("<");
+    previousPageButton->setStyleSheet("background-color: #D7A96B; color: #4C5550; border: none; border-radius: 5px; font-size: 13px;");
+    previousPageButton->setCursor(Qt::PointingHandCursor);
+    previousPageButton->setFixedSize(25, 25);
+
+    pageLabel = new QLabel("Page 1");
+    pageLabel->setStyleSheet("background: transparent; color: #4C5550; font-size: 13px;");
+    pageLabel->setAlignment(Qt::AlignCenter);
+
+    nextPageButton = new QPushButton(">");
+    nextPageButton->setStyleSheet("background-color: #D7A96B; color: #4C5550; border: none; border-radius: 5px; font-size: 13px;");
+    nextPageButton->setCursor(Qt::PointingHandCursor);
+    nextPageButton->setFixedSize(25, 25);
+
+    pageLayout->addWidget(previousPageButton);
+    pageLayout->addWidget(pageLabel);
+    pageLayout->addWidget(nextPageButton);
+    // <= END
+
+    // => Import Save Button
+    importSaveButton = new QPushButton("Import save");
+    importSaveButton->setStyleSheet("background-color: #D7A96B; color: #4C5550; border: none; border-radius: 5px; font-size: 13px;");
+    importSaveButton->setCursor(Qt::PointingHandCursor);
+    importSaveButton->setFixedSize(100, 25);
+    importSaveButton->setToolTip("Mark as caught the fish caught in a Stardew Valley save file");
+    // <= END
+
+    // => Next Planned Session
+    planText = new QTextEdit();
+    planText->setMaximumSize(120, 90);
+    planText->setStyleSheet(styleSheet);
+    planText->setReadOnly(true);
+    // <= END
+
+    filterCheckboxLayout->addWidget(planText);
     filterCheckboxLayout->addWidget(singleCheckbox);
     filterCheckboxLayout->addWidget(multipleCheckbox);
     filterCheckboxLayout->addWidget(applyMultipleFiltersButton);
@@ -213,6 +285,8 @@ void FishManagementController::setupLayout() {
     filterCheckboxLayout->addWidget(favoriteFishCheckbox);
     QSpacerItem* spacer2 = new QSpacerItem(0, 30, QSizePolicy::Minimum, QSizePolicy::Fixed);
     filterCheckboxLayout->addItem(spacer2);
+    filterCheckboxLayout->addLayout(pageLayout);
+    filterCheckboxLayout->addWidget(importSaveButton);
     filterCheckboxLayout->addWidget(refreshButton);
 
     rightLayout->addLayout(filterCheckboxLayout);
@@ -223,10 +297,14 @@ void FishManagementController::setupLayout() {
     connect(uncaughtFishCheckbox, &QCheckBox::toggled, this, &FishManagementController::onUncaughtFishCheckboxToggled);
     connect(favoriteFishCheckbox, &QCheckBox::toggled, this, &FishManagementController::onFavoriteFishCheckboxToggled);
     connect(refreshButton, &QPushButton::clicked, this, &FishManagementController::refresh);
+    connect(previousPageButton, &QPushButton::clicked, this, &FishManagementController::onPreviousPageClicked);
+    connect(nextPageButton, &QPushButton::clicked, this, &FishManagementController::onNextPageClicked);
+    connect(importSaveButton, &QPushButton::clicked, this, &FishManagementController::onImportSaveClicked);
 
     selectedOptions["season"] = "";
     selectedOptions["weather"] = "";
     selectedOptions["location"] = "";
+    selectedOptions["time"] = "";
 
     rightLayout->setStretch(0, 1);
     rightLayout->setStretch(1, 0);
@@ -234,8 +312,8 @@ void FishManagementController::setupLayout() {
 
 
     // => FISH LAYOUT
-    pixmap = imageCache.value("EmptyPanel");
-    backgroundWidget = new BackgroundWidget(pixmap);
+    sprite = imageCache.value("EmptyPanel");
+    backgroundWidget = new BackgroundWidget(sprite);
     backgroundWidget->setFixedWidth(640);
     fishLayout = new QVBoxLayout();
     fishLayout->setSpacing(0);
@@ -243,19 +321,20 @@ void FishManagementController::setupLayout() {
     fishLayout->setAlignment(Qt::AlignTop);
     backgroundWidget->setLayout(fishLayout);
 
-    populateFishLayout(service.getAllFish(userId));
+    populateAllFishLayout();
+    refreshPlanText();
     // <= END
 
 
 
     // => CLOSE BUTTON LAYOUT
-    pixmap = imageCache.value("Uncheckmark");
+    QPixmap closeButtonPixmap = imageCache.pixmap("Uncheckmark");
     closeButtonLayout = new QHBoxLayout();
     closeButtonLayout->setAlignment(Qt::AlignCenter | Qt::AlignRight);
 
     // Close button
     closeButton = new QPushButton();
-    closeButton->setIcon(QIcon(pixmap));
+    closeButton->setIcon(QIcon(closeButtonPixmap));
     closeButton->setIconSize(QSize(40, 40));
     
     closeButton->setStyleSheet("background: transparent; border: none;");
@@ -271,7 +350,7 @@ void FishManagementController::setupLayout() {
 
 
     // => BOTTOM LAYOUT
-    pixmap = imageCache.value("Label");
+    sprite = imageCache.value("Label");
     QHBoxLayout* achievementLayout = new QHBoxLayout();
     achievementLayout->setAlignment(Qt::AlignCenter | Qt::AlignLeft);
 
@@ -283,8 +362,9 @@ void FishManagementController::setupLayout() {
 
     achievementProgress = new QProgressBar();
     achievementProgress->setFixedSize(200, 30);
-    achievementProgress->setStyleSheet(progressBarUnfinishedStyleSheet);
-    achievementProgress->setValue(service.getCaughtFishNumber(userId) * 100 / service.getAllFishNumber());
+    caughtFishNumber = service.getCaughtFishNumber(userId);
+    allFishNumber = service.getAllFishNumber();
+    updateAchievementProgress();
 
     achievementLayout->addWidget(achievementText);
     achievementLayout->addWidget(achievementProgress);
@@ -297,37 +377,72 @@ void FishManagementController::setupLayout() {
     bottomLayout->addLayout(closeButtonLayout);
 
     fishLayout->addLayout(bottomLayout);
+
+
+    // => CHANGE NOTIFICATIONS (the fish updated here, in a details window or through the HTTP server)
+    connect(&service.getChangeBus(), &ChangeBus::fishFlagsChanged, this, &FishManagementController::onFishFlagsChanged);
+    connect(&service.getChangeBus(), &ChangeBus::catalogChanged, this, &FishManagementController::onCatalogChanged);
+    // <= END
 }
 
 
 
 void FishManagementController::populateFishLayout(const std::vector<Fish>& fishList) {
-	deleteLayouts(fishLayout);
+    clearFishLayout();
+    for (const auto& fish : fishList) {
+        addFishLabel(fish);
+    }
 
-    currentRowLayout = nullptr;
+    // The filtered lists are shown whole, so there are no pages to move through
+    pageCursors.assign(1, "");
+    nextPageCursor.clear();
+    updatePageControls();
+}
 
-    QPixmap fishToolTipImage = imageCache.value("Fish_ToolTip");
-    QPixmap checkmarkImage = imageCache.value("Checkmark_Little");
-    QPixmap favoriteImage = imageCache.value("Favorite_Little");
+void FishManagementController::populateAllFishLayout() {
+    pageCursors.assign(1, "");
+    loadFishPage();
+}
 
-    int fishCount = 0;
-    for (const auto& fish : fishList) {
-        if (fishCount % 10 == 0) {
-            currentRowLayout = new QHBoxLayout();
-            currentRowLayout->setSpacing(0);
-            currentRowLayout->setContentsMargins(20, 0, 20, 0);
-            currentRowLayout->setAlignment(Qt::AlignLeft | Qt::AlignTop);
-            fishLayout->addLayout(currentRowLayout);
-        }
+void FishManagementController::loadFishPage() {
+    clearFishLayout();
+    pageRequest.cursor = pageCursors.back();
+    nextPageCursor = service.forEachFishInPage(userId, pageRequest, [this](const Fish& fish) {
+        addFishLabel(fish);
+    });
+    updatePageControls();
+}
 
-        FishLabel* fishLabel = new FishLabel(fishToolTipImage);
-        fishLabel->setFishDetails(fish, checkmarkImage, favoriteImage);
+void FishManagementController::updatePageControls() {
+    previousPageButton->setEnabled(pageCursors.size() > 1);
+    nextPageButton->setEnabled(!nextPageCursor.empty());
+    pageLabel->setText("Page " + QString::number(pageCursors.size()));
+}
 
-        connect(fishLabel, &FishLabel::clicked, this, &FishManagementController::onFishClicked);
+void FishManagementController::clearFishLayout() {
+	deleteLayouts(fishLayout);
 
-        currentRowLayout->addWidget(fishLabel);
-        fishCount++;
+    currentRowLayout = nullptr;
+    fishToolTipSprite = imageCache.value("Fish_ToolTip");
+    fishCount = 0;
+}
+
+void FishManagementController::addFishLabel(const Fish& fish) {
+    if (fishCount % 10 == 0) {
+        currentRowLayout = new QHBoxLayout();
+        currentRowLayout->setSpacing(0);
+        currentRowLayout->setContentsMargins(20, 0, 20, 0);
+        currentRowLayout->setAlignment(Qt::AlignLeft | Qt::AlignTop);
+        fishLayout->addLayout(currentRowLayout);
     }
+
+    FishLabel* fishLabel = new FishLabel(fishToolTipSprite);
+    fishLabel->setFishDetails(fish, checkmarkSprite, favoriteSprite);
+
+    connect(fishLabel, &FishLabel::clicked, this, &FishManagementController::onFishClicked);
+
+    currentRowLayout->addWidget(fishLabel);
+    fishCount++;
 }
 
 void FishManagementController::deleteLayouts(QLayout* layout) {
@@ -359,24 +474,22 @@ void FishManagementController::deleteLayouts(QLayout* layout) {
 
 
 
-void FishManagementController::onFishDetailsUpdated(long fishId) {
-    qDebug() << "Fish details updated (FishManagementController). Updating fish with ID: " << fishId << "!";
-	
+void FishManagementController::onFishFlagsChanged(long changedUserId, const Fish& fish, bool wasCaught, bool wasFavorite) {
+    if (changedUserId != userId) {
+        return;
+    }
+
+    // The counter is patched from the flags before and after the change, instead of being counted again
+    caughtFishNumber += (fish.getIsCaught() ? 1 : 0) - (wasCaught ? 1 : 0);
+    updateAchievementProgress();
+
     for (int i = 0; i < fishLayout->count(); i++) {
         QHBoxLayout* rowLayout = qobject_cast<QHBoxLayout*>(fishLayout->itemAt(i)->layout());
         if (rowLayout) {
             for (int j = 0; j < rowLayout->count(); j++) {
                 FishLabel* fishLabel = qobject_cast<FishLabel*>(rowLayout->itemAt(j)->widget());
-                if (fishLabel && fishLabel->property("fishId").toLongLong() == fishId) {
-                    Fish updatedFish = service.getFishById(fishId, userId);
-                    qDebug() << updatedFish.getName().c_str() << " " << updatedFish.toString();
-
-                    fishLabel->setFishDetails(updatedFish, checkmarkPixmap, favoritePixmap);
-                    achievementProgress->setValue(service.getCaughtFishNumber(userId) * 100 / service.getAllFishNumber());
-                    if (achievementProgress->value() == 100)
-                        achievementProgress->setStyleSheet(progressBarFinishedStyleSheet);
-                    else
-                        achievementProgress->setStyleSheet(progressBarUnfinishedStyleSheet);
+                if (fishLabel && fishLabel->property("fishId").toLongLong() == fish.getId()) {
+                    fishLabel->setFishDetails(fish, checkmarkSprite, favoriteSprite);
                     return;
                 }
             }
@@ -384,6 +497,13 @@ void FishManagementController::onFishDetailsUpdated(long fishId) {
     }
 }
 
+void FishManagementController::onCatalogChanged(long changedUserId, const QList<long>& fishIds) {
+    // The plan of the user was already patched by the service, it is only written again
+    if (changedUserId == userId) {
+        refreshPlanText();
+    }
+}
+
 
 
 void FishManagementController::onFishClicked(QMouseEvent* event) {
@@ -393,15 +513,13 @@ void FishManagementController::onFishClicked(QMouseEvent* event) {
         qDebug() << "Fish ID (FishManagementController): " << fishId;
         Fish fish = service.getFishById(fishId, userId);
         fish.setId(fishId);
-        pixmap = imageCache.value("Horizontal_Panel");
+        sprite = imageCache.value("Horizontal_Panel");
 
-        FishDetailsWindow* fishWindow = new FishDetailsWindow(nullptr, service, fish, userId, pixmap);
+        FishDetailsWindow* fishWindow = new FishDetailsWindow(nullptr, service, fish, userId, sprite);
         fishWindow->setImageCache(imageCache);
         fishWindow->setupLayout();
 
         connect(fishWindow, &FishDetailsWindow::destroyed, fishWindow, &FishDetailsWindow::deleteLater);
-
-        connect(fishWindow, &FishDetailsWindow::fishDetailsUpdated, this, &FishManagementController::onFishDetailsUpdated);
         fishWindow->show();
     }
 }
@@ -425,6 +543,7 @@ void FishManagementController::handleDetailBoxButtonClicked(const string& option
         seasonText->hide();
         weatherText->hide();
         locationText->hide();
+        timeText->hide();
         if (sender() == seasonDetailBox) {
             qDebug() << "Filtered by season!";
 			populateFishLayout(service.getAllFishBySeason(userId, option));
@@ -489,12 +608,81 @@ void FishManagementController::handleDetailBoxButtonClicked(const string& option
 }
 
 
+void FishManagementController::handleTimeBoxButtonClicked(const string& option) {
+    const int minute = CatchTimes::parseTime(option);
+    if (multipleCheckbox->isChecked()) {
+        if (minute < 0) {
+            selectedOptions["time"] = "";
+            timeText->hide();
+        }
+        else {
+            selectedOptions["time"] = QString::fromStdString(option);
+            timeText->setHtml(
+                "<div style='text-align: center;'>"
+                "<span style='color: purple; font-size: 14px;'>Time:</span><br/>"
+                + QString::fromStdString(option) +
+                "</div>");
+            timeText->show();
+        }
+        return;
+    }
+
+    if (minute < 0) {
+        populateAllFishLayout();
+        return;
+    }
+
+    qDebug() << "Filtered by time: " << QString::fromStdString(option);
+    populateFishLayout(service.getAllFishCatchableAt(userId, minute));
+}
+
+
+void FishManagementController::handleSortBoxButtonClicked(const string& option) {
+    if (option.rfind("Name", 0) == 0) {
+        pageRequest.sortKey = FishSortKey::Name;
+    }
+    else if (option.rfind("Difficulty", 0) == 0) {
+        pageRequest.sortKey = FishSortKey::Difficulty;
+    }
+    else {
+        pageRequest.sortKey = FishSortKey::Category;
+    }
+    pageRequest.direction = option == "Name (Z-A)" || option == "Difficulty (Hard first)" || option == "Category (Z-A)"
+        ? SortDirection::Descending
+        : SortDirection::Ascending;
+
+    qDebug() << "Sorted by: " << QString::fromStdString(option);
+
+    // The sort applies to the whole catalog, so the filters are cleared and the first page is shown
+    refresh();
+}
+
+
+void FishManagementController::onPreviousPageClicked() {
+    if (pageCursors.size() > 1) {
+        pageCursors.pop_back();
+        loadFishPage();
+    }
+}
+
+void FishManagementController::onNextPageClicked() {
+    if (!nextPageCursor.empty()) {
+        pageCursors.push_back(nextPageCursor);
+        loadFishPage();
+    }
+}
+
+
 void FishManagementController::applyFilters() {
     if (multipleCheckbox->isChecked()) {
         QString season = selectedOptions["season"];
         QString weather = selectedOptions["weather"];
         QString location = selectedOptions["location"];
-        populateFishLayout(service.getAllFishBySeasonWeatherLocation(userId, season.toStdString(), weather.toStdString(), location.toStdString()));
+        QString time = selectedOptions["time"];
+        const int minute = time.isEmpty() ? CatchQueryEngine::ANY_TIME : CatchTimes::parseTime(time.toStdString());
+
+        // The conditions are combined in memory, together with the uncaught fish if they are the ones shown
+        populateFishLayout(service.getCatchableFish(userId, season.toStdString(), weather.toStdString(), location.toStdString(), minute, uncaughtFishCheckbox->isChecked()));
     }
 }
 
@@ -508,7 +696,7 @@ void FishManagementController::onUncaughtFishCheckboxToggled(bool checked) {
 		populateFishLayout(service.getAllUncaughtFish(userId));
 	}
     else {
-		populateFishLayout(service.getAllFish(userId));
+		populateAllFishLayout();
 	
     }
 }
@@ -523,13 +711,13 @@ void FishManagementController::onFavoriteFishCheckboxToggled(bool checked) {
         populateFishLayout(service.getAllFavoriteFish(userId));
     }
     else {
-		populateFishLayout(service.getAllFish(userId));
+		populateAllFishLayout();
 	}
 }
 
 
 void FishManagementController::refresh() {
-	populateFishLayout(service.getAllFish(userId));
+	populateAllFishLayout();
     refreshChosenFilters();
     if (uncaughtFishCheckbox->isChecked())
         uncaughtFishCheckbox->setChecked(false);
@@ -537,21 +725,79 @@ void FishManagementController::refresh() {
         favoriteFishCheckbox->setChecked(false);
 }
 
+void FishManagementController::updateAchievementProgress() {
+    achievementProgress->setValue(allFishNumber > 0 ? caughtFishNumber * 100 / allFishNumber : 0);
+    if (achievementProgress->value() == 100)
+        achievementProgress->setStyleSheet(progressBarFinishedStyleSheet);
+    else
+        achievementProgress->setStyleSheet(progressBarUnfinishedStyleSheet);
+}
+
+void FishManagementController::onImportSaveClicked() {
+    const QString path = QFileDialog::getOpenFileName(this, "Import a Stardew Valley save", QDir::homePath() + "/AppData/Roaming/StardewValley/Saves");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    SaveFileImport saveImport = service.importSaveFile(userId, path.toStdString());
+    if (!saveImport.valid) {
+        QMessageBox::warning(this, "Import save", "The file is not a Stardew Valley save.");
+        return;
+    }
+
+    // The imported fish, the progress and the plan were already patched by the change notifications
+    QMessageBox::information(this, "Import save", QString("%1 fish caught in the save, %2 of them newly marked as caught.")
+        .arg(saveImport.caughtFishIds.size())
+        .arg(saveImport.newlyCaught));
+}
+
+void FishManagementController::refreshPlanText() {
+    shared_ptr<const SeasonPlan> plan = service.getSeasonPlan(userId);
+    if (plan->steps.empty()) {
+        planText->setHtml("<div style='text-align: center;'>Next:<br/>Nothing left to plan</div>");
+        return;
+    }
+
+    const PlanStep& next = plan->steps.front();
+    planText->setHtml(
+        "<div style='text-align: center;'>"
+        "<span style='font-size: 12px;'>Next:</span><br/>"
+        + QString::fromStdString(next.season + " " + to_string(next.day) + ", " + CatchTimes::formatTime(next.minute)) + "<br/>"
+        + QString::fromStdString(next.weather + ", " + next.location) + "<br/>"
+        + QString::fromStdString("+" + to_string(next.fish.size()) + " fish, " + to_string(plan->steps.size()) + " sessions") +
+        "</div>");
+    planText->setToolTip(QString::fromStdString(next.toString()));
+}
+
 void FishManagementController::refreshChosenFilters() {
-	selectedOptions["season"] = "All (No Filter)";
-	selectedOptions["weather"] = "All (No Filter)";
-	selectedOptions["location"] = "All (No Filter)";
+	selectedOptions["season"] = "";
+	selectedOptions["weather"] = "";
+	selectedOptions["location"] = "";
+	selectedOptions["time"] = "";
 	seasonText->hide();
 	weatherText->hide();
 	locationText->hide();
+	timeText->hide();
 }
 
 
 void FishManagementController::on_lineEditWidget_textChanged(const QString& text) {
 	qDebug() << "Text changed: " << text;
-    vector<Fish> allFish = service.getAllFishFiltered(userId, text.toStdString());
+    if (text.trimmed().isEmpty()) {
+        ui.filteringCondition->setToolTip("");
+        populateAllFishLayout();
+        return;
+    }
+
+    // The text is compiled once, and the terms that could not be compiled are shown in the tooltip
+    FishQuery query = FishQuery::compile(text.toStdString());
+    QStringList errors;
+    for (const string& error : query.getErrors()) {
+        errors.append(QString::fromStdString(error));
+    }
+    ui.filteringCondition->setToolTip(errors.join("\n"));
 
-    populateFishLayout(allFish);
+    populateFishLayout(service.getFishMatching(userId, query));
 }
 
 
@@ -23,6 +23,8 @@
 #include <vector>
 #include <QTime>
 #include <QTextEdit>
+#include <QFileDialog>
+#include <QMessageBox>
 #include "ui_FishManagementController.h"
 
 using namespace std;
@@ -34,7 +36,7 @@ class FishManagementController : public QMainWindow
 public:
 	explicit FishManagementController(QWidget* parent, const string& databasePath, Service& service, const long userId);
 	~FishManagementController() override;
-	void setImageCache(QMap<QString, QPixmap> images);
+	void setImageCache(const SpriteAtlas& images);
 	void setupLayout();
 
 private:
@@ -51,11 +53,14 @@ private:
 	QTextEdit* seasonText;
 	QTextEdit* weatherText;
 	QTextEdit* locationText;
+	QTextEdit* timeText;
+	QTextEdit* planText;
 
 	CustomCheckBox* singleCheckbox;
 	CustomCheckBox* multipleCheckbox;
 	QPushButton* applyMultipleFiltersButton;
 	QPushButton* refreshButton;
+	QPushButton* importSaveButton;
 	CustomCheckBox* uncaughtFishCheckbox;
 	CustomCheckBox* favoriteFishCheckbox;
 
@@ -63,13 +68,34 @@ private:
 
 	QProgressBar* achievementProgress;
 
+	// Read once when the layout is set up, then patched by the change notifications
+	long caughtFishNumber = 0;
+	long allFishNumber = 0;
+
+	// The grid shows the whole catalog one page at a time, pageCursors holds the cursor of every page up to the current one
+	FishPageRequest pageRequest;
+	vector<string> pageCursors;
+	string nextPageCursor;
+	QPushButton* previousPageButton;
+	QPushButton* nextPageButton;
+	QLabel* pageLabel;
+
 	void populateFishLayout(const vector<Fish>& fishList);
+	void populateAllFishLayout();
+	void loadFishPage();
+	void updatePageControls();
+	void clearFishLayout();
+	void addFishLabel(const Fish& fish);
     void deleteLayouts(QLayout* layout);
 	void refreshChosenFilters();
+	void refreshPlanText();
+	void updateAchievementProgress();
 
 	BackgroundWidget* backgroundWidget;
 	QVBoxLayout* fishLayout;
     QHBoxLayout* currentRowLayout;
+	int fishCount = 0;
+	Sprite fishToolTipSprite;
     QHBoxLayout* closeButtonLayout;
 	QHBoxLayout* achievementLayout;
 	QHBoxLayout* bottomLayout;
@@ -81,11 +107,13 @@ private:
 	DetailBox* seasonDetailBox;
 	DetailBox* weatherDetailBox;
 	DetailBox* locationDetailBox;
+	DetailBox* sortDetailBox;
+	DetailBox* timeDetailBox;
 
-	QMap<QString, QPixmap> imageCache;
-	QPixmap pixmap;
-	QPixmap checkmarkPixmap;
-	QPixmap favoritePixmap;
+	SpriteAtlas imageCache;
+	Sprite sprite;
+	Sprite checkmarkSprite;
+	Sprite favoriteSprite;
 
 	QString progressBarUnfinishedStyleSheet = "QProgressBar {"
 		"background-color: #D7A96B; "
@@ -120,7 +148,13 @@ private slots:
 	void on_closeButton_clicked();
 	void on_lineEditWidget_textChanged(const QString& text);
 	void handleDetailBoxButtonClicked(const string& name);
-	void onFishDetailsUpdated(long fishId);
+	void handleSortBoxButtonClicked(const string& option);
+	void handleTimeBoxButtonClicked(const string& option);
+	void onPreviousPageClicked();
+	void onNextPageClicked();
+	void onImportSaveClicked();
+	void onFishFlagsChanged(long changedUserId, const Fish& fish, bool wasCaught, bool wasFavorite);
+	void onCatalogChanged(long changedUserId, const QList<long>& fishIds);
 
 	void onSingleCheckboxToggled(bool checked);
 	void onMultipleCheckboxToggled(bool checked);
@@ -0,0 +1,97 @@
+#include "FishTableModel.h"
+#include "../utils/ThumbnailCache.h"
+#include <QGuiApplication>
+
+FishTableModel::FishTableModel(const Service& service, const long userId, QObject* parent)
+    : QAbstractTableModel(parent), service(service), userId(userId)
+{
+}
+
+int FishTableModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(fishList.size());
+}
+
+int FishTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant FishTableModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= static_cast<int>(fishList.size())) {
+        return QVariant();
+    }
+    const Fish& fish = fishList[index.row()];
+
+    // The image is decoded on the first paint of its cell, then found in the pixmap cache shared with the fish grid
+    if (role == Qt::DecorationRole && index.column() == Image) {
+        return ThumbnailCache::thumbnail(fish, ICON_SIZE, qApp->devicePixelRatio());
+    }
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    switch (index.column()) {
+    case Name:
+        return QString::fromStdString(fish.getName());
+    case Season:
+        return join(fish.getSeason().toStrings());
+    case Weather:
+        return join(fish.getWeather().toStrings());
+    case Location:
+        return join(fish.getLocation().toStrings());
+    case StartCatchingHour:
+        return QString::fromStdString(fish.getStartCatchingHour());
+    case EndCatchingHour:
+        return QString::fromStdString(fish.getEndCatchingHour());
+    case Difficulty:
+        return QString::number(fish.getDifficulty());
+    case Caught:
+        return QString(fish.getIsCaught() ? "Yes" : "No");
+    default:
+        return QVariant();
+    }
+}
+
+QVariant FishTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    static const QStringList headers = { "Name", "Season", "Weather", "Location", "Start Catching Hour", "End Catching Hour", "Difficulty", "Caught", "Image" };
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal || section < 0 || section >= headers.size()) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    return headers[section];
+}
+
+bool FishTableModel::canFetchMore(const QModelIndex& parent) const
+{
+    return !parent.isValid() && hasMorePages;
+}
+
+void FishTableModel::fetchMore(const QModelIndex& parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+
+    FishPage page = service.getFishPage(userId, pageRequest);
+    pageRequest.cursor = page.nextCursor;
+    hasMorePages = !page.nextCursor.empty();
+    if (page.fish.empty()) {
+        return;
+    }
+
+    const int first = static_cast<int>(fishList.size());
+    beginInsertRows(QModelIndex(), first, first + static_cast<int>(page.fish.size()) - 1);
+    fishList.insert(fishList.end(), make_move_iterator(page.fish.begin()), make_move_iterator(page.fish.end()));
+    endInsertRows();
+}
+
+QString FishTableModel::join(const vector<string>& values)
+{
+    QStringList list;
+    for (const auto& value : values) {
+        list.append(QString::fromStdString(value));
+    }
+    return list.join(", ");
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QStringList>
+#include <string>
+#include <vector>
+#include "../model/Fish.h"
+#include "../service/Service.h"
+
+using namespace std;
+
+class FishTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { Name, Season, Weather, Location, StartCatchingHour, EndCatchingHour, Difficulty, Caught, Image, ColumnCount };
+
+    // Logical size of the fish images shown in the Image column
+    static constexpr int ICON_SIZE = 32;
+
+    /*
+    * Table model of the fish catalog, read one page at a time as the view asks for more rows
+    * The cells are read straight from the fish of the loaded pages, and the images are only decoded when their cell is painted
+    * @param service - the service the pages are read from
+    * @param userId - the id of the logged user
+    * @param parent - the parent object
+    */
+    FishTableModel(const Service& service, const long userId, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // The next page is read when the view is scrolled to the last row, or when the loaded rows do not fill it
+    bool canFetchMore(const QModelIndex& parent = QModelIndex()) const override;
+    void fetchMore(const QModelIndex& parent = QModelIndex()) override;
+
+private:
+    const Service& service;
+    const long userId;
+
+    vector<Fish> fishList;
+    FishPageRequest pageRequest;
+    bool hasMorePages = true;
+
+    static QString join(const vector<string>& values);
+};
@@ -10,13 +10,13 @@ MainWindow::MainWindow(QWidget* parent, const string& databasePath, Service& ser
     setFixedSize(600, 400);
 }
 
-void MainWindow::setImageCache(QMap<QString, QPixmap> images) {
+void MainWindow::setImageCache(const SpriteAtlas& images) {
     imageCache = images;
 }
 
 void MainWindow::setupLayout() {
-    pixmap = imageCache.value("Page");
-    BackgroundWidget* centralWidget = new BackgroundWidget(pixmap, this);
+    sprite = imageCache.value("Page");
+    BackgroundWidget* centralWidget = new BackgroundWidget(sprite, this);
     setCentralWidget(centralWidget);
 
     QVBoxLayout* mainLayout = new QVBoxLayout(centralWidget);
@@ -32,7 +32,7 @@ void MainWindow::setupLayout() {
 
     // Minimize Button
     HoverButton* minimizeButton = new HoverButton(this, originalButtonSize, hoveredButtonSize);
-    QPixmap minimizeButtonImage = imageCache.value("Minimize_Panel");
+    QPixmap minimizeButtonImage = imageCache.pixmap("Minimize_Panel");
     minimizeButton->setStyleSheet("background: transparent; border: none;");
     minimizeButton->setIcon(minimizeButtonImage);
     connect(minimizeButton, &HoverButton::clicked, this, &MainWindow::showMinimized);
@@ -40,7 +40,7 @@ void MainWindow::setupLayout() {
 
     // Return Button
     HoverButton* returnButton = new HoverButton(this, originalButtonSize, hoveredButtonSize);
-    QPixmap returnButtonImage = imageCache.value("Return_Panel");
+    QPixmap returnButtonImage = imageCache.pixmap("Return_Panel");
     returnButton->setStyleSheet("background: transparent; border: none;");
     returnButton->setIcon(returnButtonImage);
     connect(returnButton, &HoverButton::clicked, this, &MainWindow::onReturnButtonClicked);
@@ -48,7 +48,7 @@ void MainWindow::setupLayout() {
     
     // Close Button
     HoverButton* closeButton = new HoverButton(this, originalButtonSize, hoveredButtonSize);
-    QPixmap closeButtonImage = imageCache.value("Close_Panel");
+    QPixmap closeButtonImage = imageCache.pixmap("Close_Panel");
     closeButton->setStyleSheet("background: transparent; border: none;");
     closeButton->setIcon(closeButtonImage);
     connect(closeButton, &HoverButton::clicked, this, &MainWindow::close);
@@ -78,9 +78,9 @@ void MainWindow::setupLayout() {
     QHBoxLayout* imageLayout = new QHBoxLayout();
     imageLayout->setAlignment(Qt::AlignCenter);
 
-    QPixmap firstImageContainerImage = imageCache.value("Bream");
-    QPixmap secondImageContainerImage = imageCache.value("Dish_O'_The_Sea");
-    QPixmap thirdImageContainerImage = imageCache.value("Heart");
+    QPixmap firstImageContainerImage = imageCache.pixmap("Bream");
+    QPixmap secondImageContainerImage = imageCache.pixmap("Dish_O'_The_Sea");
+    QPixmap thirdImageContainerImage = imageCache.pixmap("Heart");
     QWidget* firstImageContainer = createClickableLabel(firstImageContainerImage, "Fish");
     QWidget* secondImageContainer = createClickableLabel(secondImageContainerImage, "Cooking");
     QWidget* thirdImageContainer = createClickableLabel(thirdImageContainerImage, "NPCs");
@@ -112,13 +112,15 @@ void MainWindow::onFirstImageClicked() {
 }
 
 void MainWindow::onSecondImageClicked() {
-    StardewValleyApp* stardewValleyApp = new StardewValleyApp(nullptr, databasePath);
+    StardewValleyApp* stardewValleyApp = new StardewValleyApp(nullptr, service, userId);
+    stardewValleyApp->setAttribute(Qt::WA_DeleteOnClose);
     stardewValleyApp->setWindowTitle("Dishes Window");
     stardewValleyApp->show();
 }
 
 void MainWindow::onThirdImageClicked() {
-    StardewValleyApp* stardewValleyApp = new StardewValleyApp(nullptr, databasePath);
+    StardewValleyApp* stardewValleyApp = new StardewValleyApp(nullptr, service, userId);
+    stardewValleyApp->setAttribute(Qt::WA_DeleteOnClose);
     stardewValleyApp->setWindowTitle("NPCs Window");
     stardewValleyApp->show();
 }
@@ -24,7 +24,7 @@ public:
     ~MainWindow() override;
 
     void setupLayout();
-    void setImageCache(QMap<QString, QPixmap> images);
+    void setImageCache(const SpriteAtlas& images);
 
 private:
 
@@ -66,8 +66,8 @@ private:
     QPoint dragStartPosition;
     QWidget* dragHandle;
 
-    QPixmap pixmap;
-    QMap<QString, QPixmap> imageCache;
+    Sprite sprite;
+    SpriteAtlas imageCache;
 
 private slots:
     void mousePressEvent(QMouseEvent* event);
@@ -38,7 +38,7 @@ void SplashScreen::startLoading()
 {
     // Load images
     QFuture<void> imageFuture = QtConcurrent::run([this]() {
-        imageCache = service.populateImagesCacheMap();
+        imageCache = service.loadSpriteAtlas();
         QMetaObject::invokeMethod(this, &SplashScreen::imagesLoadingComplete, Qt::QueuedConnection);
         });
 
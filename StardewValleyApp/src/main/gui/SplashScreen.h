@@ -38,7 +38,7 @@ private:
 	bool databaseLoaded = false;
 	bool uiInitialized = false;
 
-	QMap<QString, QPixmap> imageCache;
+	SpriteAtlas imageCache;
 	long currentProgress = 0;
 	QTimer* timer;
 
@@ -1,15 +1,13 @@
 #include "StardewValleyApp.h"
 #include "../model/Fish.h"
-#include <QPixmap>
-#include <QIcon>
 #include <iostream>
 #include <fstream>
 #include <filesystem>
 
 using namespace std;
 
-StardewValleyApp::StardewValleyApp(QWidget *parent, const string& databasePath, const long userId)
-    : QMainWindow(parent), fishRepository(databasePath), userId(userId)
+StardewValleyApp::StardewValleyApp(QWidget *parent, Service& service, const long userId)
+    : QMainWindow(parent), model(nullptr), service(service), userId(userId)
 {
     ui.setupUi(this);
 
@@ -23,13 +21,13 @@ StardewValleyApp::StardewValleyApp(QWidget *parent, const string& databasePath,
     // Setup the model and populate it
     setupModel();
 
-    // Set the model to the tableView
+    // Set the model to the tableView, the view asks the model for the pages it shows
     tableView->setModel(model);
+    tableView->setIconSize(QSize(FishTableModel::ICON_SIZE, FishTableModel::ICON_SIZE));
 }
 
 StardewValleyApp::~StardewValleyApp()
 {
-    delete model;
 }
 
 //std::vector<char> readImageFile(const std::string& relativePath) {
@@ -71,41 +69,7 @@ void StardewValleyApp::setupModel()
 
 
 
-    std::vector<Fish> allFish = fishRepository.findAll(userId);
-
-    model = new QStandardItemModel(allFish.size(), 9);
-
-    // Set up the table headers
-    model->setHorizontalHeaderLabels({ "Name", "Season", "Weather", "Location", "Start Catching Hour", "End Catching Hour", "Difficulty", "Caught", "Image" });
-
-    // Populate the model with fish data
-    for (int row = 0; row < allFish.size(); ++row) {
-        const Fish& fish = allFish[row];
-        model->setItem(row, 0, new QStandardItem(QString::fromStdString(fish.getName())));
-        model->setItem(row, 1, new QStandardItem(join(fish.getSeason())));
-        model->setItem(row, 2, new QStandardItem(join(fish.getWeather())));
-        model->setItem(row, 3, new QStandardItem(join(fish.getLocation())));
-        model->setItem(row, 4, new QStandardItem(QString::fromStdString(fish.getStartCatchingHour())));
-        model->setItem(row, 5, new QStandardItem(QString::fromStdString(fish.getEndCatchingHour())));
-        model->setItem(row, 6, new QStandardItem(QString::number(fish.getDifficulty())));
-        model->setItem(row, 7, new QStandardItem(fish.getIsCaught() ? "Yes" : "No"));
-
-        // Convert the image data to QPixmap
-        QPixmap pixmap;
-        pixmap.loadFromData(reinterpret_cast<const uchar*>(fish.getImage().data()), fish.getImage().size());
-
-        // Create a QStandardItem with the QPixmap as icon
-        QStandardItem* imageItem = new QStandardItem();
-        imageItem->setIcon(QIcon(pixmap));
-        model->setItem(row, 8, imageItem);
-    }
+    // The rows are read one page at a time and the images decoded only when painted, so the window opens before any of them;
+    // the pages come from the service of the application, and the model is deleted with the window
+    model = new FishTableModel(service, userId, this);
 }
-
-QString StardewValleyApp::join(const std::vector<std::string>& vec)
-{
-    QStringList list;
-    for (const auto& item : vec) {
-        list.append(QString::fromStdString(item));
-    }
-    return list.join(", ");
-}
\ No newline at end of file
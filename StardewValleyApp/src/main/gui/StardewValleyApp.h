@@ -2,10 +2,10 @@
 
 #include <QtWidgets/QMainWindow>
 #include <QtWidgets/QTableView>
-#include <QtGui/QStandardItemModel>
 #include <string>
 #include "ui_StardewValleyApp.h"
-#include "../repository/FishDBRepository.h"
+#include "../service/Service.h"
+#include "FishTableModel.h"
 
 using namespace std;
 
@@ -14,16 +14,14 @@ class StardewValleyApp : public QMainWindow
     Q_OBJECT
 
 public:
-    StardewValleyApp(QWidget *parent = nullptr, const string& databasePath = "", const long userId = 0);
+    StardewValleyApp(QWidget *parent, Service& service, const long userId);
     ~StardewValleyApp();
 
 private:
     Ui::StardewValleyAppClass ui;
-    QStandardItemModel* model;
-    FishDBRepository fishRepository;
-    string databasePath;
+    FishTableModel* model;
+    Service& service;
     const long userId;
 
     void setupModel();
-    QString join(const vector<std::string>& vec);
 };
\ No newline at end of file
@@ -8,15 +8,17 @@ UserAccountsWindow::UserAccountsWindow(QWidget* parent, const string& databasePa
 	setWindowFlags(Qt::FramelessWindowHint);
 	setAttribute(Qt::WA_TranslucentBackground, true);
 	setAttribute(Qt::WA_StyledBackground, true);
+
+	connect(&service.getChangeBus(), &ChangeBus::fishFlagsChanged, this, &UserAccountsWindow::onFishFlagsChanged);
 }
 
-void UserAccountsWindow::setImageCache(QMap<QString, QPixmap> images) {
+void UserAccountsWindow::setImageCache(const SpriteAtlas& images) {
 	imageCache = images;
 }
 
 void UserAccountsWindow::setupLayout() {
-	pixmap = imageCache.value("Horizontal_Panel");
-	BackgroundWidget* centralWidget = new BackgroundWidget(pixmap, this);
+	sprite = imageCache.value("Horizontal_Panel");
+	BackgroundWidget* centralWidget = new BackgroundWidget(sprite, this);
 	centralWidget->setCornerRadius(0);
 	setCentralWidget(centralWidget);
 
@@ -36,10 +38,10 @@ void UserAccountsWindow::setupLayout() {
 	QHBoxLayout* closeButtonLayout = new QHBoxLayout();
 	closeButtonLayout->setAlignment(Qt::AlignCenter | Qt::AlignRight);
 
-	pixmap = imageCache.value("Uncheckmark");
+	QPixmap closeButtonPixmap = imageCache.pixmap("Uncheckmark");
 	QPushButton* closeButton = new QPushButton();
 	closeButton->setStyleSheet("background: transparent; border: none;");
-	closeButton->setIcon(pixmap);
+	closeButton->setIcon(closeButtonPixmap);
 	closeButton->setIconSize(QSize(40, 40));
 
 	closeButtonLayout->addWidget(closeButton);
@@ -58,21 +60,23 @@ void UserAccountsWindow::setupLayout() {
 	centerLayout->setContentsMargins(25, 10, 25, 25);
 
 	// => User Accounts
-	QPixmap horizontalPanelPixmap = imageCache.value("LargePanel_Unhovered");
-	QPixmap horizontalPanelHoveredPixmap = imageCache.value("LargePanel");
+	Sprite horizontalPanelSprite = imageCache.value("LargePanel_Unhovered");
+	Sprite horizontalPanelHoveredSprite = imageCache.value("LargePanel");
 
 	int userCount = 0;
 
+	fishStatistics.clear();
+	allFishNumber = service.getAllFishNumber();
 	vector<User> users = service.getAllUsers();
 	for (const User& user : users) {
-		BackgroundHoverWidget* userAccountsPanel = createUserAccountPanel(user, horizontalPanelPixmap, horizontalPanelHoveredPixmap);
+		BackgroundHoverWidget* userAccountsPanel = createUserAccountPanel(user, horizontalPanelSprite, horizontalPanelHoveredSprite);
 		userAccountsPanel->setProperty("userId", QVariant::fromValue(user.getId()));
 		centerLayout->addWidget(userAccountsPanel);
 		userCount++;
 	}
 
 	for (int userNo = userCount; userNo < 5; userNo++) {
-		BackgroundHoverWidget* userAccountsPanel = createEmptyAccountPanel(horizontalPanelPixmap, horizontalPanelHoveredPixmap);
+		BackgroundHoverWidget* userAccountsPanel = createEmptyAccountPanel(horizontalPanelSprite, horizontalPanelHoveredSprite);
 		centerLayout->addWidget(userAccountsPanel);
 	}
 	// <= End
@@ -84,18 +88,18 @@ void UserAccountsWindow::setupLayout() {
 
 
 
-BackgroundHoverWidget* UserAccountsWindow::createEmptyAccountPanel(const QPixmap& originalpixmap, const QPixmap& hoveredPixmap) {
-	BackgroundHoverWidget* widget = new BackgroundHoverWidget(originalpixmap, hoveredPixmap, this);
+BackgroundHoverWidget* UserAccountsWindow::createEmptyAccountPanel(const Sprite& originalSprite, const Sprite& hoveredSprite) {
+	BackgroundHoverWidget* widget = new BackgroundHoverWidget(originalSprite, hoveredSprite, this);
 
 	QVBoxLayout* layout = new QVBoxLayout(widget);
 	layout->setAlignment(Qt::AlignCenter);
 
-	QPixmap addButtonPixmap = imageCache.value("AddButton");
-	QPixmap addButtonHoveredPixmap = imageCache.value("AddButton_Hovered");
+	QPixmap addButtonPixmap = imageCache.pixmap("AddButton");
+	QPixmap addButtonHoveredPixmap = imageCache.pixmap("AddButton_Hovered");
 
 	QPushButton* addButton = new QPushButton();
 	addButton->setStyleSheet("background: transparent; border: none;");
-	addButton->setIcon(imageCache.value("AddButton"));
+	addButton->setIcon(addButtonPixmap);
 	addButton->setIconSize(QSize(100, 100));
 
 	layout->addWidget(addButton);
@@ -117,8 +121,8 @@ BackgroundHoverWidget* UserAccountsWindow::createEmptyAccountPanel(const QPixmap
 
 
 
-BackgroundHoverWidget* UserAccountsWindow::createUserAccountPanel(const User& user, const QPixmap& originalpixmap, const QPixmap& hoveredPixmap) {
-	BackgroundHoverWidget* widget = new BackgroundHoverWidget(originalpixmap, hoveredPixmap, this);
+BackgroundHoverWidget* UserAccountsWindow::createUserAccountPanel(const User& user, const Sprite& originalSprite, const Sprite& hoveredSprite) {
+	BackgroundHoverWidget* widget = new BackgroundHoverWidget(originalSprite, hoveredSprite, this);
 
 	QVBoxLayout* layout = new QVBoxLayout(widget);
 	layout->setAlignment(Qt::AlignTop);
@@ -130,7 +134,7 @@ BackgroundHoverWidget* UserAccountsWindow::createUserAccountPanel(const User& us
 	deleteAccountLayout->setAlignment(Qt::AlignRight | Qt::AlignTop);
 	deleteAccountLayout->setContentsMargins(0, 25, 20, 0);
 
-	QPixmap deleteAccountPixmap = imageCache.value("Delete");
+	QPixmap deleteAccountPixmap = imageCache.pixmap("Delete");
 	HoverButton* deleteAccountButton = new HoverButton(nullptr, QSize(40, 40), QSize(60, 60));
 	deleteAccountButton->setStyleSheet("background: transparent; border: none;");
 	deleteAccountButton->setIcon(deleteAccountPixmap);
@@ -198,6 +202,15 @@ BackgroundHoverWidget* UserAccountsWindow::createUserAccountPanel(const User& us
 	achievementsLayout->setAlignment(Qt::AlignBottom);
 	setFontToStatisticsLabels(false);
 
+	// The numbers are read once here, then patched by the change notifications while the window lives
+	FishStatistics& statistics = fishStatistics[user.getId()];
+	statistics.masterAnglerProgress = masterAnglerProgress;
+	statistics.caughtFishLabel = caughtFishLabel;
+	statistics.favoriteFishLabel = favoriteFishLabel;
+	statistics.caughtFishNumber = service.getCaughtFishNumber(user.getId());
+	statistics.favoriteFishNumber = service.getFavoriteFishNumber(user.getId());
+	showFishStatistics(statistics);
+
 	QWidget* containerWidget = new QWidget();
 	containerWidget->setLayout(achievementsLayout);
 
@@ -276,6 +289,27 @@ void UserAccountsWindow::openMainMenu() {
 	close();
 }
 
+void UserAccountsWindow::showFishStatistics(const FishStatistics& statistics) {
+	statistics.masterAnglerProgress->setValue(allFishNumber > 0 ? statistics.caughtFishNumber * 100 / allFishNumber : 0);
+	if (statistics.masterAnglerProgress->value() == 100)
+		statistics.masterAnglerProgress->setStyleSheet(progressBarFinishedStyleSheet);
+	else
+		statistics.masterAnglerProgress->setStyleSheet(progressBarUnfinishedStyleSheet);
+
+	statistics.caughtFishLabel->setText(QString("Caught: %1").arg(statistics.caughtFishNumber));
+	statistics.favoriteFishLabel->setText(QString("Favorite: %1").arg(statistics.favoriteFishNumber));
+}
+
+void UserAccountsWindow::onFishFlagsChanged(long userId, const Fish& fish, bool wasCaught, bool wasFavorite) {
+	auto statistics = fishStatistics.find(userId);
+	if (statistics == fishStatistics.end()) {
+		return;
+	}
+	statistics->caughtFishNumber += (fish.getIsCaught() ? 1 : 0) - (wasCaught ? 1 : 0);
+	statistics->favoriteFishNumber += (fish.getIsFavorite() ? 1 : 0) - (wasFavorite ? 1 : 0);
+	showFishStatistics(*statistics);
+}
+
 void UserAccountsWindow::openCreateAccountWindow() {
 	CreateUserWindow* createUserWindow = new CreateUserWindow(nullptr, service);
 	createUserWindow->setImageCache(imageCache);
@@ -302,11 +336,6 @@ QVBoxLayout* UserAccountsWindow::createProgressBarsLayout(const User& user) {
 
 
 	masterAnglerProgress->setFixedSize(175, 25);
-	masterAnglerProgress->setValue(service.getCaughtFishNumber(user.getId()) * 100 / service.getAllFishNumber());
-	if (masterAnglerProgress->value() == 100)
-		masterAnglerProgress->setStyleSheet(progressBarFinishedStyleSheet);
-	else
-		masterAnglerProgress->setStyleSheet(progressBarUnfinishedStyleSheet);
 
 	masterAnglerLayout->addWidget(masterAnglerText);
 	masterAnglerLayout->addWidget(masterAnglerProgress);
@@ -383,11 +412,9 @@ QVBoxLayout* UserAccountsWindow::createStatisticsLayout(const User& user) {
 
 	QVBoxLayout* fishLayout = new QVBoxLayout();
 
-	caughtFishLabel->setText(QString("Caught: %1").arg(service.getCaughtFishNumber(user.getId())));
 	caughtFishLabel->setAlignment(Qt::AlignCenter);
 	caughtFishLabel->setStyleSheet("color: brown; font-size: 18px;");
 
-	favoriteFishLabel->setText(QString("Favorite: %1").arg(service.getFavoriteFishNumber(user.getId())));
 	favoriteFishLabel->setAlignment(Qt::AlignCenter);
 	favoriteFishLabel->setStyleSheet("color: red; font-size: 18px;");
 
@@ -5,6 +5,9 @@
 #include <QTimer>
 #include <QPropertyAnimation>
 #include <QGraphicsOpacityEffect>
+#include <QMap>
+#include <QProgressBar>
+#include <QLabel>
 #include <string>
 #include "../service/Service.h"
 #include "../utils/BackgroundHoverWidget.h"
@@ -20,7 +23,7 @@ class UserAccountsWindow : public QMainWindow
 public:
 	UserAccountsWindow(QWidget* parent, const string& databasePath, Service& service);
 	~UserAccountsWindow();
-	void setImageCache(QMap<QString, QPixmap> images);
+	void setImageCache(const SpriteAtlas& images);
 	void setupLayout();
 
 private:
@@ -30,11 +33,11 @@ private:
 	Service& service;
 	string databasePath;
 
-	QPixmap pixmap;
-	QMap<QString, QPixmap> imageCache;
+	Sprite sprite;
+	SpriteAtlas imageCache;
 
-	BackgroundHoverWidget* createUserAccountPanel(const User& user, const QPixmap& originalpixmap, const QPixmap& hoveredPixmap);
-	BackgroundHoverWidget* createEmptyAccountPanel(const QPixmap& originalpixmap, const QPixmap& hoveredPixmap);
+	BackgroundHoverWidget* createUserAccountPanel(const User& user, const Sprite& originalSprite, const Sprite& hoveredSprite);
+	BackgroundHoverWidget* createEmptyAccountPanel(const Sprite& originalSprite, const Sprite& hoveredSprite);
 	QString progressBarUnfinishedStyleSheet = "QProgressBar {"
 		"background-color: #D7A96B; "
 		"color: #4C5550;"
@@ -89,6 +92,19 @@ private:
 	QLabel* tenHeartsNpcs;
 	// <= End
 
+	// The widgets showing the fish numbers of a user, and the numbers they show
+	struct FishStatistics {
+		QProgressBar* masterAnglerProgress = nullptr;
+		QLabel* caughtFishLabel = nullptr;
+		QLabel* favoriteFishLabel = nullptr;
+		long caughtFishNumber = 0;
+		long favoriteFishNumber = 0;
+	};
+	QMap<long, FishStatistics> fishStatistics;
+	long allFishNumber = 0;
+
+	void showFishStatistics(const FishStatistics& statistics);
+
 	void deleteUser(const User& user);
 
 private slots:
@@ -96,4 +112,5 @@ private slots:
 	void openMainMenu();
 	void openCreateAccountWindow();
 	void onSwitchTimerTimeout();
+	void onFishFlagsChanged(long userId, const Fish& fish, bool wasCaught, bool wasFavorite);
 };
@@ -2,6 +2,8 @@
 #include "gui/SplashScreen.h"
 #include "repository/FishDBRepository.h"
 #include "service/Service.h"
+#include "service/BackupManager.h"
+#include "server/CatalogHttpServer.h"
 #include <QtWidgets/QApplication>
 #include <iostream>
 #include <fstream>
@@ -122,6 +124,50 @@ int main(int argc, char* argv[])
     // <= END
 
 
+    // => IMAGE STORE MIGRATION (one-shot: moves the image BLOBs out of the database and exits)
+    if (QApplication::arguments().contains("--migrate-images")) {
+        bool migrated = fishRepository.migrateImagesToStore();
+        logFile.close();
+        std::cerr.rdbuf(originalCerr);
+        return migrated ? 0 : -1;
+    }
+    // <= END
+
+
+    // => HTTP SERVER (optional: "--http-port <port>" answers JSON requests about the fish on localhost,
+    //    every "--http-origin <origin>" lets the pages of that origin update the fish)
+    std::vector<string> httpOrigins;
+    for (qsizetype i = 0; i + 1 < QApplication::arguments().size(); i++) {
+        if (QApplication::arguments().at(i) == "--http-origin") {
+            httpOrigins.push_back(QApplication::arguments().at(i + 1).toStdString());
+        }
+    }
+    CatalogHttpServer httpServer(service, httpOrigins);
+    const qsizetype httpPortIndex = QApplication::arguments().indexOf("--http-port");
+    if (httpPortIndex >= 0) {
+        const quint16 httpPort = QApplication::arguments().value(httpPortIndex + 1).toUShort();
+        if (httpPort == 0 || !httpServer.start(httpPort)) {
+            std::cerr << "Failed to start the HTTP server, --http-port must be followed by a free port\n";
+        }
+        else {
+            // The token of the PUT requests changes at every start, the tools updating the fish read it from this file
+            const string tokenPath = databasePath + ".http-token";
+            std::ofstream tokenFile(tokenPath, std::ios::trunc);
+            tokenFile << httpServer.getToken().toStdString() << "\n";
+            std::cerr << "The token of the HTTP server is in " << tokenPath << "\n";
+        }
+    }
+    // <= END
+
+
+    // => BACKUP (optional: "--backup" takes a dated snapshot in the background, into the backups directory next to the database; the newest 7 are kept)
+    BackupManager backupManager(service, databasePath, BackupManager::defaultDirectory(databasePath));
+    if (QApplication::arguments().contains("--backup")) {
+        backupManager.start();
+    }
+    // <= END
+
+
     /*string filePath1 = "src/resources/images/Delete.png";
     saveImagePng("Delete", filePath1, fishRepository);*/
 
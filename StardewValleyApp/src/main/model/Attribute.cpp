@@ -0,0 +1,67 @@
+#include "Attribute.h"
+#include "../utils/CaseFolding.h"
+#include <algorithm>
+#include <mutex>
+
+using namespace std;
+
+InternTable& InternTable::of(const AttributeKind kind) {
+    static InternTable tables[5];
+    return tables[static_cast<int>(kind)];
+}
+
+uint16_t InternTable::intern(const string_view name) {
+    {
+        shared_lock<shared_mutex> lock(mutex);
+        auto id = ids.find(name);
+        if (id != ids.end()) {
+            return id->second;
+        }
+    }
+
+    unique_lock<shared_mutex> lock(mutex);
+    auto id = ids.find(name);
+    if (id != ids.end()) {
+        return id->second;
+    }
+
+    // The key views the string kept in the deque, which does not move when the deque grows
+    names.emplace_back(name);
+    const uint16_t newId = static_cast<uint16_t>(names.size() - 1);
+    ids.emplace(names.back(), newId);
+    return newId;
+}
+
+int InternTable::find(const string_view name) const {
+    shared_lock<shared_mutex> lock(mutex);
+    auto id = ids.find(name);
+    return id != ids.end() ? id->second : -1;
+}
+
+const string& InternTable::name(const uint16_t id) const {
+    shared_lock<shared_mutex> lock(mutex);
+    return names.at(id);
+}
+
+size_t InternTable::size() const {
+    shared_lock<shared_mutex> lock(mutex);
+    return names.size();
+}
+
+uint64_t everyValueBits(const AttributeKind kind) {
+    const InternTable& table = InternTable::of(kind);
+    uint64_t bits = 0;
+    for (size_t id = 0; id < min<size_t>(table.size(), 64); id++) {
+        const string name = CaseFolding::toLower(table.name(static_cast<uint16_t>(id)));
+        if (name == "all" || name == "any") {
+            bits |= uint64_t(1) << id;
+        }
+    }
+    return bits;
+}
+
+uint64_t concreteValueBits(const AttributeKind kind, const uint64_t everyValue) {
+    const size_t size = min<size_t>(InternTable::of(kind).size(), 64);
+    const uint64_t all = size == 64 ? ~uint64_t(0) : (uint64_t(1) << size) - 1;
+    return all & ~everyValue;
+}
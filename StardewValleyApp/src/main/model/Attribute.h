@@ -0,0 +1,178 @@
+#ifndef ATTRIBUTE_H
+#define ATTRIBUTE_H
+
+#include <bitset>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <iterator>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// The kinds of values that a Fish refers to by id instead of holding its own copy of the string
+enum class AttributeKind { Season, Weather, Location, Category, Movement };
+
+
+/**
+ * @brief The InternTable class
+ * Keeps a single copy of every name of one attribute kind and gives every name a small id
+ * There is one table per kind for the whole application, and the names are never removed,
+ * so references to the names stay valid for the lifetime of the application
+ */
+class InternTable {
+
+private:
+    deque<string> names;
+    unordered_map<string_view, uint16_t> ids;
+    mutable shared_mutex mutex;
+
+public:
+    // Get the table of the given attribute kind
+    static InternTable& of(const AttributeKind kind);
+
+    // Get the id of a name, adding the name to the table if it was not seen before
+    uint16_t intern(const string_view name);
+
+    // Get the id of a name, or -1 if the name was never interned
+    int find(const string_view name) const;
+
+    // Get the name with the given id
+    const string& name(const uint16_t id) const;
+
+    // Get the number of names in the table
+    size_t size() const;
+};
+
+
+/**
+ * @brief The AttributeSet class
+ * A set of names of one attribute kind (the seasons, weathers or locations of a Fish), kept as a bitset of interned ids
+ * Iterating the set yields references to the shared names, in the order in which the names were interned
+ */
+template <AttributeKind Kind>
+class AttributeSet {
+
+private:
+    uint64_t bits = 0;
+
+public:
+    // Number of different names a set of this kind can hold
+    static constexpr size_t CAPACITY = 64;
+
+    class const_iterator {
+    private:
+        uint64_t rest;
+
+    public:
+        using iterator_category = forward_iterator_tag;
+        using value_type = string;
+        using difference_type = ptrdiff_t;
+        using pointer = const string*;
+        using reference = const string&;
+
+        explicit const_iterator(const uint64_t rest) : rest(rest) {}
+
+        // The id of the lowest name left is the number of zero bits under its bit
+        reference operator*() const { return InternTable::of(Kind).name(static_cast<uint16_t>(bitset<CAPACITY>((rest & (~rest + 1)) - 1).count())); }
+        pointer operator->() const { return &**this; }
+        const_iterator& operator++() { rest &= rest - 1; return *this; }
+        const_iterator operator++(int) { const_iterator previous = *this; ++*this; return previous; }
+        bool operator==(const const_iterator& other) const { return rest == other.rest; }
+        bool operator!=(const const_iterator& other) const { return rest != other.rest; }
+    };
+
+    // Constructor
+    AttributeSet() = default;
+    AttributeSet(const vector<string>& names) {
+        for (const string& name : names) {
+            insert(name);
+        }
+    }
+
+    // Add a name to the set, interning it if needed
+    void insert(const string_view name) {
+        insertId(InternTable::of(Kind).intern(name));
+    }
+
+    // Add the name with the given id to the set
+    void insertId(const uint16_t id) {
+        if (id >= CAPACITY) {
+            cerr << "Attribute id out of the set capacity: " << id << std::endl;
+            return;
+        }
+        bits |= uint64_t(1) << id;
+    }
+
+    // Check if a name is in the set (the name is not interned if it was never seen)
+    bool contains(const string_view name) const {
+        const int id = InternTable::of(Kind).find(name);
+        return id >= 0 && containsId(static_cast<uint16_t>(id));
+    }
+
+    // Check if the name with the given id is in the set
+    bool containsId(const uint16_t id) const {
+        return id < CAPACITY && (bits >> id) & 1;
+    }
+
+    // Check if the two sets have at least one name in common
+    bool intersects(const AttributeSet& other) const {
+        return (bits & other.bits) != 0;
+    }
+
+    // Get the bits of the set, one bit for every interned id
+    uint64_t getBits() const {
+        return bits;
+    }
+
+    bool empty() const {
+        return bits == 0;
+    }
+
+    size_t size() const {
+        return bitset<CAPACITY>(bits).count();
+    }
+
+    const_iterator begin() const {
+        return const_iterator(bits);
+    }
+
+    const_iterator end() const {
+        return const_iterator(0);
+    }
+
+    // Get a copy of the names of the set, for the callers that need a container of their own
+    vector<string> toStrings() const {
+        return vector<string>(begin(), end());
+    }
+
+    bool operator==(const AttributeSet& other) const {
+        return bits == other.bits;
+    }
+
+    bool operator!=(const AttributeSet& other) const {
+        return bits != other.bits;
+    }
+};
+
+using SeasonSet = AttributeSet<AttributeKind::Season>;
+using WeatherSet = AttributeSet<AttributeKind::Weather>;
+using LocationSet = AttributeSet<AttributeKind::Location>;
+
+
+// Get the bits of the ids of a kind whose names stand for every value of the kind, like the All weather of the fish that bite in any weather
+uint64_t everyValueBits(const AttributeKind kind);
+
+// Get the bits of every value of a kind, without the names that stand for all of them
+uint64_t concreteValueBits(const AttributeKind kind, const uint64_t everyValue);
+
+// Get the bits of a set, with a name that stands for every value replaced by all the concrete values
+inline uint64_t expandBits(const uint64_t bits, const uint64_t everyValue, const uint64_t concrete) {
+    return (bits & everyValue) != 0 ? concrete : bits;
+}
+
+#endif // ATTRIBUTE_H
@@ -0,0 +1,185 @@
+#include "CatchTimes.h"
+#include <cctype>
+
+using namespace std;
+
+// Remove the spaces around a part of the catching hours text
+static string_view trim(string_view text) {
+    while (!text.empty() && isspace(static_cast<unsigned char>(text.front()))) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && isspace(static_cast<unsigned char>(text.back()))) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+// Cut the text before the next separator, and remove it and the separator from the rest
+static string_view nextPart(string_view& rest, const char separator) {
+    const size_t position = rest.find(separator);
+    const string_view part = rest.substr(0, position);
+    rest = position == string_view::npos ? string_view() : rest.substr(position + 1);
+    return part;
+}
+
+// Read a number from the start of the text, or -1 if the text does not start with a digit
+static int readNumber(string_view& text) {
+    if (text.empty() || !isdigit(static_cast<unsigned char>(text.front()))) {
+        return -1;
+    }
+    int number = 0;
+    while (!text.empty() && isdigit(static_cast<unsigned char>(text.front())) && number < 100000) {
+        number = number * 10 + (text.front() - '0');
+        text.remove_prefix(1);
+    }
+    return number;
+}
+
+static bool isAny(const string_view text) {
+    return text.size() == 3 && tolower(static_cast<unsigned char>(text[0])) == 'a' && tolower(static_cast<unsigned char>(text[1])) == 'n' && tolower(static_cast<unsigned char>(text[2])) == 'y';
+}
+
+CatchTimes CatchTimes::parse(const string_view startCatchingHour, const string_view endCatchingHour) {
+    CatchTimes catchTimes;
+    if (isAny(trim(startCatchingHour))) {
+        catchTimes.windows[0] = { 0, MINUTES_PER_DAY };
+        catchTimes.count = 1;
+        return catchTimes;
+    }
+
+    string_view starts = startCatchingHour;
+    string_view ends = endCatchingHour;
+    while (!starts.empty() || !ends.empty()) {
+        const int start = parseTime(nextPart(starts, ','));
+        int end = parseTime(nextPart(ends, ','));
+        if (start < 0 || end < 0 || catchTimes.count == MAX_WINDOWS) {
+            return CatchTimes();
+        }
+
+        // A window that ends at or before its start goes past midnight
+        if (end <= start) {
+            end += MINUTES_PER_DAY;
+        }
+        catchTimes.windows[catchTimes.count++] = { static_cast<uint16_t>(start), static_cast<uint16_t>(end) };
+    }
+    return catchTimes;
+}
+
+CatchTimes CatchTimes::decode(const string_view encoded) {
+    CatchTimes catchTimes;
+    string_view rest = encoded;
+    while (!rest.empty()) {
+        string_view window = nextPart(rest, ',');
+        const int start = readNumber(window);
+        if (window.empty() || window.front() != '-') {
+            return CatchTimes();
+        }
+        window.remove_prefix(1);
+        const int end = readNumber(window);
+        if (start < 0 || end <= start || end > 2 * MINUTES_PER_DAY || !window.empty() || catchTimes.count == MAX_WINDOWS) {
+            return CatchTimes();
+        }
+        catchTimes.windows[catchTimes.count++] = { static_cast<uint16_t>(start), static_cast<uint16_t>(end) };
+    }
+    return catchTimes;
+}
+
+string CatchTimes::encode() const {
+    string encoded;
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) {
+            encoded += ',';
+        }
+        encoded += to_string(windows[i].start) + "-" + to_string(windows[i].end);
+    }
+    return encoded;
+}
+
+bool CatchTimes::contains(const int minute) const {
+    // A window past midnight holds the minutes of the next day after MINUTES_PER_DAY
+    const int dayMinute = ((minute % MINUTES_PER_DAY) + MINUTES_PER_DAY) % MINUTES_PER_DAY;
+    for (size_t i = 0; i < count; i++) {
+        if ((dayMinute >= windows[i].start && dayMinute < windows[i].end) || (dayMinute + MINUTES_PER_DAY >= windows[i].start && dayMinute + MINUTES_PER_DAY < windows[i].end)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CatchTimes::isAnyTime() const {
+    return count == 1 && windows[0].start == 0 && windows[0].end == MINUTES_PER_DAY;
+}
+
+bool CatchTimes::empty() const {
+    return count == 0;
+}
+
+size_t CatchTimes::size() const {
+    return count;
+}
+
+const CatchTimes::Window& CatchTimes::operator[](const size_t index) const {
+    return windows.at(index);
+}
+
+string CatchTimes::toString() const {
+    if (empty()) {
+        return "?";
+    }
+    if (isAnyTime()) {
+        return "Any";
+    }
+
+    string text;
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) {
+            text += " and ";
+        }
+        text += formatTime(windows[i].start) + "-" + formatTime(windows[i].end);
+    }
+    return text;
+}
+
+int CatchTimes::parseTime(string_view time) {
+    time = trim(time);
+    int hour = readNumber(time);
+    int minute = 0;
+    if (!time.empty() && time.front() == ':') {
+        time.remove_prefix(1);
+        minute = readNumber(time);
+    }
+    time = trim(time);
+    if (hour < 1 || hour > 12 || minute < 0 || minute > 59 || time.size() != 2 || tolower(static_cast<unsigned char>(time[1])) != 'm') {
+        return -1;
+    }
+
+    // 12am is midnight and 12pm is noon
+    const char period = static_cast<char>(tolower(static_cast<unsigned char>(time[0])));
+    if (period != 'a' && period != 'p') {
+        return -1;
+    }
+    hour = hour % 12 + (period == 'p' ? 12 : 0);
+    return hour * 60 + minute;
+}
+
+string CatchTimes::formatTime(const int minute) {
+    const int dayMinute = ((minute % MINUTES_PER_DAY) + MINUTES_PER_DAY) % MINUTES_PER_DAY;
+    const int hour = dayMinute / 60;
+    string time = to_string(hour % 12 == 0 ? 12 : hour % 12);
+    if (dayMinute % 60 != 0) {
+        time += (dayMinute % 60 < 10 ? ":0" : ":") + to_string(dayMinute % 60);
+    }
+    return time + (hour < 12 ? "am" : "pm");
+}
+
+bool CatchTimes::operator==(const CatchTimes& other) const {
+    if (count != other.count) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (windows[i].start != other.windows[i].start || windows[i].end != other.windows[i].end) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,73 @@
+#ifndef CATCHTIMES_H
+#define CATCHTIMES_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+/**
+ * @brief The CatchTimes class
+ * The times of the day when a Fish can be caught, as ranges of minutes since midnight
+ * Parsed once from the catching hours text ("6am, 6pm" / "11am, 2am", or "Any"), and kept on the Fish row in encoded form,
+ * so the times can be checked without parsing the text again
+ */
+class CatchTimes {
+
+public:
+    static constexpr int MINUTES_PER_DAY = 24 * 60;
+
+    // Maximum number of windows of a fish, the text of the fish never has more than two
+    static constexpr size_t MAX_WINDOWS = 4;
+
+    // A range of minutes, from start (included) to end (excluded)
+    // A window that goes past midnight ends after MINUTES_PER_DAY, so end is always greater than start
+    struct Window {
+        uint16_t start = 0;
+        uint16_t end = 0;
+    };
+
+private:
+    array<Window, MAX_WINDOWS> windows;
+    uint8_t count = 0;
+
+public:
+    // Constructor
+    CatchTimes() = default;
+
+    // Get the catch times of the catching hours text, or empty catch times if the text cannot be parsed
+    static CatchTimes parse(const string_view startCatchingHour, const string_view endCatchingHour);
+
+    // Get the catch times of a text built by encode
+    static CatchTimes decode(const string_view encoded);
+
+    // Get the catch times as "start-end" minute ranges separated by commas, the form kept on the Fish row
+    string encode() const;
+
+    // Check if the fish can be caught at the given minute of the day
+    bool contains(const int minute) const;
+
+    // Check if the fish can be caught at any time of the day
+    bool isAnyTime() const;
+
+    bool empty() const;
+
+    size_t size() const;
+
+    const Window& operator[](const size_t index) const;
+
+    // Get the catch times as they are shown to the user, like "6am-11am and 6pm-2am"
+    string toString() const;
+
+    // Get the minute of the day of a time like "6am", "12pm" or "6:30pm", or -1 if the time cannot be parsed
+    static int parseTime(string_view time);
+
+    // Get a minute of the day as it is shown to the user, like "6am" or "6:30pm"
+    static string formatTime(const int minute);
+
+    bool operator==(const CatchTimes& other) const;
+};
+
+#endif // CATCHTIMES_H
@@ -4,129 +4,208 @@
 
 using namespace std;
 
-Fish::Fish() {}
-Fish::Fish(const string& name, const string& category, const string& description, const vector<string>& season, const vector<string>& weather, const vector<string>& location, const string& startCatchingHour, const string& endCatchingHour, const long difficulty, const string& movement, const bool isCaught, const bool isFavorite, const std::vector<char>& image) : Entity(0), name(name), category(category), description(description), season(season), weather(weather), location(location), startCatchingHour(startCatchingHour), endCatchingHour(endCatchingHour), difficulty(difficulty), movement(movement), isCaught(isCaught), isFavorite(isFavorite), image(image) {}
-Fish::Fish(const long id, const string& name, const string& category, const string& description, const vector<string>& season, const vector<string>& weather, const vector<string>& location, const string& startCatchingHour, const string& endCatchingHour, const long difficulty, const string& movement, const bool isCaught, const bool isFavorite, const std::vector<char>& image) : Entity(id), name(name), category(category), description(description), season(season), weather(weather), location(location), startCatchingHour(startCatchingHour), endCatchingHour(endCatchingHour), difficulty(difficulty), movement(movement), isCaught(isCaught), isFavorite(isFavorite), image(image) {}
+// Wraps the bytes of an image in a view that owns them, an empty image is no image
+static ImageView ownedImage(vector<char>&& image) {
+    if (image.empty()) {
+        return ImageView();
+    }
+    shared_ptr<const vector<char>> bytes = make_shared<const vector<char>>(std::move(image));
+    return ImageView{ bytes->data(), bytes->size(), bytes };
+}
+
+Fish::Fish() : d(new FishData) {
+    static const uint16_t noCategory = InternTable::of(AttributeKind::Category).intern("");
+    static const uint16_t noMovement = InternTable::of(AttributeKind::Movement).intern("");
+    d->category = noCategory;
+    d->movement = noMovement;
+}
+Fish::Fish(const string& name, const string& category, const string& description, const SeasonSet& season, const WeatherSet& weather, const LocationSet& location, const string& startCatchingHour, const string& endCatchingHour, const long difficulty, const string& movement, const bool isCaught, const bool isFavorite, const std::vector<char>& image) : Entity(0), d(new FishData) {
+    d->name = name;
+    d->category = InternTable::of(AttributeKind::Category).intern(category);
+    d->description = description;
+    d->season = season;
+    d->weather = weather;
+    d->location = location;
+    d->startCatchingHour = startCatchingHour;
+    d->endCatchingHour = endCatchingHour;
+    d->catchTimes = CatchTimes::parse(startCatchingHour, endCatchingHour);
+    d->difficulty = difficulty;
+    d->movement = InternTable::of(AttributeKind::Movement).intern(movement);
+    d->isCaught = isCaught;
+    d->isFavorite = isFavorite;
+    d->image = ownedImage(vector<char>(image));
+}
+Fish::Fish(const long id, const string& name, const string& category, const string& description, const SeasonSet& season, const WeatherSet& weather, const LocationSet& location, const string& startCatchingHour, const string& endCatchingHour, const long difficulty, const string& movement, const bool isCaught, const bool isFavorite, const std::vector<char>& image) : Entity(id), d(new FishData) {
+    d->name = name;
+    d->category = InternTable::of(AttributeKind::Category).intern(category);
+    d->description = description;
+    d->season = season;
+    d->weather = weather;
+    d->location = location;
+    d->startCatchingHour = startCatchingHour;
+    d->endCatchingHour = endCatchingHour;
+    d->catchTimes = CatchTimes::parse(startCatchingHour, endCatchingHour);
+    d->difficulty = difficulty;
+    d->movement = InternTable::of(AttributeKind::Movement).intern(movement);
+    d->isCaught = isCaught;
+    d->isFavorite = isFavorite;
+    d->image = ownedImage(vector<char>(image));
+}
 
 const string& Fish::getName() const {
-    return this->name;
+    return d->name;
 }
 
 const string& Fish::getCategory() const {
-	return this->category;
+	return InternTable::of(AttributeKind::Category).name(d->category);
 }
 
 const string& Fish::getDescription() const {
-	return this->description;
+	return d->description;
 }
 
-const vector<string>& Fish::getSeason() const {
-    return this->season;
+const SeasonSet& Fish::getSeason() const {
+    return d->season;
 }
 
-const vector<string>& Fish::getWeather() const {
-    return this->weather;
+const WeatherSet& Fish::getWeather() const {
+    return d->weather;
 }
 
-const vector<string>& Fish::getLocation() const {
-    return this->location;
+const LocationSet& Fish::getLocation() const {
+    return d->location;
 }
 
 const string& Fish::getStartCatchingHour() const {
-    return this->startCatchingHour;
+    return d->startCatchingHour;
 }
 
 const string& Fish::getEndCatchingHour() const {
-    return this->endCatchingHour;
+    return d->endCatchingHour;
+}
+
+const CatchTimes& Fish::getCatchTimes() const {
+    return d->catchTimes;
 }
 
 long Fish::getDifficulty() const {
-    return this->difficulty;
+    return d->difficulty;
 }
 
 const string& Fish::getMovement() const {
-	return this->movement;
+	return InternTable::of(AttributeKind::Movement).name(d->movement);
 }
 
 bool Fish::getIsCaught() const {
-    return this->isCaught;
+    return d->isCaught;
 }
 
 bool Fish::getIsFavorite() const {
-    return this->isFavorite;
+    return d->isFavorite;
+}
+
+const ImageView& Fish::getImage() const {
+    return d->image;
+}
+
+const string& Fish::getImageHash() const {
+    return d->imageHash;
 }
 
-const std::vector<char>& Fish::getImage() const {
-    return this->image;
+void Fish::setName(const string_view name) {
+    d->name.assign(name.data(), name.size());
 }
 
-void Fish::setName(const string& name) {
-    this->name = name;
+void Fish::setCategory(const string_view category) {
+	d->category = InternTable::of(AttributeKind::Category).intern(category);
 }
 
-void Fish::setCategory(const string& category) {
-	this->category = category;
+void Fish::setDescription(const string_view description) {
+    d->description.assign(description.data(), description.size());
 }
 
-void Fish::setDescription(const string& description) {
-    this->description = description;
+void Fish::setSeason(const SeasonSet& season) {
+    d->season = season;
 }
 
-void Fish::setSeason(const vector<string>& season) {
-    this->season = season;
+void Fish::setWeather(const WeatherSet& weather) {
+    d->weather = weather;
 }
 
-void Fish::setWeather(const vector<string>& weather) {
-    this->weather = weather;
+void Fish::setLocation(const LocationSet& location) {
+    d->location = location;
 }
 
-void Fish::setLocation(const vector<string>& location) {
-    this->location = location;
+void Fish::setStartCatchingHour(const string_view startCatchingHour) {
+    d->startCatchingHour.assign(startCatchingHour.data(), startCatchingHour.size());
+    d->catchTimes = CatchTimes::parse(d->startCatchingHour, d->endCatchingHour);
 }
 
-void Fish::setStartCatchingHour(const string& startCatchingHour) {
-    this->startCatchingHour = startCatchingHour;
+void Fish::setEndCatchingHour(const string_view endCatchingHour) {
+    d->endCatchingHour.assign(endCatchingHour.data(), endCatchingHour.size());
+    d->catchTimes = CatchTimes::parse(d->startCatchingHour, d->endCatchingHour);
 }
 
-void Fish::setEndCatchingHour(const string& endCatchingHour) {
-    this->endCatchingHour = endCatchingHour;
+void Fish::setCatchingHours(const string_view startCatchingHour, const string_view endCatchingHour, const CatchTimes& catchTimes) {
+    d->startCatchingHour.assign(startCatchingHour.data(), startCatchingHour.size());
+    d->endCatchingHour.assign(endCatchingHour.data(), endCatchingHour.size());
+    d->catchTimes = catchTimes;
 }
 
 void Fish::setDifficulty(const long difficulty) {
-    this->difficulty = difficulty;
+    d->difficulty = difficulty;
 }
 
-void Fish::setMovement(const string& movement) {
-	this->movement = movement;
+void Fish::setMovement(const string_view movement) {
+	d->movement = InternTable::of(AttributeKind::Movement).intern(movement);
 }
 
 void Fish::setIsCaught(const bool isCaught) {
-    this->isCaught = isCaught;
+    d->isCaught = isCaught;
 }
 
 void Fish::setIsFavorite(const bool isFavorite) {
-    this->isFavorite = isFavorite;
+    d->isFavorite = isFavorite;
 }
 
 void Fish::setImage(const std::vector<char>& image) {
-    this->image = image;
+    d->image = ownedImage(vector<char>(image));
+    d->imageHash.clear();
+}
+
+void Fish::setImage(vector<char>&& image) {
+    d->image = ownedImage(std::move(image));
+    d->imageHash.clear();
+}
+
+void Fish::setImage(const ImageView& image) {
+    d->image = image.empty() ? ImageView() : image;
+    d->imageHash.clear();
+}
+
+void Fish::setImageHash(const string_view imageHash) {
+    d->imageHash.assign(imageHash.data(), imageHash.size());
+}
+
+bool Fish::isDetached() const {
+    return d->ref.loadRelaxed() == 1;
 }
 
 const string Fish::toString() const {
     std::ostringstream oss;
     oss << "Fish: ";
     oss << "Id: " << id << " ";
-    oss << "Name: " << name << " ";
-    oss << "Description: " << description << " ";
-    oss << "No. Seasons: " << season.size() << " ";
-    oss << "No. Weathers: " << weather.size() << " ";
-    oss << "No. Locations: " << location.size() << " ";
-    oss << "Start Catching Hour: " << startCatchingHour << " ";
-    oss << "End Cathcing Hour: " << endCatchingHour << " ";
-    oss << "Difficulty: " << difficulty << " ";
-    oss << "Movement: " << movement << " ";
-    oss << "Caught: " << (isCaught ? "Yes" : "No");
-    oss << "Favorite: " << (isFavorite ? "Yes" : "No");
-    oss << "Has Image: " << (image.size() > 0 ? "Yes" : "No");
+    oss << "Name: " << d->name << " ";
+    oss << "Description: " << d->description << " ";
+    oss << "No. Seasons: " << d->season.size() << " ";
+    oss << "No. Weathers: " << d->weather.size() << " ";
+    oss << "No. Locations: " << d->location.size() << " ";
+    oss << "Start Catching Hour: " << d->startCatchingHour << " ";
+    oss << "End Cathcing Hour: " << d->endCatchingHour << " ";
+    oss << "Difficulty: " << d->difficulty << " ";
+    oss << "Movement: " << getMovement() << " ";
+    oss << "Caught: " << (d->isCaught ? "Yes" : "No");
+    oss << "Favorite: " << (d->isFavorite ? "Yes" : "No");
+    oss << "Has Image: " << (!getImage().empty() ? "Yes" : "No");
     return oss.str();
 }
@@ -2,34 +2,61 @@
 #define FISH_H
 
 #include "Entity.h"
+#include "Attribute.h"
+#include "CatchTimes.h"
+#include "ImageView.h"
 #include <qDebug>
+#include <QSharedData>
+#include <QSharedDataPointer>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 using namespace std;
 
-class Fish : public Entity {
+/**
+ * @brief The FishData class
+ * The values of a Fish, shared between all the copies of the Fish until one of them is changed
+ */
+class FishData : public QSharedData {
 
-protected:
+public:
     string name;
-    string category;
+    uint16_t category;
     string description;
-    vector<string> season;
-    vector<string> weather;
-    vector<string> location;
+    SeasonSet season;
+    WeatherSet weather;
+    LocationSet location;
     string startCatchingHour;
     string endCatchingHour;
-    long difficulty;
-    string movement;
-    bool isCaught;
-    bool isFavorite;
-    vector<char> image;
+    CatchTimes catchTimes;
+    long difficulty = 0;
+    uint16_t movement;
+    bool isCaught = false;
+    bool isFavorite = false;
+    // The image bytes are shared on their own, so changing another value of a shared Fish does not copy the image,
+    // and an image read from the image store is a view into its mapped pack instead of a copy
+    ImageView image;
+    string imageHash;
+};
+
+
+/**
+ * @brief The Fish class
+ * An implicitly shared handle to the values of a fish: copying a Fish only counts one more reference to its values,
+ * and the setters copy the values first if they are shared with another Fish
+ */
+class Fish : public Entity {
+
+protected:
+    QSharedDataPointer<FishData> d;
 
 public:
     // Constructor
     Fish();
-    Fish(const string& name, const string& category, const string& description, const vector<string>& season, const vector<string>& weather, const vector<string>& location, const string& startCatchingHour, const string& endCatchingHour, const long difficulty, const string& movement, const bool isCaught, const bool isFavorite, const std::vector<char>& image);
-    Fish(const long id, const string& name, const string& category, const string& description, const vector<string>& season, const vector<string>& weather, const vector<string>& location, const string& startCatchingHour, const string& endCatchingHour, const long difficulty, const string& movement, const bool isCaught, const bool isFavorite, const std::vector<char>& image);
+    Fish(const string& name, const string& category, const string& description, const SeasonSet& season, const WeatherSet& weather, const LocationSet& location, const string& startCatchingHour, const string& endCatchingHour, const long difficulty, const string& movement, const bool isCaught, const bool isFavorite, const std::vector<char>& image);
+    Fish(const long id, const string& name, const string& category, const string& description, const SeasonSet& season, const WeatherSet& weather, const LocationSet& location, const string& startCatchingHour, const string& endCatchingHour, const long difficulty, const string& movement, const bool isCaught, const bool isFavorite, const std::vector<char>& image);
 
     // Get the Fish name
     const string& getName() const;
@@ -41,13 +68,13 @@ public:
     const string& getDescription() const;
 
     // Get the Fish season(s)
-    const vector<string>& getSeason() const;
+    const SeasonSet& getSeason() const;
 
     // Get the Fish weather(s)
-    const vector<string>& getWeather() const;
+    const WeatherSet& getWeather() const;
 
     // Get the Fish location(s)
-    const vector<string>& getLocation() const;
+    const LocationSet& getLocation() const;
 
     // Get the Hour from when the Fish can be caught
     const string& getStartCatchingHour() const;
@@ -55,6 +82,9 @@ public:
     // Get the Hour from when the Fish cannot be caught anymore in the current day
     const string& getEndCatchingHour() const;
 
+    // Get the minutes of the day when the Fish can be caught, parsed from the catching hours
+    const CatchTimes& getCatchTimes() const;
+
     // Get the Fish catching Difficulty
     long getDifficulty() const;
 
@@ -68,37 +98,43 @@ public:
     bool getIsFavorite() const;
 
     // Get the Fish image
-    const std::vector<char>& getImage() const;
+    const ImageView& getImage() const;
+
+    // Get the SHA-256 hash of the Fish image, the key of the image in the image store and of its thumbnails (empty if there is no image)
+    const string& getImageHash() const;
 
     // Set the Fish name to a new value
-    void setName(const string& name);
+    void setName(const string_view name);
 
     // Set the Fish category to a new value
-    void setCategory(const string& category);
+    void setCategory(const string_view category);
 
     // Set the Fish description to a new value
-    void setDescription(const string& description);
+    void setDescription(const string_view description);
 
     // Set the Fish season(s) to a new value
-    void setSeason(const vector<string>& season);
+    void setSeason(const SeasonSet& season);
 
     // Set the Fish weather(s) to a new value
-    void setWeather(const vector<string>& weather);
+    void setWeather(const WeatherSet& weather);
 
     // Set the Fish location(s) to a new value
-    void setLocation(const vector<string>& location);
+    void setLocation(const LocationSet& location);
+
+    // Set the Fish starting catching hour to a new value, the catch times are parsed again
+    void setStartCatchingHour(const string_view startCatchingHour);
 
-    // Set the Fish starting catching hour to a new value
-    void setStartCatchingHour(const string& startCatchingHour);
+    // Set the Fish ending catching hour to a new value, the catch times are parsed again
+    void setEndCatchingHour(const string_view endCatchingHour);
 
-    // Set the Fish ending catching hour to a new value
-    void setEndCatchingHour(const string& endCatchingHour);
+    // Set both Fish catching hours along with the catch times already parsed from them, which are not parsed again
+    void setCatchingHours(const string_view startCatchingHour, const string_view endCatchingHour, const CatchTimes& catchTimes);
 
     // Set the Fish catching difficulty to a new value
     void setDifficulty(const long difficulty);
 
     // Set the Fish movement to a new value
-    void setMovement(const string& movement);
+    void setMovement(const string_view movement);
 
     // Set the Fish caught status to a new value
     void setIsCaught(const bool caught);
@@ -106,8 +142,18 @@ public:
     // Set the Fish favorite status to a new value
     void setIsFavorite(const bool favorite);
 
-    // Set the Fish image to a new value
+    // Set the Fish image to a new value, the hash of the previous image is cleared; an empty image removes the image
     void setImage(const vector<char>& image);
+    void setImage(vector<char>&& image);
+
+    // Set the Fish image to a view that keeps its bytes alive through its owner, the hash of the previous image is cleared
+    void setImage(const ImageView& image);
+
+    // Set the Fish image hash to a new value
+    void setImageHash(const string_view imageHash);
+
+    // Check if the Fish is the only one holding its values (no other copy shares them)
+    bool isDetached() const;
 
     // Convert the Fish object to a string
     const string toString() const;
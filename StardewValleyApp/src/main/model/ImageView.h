@@ -0,0 +1,25 @@
+#ifndef IMAGEVIEW_H
+#define IMAGEVIEW_H
+
+#include <cstddef>
+#include <memory>
+
+using namespace std;
+
+/**
+ * @brief A read-only view over the bytes of an image
+ * A view from the ImageStore points straight into the memory-mapped pack file, so no bytes are copied,
+ * and shares the ownership of the mapping, so the mapping is only released once no view points into it anymore
+ * A view of bytes that are not in the store (an image still inline in the database, or given to a Fish) owns a copy of them
+ */
+struct ImageView {
+    const char* data = nullptr;
+    size_t size = 0;
+    shared_ptr<const void> owner;
+
+    bool empty() const { return size == 0; }
+    const char* begin() const { return data; }
+    const char* end() const { return data + size; }
+};
+
+#endif // IMAGEVIEW_H
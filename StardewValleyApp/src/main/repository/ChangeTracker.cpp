@@ -0,0 +1,265 @@
+#include "ChangeTracker.h"
+#include <qDebug>
+#include <cstring>
+
+using namespace std;
+
+
+
+void DataChanges::merge(const DataChanges& other) {
+	everything = everything || other.everything;
+	fishIds.insert(other.fishIds.begin(), other.fishIds.end());
+	progress.insert(other.progress.begin(), other.progress.end());
+	imageNames.insert(other.imageNames.begin(), other.imageNames.end());
+}
+
+
+
+/*
+	Function that installs the update, commit and rollback hooks on a write connection.
+	The hooks only touch the session of the connection, so the writes are recorded without locking.
+	Params:
+		db - the write connection
+		publish - false if the caller applies the changes to the caches itself
+*/
+void ChangeTracker::attach(sqlite3* db, const bool publish) {
+	if (db == nullptr) {
+		return;
+	}
+
+	unique_ptr<Session> session = make_unique<Session>();
+	session->tracker = this;
+	session->publish = publish;
+
+	sqlite3_update_hook(db, &ChangeTracker::onUpdate, session.get());
+	sqlite3_commit_hook(db, &ChangeTracker::onCommit, session.get());
+	sqlite3_rollback_hook(db, &ChangeTracker::onRollback, session.get());
+
+	lock_guard<mutex> lock(trackerMutex);
+	sessions[db] = std::move(session);
+}
+
+
+
+/*
+	Function that removes the hooks of a write connection and keeps the keys of the rows its transactions committed.
+	Params:
+		db - the write connection, still open
+*/
+void ChangeTracker::detach(sqlite3* db) {
+	if (db == nullptr) {
+		return;
+	}
+
+	unique_ptr<Session> session;
+	{
+		lock_guard<mutex> lock(trackerMutex);
+		auto found = sessions.find(db);
+		if (found == sessions.end()) {
+			return;
+		}
+		session = std::move(found->second);
+		sessions.erase(found);
+	}
+
+	sqlite3_update_hook(db, nullptr, nullptr);
+	sqlite3_commit_hook(db, nullptr, nullptr);
+	sqlite3_rollback_hook(db, nullptr, nullptr);
+
+	if (!session->publish || session->committed.empty()) {
+		return;
+	}
+
+	const DataChanges committed = resolve(db, *session);
+	lock_guard<mutex> lock(trackerMutex);
+	changes.merge(committed);
+}
+
+
+
+/*
+	Function that takes the changes committed since the last call.
+	The data version is checked first, so the changes made by other processes since the last call are included.
+	Params:
+		writeConnection - the write connection, or null if it is busy
+*/
+DataChanges ChangeTracker::take(sqlite3* writeConnection) {
+	lock_guard<mutex> lock(trackerMutex);
+	pollExternalChanges(writeConnection);
+
+	DataChanges taken = std::move(changes);
+	changes = DataChanges();
+	return taken;
+}
+
+
+
+/*
+	Function that marks everything as changed, so the next take drops all the cached rows.
+*/
+void ChangeTracker::markEverything() {
+	lock_guard<mutex> lock(trackerMutex);
+	changes.everything = true;
+}
+
+
+
+/*
+	Update hook of the write connections: records the changed row of a tracked table until its transaction ends.
+	A deleted row can not be read again, so its key is found from the other rows of its transaction.
+*/
+void ChangeTracker::onUpdate(void* argument, int operation, const char* database, const char* table, sqlite3_int64 rowid) {
+	Session* session = static_cast<Session*>(argument);
+	if (strcmp(database, "main") != 0) {
+		return;
+	}
+
+	Table changed;
+	if (strcmp(table, "Fish") == 0) changed = Table::Fish;
+	else if (strcmp(table, "Users_Fish") == 0) changed = Table::UsersFish;
+	else if (strcmp(table, "Fish_Season") == 0) changed = Table::FishSeason;
+	else if (strcmp(table, "Fish_Weather") == 0) changed = Table::FishWeather;
+	else if (strcmp(table, "Fish_FishLocation") == 0) changed = Table::FishLocation;
+	else if (strcmp(table, "Images") == 0) changed = Table::Images;
+	else return;
+
+	session->pending.push_back(RowChange{ changed, rowid, operation == SQLITE_DELETE });
+}
+
+
+
+/*
+	Commit hook of the write connections: keeps the rows of the transaction.
+	A commit that fails is followed by the rollback hook, which only clears the rows still pending, so they are kept anyway; a change too many is safe.
+*/
+int ChangeTracker::onCommit(void* argument) {
+	Session* session = static_cast<Session*>(argument);
+	session->committed.insert(session->committed.end(), session->pending.begin(), session->pending.end());
+	session->pending.clear();
+	return 0;
+}
+
+
+
+/*
+	Rollback hook of the write connections: forgets the rows of the transaction.
+*/
+void ChangeTracker::onRollback(void* argument) {
+	Session* session = static_cast<Session*>(argument);
+	session->pending.clear();
+}
+
+
+
+/*
+	Function that finds the keys of the rows committed by a session.
+	The Fish rows are keyed by their rowid. The rows of the other tables are read again by rowid to find their keys.
+	A deleted row of the attribute or Users_Fish tables is covered by the Fish row its writer always updates with it;
+	without one, or for a deleted image, the rows can not be told apart and everything is marked as changed.
+	Params:
+		db - the connection of the session
+		session - the session
+*/
+DataChanges ChangeTracker::resolve(sqlite3* db, const Session& session) {
+	DataChanges resolved;
+	bool unresolvedFish = false;
+
+	sqlite3_stmt* statements[6] = {};
+	const char* queries[6] = {
+		nullptr,
+		"SELECT user_id, fish_id FROM Users_Fish WHERE rowid = ?",
+		"SELECT fish_id FROM Fish_Season WHERE rowid = ?",
+		"SELECT fish_id FROM Fish_Weather WHERE rowid = ?",
+		"SELECT fish_id FROM Fish_FishLocation WHERE rowid = ?",
+		"SELECT name FROM Images WHERE rowid = ?"
+	};
+
+	for (const RowChange& change : session.committed) {
+		const int table = static_cast<int>(change.table);
+		if (change.table == Table::Fish) {
+			resolved.fishIds.insert(static_cast<long>(change.rowid));
+			continue;
+		}
+		if (change.deleted) {
+			if (change.table == Table::Images) {
+				resolved.everything = true;
+			}
+			else {
+				unresolvedFish = true;
+			}
+			continue;
+		}
+
+		if (statements[table] == nullptr && sqlite3_prepare_v2(db, queries[table], -1, &statements[table], nullptr) != SQLITE_OK) {
+			qDebug() << "Failed to prepare the change query: " << sqlite3_errmsg(db);
+			sqlite3_finalize(statements[table]);
+			statements[table] = nullptr;
+			resolved.everything = true;
+			continue;
+		}
+
+		sqlite3_stmt* statement = statements[table];
+		sqlite3_bind_int64(statement, 1, change.rowid);
+		if (sqlite3_step(statement) == SQLITE_ROW) {
+			if (change.table == Table::UsersFish) {
+				resolved.progress.insert({ static_cast<long>(sqlite3_column_int64(statement, 0)), static_cast<long>(sqlite3_column_int64(statement, 1)) });
+			}
+			else if (change.table == Table::Images) {
+				const char* name = reinterpret_cast<const char*>(sqlite3_column_text(statement, 0));
+				resolved.imageNames.insert(name != nullptr ? name : "");
+			}
+			else {
+				resolved.fishIds.insert(static_cast<long>(sqlite3_column_int64(statement, 0)));
+			}
+		}
+		else if (change.table == Table::Images) {
+			resolved.everything = true;
+		}
+		else {
+			unresolvedFish = true;
+		}
+		sqlite3_reset(statement);
+	}
+
+	for (sqlite3_stmt* statement : statements) {
+		sqlite3_finalize(statement);
+	}
+
+	if (unresolvedFish && resolved.fishIds.empty()) {
+		resolved.everything = true;
+	}
+	return resolved;
+}
+
+
+
+/*
+	Function that checks if other processes changed the database since the last check.
+	PRAGMA data_version only changes when another connection commits, and this process writes through the write connection alone,
+	so a new data version on it means another process wrote to the database.
+	Params:
+		writeConnection - the write connection, or null to skip the check
+*/
+void ChangeTracker::pollExternalChanges(sqlite3* writeConnection) {
+	if (writeConnection == nullptr) {
+		return;
+	}
+
+	sqlite3_stmt* statement;
+	if (sqlite3_prepare_v2(writeConnection, "PRAGMA data_version", -1, &statement, nullptr) != SQLITE_OK) {
+		sqlite3_finalize(statement);
+		return;
+	}
+	if (sqlite3_step(statement) != SQLITE_ROW) {
+		sqlite3_finalize(statement);
+		return;
+	}
+	const sqlite3_int64 dataVersion = sqlite3_column_int64(statement, 0);
+	sqlite3_finalize(statement);
+
+	// Everything read before the first check was read after the commits that came before it
+	if (lastDataVersion != 0 && dataVersion != lastDataVersion) {
+		changes.everything = true;
+	}
+	lastDataVersion = dataVersion;
+}
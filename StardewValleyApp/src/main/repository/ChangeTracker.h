@@ -0,0 +1,130 @@
+#ifndef CHANGETRACKER_H
+#define CHANGETRACKER_H
+
+#include "../../resources/sqlite/sqlite3.h"
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief The keys of the rows changed by the writes committed since the changes were last taken
+ */
+struct DataChanges {
+	// The fish whose Fish row or seasons, weathers or locations changed, for every user
+	set<long> fishIds;
+
+	// The (user id, fish id) pairs whose caught or favorite flags changed
+	set<pair<long, long>> progress;
+
+	// The names of the changed rows of the Images table
+	set<string> imageNames;
+
+	// Set when the database was changed by another process, or a change could not be tied to its rows
+	bool everything = false;
+
+	bool empty() const { return !everything && fishIds.empty() && progress.empty() && imageNames.empty(); }
+
+	void merge(const DataChanges& other);
+};
+
+
+/**
+ * @brief The ChangeTracker class
+ * Finds out which rows of the database were changed, so the caches holding them can evict exactly those rows.
+ * The writes of this process are recorded by a sqlite3_update_hook on the write connection, and kept once their
+ * transaction commits. The writes of other processes are found through PRAGMA data_version on the write connection:
+ * every write of this process goes through that connection, and its data version only moves on the commits of the others.
+ */
+class ChangeTracker {
+private:
+	// The tables whose changes are tracked, the rows of the other tables are not cached
+	enum class Table { Fish, UsersFish, FishSeason, FishWeather, FishLocation, Images };
+
+	struct RowChange {
+		Table table;
+		sqlite3_int64 rowid;
+		bool deleted;
+	};
+
+	// The state of one attached write connection, given to its hooks
+	struct Session {
+		ChangeTracker* tracker;
+		bool publish;
+		vector<RowChange> pending;
+		vector<RowChange> committed;
+	};
+
+	unordered_map<sqlite3*, unique_ptr<Session>> sessions;
+	DataChanges changes;
+
+	// The data version of the write connection at the last check, 0 before the first one
+	sqlite3_int64 lastDataVersion = 0;
+
+	mutable mutex trackerMutex;
+
+	static void onUpdate(void* argument, int operation, const char* database, const char* table, sqlite3_int64 rowid);
+	static int onCommit(void* argument);
+	static void onRollback(void* argument);
+
+	/*
+	* @brief Finds the keys of the committed rows of a session, on its connection
+	* @param db - the connection of the session, after its transaction ended
+	* @param session - the session
+	* @return the changes of the session
+	*/
+	static DataChanges resolve(sqlite3* db, const Session& session);
+
+
+	/*
+	* @brief Checks the data version of the write connection, and marks everything as changed if another process committed
+	* Must be called with trackerMutex locked
+	* @param writeConnection - the write connection, not in a transaction
+	*/
+	void pollExternalChanges(sqlite3* writeConnection);
+
+public:
+
+	/*
+	* Default constructor
+	*/
+	ChangeTracker() = default;
+
+	ChangeTracker(const ChangeTracker& other) = delete;
+
+
+	/*
+	* @brief Records the writes of a connection, until it is detached
+	* @param db - the write connection
+	* @param publish - false if the caller applies the changes to the caches itself
+	*/
+	void attach(sqlite3* db, const bool publish = true);
+
+
+	/*
+	* @brief Stops recording the writes of a connection, and keeps the keys of the rows it committed
+	* Must be called before the connection is closed, the keys of the rows are read on it
+	* @param db - the write connection
+	*/
+	void detach(sqlite3* db);
+
+
+	/*
+	* @brief Takes the changes committed since the last call, checking first for the changes of other processes
+	* @param writeConnection - the write connection, held by the caller; if null, the changes of other processes are checked on the next call
+	* @return the changes, empty if nothing changed
+	*/
+	DataChanges take(sqlite3* writeConnection);
+
+
+	/*
+	* @brief Marks everything as changed, for a change that replaced the database as a whole, like a restore
+	*/
+	void markEverything();
+};
+
+#endif // CHANGETRACKER_H
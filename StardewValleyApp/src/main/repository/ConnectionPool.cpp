@@ -0,0 +1,253 @@
+#include "ConnectionPool.h"
+#include <qDebug>
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+
+// The number of wait and hold times kept for the percentiles
+static const size_t SAMPLE_CAPACITY = 1024;
+
+
+
+/*
+	Constructor for the ConnectionPool class.
+	The connections are only opened when they are first handed out, so a pool nobody reads from costs nothing.
+	Params:
+		name - the name of the pool
+		databasePath - the path to the database
+		size - the number of connections, at least one
+		timeout - how long a caller waits for a connection
+		configure - called with every connection once it is opened
+*/
+ConnectionPool::ConnectionPool(const string& name, const string& databasePath, const size_t size, const chrono::milliseconds timeout, const function<void(sqlite3*)>& configure)
+	: name(name), databasePath(databasePath), timeout(timeout), configure(configure), connectionSlots(max<size_t>(size, 1)), available(max<size_t>(size, 1)) {
+	stats.name = name;
+	stats.connections = connectionSlots.size();
+}
+
+
+
+/*
+	Destructor for the ConnectionPool class.
+	Closes the opened connections.
+*/
+ConnectionPool::~ConnectionPool() {
+	for (Slot& slot : connectionSlots) {
+		if (slot.checkedOut) {
+			qDebug() << "Closing a connection of the" << name.c_str() << "pool that was not released";
+		}
+		if (slot.db != nullptr) {
+			sqlite3_close(slot.db);
+			slot.db = nullptr;
+		}
+	}
+}
+
+
+
+/*
+	Function that waits for a free connection and takes it.
+	Every caller draws a ticket and is only served once the callers before it were, so the connections go out in the order they were asked for.
+	Params:
+		db - receives the connection, or nullptr if none could be taken
+*/
+int ConnectionPool::acquire(sqlite3** db) {
+	*db = nullptr;
+	const chrono::steady_clock::time_point requestedAt = chrono::steady_clock::now();
+
+	unique_lock<mutex> lock(poolMutex);
+	if (connectionSlots.empty()) {
+		return SQLITE_CANTOPEN;
+	}
+
+	const uint64_t ticket = nextTicket++;
+	const bool ready = ticket == servedTicket && available > 0;
+	if (!ready) {
+		stats.waited++;
+		stats.queueDepth++;
+		stats.maxQueueDepth = max(stats.maxQueueDepth, stats.queueDepth);
+
+		const bool served = freed.wait_until(lock, requestedAt + timeout, [&] { return ticket == servedTicket && available > 0; });
+		stats.queueDepth--;
+		if (!served) {
+			abandonedTickets.push_back(ticket);
+			skipAbandonedTickets();
+			stats.timedOut++;
+			record(waitSamples, nextWaitSample, chrono::steady_clock::now() - requestedAt);
+
+			// The ticket that was skipped may have been the one in front of a free connection
+			freed.notify_all();
+			qDebug() << "Timed out waiting for a connection of the" << name.c_str() << "pool";
+			return SQLITE_BUSY;
+		}
+	}
+
+	servedTicket++;
+	skipAbandonedTickets();
+	record(waitSamples, nextWaitSample, chrono::steady_clock::now() - requestedAt);
+
+	const int rc = takeSlot(db);
+
+	// The next caller can be served at once if another connection is free
+	freed.notify_all();
+	return rc;
+}
+
+
+
+/*
+	Function that takes a free connection without waiting, and without getting ahead of the callers already waiting.
+	Params:
+		db - receives the connection, or nullptr if none was taken
+*/
+bool ConnectionPool::tryAcquire(sqlite3** db) {
+	*db = nullptr;
+	lock_guard<mutex> lock(poolMutex);
+	if (available == 0 || nextTicket != servedTicket) {
+		return false;
+	}
+	return takeSlot(db) == SQLITE_OK;
+}
+
+
+
+/*
+	Function that gives a connection back and wakes the callers waiting for one.
+	A transaction the caller left open is rolled back, as closing the connection would have done, so the next caller starts clean
+	and a reader does not pin its old snapshot of the WAL.
+	Params:
+		db - the connection, ignored if it is null or was not handed out by the pool
+*/
+void ConnectionPool::release(sqlite3* db) {
+	if (db == nullptr) {
+		return;
+	}
+	if (sqlite3_get_autocommit(db) == 0) {
+		sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+	}
+
+	lock_guard<mutex> lock(poolMutex);
+	for (Slot& slot : connectionSlots) {
+		if (slot.db == db && slot.checkedOut) {
+			slot.checkedOut = false;
+			available++;
+			record(holdSamples, nextHoldSample, chrono::steady_clock::now() - slot.acquiredAt);
+			freed.notify_all();
+			return;
+		}
+	}
+}
+
+
+
+/*
+	Function that returns the counters of the pool, with the percentiles of the last wait and hold times.
+*/
+ConnectionPoolStats ConnectionPool::getStats() const {
+	lock_guard<mutex> lock(poolMutex);
+	ConnectionPoolStats current = stats;
+	summarize(waitSamples, current.meanWaitMs, current.p95WaitMs, current.maxWaitMs);
+	summarize(holdSamples, current.meanHoldMs, current.p95HoldMs, current.maxHoldMs);
+	return current;
+}
+
+
+
+/*
+	Function that takes a free slot, preferring one whose connection is already open.
+	A connection that fails to open is closed again and its slot stays free, so the next caller tries again.
+	Params:
+		db - receives the connection
+*/
+int ConnectionPool::takeSlot(sqlite3** db) {
+	Slot* chosen = nullptr;
+	for (Slot& slot : connectionSlots) {
+		if (!slot.checkedOut && (chosen == nullptr || (chosen->db == nullptr && slot.db != nullptr))) {
+			chosen = &slot;
+		}
+	}
+	if (chosen == nullptr) {
+		return SQLITE_BUSY;
+	}
+
+	if (chosen->db == nullptr) {
+		const int rc = sqlite3_open(databasePath.c_str(), &chosen->db);
+		if (rc != SQLITE_OK) {
+			qDebug() << "Failed to open database: " << sqlite3_errmsg(chosen->db);
+			sqlite3_close(chosen->db);
+			chosen->db = nullptr;
+			return rc;
+		}
+		if (configure) {
+			configure(chosen->db);
+		}
+	}
+
+	chosen->checkedOut = true;
+	chosen->acquiredAt = chrono::steady_clock::now();
+	available--;
+	stats.acquired++;
+	*db = chosen->db;
+	return SQLITE_OK;
+}
+
+
+
+/*
+	Function that moves the served ticket past the tickets of the callers that timed out, so they do not block the callers behind them.
+*/
+void ConnectionPool::skipAbandonedTickets() {
+	auto abandoned = find(abandonedTickets.begin(), abandonedTickets.end(), servedTicket);
+	while (abandoned != abandonedTickets.end()) {
+		abandonedTickets.erase(abandoned);
+		servedTicket++;
+		abandoned = find(abandonedTickets.begin(), abandonedTickets.end(), servedTicket);
+	}
+}
+
+
+
+/*
+	Function that records a duration in a ring of samples, in microseconds.
+	Params:
+		samples - the ring
+		next - the position of the next sample in the ring
+		elapsed - the duration
+*/
+void ConnectionPool::record(vector<uint32_t>& samples, size_t& next, const chrono::steady_clock::duration elapsed) {
+	const long long micros = chrono::duration_cast<chrono::microseconds>(elapsed).count();
+	const uint32_t sample = static_cast<uint32_t>(min<long long>(max<long long>(micros, 0), numeric_limits<uint32_t>::max()));
+	if (samples.size() < SAMPLE_CAPACITY) {
+		samples.push_back(sample);
+	}
+	else {
+		samples[next] = sample;
+	}
+	next = (next + 1) % SAMPLE_CAPACITY;
+}
+
+
+
+/*
+	Function that computes the mean, 95th percentile and maximum of a ring of samples, in milliseconds.
+	Params:
+		samples - the ring, in microseconds
+		mean, p95, max - receive the results, 0 if there are no samples
+*/
+void ConnectionPool::summarize(const vector<uint32_t>& samples, double& mean, double& p95, double& max) {
+	mean = p95 = max = 0;
+	if (samples.empty()) {
+		return;
+	}
+
+	vector<uint32_t> sorted = samples;
+	sort(sorted.begin(), sorted.end());
+	double total = 0;
+	for (const uint32_t sample : sorted) {
+		total += sample;
+	}
+	mean = total / sorted.size() / 1000.0;
+	p95 = sorted[min(sorted.size() - 1, sorted.size() * 95 / 100)] / 1000.0;
+	max = sorted.back() / 1000.0;
+}
@@ -0,0 +1,150 @@
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include "../../resources/sqlite/sqlite3.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief The counters of a ConnectionPool, to see how long the callers queue for a connection and how long they keep it
+ */
+struct ConnectionPoolStats {
+	string name;
+	size_t connections = 0;
+	size_t queueDepth = 0;
+	size_t maxQueueDepth = 0;
+	uint64_t acquired = 0;
+	uint64_t waited = 0;
+	uint64_t timedOut = 0;
+	double meanWaitMs = 0;
+	double p95WaitMs = 0;
+	double maxWaitMs = 0;
+	double meanHoldMs = 0;
+	double p95HoldMs = 0;
+	double maxHoldMs = 0;
+};
+
+
+/**
+ * @brief The ConnectionPool class
+ * Hands out a fixed number of connections to the same database, opened on first use and kept until the pool is destroyed.
+ * The callers waiting for a connection are served in the order they came, so a long queue of readers can not starve a writer.
+ * A pool of one connection serializes its callers: the repository funnels every write through one, so the writes never
+ * fight over the database lock, while the readers of the other pool keep reading their WAL snapshot.
+ */
+class ConnectionPool {
+private:
+	struct Slot {
+		sqlite3* db = nullptr;
+		bool checkedOut = false;
+		chrono::steady_clock::time_point acquiredAt;
+	};
+
+	string name;
+	string databasePath;
+	chrono::milliseconds timeout{ 0 };
+	function<void(sqlite3*)> configure;
+
+	vector<Slot> connectionSlots;
+	size_t available = 0;
+
+	// The waiting callers are served by ticket, a caller that timed out leaves its ticket to be skipped
+	uint64_t nextTicket = 0;
+	uint64_t servedTicket = 0;
+	vector<uint64_t> abandonedTickets;
+
+	// The last wait and hold times, in microseconds, kept in rings for the percentiles
+	vector<uint32_t> waitSamples;
+	vector<uint32_t> holdSamples;
+	size_t nextWaitSample = 0;
+	size_t nextHoldSample = 0;
+	ConnectionPoolStats stats;
+
+	mutable mutex poolMutex;
+	condition_variable freed;
+
+	/*
+	* @brief Takes a free slot, opening its connection if needed
+	* Must be called with poolMutex locked, with a free slot
+	* @param db - receives the connection
+	* @return SQLITE_OK, or the error of sqlite3_open
+	*/
+	int takeSlot(sqlite3** db);
+
+
+	/*
+	* @brief Moves the served ticket past the tickets of the callers that gave up
+	* Must be called with poolMutex locked
+	*/
+	void skipAbandonedTickets();
+
+
+	// Records a sample in a ring of samples, must be called with poolMutex locked
+	static void record(vector<uint32_t>& samples, size_t& next, const chrono::steady_clock::duration elapsed);
+
+	// Gets the mean, 95th percentile and maximum of a ring of samples, in milliseconds
+	static void summarize(const vector<uint32_t>& samples, double& mean, double& p95, double& max);
+
+public:
+
+	/*
+	* Default constructor, the pool has no database and every acquire fails
+	*/
+	ConnectionPool() = default;
+
+	ConnectionPool(const ConnectionPool& other) = delete;
+
+	/*
+	* @brief Creates a pool of connections to the given database, none of them is opened yet
+	* @param name - the name of the pool, in the logs and the counters
+	* @param databasePath - the path to the database
+	* @param size - the number of connections
+	* @param timeout - how long a caller waits for a connection before giving up
+	* @param configure - called with every connection once it is opened
+	*/
+	ConnectionPool(const string& name, const string& databasePath, const size_t size, const chrono::milliseconds timeout, const function<void(sqlite3*)>& configure);
+
+	/*
+	* Closes the connections, they must all have been released
+	*/
+	~ConnectionPool();
+
+
+	/*
+	* @brief Waits for a connection, in the order the callers came
+	* @param db - receives the connection, or nullptr if none could be taken
+	* @return SQLITE_OK, SQLITE_BUSY if no connection was released before the timeout, or the error of sqlite3_open
+	*/
+	int acquire(sqlite3** db);
+
+
+	/*
+	* @brief Takes a connection only if one is free and nobody is waiting for one
+	* @param db - receives the connection, or nullptr if none was taken
+	* @return true if a connection was taken
+	*/
+	bool tryAcquire(sqlite3** db);
+
+
+	/*
+	* @brief Gives a connection back to the pool, rolling back the transaction left open on it
+	* A connection the pool did not hand out is ignored
+	* @param db - the connection
+	*/
+	void release(sqlite3* db);
+
+
+	/*
+	* @brief Gets the counters of the pool
+	*/
+	ConnectionPoolStats getStats() const;
+};
+
+#endif // CONNECTIONPOOL_H
@@ -1,28 +1,115 @@
 #include "FishDBRepository.h"
+#include <filesystem>
+#include <thread>
 
 using namespace std;
 
+// The tables whose rows hold an image, either inline or in the image store
+static const vector<string> IMAGE_TABLES = { "Fish", "Images", "Users" };
+
+// The tables a fish can be filtered by: the bit of the filter, the junction table, its alias, the id column, the names table and the name parameter
+struct FilterDimension {
+	int bit;
+	const char* table;
+	const char* alias;
+	const char* idColumn;
+	const char* namesTable;
+	const char* nameParameter;
+};
+static const FilterDimension FILTER_DIMENSIONS[] = {
+	{ 1, "Fish_Season", "fs", "season_id", "Seasons", "?1" },
+	{ 2, "Fish_Weather", "fw", "weather_id", "Weathers", "?2" },
+	{ 4, "Fish_FishLocation", "fl", "location_id", "FishLocations", "?3" }
+};
+
+// The queries of the seasons, weathers and locations of a fish and of the flags of its user, at the positions given to fishDetailStatement.
+// The attributes are selected with their ids, so they are interned by id; their names are only read for the ids missing from internedAttributeIds
+static const char* FISH_DETAIL_QUERIES[] = {
+	"SELECT fs.season_id, s.name FROM Fish_Season fs JOIN Seasons s ON s.id = fs.season_id WHERE fs.fish_id = ?1",
+	"SELECT fw.weather_id, w.name FROM Fish_Weather fw JOIN Weathers w ON w.id = fw.weather_id WHERE fw.fish_id = ?1",
+	"SELECT fl.location_id, l.name FROM Fish_FishLocation fl JOIN FishLocations l ON l.id = fl.location_id WHERE fl.fish_id = ?1",
+	"SELECT is_caught, is_favorite FROM Users_Fish WHERE fish_id = ?1 AND user_id = ?2"
+};
+
+// The interned id of an attribute id that is missing from its table
+static const uint16_t NO_INTERNED_ID = UINT16_MAX;
+
+// The number of connections the reads share, one for every window or request reading at the same time
+static const size_t READER_CONNECTIONS = 4;
+
+// How long a caller waits for a connection, a write of the whole catalog included
+static const chrono::milliseconds CONNECTION_TIMEOUT(30000);
+
+// How long a connection retries a locked database, only another process can hold the lock
+static const int BUSY_TIMEOUT_MS = 5000;
+
+// The number of backup steps in a row that may find the database locked before the backup gives up
+static const int MAX_BUSY_BACKUP_STEPS = 100;
+
+// The user_version of a database whose Users_Fish rows were compacted, the compaction only runs on the databases below it
+static const int SPARSE_USER_PROGRESS_VERSION = 1;
+
 
 
 /*
 	Constructor for the FishDBRepository class.
-	Initializes the databasePath field with the given database path.
+	Initializes the databasePath field with the given database path and opens the image store next to the database.
+	The database is switched to WAL mode, so the readers keep reading their snapshot while the writer commits.
 	Params:
 		databasePath - the path to the database
 */
-FishDBRepository::FishDBRepository(const string& databasePath) : databasePath(databasePath) {
+FishDBRepository::FishDBRepository(const string& databasePath) : databasePath(databasePath), imageStore(databasePath + ".images"),
+	writer("writer", databasePath, 1, CONNECTION_TIMEOUT, &FishDBRepository::configureConnection),
+	readers("readers", databasePath, READER_CONNECTIONS, CONNECTION_TIMEOUT, &FishDBRepository::configureConnection) {
 	sqlite3* db;
 	int rc = sqlite3_open(databasePath.c_str(), &db);
 	if (rc != SQLITE_OK) {
 		std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
 	}
 	else {
+		// The migrations wait for a lock held by another process like the pooled connections do, instead of failing at once
+		configureConnection(db);
+		if (sqlite3_exec(db, "PRAGMA journal_mode=WAL", nullptr, nullptr, nullptr) != SQLITE_OK) {
+			std::cerr << "Failed to switch to WAL mode: " << sqlite3_errmsg(db) << std::endl;
+		}
+		ensureImageHashColumns(db);
+		hashInlineImages(db);
+		ensureCatchWindowsColumn(db);
+		internAttributeNames(db);
+		ensurePagingIndexes(db);
+		ensureFilterIndexes(db);
+		ensureUserProgressTable(db);
+		compactUserProgress(db);
 		sqlite3_close(db);
 	}
 }
 
 
 
+/*
+	Destructor for the FishDBRepository class.
+	Finalizes the cached statements, before the readers pool closes the connections they were prepared on.
+*/
+FishDBRepository::~FishDBRepository() {
+	lock_guard<mutex> lock(statementsMutex);
+	for (auto& [db, statements] : seasonWeatherLocationStatements) {
+		for (sqlite3_stmt*& statement : statements) {
+			sqlite3_finalize(statement);
+			statement = nullptr;
+		}
+	}
+	seasonWeatherLocationStatements.clear();
+	for (auto& [db, statements] : fishDetailStatements) {
+		for (sqlite3_stmt*& statement : statements) {
+			sqlite3_finalize(statement);
+			statement = nullptr;
+		}
+	}
+	fishDetailStatements.clear();
+}
+
+
+
 /*
 	Function that returns a Fish object from the database with the given id and the specific username of the logged user.
 	If the fish is not found, an empty Fish object is returned.
@@ -33,19 +120,19 @@ FishDBRepository::FishDBRepository(const string& databasePath) : databasePath(da
 Fish FishDBRepository::findOne(long id, const long userId) const {
 	// Open connection to the database
 	sqlite3* db;
-	int rc = sqlite3_open(databasePath.c_str(), &db);
+	int rc = readers.acquire(&db);
 	if (rc != SQLITE_OK) {
-		sqlite3_close(db);
+		readers.release(db);
 		return Fish();
 	}
 
 	// Prepare SQL statement
 	sqlite3_stmt* statement;
-	const char* query = "SELECT name, description, category, start_catching_hour, end_catching_hour, difficulty, movement, image FROM Fish WHERE id = ?";
+	const char* query = "SELECT " FISH_ROW_COLUMNS " FROM Fish f WHERE f.id = ?";
 	rc = sqlite3_prepare_v2(db, query, -1, &statement, nullptr);
 	if (rc != SQLITE_OK) {
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		readers.release(db);
 		return Fish();
 	}
 
@@ -56,37 +143,83 @@ Fish FishDBRepository::findOne(long id, const long userId) const {
 	rc = sqlite3_step(statement);
 	if (rc != SQLITE_ROW) {
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		readers.release(db);
 		return Fish();
 	}
 
 	// Extract data
-	string name = reinterpret_cast<const char*>(sqlite3_column_text(statement, 0));
-	string description = reinterpret_cast<const char*>(sqlite3_column_text(statement, 1));
-	string category = reinterpret_cast<const char*>(sqlite3_column_text(statement, 2));
-	vector<string> seasons = getSeasonsByFishId(db, id);
-	vector<string> weathers = getWeathersByFishId(db, id);
-	vector<string> locations = getLocationsByFishId(db, id);
-	string startCatchingHour = reinterpret_cast<const char*>(sqlite3_column_text(statement, 3));
-	string endCatchingHour = reinterpret_cast<const char*>(sqlite3_column_text(statement, 4));
-	long difficulty = sqlite3_column_int(statement, 5);
-	string movement = reinterpret_cast<const char*>(sqlite3_column_text(statement, 6));
-	long isCaught = getIsCaughtByFishId(db, id, userId);
-	long isFavorite = getIsFavoriteByFishId(db, id, userId);
-	const void* imageBlob = sqlite3_column_blob(statement, 7);
-	int imageSize = sqlite3_column_bytes(statement, 7);
-	std::vector<char> image(reinterpret_cast<const char*>(imageBlob), reinterpret_cast<const char*>(imageBlob) + imageSize);
+	Fish fish;
+	readFish(db, statement, userId, fish);
 
 	// Clean up and return result
 	sqlite3_finalize(statement);
-	sqlite3_close(db);
-	return Fish(id, name, category, description, seasons, weathers, locations, startCatchingHour, endCatchingHour, difficulty, movement, isCaught, isFavorite, image);
+	readers.release(db);
+	return fish;
+}
+
+
+
+/*
+	Function that returns the Fish objects from the database with the given ids and the specific username of the logged user.
+	All the fish are read in one transaction, with one statement that is reset and bound again for every id.
+	The ids that are not found are skipped.
+	Params:
+		ids - the ids of the fish
+		userId - the id of the logged user
+*/
+vector<Fish> FishDBRepository::findMany(const vector<long>& ids, const long userId) const {
+	vector<Fish> fishList;
+	if (ids.empty()) {
+		return fishList;
+	}
+
+	// Open connection to the database
+	sqlite3* db;
+	int rc = readers.acquire(&db);
+	if (rc != SQLITE_OK) {
+		std::cerr << "Error opening database: " << sqlite3_errstr(rc) << std::endl;
+		readers.release(db);
+		return fishList;
+	}
+
+	// Prepare SQL statement
+	sqlite3_stmt* statement;
+	const char* query = "SELECT " FISH_ROW_COLUMNS " FROM Fish f WHERE f.id = ?";
+	rc = sqlite3_prepare_v2(db, query, -1, &statement, nullptr);
+	if (rc != SQLITE_OK) {
+		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
+		sqlite3_finalize(statement);
+		readers.release(db);
+		return fishList;
+	}
+
+	// One read transaction for all the ids, instead of one for every statement
+	sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
+
+	fishList.reserve(ids.size());
+	for (const long id : ids) {
+		sqlite3_bind_int64(statement, 1, id);
+		if (sqlite3_step(statement) == SQLITE_ROW) {
+			Fish fish;
+			readFish(db, statement, userId, fish);
+			fishList.push_back(std::move(fish));
+		}
+		sqlite3_reset(statement);
+	}
+
+	sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+
+	// Finalize statement and close connection
+	sqlite3_finalize(statement);
+	readers.release(db);
+	return fishList;
 }
 
 
 
 /*
 	Function that returns a Fish object from the database with the given name and the specific username of the logged user.
+	The name is compared without case, through the NOCASE index of the names.
 	If the fish is not found, an empty Fish object is returned.
 	Params:
 		name - the name of the fish
@@ -95,19 +228,19 @@ Fish FishDBRepository::findOne(long id, const long userId) const {
 Fish FishDBRepository::findOneByName(const string& name, const long userId) const {
 	// Open connection to the database
 	sqlite3* db;
-	int rc = sqlite3_open(databasePath.c_str(), &db);
+	int rc = readers.acquire(&db);
 	if (rc != SQLITE_OK) {
-		sqlite3_close(db);
+		readers.release(db);
 		return Fish();
 	}
 
 	// Prepare SQL statement
 	sqlite3_stmt* statement;
-	const char* query = "SELECT id, category, description, start_catching_hour, end_catching_hour, difficulty, movement, image FROM Fish WHERE name = ?";
+	const char* query = "SELECT " FISH_ROW_COLUMNS " FROM Fish f WHERE f.name = ? COLLATE NOCASE";
 	rc = sqlite3_prepare_v2(db, query, -1, &statement, nullptr);
 	if (rc != SQLITE_OK) {
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		readers.release(db);
 		return Fish();
 	}
 
@@ -118,32 +251,19 @@ Fish FishDBRepository::findOneByName(const string& name, const long userId) cons
 	rc = sqlite3_step(statement);
 	if (rc != SQLITE_ROW) {
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		readers.release(db);
 		return Fish();
 	}
 
 	// Extract data
-	long id = sqlite3_column_int(statement, 0);
-	string category = reinterpret_cast<const char*>(sqlite3_column_text(statement, 1));
-	string description = reinterpret_cast<const char*>(sqlite3_column_text(statement, 2));
-	vector<string> seasons = getSeasonsByFishId(db, id);
-	vector<string> weathers = getWeathersByFishId(db, id);
-	vector<string> locations = getLocationsByFishId(db, id);
-	string startCatchingHour = reinterpret_cast<const char*>(sqlite3_column_text(statement, 3));
-	string endCatchingHour = reinterpret_cast<const char*>(sqlite3_column_text(statement, 4));
-	long difficulty = sqlite3_column_int(statement, 5);
-	string movement = reinterpret_cast<const char*>(sqlite3_column_text(statement, 6));
-	long isCaught = getIsCaughtByFishId(db, id, userId);
-	long isFavorite = getIsFavoriteByFishId(db, id, userId);
-	const void* imageBlob = sqlite3_column_blob(statement, 7);
-	int imageSize = sqlite3_column_bytes(statement, 7);
-	std::vector<char> image(reinterpret_cast<const char*>(imageBlob), reinterpret_cast<const char*>(imageBlob) + imageSize);
+	Fish fish;
+	readFish(db, statement, userId, fish);
 
 	// Finalize statement and close connection
 	sqlite3_finalize(statement);
-	sqlite3_close(db);
+	readers.release(db);
 
-	return Fish(id, name, category, description, seasons, weathers, locations, startCatchingHour, endCatchingHour, difficulty, movement, isCaught, isFavorite, image);
+	return fish;
 }
 
 
@@ -155,54 +275,153 @@ Fish FishDBRepository::findOneByName(const string& name, const long userId) cons
 */
 vector<Fish> FishDBRepository::findAll(const long userId) const {
 	vector<Fish> allFish;
+	forEach(userId, [&allFish](const Fish& fish) {
+		allFish.push_back(fish);
+	});
+	return allFish;
+}
 
+
+
+/*
+	Function that streams all the Fish objects from the database to a visitor, one row at a time.
+	Nothing is collected, so the memory used does not grow with the number of fish.
+	Params:
+		userId - the id of the logged user
+		visitor - the function called with every fish
+*/
+void FishDBRepository::forEach(const long userId, const function<void(const Fish&)>& visitor) const {
 	// Open connection to the database
 	sqlite3* db;
-	int rc = sqlite3_open(databasePath.c_str(), &db);
+	int rc = readers.acquire(&db);
 	if (rc != SQLITE_OK) {
-		std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
-		sqlite3_close(db);
-		return allFish;
+		std::cerr << "Error opening database: " << sqlite3_errstr(rc) << std::endl;
+		readers.release(db);
+		return;
 	}
 
 	// Prepare SQL statement
 	sqlite3_stmt* statement;
-	const char* query = "SELECT id, name, category, description, start_catching_hour, end_catching_hour, difficulty, movement, image FROM Fish";
+	const char* query = "SELECT " FISH_ROW_COLUMNS " FROM Fish f";
 	rc = sqlite3_prepare_v2(db, query, -1, &statement, nullptr);
 	if (rc != SQLITE_OK) {
 		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
-		return allFish;
+		readers.release(db);
+		return;
 	}
 
 	// Execute query
-	while ((rc = sqlite3_step(statement)) == SQLITE_ROW) {
-		int id = sqlite3_column_int(statement, 0);
-		string name = reinterpret_cast<const char*>(sqlite3_column_text(statement, 1));
-		string category = reinterpret_cast<const char*>(sqlite3_column_text(statement, 2));
-		string description = reinterpret_cast<const char*>(sqlite3_column_text(statement, 3));
-		vector<string> seasons = getSeasonsByFishId(db, id);
-		vector<string> weathers = getWeathersByFishId(db, id);
-		vector<string> locations = getLocationsByFishId(db, id);
-		string startCatchingHour = reinterpret_cast<const char*>(sqlite3_column_text(statement, 4));
-		string endCatchingHour = reinterpret_cast<const char*>(sqlite3_column_text(statement, 5));
-		long difficulty = sqlite3_column_int(statement, 6);
-		string movement = reinterpret_cast<const char*>(sqlite3_column_text(statement, 7));
-		long isCaught = getIsCaughtByFishId(db, id, userId);
-		long isFavorite = getIsFavoriteByFishId(db, id, userId);
-		const void* imageBlob = sqlite3_column_blob(statement, 8);
-		int imageSize = sqlite3_column_bytes(statement, 8);
-		std::vector<char> image(reinterpret_cast<const char*>(imageBlob), reinterpret_cast<const char*>(imageBlob) + imageSize);
-
-		allFish.push_back(Fish(id, name, category, description, seasons, weathers, locations, startCatchingHour, endCatchingHour, difficulty, movement, isCaught, isFavorite, image));
+	stepFish(db, statement, userId, visitor);
+
+	// Finalize statement and close connection
+	sqlite3_finalize(statement);
+	readers.release(db);
+}
+
+
+
+/*
+	Function that returns one page of Fish objects, sorted by the key of the request.
+	Params:
+		userId - the id of the logged user
+		request - the sort key, direction, size and cursor of the page
+*/
+FishPage FishDBRepository::findPage(const long userId, const FishPageRequest& request) const {
+	FishPage page;
+	page.nextCursor = forEachInPage(userId, request, [&page](const Fish& fish) {
+		page.fish.push_back(fish);
+	});
+	return page;
+}
+
+
+
+/*
+	Function that streams one page of Fish objects to a visitor, sorted by the key of the request.
+	The page starts right after the (sort value, id) of the cursor, so SQLite seeks into the matching index
+	instead of skipping the rows of the previous pages. The sort value of the last row is selected after the
+	FISH_ROW_COLUMNS, to build the cursor of the next page.
+	Params:
+		userId - the id of the logged user
+		request - the sort key, direction, size and cursor of the page
+		visitor - the function called with every fish of the page
+*/
+string FishDBRepository::forEachInPage(const long userId, const FishPageRequest& request, const function<void(const Fish&)>& visitor) const {
+	if (request.limit <= 0) {
+		return "";
+	}
+
+	// Open connection to the database
+	sqlite3* db;
+	int rc = readers.acquire(&db);
+	if (rc != SQLITE_OK) {
+		std::cerr << "Error opening database: " << sqlite3_errstr(rc) << std::endl;
+		readers.release(db);
+		return "";
+	}
+
+	// Build the query, the sort expressions are the ones of the paging indexes
+	string sortColumn = "f.name";
+	if (request.sortKey == FishSortKey::Difficulty) {
+		sortColumn = "f.difficulty";
+	}
+	else if (request.sortKey == FishSortKey::Category) {
+		sortColumn = "IFNULL(f.category, '')";
+	}
+	const bool ascending = request.direction == SortDirection::Ascending;
+
+	long afterId = 0;
+	string afterValue;
+	const bool hasCursor = !request.cursor.empty() && decodePageCursor(request, afterId, afterValue);
+	if (!request.cursor.empty() && !hasCursor) {
+		std::cerr << "Invalid page cursor, reading the first page" << std::endl;
+	}
+
+	string query = "SELECT " FISH_ROW_COLUMNS ", " + sortColumn + " FROM Fish f";
+	if (hasCursor) {
+		// The bound on the sort value alone lets SQLite seek into the expression index of the category too
+		const string comparison = ascending ? ">" : "<";
+		query += " WHERE " + sortColumn + " " + comparison + "= ?1 AND (" + sortColumn + ", f.id) " + comparison + " (?1, ?2)";
+	}
+	query += " ORDER BY " + sortColumn + (ascending ? " ASC" : " DESC") + ", f.id" + (ascending ? " ASC" : " DESC") + " LIMIT ?3";
+
+	// Prepare SQL statement
+	sqlite3_stmt* statement;
+	rc = sqlite3_prepare_v2(db, query.c_str(), -1, &statement, nullptr);
+	if (rc != SQLITE_OK) {
+		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
+		sqlite3_finalize(statement);
+		readers.release(db);
+		return "";
+	}
+
+	// Bind parameters, one row more than the page is read to know if a next page exists
+	if (hasCursor) {
+		if (request.sortKey == FishSortKey::Difficulty) {
+			sqlite3_bind_int64(statement, 1, atoll(afterValue.c_str()));
+		}
+		else {
+			sqlite3_bind_text(statement, 1, afterValue.c_str(), -1, SQLITE_STATIC);
+		}
+		sqlite3_bind_int64(statement, 2, afterId);
+	}
+	sqlite3_bind_int(statement, 3, request.limit + 1);
+
+	// Execute query
+	string nextCursor;
+	if (stepFish(db, statement, userId, visitor, request.limit) == request.limit) {
+		const string cursor = encodePageCursor(request, FishRow::Id::read(statement), ColumnType<string_view>::read(statement, FishRow::COUNT));
+		if (sqlite3_step(statement) == SQLITE_ROW) {
+			nextCursor = cursor;
+		}
 	}
 
 	// Finalize statement and close connection
 	sqlite3_finalize(statement);
-	sqlite3_close(db);
+	readers.release(db);
 
-	return allFish;
+	return nextCursor;
 }
 
 
@@ -213,43 +432,98 @@ vector<Fish> FishDBRepository::findAll(const long userId) const {
 		fish - the Fish object to be saved
 */
 void FishDBRepository::save(Fish& fish) {
+	vector<Fish> fishList{ fish };
+	saveAll(fishList);
+	fish = fishList.front();
+}
+
+
+
+/*
+	Function that saves Fish objects to the database, in one transaction.
+	The insert statement is prepared once and reset for every fish, and the transaction is committed once,
+	so saving many fish costs a single commit instead of one for every fish.
+	Params:
+		fishList - the Fish objects to be saved, their ids are set to the ids they were saved with
+*/
+void FishDBRepository::saveAll(vector<Fish>& fishList) {
+	if (fishList.empty()) {
+		return;
+	}
+
 	// Open connection to the database
 	sqlite3* db;
-	int rc = sqlite3_open(databasePath.c_str(), &db);
+	int rc = writer.acquire(&db);
 	if (rc != SQLITE_OK) {
-		sqlite3_close(db);
+		std::cerr << "Error opening database: " << sqlite3_errstr(rc) << std::endl;
+		releaseWriteConnection(db);
+		return;
+	}
+	changeTracker.attach(db);
+
+	// Begin transaction
+	rc = sqlite3_exec(db, "BEGIN IMMEDIATE TRANSACTION;", nullptr, nullptr, nullptr);
+	if (rc != SQLITE_OK) {
+		std::cerr << "Failed to begin transaction: " << sqlite3_errmsg(db) << std::endl;
+		releaseWriteConnection(db);
 		return;
 	}
 
 	// Prepare SQL statement
 	sqlite3_stmt* statement;
-	const char* query = "INSERT INTO Fish (name, start_catching_hour, end_catching_hour, difficulty, movement, image) VALUES (?, ?, ?, ?, ?, ?)";
+	const char* query = "INSERT INTO Fish (name, start_catching_hour, end_catching_hour, difficulty, movement, image, image_hash, catch_windows) VALUES (?, ?, ?, ?, ?, ?, ?, ?)";
 	rc = sqlite3_prepare_v2(db, query, -1, &statement, nullptr);
 	if (rc != SQLITE_OK) {
+		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+		releaseWriteConnection(db);
 		return;
 	}
 
-	// Bind parameters
-	sqlite3_bind_text(statement, 1, fish.getName().c_str(), -1, SQLITE_STATIC);
-	sqlite3_bind_text(statement, 2, fish.getStartCatchingHour().c_str(), -1, SQLITE_STATIC);
-	sqlite3_bind_text(statement, 3, fish.getEndCatchingHour().c_str(), -1, SQLITE_STATIC);
-	sqlite3_bind_int(statement, 4, fish.getDifficulty());
-	sqlite3_bind_text(statement, 5, fish.getMovement().c_str(), -1, SQLITE_STATIC);
-	sqlite3_bind_blob(statement, 6, fish.getImage().data(), fish.getImage().size(), SQLITE_STATIC);
+	vector<long> savedIds;
+	savedIds.reserve(fishList.size());
+	for (const Fish& fish : fishList) {
+		// Bind parameters
+		sqlite3_bind_text(statement, 1, fish.getName().c_str(), -1, SQLITE_STATIC);
+		sqlite3_bind_text(statement, 2, fish.getStartCatchingHour().c_str(), -1, SQLITE_STATIC);
+		sqlite3_bind_text(statement, 3, fish.getEndCatchingHour().c_str(), -1, SQLITE_STATIC);
+		sqlite3_bind_int(statement, 4, fish.getDifficulty());
+		sqlite3_bind_text(statement, 5, fish.getMovement().c_str(), -1, SQLITE_STATIC);
+		bindImage(statement, 6, 7, fish.getImage());
 
-	// Execute query
-	rc = sqlite3_step(statement);
-	if (rc != SQLITE_DONE) {
-		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		// The catch windows always follow the catching hours that are saved with them
+		const string catchWindows = CatchTimes::parse(fish.getStartCatchingHour(), fish.getEndCatchingHour()).encode();
+		sqlite3_bind_text(statement, 8, catchWindows.c_str(), -1, SQLITE_TRANSIENT);
+
+		// Execute query
+		rc = sqlite3_step(statement);
+		if (rc != SQLITE_DONE) {
+			std::cerr << "Failed to save fish " << fish.getName() << ": " << sqlite3_errmsg(db) << std::endl;
+			sqlite3_finalize(statement);
+			sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+			releaseWriteConnection(db);
+			return;
+		}
+		savedIds.push_back(static_cast<long>(sqlite3_last_insert_rowid(db)));
+		sqlite3_reset(statement);
+	}
+	sqlite3_finalize(statement);
+
+	// Commit transaction
+	rc = sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+	if (rc != SQLITE_OK) {
+		std::cerr << "Failed to commit transaction: " << sqlite3_errmsg(db) << std::endl;
+		sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+		releaseWriteConnection(db);
 		return;
 	}
+	releaseWriteConnection(db);
 
-	// Finalize statement and close connection
-	sqlite3_finalize(statement);
-	sqlite3_close(db);
+	// The ids are only set once they are committed
+	for (size_t i = 0; i < fishList.size(); i++) {
+		fishList[i].setId(savedIds[i]);
+	}
 }
 
 
@@ -262,10 +536,12 @@ void FishDBRepository::save(Fish& fish) {
 void FishDBRepository::remove(long id) {
 	// Open connection to the database
 	sqlite3* db;
-	int rc = sqlite3_open(databasePath.c_str(), &db);
+	int rc = writer.acquire(&db);
 	if (rc != SQLITE_OK) {
-		sqlite3_close(db);
+		releaseWriteConnection(db);
+		return;
 	}
+	changeTracker.attach(db);
 
 	// Prepare SQL statement
 	sqlite3_stmt* statement;
@@ -273,7 +549,8 @@ void FishDBRepository::remove(long id) {
 	rc = sqlite3_prepare_v2(db, query, -1, &statement, nullptr);
 	if (rc != SQLITE_OK) {
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		releaseWriteConnection(db);
+		return;
 	}
 
 	// Bind parameter
@@ -283,12 +560,13 @@ void FishDBRepository::remove(long id) {
 	rc = sqlite3_step(statement);
 	if (rc != SQLITE_DONE) {
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		releaseWriteConnection(db);
+		return;
 	}
 
 	// Finalize statement and close connection
 	sqlite3_finalize(statement);
-	sqlite3_close(db);
+	releaseWriteConnection(db);
 }
 
 
@@ -301,88 +579,189 @@ void FishDBRepository::remove(long id) {
 Fish FishDBRepository::update(const Fish& fish, const long userId) {
 	qDebug() << "Updating fish in database: " << QString::fromStdString(fish.toString());
 
+	vector<Fish> updated = updateAll(vector<Fish>{ fish }, userId);
+	return updated.empty() ? Fish() : updated.front();
+}
+
+
+
+/*
+	Function that updates Fish objects in the database, in one transaction.
+	The Fish and Users_Fish statements are prepared once and reset for every fish, and the transaction is committed once.
+	Users_Fish only holds the fish a user caught or marked as favorite: the row is inserted or updated when either is set, and deleted when neither is.
+	If any fish fails to update, the transaction is rolled back and none of them are updated.
+	Params:
+		fishList - the Fish objects to be updated
+		userId - the id of the logged user
+*/
+vector<Fish> FishDBRepository::updateAll(const vector<Fish>& fishList, const long userId) {
+	return updateAll(fishList, userId, nullptr);
+}
+
+
+
+/*
+	Function that updates Fish objects in the database, in one transaction, and gives the flags they had before.
+	The flags are read from Users_Fish in the same transaction, just before every fish is written, so they are the ones the update replaced.
+	The caller asking for the flags applies the update to its caches itself, so the rows it writes are not handed out by takeDataChanges.
+	Params:
+		fishList - the Fish objects to be updated
+		userId - the id of the logged user
+		previousFlags - if not null, receives the caught and favorite flags of every fish before the update
+*/
+vector<Fish> FishDBRepository::updateAll(const vector<Fish>& fishList, const long userId, vector<FishFlags>* previousFlags) {
+	if (fishList.empty()) {
+		return {};
+	}
+
 	sqlite3* db;
-	sqlite3_stmt* stmt;
+	sqlite3_stmt* fishStatement;
+	sqlite3_stmt* usersFishStatement;
+	sqlite3_stmt* usersFishDeleteStatement;
+	sqlite3_stmt* usersFishSelectStatement = nullptr;
 	int rc;
 
 	// Open connection to the database
-	rc = sqlite3_open(databasePath.c_str(), &db);
+	rc = writer.acquire(&db);
 	if (rc != SQLITE_OK) {
-		qDebug() << "Failed to open database: " << sqlite3_errmsg(db);
-		sqlite3_close(db);
-		return Fish();
+		qDebug() << "Failed to open database: " << sqlite3_errstr(rc);
+		releaseWriteConnection(db);
+		return {};
 	}
 
+	// A caller asking for the previous flags applies the update to its caches itself
+	changeTracker.attach(db, previousFlags == nullptr);
+
 	// Begin transaction
-	rc = sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
+	rc = sqlite3_exec(db, "BEGIN IMMEDIATE TRANSACTION;", nullptr, nullptr, nullptr);
 	if (rc != SQLITE_OK) {
 		qDebug() << "Failed to begin transaction: " << sqlite3_errmsg(db);
-		sqlite3_close(db);
-		return Fish();
+		releaseWriteConnection(db);
+		return {};
 	}
 
-	// Update Fish table
-	std::string fishUpdateQuery = "UPDATE Fish SET name = ?, category = ?, description = ?, start_catching_hour = ?, end_catching_hour = ?, difficulty = ?, movement = ? WHERE id = ?";
-	rc = sqlite3_prepare_v2(db, fishUpdateQuery.c_str(), -1, &stmt, nullptr);
+	// Prepare the statements of the Fish and Users_Fish tables
+	const char* fishUpdateQuery = "UPDATE Fish SET name = ?, category = ?, description = ?, start_catching_hour = ?, end_catching_hour = ?, difficulty = ?, movement = ?, catch_windows = ? WHERE id = ?";
+	const char* usersFishUpdateQuery = "INSERT INTO Users_Fish (is_caught, is_favorite, user_id, fish_id) VALUES (?, ?, ?, ?) ON CONFLICT (user_id, fish_id) DO UPDATE SET is_caught = excluded.is_caught, is_favorite = excluded.is_favorite";
+	const char* usersFishDeleteQuery = "DELETE FROM Users_Fish WHERE user_id = ? AND fish_id = ?";
+	rc = sqlite3_prepare_v2(db, fishUpdateQuery, -1, &fishStatement, nullptr);
 	if (rc != SQLITE_OK) {
 		qDebug() << "Failed to prepare fishUpdateQuery: " << sqlite3_errmsg(db);
 		sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
-		sqlite3_close(db);
-		return Fish();
-	}
-
-	sqlite3_bind_text(stmt, 1, fish.getName().c_str(), -1, SQLITE_STATIC);
-	sqlite3_bind_text(stmt, 2, fish.getCategory().c_str(), -1, SQLITE_STATIC);
-	sqlite3_bind_text(stmt, 3, fish.getDescription().c_str(), -1, SQLITE_STATIC);
-	sqlite3_bind_text(stmt, 4, fish.getStartCatchingHour().c_str(), -1, SQLITE_STATIC);
-	sqlite3_bind_text(stmt, 5, fish.getEndCatchingHour().c_str(), -1, SQLITE_STATIC);
-	sqlite3_bind_int(stmt, 6, fish.getDifficulty());
-	sqlite3_bind_text(stmt, 7, fish.getMovement().c_str(), -1, SQLITE_STATIC);
-	sqlite3_bind_int(stmt, 8, static_cast<int>(fish.getId()));
-
-	rc = sqlite3_step(stmt);
-	sqlite3_finalize(stmt);
-	if (rc != SQLITE_DONE) {
-		qDebug() << "Failed to update Fish table: " << sqlite3_errmsg(db);
-		sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
-		sqlite3_close(db);
-		return Fish();
+		releaseWriteConnection(db);
+		return {};
 	}
-
-	// Update Users_Fish table
-	std::string usersFishUpdateQuery = "UPDATE Users_Fish SET is_caught = ?, is_favorite = ? WHERE user_id = ? AND fish_id = ?";
-	rc = sqlite3_prepare_v2(db, usersFishUpdateQuery.c_str(), -1, &stmt, nullptr);
+	rc = sqlite3_prepare_v2(db, usersFishUpdateQuery, -1, &usersFishStatement, nullptr);
 	if (rc != SQLITE_OK) {
 		qDebug() << "Failed to prepare usersFishUpdateQuery: " << sqlite3_errmsg(db);
+		sqlite3_finalize(fishStatement);
 		sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
-		sqlite3_close(db);
-		return Fish();
+		releaseWriteConnection(db);
+		return {};
 	}
+	rc = sqlite3_prepare_v2(db, usersFishDeleteQuery, -1, &usersFishDeleteStatement, nullptr);
+	if (rc != SQLITE_OK) {
+		qDebug() << "Failed to prepare usersFishDeleteQuery: " << sqlite3_errmsg(db);
+		sqlite3_finalize(fishStatement);
+		sqlite3_finalize(usersFishStatement);
+		sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+		releaseWriteConnection(db);
+		return {};
+	}
+
+	const char* usersFishSelectQuery = "SELECT is_caught, is_favorite FROM Users_Fish WHERE user_id = ? AND fish_id = ?";
+	if (previousFlags != nullptr) {
+		rc = sqlite3_prepare_v2(db, usersFishSelectQuery, -1, &usersFishSelectStatement, nullptr);
+		if (rc != SQLITE_OK) {
+			qDebug() << "Failed to prepare usersFishSelectQuery: " << sqlite3_errmsg(db);
+			sqlite3_finalize(fishStatement);
+			sqlite3_finalize(usersFishStatement);
+			sqlite3_finalize(usersFishDeleteStatement);
+			sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+			releaseWriteConnection(db);
+			return {};
+		}
+		previousFlags->clear();
+		previousFlags->reserve(fishList.size());
+	}
+
+	for (const Fish& fish : fishList) {
+		// Read the flags the fish had, a fish without a Users_Fish row was neither caught nor favorite
+		if (usersFishSelectStatement != nullptr) {
+			FishFlags flags;
+			sqlite3_bind_int64(usersFishSelectStatement, 1, userId);
+			sqlite3_bind_int64(usersFishSelectStatement, 2, fish.getId());
+			if (sqlite3_step(usersFishSelectStatement) == SQLITE_ROW) {
+				flags.caught = sqlite3_column_int(usersFishSelectStatement, 0) != 0;
+				flags.favorite = sqlite3_column_int(usersFishSelectStatement, 1) != 0;
+			}
+			sqlite3_reset(usersFishSelectStatement);
+			previousFlags->push_back(flags);
+		}
 
-	sqlite3_bind_int(stmt, 1, fish.getIsCaught() ? 1 : 0);
-	sqlite3_bind_int(stmt, 2, fish.getIsFavorite() ? 1 : 0);
-	sqlite3_bind_int(stmt, 3, userId);
-	sqlite3_bind_int(stmt, 4, fish.getId());
+		// Update Fish table
+		sqlite3_bind_text(fishStatement, 1, fish.getName().c_str(), -1, SQLITE_STATIC);
+		sqlite3_bind_text(fishStatement, 2, fish.getCategory().c_str(), -1, SQLITE_STATIC);
+		sqlite3_bind_text(fishStatement, 3, fish.getDescription().c_str(), -1, SQLITE_STATIC);
+		sqlite3_bind_text(fishStatement, 4, fish.getStartCatchingHour().c_str(), -1, SQLITE_STATIC);
+		sqlite3_bind_text(fishStatement, 5, fish.getEndCatchingHour().c_str(), -1, SQLITE_STATIC);
+		sqlite3_bind_int(fishStatement, 6, fish.getDifficulty());
+		sqlite3_bind_text(fishStatement, 7, fish.getMovement().c_str(), -1, SQLITE_STATIC);
+		const string catchWindows = CatchTimes::parse(fish.getStartCatchingHour(), fish.getEndCatchingHour()).encode();
+		sqlite3_bind_text(fishStatement, 8, catchWindows.c_str(), -1, SQLITE_TRANSIENT);
+		sqlite3_bind_int64(fishStatement, 9, fish.getId());
+
+		rc = sqlite3_step(fishStatement);
+		sqlite3_reset(fishStatement);
+		if (rc != SQLITE_DONE) {
+			qDebug() << "Failed to update Fish table: " << sqlite3_errmsg(db);
+			break;
+		}
+
+		// Update Users_Fish table, a fish neither caught nor favorite has no row
+		if (fish.getIsCaught() || fish.getIsFavorite()) {
+			sqlite3_bind_int(usersFishStatement, 1, fish.getIsCaught() ? 1 : 0);
+			sqlite3_bind_int(usersFishStatement, 2, fish.getIsFavorite() ? 1 : 0);
+			sqlite3_bind_int64(usersFishStatement, 3, userId);
+			sqlite3_bind_int64(usersFishStatement, 4, fish.getId());
+
+			rc = sqlite3_step(usersFishStatement);
+			sqlite3_reset(usersFishStatement);
+		}
+		else {
+			sqlite3_bind_int64(usersFishDeleteStatement, 1, userId);
+			sqlite3_bind_int64(usersFishDeleteStatement, 2, fish.getId());
+
+			rc = sqlite3_step(usersFishDeleteStatement);
+			sqlite3_reset(usersFishDeleteStatement);
+		}
+		if (rc != SQLITE_DONE) {
+			qDebug() << "Failed to update Users_Fish table: " << sqlite3_errmsg(db);
+			break;
+		}
+	}
+	sqlite3_finalize(fishStatement);
+	sqlite3_finalize(usersFishStatement);
+	sqlite3_finalize(usersFishDeleteStatement);
+	sqlite3_finalize(usersFishSelectStatement);
 
-	rc = sqlite3_step(stmt);
-	sqlite3_finalize(stmt);
 	if (rc != SQLITE_DONE) {
-		qDebug() << "Failed to update Users_Fish table: " << sqlite3_errmsg(db);
 		sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
-		sqlite3_close(db);
-		return Fish();
+		releaseWriteConnection(db);
+		return {};
 	}
 
 	// Commit transaction
 	rc = sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
 	if (rc != SQLITE_OK) {
 		qDebug() << "Failed to commit transaction: " << sqlite3_errmsg(db);
-		sqlite3_close(db);
-		return Fish();
+		sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+		releaseWriteConnection(db);
+		return {};
 	}
 
-	sqlite3_close(db);
-	return fish;
+	releaseWriteConnection(db);
+	return fishList;
 }
 
 
@@ -395,29 +774,33 @@ Fish FishDBRepository::update(const Fish& fish, const long userId) {
 */
 void FishDBRepository::saveImage(long fishId, const vector<char>& image) {
 	sqlite3* db;
-	int rc = sqlite3_open(databasePath.c_str(), &db);
+	int rc = writer.acquire(&db);
 	if (rc != SQLITE_OK) {
-		sqlite3_close(db);
+		releaseWriteConnection(db);
+		return;
 	}
+	changeTracker.attach(db);
 
 	sqlite3_stmt* statement;
-	const char* query = "UPDATE Fish SET image = ? WHERE id = ?";
+	const char* query = "UPDATE Fish SET image = ?, image_hash = ? WHERE id = ?";
 	rc = sqlite3_prepare_v2(db, query, -1, &statement, nullptr);
 	if (rc != SQLITE_OK) {
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		releaseWriteConnection(db);
+		return;
 	}
 
-	sqlite3_bind_blob(statement, 1, image.data(), image.size(), SQLITE_STATIC);
-	sqlite3_bind_int(statement, 2, fishId);
+	bindImage(statement, 1, 2, image);
+	sqlite3_bind_int(statement, 3, fishId);
 	rc = sqlite3_step(statement);
 	if (rc != SQLITE_DONE) {
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		releaseWriteConnection(db);
+		return;
 	}
 
 	sqlite3_finalize(statement);
-	sqlite3_close(db);
+	releaseWriteConnection(db);
 }
 
 
@@ -425,29 +808,33 @@ void FishDBRepository::saveImage(long fishId, const vector<char>& image) {
 /* Temporary Function */
 void FishDBRepository::saveUserImage(long userId, const std::vector<char>& image) {
 	sqlite3* db;
-	int rc = sqlite3_open(databasePath.c_str(), &db);
+	int rc = writer.acquire(&db);
 	if (rc != SQLITE_OK) {
-		sqlite3_close(db);
+		releaseWriteConnection(db);
+		return;
 	}
+	changeTracker.attach(db);
 
 	sqlite3_stmt* statement;
-	const char* query = "UPDATE Users SET image = ? WHERE id = ?";
+	const char* query = "UPDATE Users SET image = ?, image_hash = ? WHERE id = ?";
 	rc = sqlite3_prepare_v2(db, query, -1, &statement, nullptr);
 	if (rc != SQLITE_OK) {
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		releaseWriteConnection(db);
+		return;
 	}
 
-	sqlite3_bind_blob(statement, 1, image.data(), image.size(), SQLITE_STATIC);
-	sqlite3_bind_int(statement, 2, userId);
+	bindImage(statement, 1, 2, image);
+	sqlite3_bind_int(statement, 3, userId);
 	rc = sqlite3_step(statement);
 	if (rc != SQLITE_DONE) {
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		releaseWriteConnection(db);
+		return;
 	}
 
 	sqlite3_finalize(statement);
-	sqlite3_close(db);
+	releaseWriteConnection(db);
 }
 
 
@@ -460,29 +847,33 @@ void FishDBRepository::saveUserImage(long userId, const std::vector<char>& image
 */
 void FishDBRepository::saveImageToImages(const string& name, const vector<char>& image) {
 	sqlite3* db;
-	int rc = sqlite3_open(databasePath.c_str(), &db);
+	int rc = writer.acquire(&db);
 	if (rc != SQLITE_OK) {
-		sqlite3_close(db);
+		releaseWriteConnection(db);
+		return;
 	}
+	changeTracker.attach(db);
 
 	sqlite3_stmt* statement;
-	const char* query = "INSERT INTO Images (name, image) VALUES (?, ?)";
+	const char* query = "INSERT INTO Images (name, image, image_hash) VALUES (?, ?, ?)";
 	rc = sqlite3_prepare_v2(db, query, -1, &statement, nullptr);
 	if (rc != SQLITE_OK) {
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		releaseWriteConnection(db);
+		return;
 	}
 
 	sqlite3_bind_text(statement, 1, name.c_str(), -1, SQLITE_STATIC);
-	sqlite3_bind_blob(statement, 2, image.data(), image.size(), SQLITE_STATIC);
+	bindImage(statement, 2, 3, image);
 	rc = sqlite3_step(statement);
 	if (rc != SQLITE_DONE) {
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		releaseWriteConnection(db);
+		return;
 	}
 
 	sqlite3_finalize(statement);
-	sqlite3_close(db);
+	releaseWriteConnection(db);
 }
 
 
@@ -494,32 +885,34 @@ void FishDBRepository::saveImageToImages(const string& name, const vector<char>&
 */
 vector<char> FishDBRepository::getImage(long fishId) const {
 	sqlite3* db;
-	int rc = sqlite3_open(databasePath.c_str(), &db);
+	int rc = readers.acquire(&db);
 	if (rc != SQLITE_OK) {
-		sqlite3_close(db);
+		readers.release(db);
+		return {};
 	}
 
 	sqlite3_stmt* statement;
-	const char* query = "SELECT image FROM Fish WHERE id = ?";
+	const char* query = "SELECT image, image_hash FROM Fish WHERE id = ?";
 	rc = sqlite3_prepare_v2(db, query, -1, &statement, nullptr);
 	if (rc != SQLITE_OK) {
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		readers.release(db);
+		return {};
 	}
 
 	sqlite3_bind_int(statement, 1, fishId);
 	rc = sqlite3_step(statement);
 	if (rc != SQLITE_ROW) {
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		readers.release(db);
+		return {};
 	}
 
-	const void* imageBlob = sqlite3_column_blob(statement, 0);
-	int imageSize = sqlite3_column_bytes(statement, 0);
-	std::vector<char> image(reinterpret_cast<const char*>(imageBlob), reinterpret_cast<const char*>(imageBlob) + imageSize);
+	string imageHash;
+	std::vector<char> image = readImage(statement, 0, 1, imageHash);
 
 	sqlite3_finalize(statement);
-	sqlite3_close(db);
+	readers.release(db);
 	return image;
 }
 
@@ -532,32 +925,34 @@ vector<char> FishDBRepository::getImage(long fishId) const {
 */
 std::vector<char> FishDBRepository::getImageFromImages(const string& name) const {
 	sqlite3* db;
-	int rc = sqlite3_open(databasePath.c_str(), &db);
+	int rc = readers.acquire(&db);
 	if (rc != SQLITE_OK) {
-		sqlite3_close(db);
+		readers.release(db);
+		return {};
 	}
 
 	sqlite3_stmt* statement;
-	const char* query = "SELECT image FROM Images WHERE name = ?";
+	const char* query = "SELECT image, image_hash FROM Images WHERE name = ?";
 	rc = sqlite3_prepare_v2(db, query, -1, &statement, nullptr);
 	if (rc != SQLITE_OK) {
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		readers.release(db);
+		return {};
 	}
 
 	sqlite3_bind_text(statement, 1, name.c_str(), -1, SQLITE_STATIC);
 	rc = sqlite3_step(statement);
 	if (rc != SQLITE_ROW) {
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		readers.release(db);
+		return {};
 	}
 
-	const void* imageBlob = sqlite3_column_blob(statement, 0);
-	int imageSize = sqlite3_column_bytes(statement, 0);
-	std::vector<char> image(reinterpret_cast<const char*>(imageBlob), reinterpret_cast<const char*>(imageBlob) + imageSize);
+	string imageHash;
+	std::vector<char> image = readImage(statement, 0, 1, imageHash);
 
 	sqlite3_finalize(statement);
-	sqlite3_close(db);
+	readers.release(db);
 	return image;
 }
 
@@ -571,19 +966,20 @@ QMap<QString, QPixmap> FishDBRepository::getAllImages() const {
 	QPixmap pixmap;
 
 	sqlite3* db;
-	int rc = sqlite3_open(databasePath.c_str(), &db);
+	int rc = readers.acquire(&db);
 	if (rc != SQLITE_OK) {
-		sqlite3_close(db);
+		readers.release(db);
+		return images;
 	}
 
 	// Preparing the SQL statement
 	sqlite3_stmt* statement;
-	const char* ImagesQuery = "SELECT i.name, i.image FROM Images i";
+	const char* ImagesQuery = "SELECT i.name, i.image, i.image_hash FROM Images i";
 	rc = sqlite3_prepare_v2(db, ImagesQuery, -1, &statement, nullptr);
 	if (rc != SQLITE_OK) {
 		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		readers.release(db);
 		return images;
 	}
 
@@ -592,11 +988,10 @@ QMap<QString, QPixmap> FishDBRepository::getAllImages() const {
 	while ((rc = sqlite3_step(statement)) == SQLITE_ROW) {
 		const unsigned char* name = sqlite3_column_text(statement, 0);
 
-		const void* imageBlob = sqlite3_column_blob(statement, 1);
-		int imageSize = sqlite3_column_bytes(statement, 1);
-		const vector<char> imageData(reinterpret_cast<const char*>(imageBlob), reinterpret_cast<const char*>(imageBlob) + imageSize);
+		// Decode straight from the image store mapping (or the SQLite buffer), without copying the bytes
+		const ImageView imageData = viewImage(statement, 1, 2);
 		QImage image;
-		if (image.loadFromData(reinterpret_cast<const uchar*>(imageData.data()), imageData.size())) {
+		if (image.loadFromData(reinterpret_cast<const uchar*>(imageData.data), imageData.size)) {
 			pixmap = QPixmap::fromImage(image);
 		}
 		else {
@@ -607,13 +1002,15 @@ QMap<QString, QPixmap> FishDBRepository::getAllImages() const {
 	}
 
 
+	sqlite3_finalize(statement);
+
 	// Execute query for Fish table
-	const char* fishQuery = "SELECT f.name, f.image FROM Fish f";
+	const char* fishQuery = "SELECT f.name, f.image, f.image_hash FROM Fish f";
 	rc = sqlite3_prepare_v2(db, fishQuery, -1, &statement, nullptr);
 	if (rc != SQLITE_OK) {
 		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		readers.release(db);
 		return images;
 	}
 
@@ -622,11 +1019,10 @@ QMap<QString, QPixmap> FishDBRepository::getAllImages() const {
 	while ((rc = sqlite3_step(statement)) == SQLITE_ROW) {
 		const unsigned char* name = sqlite3_column_text(statement, 0);
 
-		const void* imageBlob = sqlite3_column_blob(statement, 1);
-		int imageSize = sqlite3_column_bytes(statement, 1);
-		const vector<char> imageData(reinterpret_cast<const char*>(imageBlob), reinterpret_cast<const char*>(imageBlob) + imageSize);
+		// Decode straight from the image store mapping (or the SQLite buffer), without copying the bytes
+		const ImageView imageData = viewImage(statement, 1, 2);
 		QImage image;
-		if (image.loadFromData(reinterpret_cast<const uchar*>(imageData.data()), imageData.size())) {
+		if (image.loadFromData(reinterpret_cast<const uchar*>(imageData.data), imageData.size)) {
 			pixmap = QPixmap::fromImage(image);
 		}
 		else {
@@ -637,12 +1033,98 @@ QMap<QString, QPixmap> FishDBRepository::getAllImages() const {
 	}
 
 	sqlite3_finalize(statement);
-	sqlite3_close(db);
+	readers.release(db);
 	return images;
 }
 
 
 
+/*
+	Function that loads the images of the Images table as a sprite atlas.
+	The signature of the table (names, sizes and hashes of the images) decides if the saved atlas can be reused.
+	If it cannot, every image is decoded once, the small ones are packed and the atlas is saved for the next runs.
+*/
+SpriteAtlas FishDBRepository::loadSpriteAtlas() const {
+	SpriteAtlas atlas;
+	const QString atlasPath = QString::fromStdString(databasePath + ".atlas.png");
+
+	sqlite3* db;
+	int rc = readers.acquire(&db);
+	if (rc != SQLITE_OK) {
+		std::cerr << "Error opening database: " << sqlite3_errstr(rc) << std::endl;
+		readers.release(db);
+		return atlas;
+	}
+
+
+	// => SIGNATURE OF THE IMAGES TABLE (the packing limits are part of it, so changing them rebuilds the atlas)
+	QCryptographicHash signatureHash(QCryptographicHash::Sha256);
+	signatureHash.addData(QByteArray::number(SpriteAtlas::MAX_SPRITE_SIDE) + " " + QByteArray::number(SpriteAtlas::MAX_PACKED_BYTES) + " " + QByteArray::number(SpriteAtlas::ATLAS_WIDTH) + "\n");
+
+	sqlite3_stmt* statement;
+	const char* signatureQuery = "SELECT name, length(image), image_hash FROM Images ORDER BY name";
+	rc = sqlite3_prepare_v2(db, signatureQuery, -1, &statement, nullptr);
+	if (rc != SQLITE_OK) {
+		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
+		readers.release(db);
+		return atlas;
+	}
+	while (sqlite3_step(statement) == SQLITE_ROW) {
+		const unsigned char* name = sqlite3_column_text(statement, 0);
+		const unsigned char* hash = sqlite3_column_text(statement, 2);
+		signatureHash.addData(QByteArray(reinterpret_cast<const char*>(name)) + "\t" + QByteArray::number(sqlite3_column_int64(statement, 1)) + "\t" + QByteArray(hash != nullptr ? reinterpret_cast<const char*>(hash) : "") + "\n");
+	}
+	sqlite3_finalize(statement);
+
+	const QByteArray signature = signatureHash.result().toHex();
+	const bool atlasLoaded = atlas.load(atlasPath, signature);
+	// <= END
+
+
+	// => DECODING THE IMAGES (only the standalone ones if the saved atlas was loaded)
+	const char* imagesQuery = "SELECT name, image, image_hash FROM Images";
+	rc = sqlite3_prepare_v2(db, imagesQuery, -1, &statement, nullptr);
+	if (rc != SQLITE_OK) {
+		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
+		readers.release(db);
+		return atlas;
+	}
+
+	QMap<QString, QImage> sprites;
+	while (sqlite3_step(statement) == SQLITE_ROW) {
+		const QString name = QString::fromUtf8(reinterpret_cast<const char*>(sqlite3_column_text(statement, 0)));
+		if (atlasLoaded && atlas.isPacked(name)) {
+			continue;
+		}
+
+		const ImageView imageData = viewImage(statement, 1, 2);
+		QImage image;
+		if (!image.loadFromData(reinterpret_cast<const uchar*>(imageData.data), imageData.size)) {
+			qWarning() << "Failed to load image from given data!";
+			continue;
+		}
+
+		if (!atlasLoaded && SpriteAtlas::fitsAtlas(image.size(), imageData.size)) {
+			sprites.insert(name, image);
+		}
+		else {
+			atlas.insertStandalone(name, QPixmap::fromImage(image));
+		}
+	}
+	sqlite3_finalize(statement);
+	readers.release(db);
+	// <= END
+
+
+	if (!atlasLoaded) {
+		atlas.pack(sprites, signature);
+		atlas.save(atlasPath);
+	}
+	return atlas;
+}
+
+
+
 /*
 	Function that returns all the users from the database.
 */
@@ -651,19 +1133,20 @@ vector<User> FishDBRepository::findAllUsers() const {
 	QPixmap pixmap;
 
 	sqlite3* db;
-	int rc = sqlite3_open(databasePath.c_str(), &db);
+	int rc = readers.acquire(&db);
 	if (rc != SQLITE_OK) {
-		sqlite3_close(db);
+		readers.release(db);
+		return users;
 	}
 
 	// Preparing the SQL statement
 	sqlite3_stmt* statement;
-	const char* usersQuery = "SELECT u.id, u.name, u.image FROM Users u";
+	const char* usersQuery = "SELECT u.id, u.name, u.image, u.image_hash FROM Users u";
 	rc = sqlite3_prepare_v2(db, usersQuery, -1, &statement, nullptr);
 	if (rc != SQLITE_OK) {
 		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		readers.release(db);
 		return users;
 	}
 
@@ -674,11 +1157,10 @@ vector<User> FishDBRepository::findAllUsers() const {
 
 		const unsigned char* name = sqlite3_column_text(statement, 1);
 
-		const void* imageBlob = sqlite3_column_blob(statement, 2);
-		int imageSize = sqlite3_column_bytes(statement, 2);
-		const vector<char> imageData(reinterpret_cast<const char*>(imageBlob), reinterpret_cast<const char*>(imageBlob) + imageSize);
+		// Decode straight from the image store mapping (or the SQLite buffer), without copying the bytes
+		const ImageView imageData = viewImage(statement, 2, 3);
 		QImage image;
-		if (image.loadFromData(reinterpret_cast<const uchar*>(imageData.data()), imageData.size())) {
+		if (image.loadFromData(reinterpret_cast<const uchar*>(imageData.data), imageData.size)) {
 			pixmap = QPixmap::fromImage(image);
 		}
 		else {
@@ -688,12 +1170,111 @@ vector<User> FishDBRepository::findAllUsers() const {
 	}
 
 	sqlite3_finalize(statement);
-	sqlite3_close(db);
+	readers.release(db);
 	return users;
 }
 
 
 
+/*
+	Function that moves every image BLOB of the Fish, Images and Users tables into the image store.
+	The rows keep only the hash of their image, and the database file is compacted afterwards.
+	It is meant to be run once, rows that were already moved are skipped.
+*/
+bool FishDBRepository::migrateImagesToStore() {
+	if (!imageStore.isOpen()) {
+		std::cerr << "Image store is not open" << std::endl;
+		return false;
+	}
+
+	sqlite3* db;
+	int rc = writer.acquire(&db);
+	if (rc != SQLITE_OK) {
+		std::cerr << "Error opening database: " << sqlite3_errstr(rc) << std::endl;
+		writer.release(db);
+		return false;
+	}
+	ensureImageHashColumns(db);
+
+	rc = sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
+	if (rc != SQLITE_OK) {
+		std::cerr << "Failed to begin transaction: " << sqlite3_errmsg(db) << std::endl;
+		writer.release(db);
+		return false;
+	}
+
+	int movedImages = 0;
+	for (const string& tableName : IMAGE_TABLES) {
+		if (!hasColumn(db, tableName, "image_hash")) {
+			continue;
+		}
+
+		sqlite3_stmt* selectStatement;
+		string selectQuery = "SELECT rowid, image FROM " + tableName + " WHERE length(image) > 0";
+		rc = sqlite3_prepare_v2(db, selectQuery.c_str(), -1, &selectStatement, nullptr);
+		if (rc != SQLITE_OK) {
+			std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
+			sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+			writer.release(db);
+			return false;
+		}
+
+		sqlite3_stmt* updateStatement;
+		string updateQuery = "UPDATE " + tableName + " SET image = zeroblob(0), image_hash = ? WHERE rowid = ?";
+		rc = sqlite3_prepare_v2(db, updateQuery.c_str(), -1, &updateStatement, nullptr);
+		if (rc != SQLITE_OK) {
+			std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
+			sqlite3_finalize(selectStatement);
+			sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+			writer.release(db);
+			return false;
+		}
+
+		// Collect the hashes first, the rows are updated only after the whole table was read
+		vector<pair<sqlite3_int64, string>> hashes;
+		while (sqlite3_step(selectStatement) == SQLITE_ROW) {
+			const char* imageBlob = reinterpret_cast<const char*>(sqlite3_column_blob(selectStatement, 1));
+			int imageSize = sqlite3_column_bytes(selectStatement, 1);
+			string hash = imageStore.put(imageBlob, imageSize);
+			if (!hash.empty()) {
+				hashes.emplace_back(sqlite3_column_int64(selectStatement, 0), hash);
+			}
+		}
+		sqlite3_finalize(selectStatement);
+
+		for (const auto& [rowId, hash] : hashes) {
+			sqlite3_bind_text(updateStatement, 1, hash.c_str(), -1, SQLITE_STATIC);
+			sqlite3_bind_int64(updateStatement, 2, rowId);
+			if (sqlite3_step(updateStatement) != SQLITE_DONE) {
+				std::cerr << "Failed to update " << tableName << " table: " << sqlite3_errmsg(db) << std::endl;
+				sqlite3_finalize(updateStatement);
+				sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+				writer.release(db);
+				return false;
+			}
+			sqlite3_reset(updateStatement);
+			movedImages++;
+		}
+		sqlite3_finalize(updateStatement);
+	}
+
+	rc = sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+	if (rc != SQLITE_OK) {
+		std::cerr << "Failed to commit transaction: " << sqlite3_errmsg(db) << std::endl;
+		writer.release(db);
+		return false;
+	}
+
+	// Give the space of the moved BLOBs back to the file system
+	sqlite3_exec(db, "VACUUM;", nullptr, nullptr, nullptr);
+	writer.release(db);
+
+	qDebug() << "Moved" << movedImages << "images to the image store";
+	return true;
+}
+
+
+
 /*
 	Function that returns all the weathers from the database (Weathers Table).
 */
@@ -702,10 +1283,10 @@ vector<string> FishDBRepository::findAllWeathers() const noexcept {
 
 	// Open connection to the database
 	sqlite3* db;
-	int rc = sqlite3_open(databasePath.c_str(), &db);
+	int rc = readers.acquire(&db);
 	if (rc != SQLITE_OK) {
-		std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
-		sqlite3_close(db);
+		std::cerr << "Error opening database: " << sqlite3_errstr(rc) << std::endl;
+		readers.release(db);
 		return weathers;
 	}
 
@@ -716,7 +1297,7 @@ vector<string> FishDBRepository::findAllWeathers() const noexcept {
 	if (rc != SQLITE_OK) {
 		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		readers.release(db);
 		return weathers;
 	}
 
@@ -728,7 +1309,7 @@ vector<string> FishDBRepository::findAllWeathers() const noexcept {
 
 	// Finalize statement and close connection
 	sqlite3_finalize(statement);
-	sqlite3_close(db);
+	readers.release(db);
 
 	return weathers;
 }
@@ -743,10 +1324,10 @@ vector<string> FishDBRepository::findAllSeasons() const noexcept {
 
 	// Open connection to the database
 	sqlite3* db;
-	int rc = sqlite3_open(databasePath.c_str(), &db);
+	int rc = readers.acquire(&db);
 	if (rc != SQLITE_OK) {
-		std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
-		sqlite3_close(db);
+		std::cerr << "Error opening database: " << sqlite3_errstr(rc) << std::endl;
+		readers.release(db);
 		return seasons;
 	}
 
@@ -757,7 +1338,7 @@ vector<string> FishDBRepository::findAllSeasons() const noexcept {
 	if (rc != SQLITE_OK) {
 		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		readers.release(db);
 		return seasons;
 	}
 
@@ -769,7 +1350,7 @@ vector<string> FishDBRepository::findAllSeasons() const noexcept {
 
 	// Finalize statement and close connection
 	sqlite3_finalize(statement);
-	sqlite3_close(db);
+	readers.release(db);
 
 	return seasons;
 }
@@ -784,10 +1365,10 @@ vector<string> FishDBRepository::findAllLocations() const noexcept {
 
 	// Open connection to the database
 	sqlite3* db;
-	int rc = sqlite3_open(databasePath.c_str(), &db);
+	int rc = readers.acquire(&db);
 	if (rc != SQLITE_OK) {
-		std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
-		sqlite3_close(db);
+		std::cerr << "Error opening database: " << sqlite3_errstr(rc) << std::endl;
+		readers.release(db);
 		return locations;
 	}
 
@@ -798,7 +1379,7 @@ vector<string> FishDBRepository::findAllLocations() const noexcept {
 	if (rc != SQLITE_OK) {
 		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		readers.release(db);
 		return locations;
 	}
 
@@ -810,7 +1391,7 @@ vector<string> FishDBRepository::findAllLocations() const noexcept {
 
 	// Finalize statement and close connection
 	sqlite3_finalize(statement);
-	sqlite3_close(db);
+	readers.release(db);
 
 	return locations;
 }
@@ -824,57 +1405,13 @@ vector<string> FishDBRepository::findAllLocations() const noexcept {
 		weather - the weather value for filtering the fish
 */
 vector<Fish> FishDBRepository::findAllByWeather(const long userId, const string& weather) const noexcept {
-	vector<Fish> allFish;
-
-	// Open connection to the database
-	sqlite3* db;
-	int rc = sqlite3_open(databasePath.c_str(), &db);
-	if (rc != SQLITE_OK) {
-		cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
-		sqlite3_close(db);
-		return allFish;
-	}
-
-	// Prepare SQL statement
-	sqlite3_stmt* statement;
-	const char* query = "SELECT id, name, category, description, start_catching_hour, end_catching_hour, difficulty, movement, image FROM Fish";
-	rc = sqlite3_prepare_v2(db, query, -1, &statement, nullptr);
-	if (rc != SQLITE_OK) {
-		cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
-		sqlite3_finalize(statement);
-		sqlite3_close(db);
-		return allFish;
-	}
-
-	// Execute query
-	while ((rc = sqlite3_step(statement)) == SQLITE_ROW) {
-		int id = sqlite3_column_int(statement, 0);
-		string name = reinterpret_cast<const char*>(sqlite3_column_text(statement, 1));
-		string category = reinterpret_cast<const char*>(sqlite3_column_text(statement, 2));
-		string description = reinterpret_cast<const char*>(sqlite3_column_text(statement, 3));
-		vector<string> seasons = getSeasonsByFishId(db, id);
-		vector<string> weathers = getWeathersByFishId(db, id);
-		vector<string> locations = getLocationsByFishId(db, id);
-		string startCatchingHour = reinterpret_cast<const char*>(sqlite3_column_text(statement, 4));
-		string endCatchingHour = reinterpret_cast<const char*>(sqlite3_column_text(statement, 5));
-		long difficulty = sqlite3_column_int(statement, 6);
-		string movement = reinterpret_cast<const char*>(sqlite3_column_text(statement, 7));
-		long isCaught = getIsCaughtByFishId(db, id, userId);
-		long isFavorite = getIsFavoriteByFishId(db, id, userId);
-		const void* imageBlob = sqlite3_column_blob(statement, 8);
-		int imageSize = sqlite3_column_bytes(statement, 8);
-		vector<char> image(reinterpret_cast<const char*>(imageBlob), reinterpret_cast<const char*>(imageBlob) + imageSize);
-
-		if (find(weathers.begin(), weathers.end(), weather) != weathers.end()) {
-			allFish.push_back(Fish(id, name, category, description, seasons, weathers, locations, startCatchingHour, endCatchingHour, difficulty, movement, isCaught, isFavorite, image));
-		}
+	// An empty weather is not a filter here, no fish has it
+	if (weather.empty()) {
+		return vector<Fish>();
 	}
 
-	// Finalize statement and close connection
-	sqlite3_finalize(statement);
-	sqlite3_close(db);
-
-	return allFish;
+	// The weather is looked up by its id through the cached statement of its filter, matched without case like the other filters
+	return findAllBySeasonWeatherLocation(userId, "", weather, "");
 }
 
 
@@ -886,57 +1423,13 @@ vector<Fish> FishDBRepository::findAllByWeather(const long userId, const string&
 		season - the season value for filtering the fish
 */
 vector<Fish> FishDBRepository::findAllBySeason(const long userId, const string& season) const noexcept {
-	vector<Fish> allFish;
-
-	// Open connection to the database
-	sqlite3* db;
-	int rc = sqlite3_open(databasePath.c_str(), &db);
-	if (rc != SQLITE_OK) {
-		std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
-		sqlite3_close(db);
-		return allFish;
-	}
-
-	// Prepare SQL statement
-	sqlite3_stmt* statement;
-	const char* query = "SELECT id, name, category, description, start_catching_hour, end_catching_hour, difficulty, movement, image FROM Fish";
-	rc = sqlite3_prepare_v2(db, query, -1, &statement, nullptr);
-	if (rc != SQLITE_OK) {
-		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
-		sqlite3_finalize(statement);
-		sqlite3_close(db);
-		return allFish;
-	}
-
-	// Execute query
-	while ((rc = sqlite3_step(statement)) == SQLITE_ROW) {
-		int id = sqlite3_column_int(statement, 0);
-		string name = reinterpret_cast<const char*>(sqlite3_column_text(statement, 1));
-		string category = reinterpret_cast<const char*>(sqlite3_column_text(statement, 2));
-		string description = reinterpret_cast<const char*>(sqlite3_column_text(statement, 3));
-		vector<string> seasons = getSeasonsByFishId(db, id);
-		vector<string> weathers = getWeathersByFishId(db, id);
-		vector<string> locations = getLocationsByFishId(db, id);
-		string startCatchingHour = reinterpret_cast<const char*>(sqlite3_column_text(statement, 4));
-		string endCatchingHour = reinterpret_cast<const char*>(sqlite3_column_text(statement, 5));
-		long difficulty = sqlite3_column_int(statement, 6);
-		string movement = reinterpret_cast<const char*>(sqlite3_column_text(statement, 7));
-		long isCaught = getIsCaughtByFishId(db, id, userId);
-		long isFavorite = getIsFavoriteByFishId(db, id, userId);
-		const void* imageBlob = sqlite3_column_blob(statement, 8);
-		int imageSize = sqlite3_column_bytes(statement, 8);
-		vector<char> image(reinterpret_cast<const char*>(imageBlob), reinterpret_cast<const char*>(imageBlob) + imageSize);
-
-		if (find(seasons.begin(), seasons.end(), season) != seasons.end()) {
-			allFish.push_back(Fish(id, category, description, name, seasons, weathers, locations, startCatchingHour, endCatchingHour, difficulty, movement, isCaught, isFavorite, image));
-		}
+	// An empty season is not a filter here, no fish has it
+	if (season.empty()) {
+		return vector<Fish>();
 	}
 
-	// Finalize statement and close connection
-	sqlite3_finalize(statement);
-	sqlite3_close(db);
-
-	return allFish;
+	// The season is looked up by its id through the cached statement of its filter, matched without case like the other filters
+	return findAllBySeasonWeatherLocation(userId, season, "", "");
 }
 
 
@@ -945,70 +1438,27 @@ vector<Fish> FishDBRepository::findAllBySeason(const long userId, const string&
 	Function that returns all the Fish objects by a specific location value from the database.
 	Params:
 		userId - the id of the logged user
-		selocationason - the location value for filtering the fish
+		location - the location value for filtering the fish
 */
 vector<Fish> FishDBRepository::findAllByLocation(const long userId, const string& location) const noexcept {
-	vector<Fish> allFish;
-
-	// Open connection to the database
-	sqlite3* db;
-	int rc = sqlite3_open(databasePath.c_str(), &db);
-	if (rc != SQLITE_OK) {
-		std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
-		sqlite3_close(db);
-		return allFish;
-	}
-
-	// Prepare SQL statement
-	sqlite3_stmt* statement;
-	const char* query = "SELECT id, name, category, description, start_catching_hour, end_catching_hour, difficulty, movement, image FROM Fish";
-	rc = sqlite3_prepare_v2(db, query, -1, &statement, nullptr);
-	if (rc != SQLITE_OK) {
-		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
-		sqlite3_finalize(statement);
-		sqlite3_close(db);
-		return allFish;
+	// An empty location is not a filter here, no fish has it
+	if (location.empty()) {
+		return vector<Fish>();
 	}
 
-	// Execute query
-	while ((rc = sqlite3_step(statement)) == SQLITE_ROW) {
-		int id = sqlite3_column_int(statement, 0);
-		string name = reinterpret_cast<const char*>(sqlite3_column_text(statement, 1));
-		string category = reinterpret_cast<const char*>(sqlite3_column_text(statement, 2));
-		string description = reinterpret_cast<const char*>(sqlite3_column_text(statement, 3));
-		vector<string> seasons = getSeasonsByFishId(db, id);
-		vector<string> weathers = getWeathersByFishId(db, id);
-		vector<string> locations = getLocationsByFishId(db, id);
-		string startCatchingHour = reinterpret_cast<const char*>(sqlite3_column_text(statement, 4));
-		string endCatchingHour = reinterpret_cast<const char*>(sqlite3_column_text(statement, 5));
-		long difficulty = sqlite3_column_int(statement, 6);
-		string movement = reinterpret_cast<const char*>(sqlite3_column_text(statement, 7));
-		long isCaught = getIsCaughtByFishId(db, id, userId);
-		long isFavorite = getIsFavoriteByFishId(db, id, userId);
-		const void* imageBlob = sqlite3_column_blob(statement, 8);
-		int imageSize = sqlite3_column_bytes(statement, 8);
-		std::vector<char> image(reinterpret_cast<const char*>(imageBlob), reinterpret_cast<const char*>(imageBlob) + imageSize);
-
-		if (find(locations.begin(), locations.end(), location) != locations.end()) {
-			allFish.push_back(Fish(id, name, category, description, seasons, weathers, locations, startCatchingHour, endCatchingHour, difficulty, movement, isCaught, isFavorite, image));
-		}
-	}
-
-	// Finalize statement and close connection
-	sqlite3_finalize(statement);
-	sqlite3_close(db);
-
-	return allFish;
+	// The location is looked up by its id through the cached statement of its filter, matched without case like the other filters
+	return findAllBySeasonWeatherLocation(userId, "", "", location);
 }
 
 
 
+/*
+	Function that returns a string with its ASCII letters in lower case, folded the same way as the NOCASE collation.
+	Params:
+		str - the string to convert
+*/
 string FishDBRepository::toLowerCase(const string& str) const {
-	string lowerStr = str;
-	transform(lowerStr.begin(), lowerStr.end(), lowerStr.begin(), [](unsigned char c) {
-		return tolower(c);
-		});
-	return lowerStr;
+	return CaseFolding::toLower(str);
 }
 
 
@@ -1026,10 +1476,10 @@ vector<Fish> FishDBRepository::findAllFiltered(const long userId, const string&
 	int rc;
 
 	// Open connection to the database
-	rc = sqlite3_open(databasePath.c_str(), &db);
+	rc = readers.acquire(&db);
 	if (rc != SQLITE_OK) {
-		qDebug() << "Failed to open database: " << sqlite3_errmsg(db);
-		sqlite3_close(db);
+		qDebug() << "Failed to open database: " << sqlite3_errstr(rc);
+		readers.release(db);
 		return filteredFish;
 	}
 
@@ -1038,61 +1488,40 @@ vector<Fish> FishDBRepository::findAllFiltered(const long userId, const string&
 	rc = sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
 	if (rc != SQLITE_OK) {
 		qDebug() << "Failed to begin transaction: " << sqlite3_errmsg(db);
-		sqlite3_close(db);
+		readers.release(db);
 		return filteredFish;
 	}
 
-	string lowerInput = toLowerCase(input);
+	// LIKE already compares ASCII letters without case, the wildcards of the input are escaped so they match themselves
+	string pattern = "%";
+	for (const char character : input) {
+		if (character == '%' || character == '_' || character == '\\') {
+			pattern += '\\';
+		}
+		pattern += character;
+	}
+	pattern += '%';
 
+	// The seasons, weathers and locations that match are found once, then every fish is checked through the junction indexes
 	const char* query = R"SQL(
-        SELECT f.id, f.name, f.category, f.description, f.start_catching_hour, f.end_catching_hour, f.difficulty, f.movement, f.image
+        SELECT )SQL" FISH_ROW_COLUMNS R"SQL(
         FROM Fish f
-        JOIN Users_Fish uf ON f.id = uf.fish_id
-        LEFT JOIN Fish_Weather fw ON f.id = fw.fish_id
-        LEFT JOIN Weathers w ON fw.weather_id = w.id
-        LEFT JOIN Fish_Season fs ON f.id = fs.fish_id
-        LEFT JOIN Seasons s ON fs.season_id = s.id
-        LEFT JOIN Fish_FishLocation fl ON f.id = fl.fish_id
-        LEFT JOIN FishLocations l ON fl.location_id = l.id
-        WHERE uf.user_id = ?
-        AND (
-            LOWER(f.name) LIKE '%' || ? || '%' OR
-            LOWER(w.name) LIKE '%' || ? || '%' OR
-            LOWER(s.name) LIKE '%' || ? || '%' OR
-            LOWER(l.name) LIKE '%' || ? || '%'
+        WHERE (
+            f.name LIKE ?1 ESCAPE '\' OR
+            EXISTS (SELECT 1 FROM Fish_Weather fw WHERE fw.fish_id = f.id AND fw.weather_id IN (SELECT id FROM Weathers WHERE name LIKE ?1 ESCAPE '\')) OR
+            EXISTS (SELECT 1 FROM Fish_Season fs WHERE fs.fish_id = f.id AND fs.season_id IN (SELECT id FROM Seasons WHERE name LIKE ?1 ESCAPE '\')) OR
+            EXISTS (SELECT 1 FROM Fish_FishLocation fl WHERE fl.fish_id = f.id AND fl.location_id IN (SELECT id FROM FishLocations WHERE name LIKE ?1 ESCAPE '\'))
 		)
-        GROUP BY f.id
+        ORDER BY f.id
     )SQL";
 	
 	rc = sqlite3_prepare_v2(db, query, -1, &statement, nullptr);
 	if (rc == SQLITE_OK) {
-		sqlite3_bind_int(statement, 1, userId);
-		sqlite3_bind_text(statement, 2, lowerInput.c_str(), -1, SQLITE_TRANSIENT);
-		sqlite3_bind_text(statement, 3, lowerInput.c_str(), -1, SQLITE_TRANSIENT);
-		sqlite3_bind_text(statement, 4, lowerInput.c_str(), -1, SQLITE_TRANSIENT);
-		sqlite3_bind_text(statement, 5, lowerInput.c_str(), -1, SQLITE_TRANSIENT);
-
-		while ((rc = sqlite3_step(statement)) == SQLITE_ROW) {
-			int id = sqlite3_column_int(statement, 0);
-			string name = reinterpret_cast<const char*>(sqlite3_column_text(statement, 1));
-			string category = reinterpret_cast<const char*>(sqlite3_column_text(statement, 2));
-			string description = reinterpret_cast<const char*>(sqlite3_column_text(statement, 3));
-			string startCatchingHour = reinterpret_cast<const char*>(sqlite3_column_text(statement, 4));
-			string endCatchingHour = reinterpret_cast<const char*>(sqlite3_column_text(statement, 5));
-			long difficulty = sqlite3_column_int(statement, 6);
-			string movement = reinterpret_cast<const char*>(sqlite3_column_text(statement, 7));
-			const void* imageBlob = sqlite3_column_blob(statement, 8);
-			int imageSize = sqlite3_column_bytes(statement, 8);
-			std::vector<char> image(reinterpret_cast<const char*>(imageBlob), reinterpret_cast<const char*>(imageBlob) + imageSize);
-
-			vector<string> seasons = getSeasonsByFishId(db, id);
-			vector<string> weathers = getWeathersByFishId(db, id);
-			vector<string> locations = getLocationsByFishId(db, id);
-			long isCaught = getIsCaughtByFishId(db, id, userId);
-			long isFavorite = getIsFavoriteByFishId(db, id, userId);
-
-			filteredFish.push_back(Fish(id, name, category, description, seasons, weathers, locations, startCatchingHour, endCatchingHour, difficulty, movement, isCaught, isFavorite, image));
-		}
+		sqlite3_bind_text(statement, 1, pattern.c_str(), -1, SQLITE_TRANSIENT);
+
+		stepFish(db, statement, userId, [&filteredFish](const Fish& fish) {
+			filteredFish.push_back(fish);
+		});
 
 		sqlite3_finalize(statement);
 	}
@@ -1104,128 +1533,183 @@ vector<Fish> FishDBRepository::findAllFiltered(const long userId, const string&
 	rc = sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
 	if (rc != SQLITE_OK) {
 		qDebug() << "Failed to commit transaction: " << sqlite3_errmsg(db);
-		sqlite3_close(db);
+		readers.release(db);
 		return filteredFish;
 	}
 
-	sqlite3_close(db);
+	readers.release(db);
 	return filteredFish;
 }
 
 
 
 /*
-	Function that returns all the Fish objects from the database that have a specific season, weather and location.
-	If the input for season, weather or location has "All (No Filter) value", it is not taken into consideration for filtering.
+	Function that returns all the Fish objects that have the given season, weather and location.
+	Only the set filters are joined, each one by the id of its attribute, with the statement of the combination prepared once and reused.
 	Params:
 		userId - the id of the logged user
-		season - the season value for filtering the fish
-		weather - the weather value for filtering the fish
-		location - the location value for filtering the fish
+		season - the season of the fish, or an empty string for any season
+		weather - the weather of the fish, or an empty string for any weather
+		location - the location of the fish, or an empty string for any location
 */
 vector<Fish> FishDBRepository::findAllBySeasonWeatherLocation(const long userId, const string& season, const string& weather, const string& location) const noexcept {
 	vector<Fish> filteredFish;
-	sqlite3* db;
-	sqlite3_stmt* statement;
-	int rc;
+	const string* names[] = { &season, &weather, &location };
+
+	int shape = 0;
+	for (int i = 0; i < 3; i++) {
+		if (!names[i]->empty()) {
+			shape |= FILTER_DIMENSIONS[i].bit;
+		}
+	}
 
 	// Open connection to the database
-	rc = sqlite3_open(databasePath.c_str(), &db);
+	sqlite3* db;
+	int rc = readers.acquire(&db);
 	if (rc != SQLITE_OK) {
-		qDebug() << "Failed to open database: " << sqlite3_errmsg(db);
-		sqlite3_close(db);
+		std::cerr << "Error opening database: " << sqlite3_errstr(rc) << std::endl;
+		readers.release(db);
 		return filteredFish;
 	}
 
-	// Begin transaction
-	rc = sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
-	if (rc != SQLITE_OK) {
-		qDebug() << "Failed to begin transaction: " << sqlite3_errmsg(db);
-		sqlite3_close(db);
+	sqlite3_stmt* statement = seasonWeatherLocationStatement(db, shape);
+	if (statement == nullptr) {
+		readers.release(db);
 		return filteredFish;
 	}
 
-	// Prepare SQL query
-	string query = R"(
-        SELECT f.id, f.name, f.category, f.description, f.start_catching_hour, f.end_catching_hour, f.difficulty, f.movement, f.image
-        FROM Fish f
-        JOIN Users_Fish uf ON f.id = uf.fish_id
-        LEFT JOIN Fish_Weather fw ON f.id = fw.fish_id
-        LEFT JOIN Weathers w ON fw.weather_id = w.id
-        LEFT JOIN Fish_Season fs ON f.id = fs.fish_id
-        LEFT JOIN Seasons s ON fs.season_id = s.id
-        LEFT JOIN Fish_FishLocation fl ON f.id = fl.fish_id
-        LEFT JOIN FishLocations l ON fl.location_id = l.id
-        WHERE uf.user_id = ?
-        AND LOWER(s.name) LIKE '%' || LOWER(?)
-        AND LOWER(w.name) LIKE '%' || LOWER(?)
-        AND LOWER(l.name) LIKE '%' || LOWER(?)
-        GROUP BY f.id
-    )";
+	// Bind parameters, only the names of the set filters are part of the statement
+	for (int i = 0; i < 3; i++) {
+		if (shape & FILTER_DIMENSIONS[i].bit) {
+			sqlite3_bind_text(statement, i + 1, names[i]->c_str(), -1, SQLITE_STATIC);
+		}
+	}
 
-	// Prepare the SQL statement
+	// The fish and their attributes are read in one transaction, so they come from the same state of the database
+	sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
+	stepFish(db, statement, userId, [&filteredFish](const Fish& fish) {
+		filteredFish.push_back(fish);
+	});
+	sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+
+	// The statement stays prepared on its connection for the next call, only its rows and bindings are dropped
+	sqlite3_reset(statement);
+	sqlite3_clear_bindings(statement);
+
+	readers.release(db);
+	return filteredFish;
+}
+
+
+
+/*
+	Function that returns the query plan of a combination of the season, weather and location filters, one detail line for every step.
+	Params:
+		shape - the filters that are set: 1 for the season, 2 for the weather, 4 for the location
+*/
+vector<string> FishDBRepository::explainSeasonWeatherLocationQuery(const int shape) const {
+	vector<string> plan;
+	if (shape < 0 || shape > 7) {
+		return plan;
+	}
+
+	// Open connection to the database
+	sqlite3* db;
+	int rc = readers.acquire(&db);
+	if (rc != SQLITE_OK) {
+		std::cerr << "Error opening database: " << sqlite3_errstr(rc) << std::endl;
+		return plan;
+	}
+
+	// Prepare SQL statement
+	sqlite3_stmt* statement;
+	const string query = "EXPLAIN QUERY PLAN " + buildSeasonWeatherLocationQuery(shape);
 	rc = sqlite3_prepare_v2(db, query.c_str(), -1, &statement, nullptr);
 	if (rc != SQLITE_OK) {
 		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
-		return filteredFish;
+		readers.release(db);
+		return plan;
 	}
 
-	// Bind parameters
-	sqlite3_bind_int(statement, 1, userId);
-	sqlite3_bind_text(statement, 2, season.c_str(), -1, SQLITE_STATIC);
-	sqlite3_bind_text(statement, 3, weather.c_str(), -1, SQLITE_STATIC);
-	sqlite3_bind_text(statement, 4, location.c_str(), -1, SQLITE_STATIC);
-
-	// Execute query and retrieve results
-	while ((rc = sqlite3_step(statement)) == SQLITE_ROW) {
-		int id = sqlite3_column_int(statement, 0);
-		string name = reinterpret_cast<const char*>(sqlite3_column_text(statement, 1));
-		string category = reinterpret_cast<const char*>(sqlite3_column_text(statement, 2));
-		string description = reinterpret_cast<const char*>(sqlite3_column_text(statement, 3));
-		string startCatchingHour = reinterpret_cast<const char*>(sqlite3_column_text(statement, 4));
-		string endCatchingHour = reinterpret_cast<const char*>(sqlite3_column_text(statement, 5));
-		long difficulty = sqlite3_column_int(statement, 6);
-		string movement = reinterpret_cast<const char*>(sqlite3_column_text(statement, 7));
-		const void* imageBlob = sqlite3_column_blob(statement, 8);
-		int imageSize = sqlite3_column_bytes(statement, 8);
-		std::vector<char> image(reinterpret_cast<const char*>(imageBlob), reinterpret_cast<const char*>(imageBlob) + imageSize);
-
-		vector<string> seasons = getSeasonsByFishId(db, id);
-		vector<string> weathers = getWeathersByFishId(db, id);
-		vector<string> locations = getLocationsByFishId(db, id);
-		long isCaught = getIsCaughtByFishId(db, id, userId);
-		long isFavorite = getIsFavoriteByFishId(db, id, userId);
-
-		filteredFish.push_back(Fish(id, name, category, description, seasons, weathers, locations, startCatchingHour, endCatchingHour, difficulty, movement, isCaught, isFavorite, image));
+	// The detail of a step is in the fourth column
+	while (sqlite3_step(statement) == SQLITE_ROW) {
+		const unsigned char* detail = sqlite3_column_text(statement, 3);
+		plan.push_back(detail != nullptr ? reinterpret_cast<const char*>(detail) : "");
 	}
 
 	// Finalize statement and close connection
 	sqlite3_finalize(statement);
-	sqlite3_close(db);
-
-	return filteredFish;
+	readers.release(db);
+	return plan;
 }
 
 
 
 /*
-	Function that returns all the Fish objects from the database that have been caught by a specific user with the given username.
+	Function that returns all the Fish objects that can be caught at a time of the day.
+	The catch windows of every fish are checked by the catchable_at function, inside the query.
 	Params:
 		userId - the id of the logged user
+		minute - the minute of the day, from 0 (12am) to 1439 (11:59pm)
 */
-vector<Fish> FishDBRepository::findAllUncaught(const long userId) const noexcept {
-	vector<Fish> uncaughtFish;
-	sqlite3* db;
-	sqlite3_stmt* statement;
-	int rc;
+vector<Fish> FishDBRepository::findAllCatchableAt(const long userId, const int minute) const noexcept {
+	vector<Fish> allFish;
 
 	// Open connection to the database
-	rc = sqlite3_open(databasePath.c_str(), &db);
+	sqlite3* db;
+	int rc = readers.acquire(&db);
 	if (rc != SQLITE_OK) {
-		qDebug() << "Failed to open database: " << sqlite3_errmsg(db);
-		sqlite3_close(db);
+		cerr << "Error opening database: " << sqlite3_errstr(rc) << std::endl;
+		readers.release(db);
+		return allFish;
+	}
+
+	// Prepare SQL statement
+	sqlite3_stmt* statement;
+	const char* query = "SELECT " FISH_ROW_COLUMNS " FROM Fish f WHERE catchable_at(f.catch_windows, ?)";
+	rc = sqlite3_prepare_v2(db, query, -1, &statement, nullptr);
+	if (rc != SQLITE_OK) {
+		cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
+		sqlite3_finalize(statement);
+		readers.release(db);
+		return allFish;
+	}
+
+	// Bind parameters
+	sqlite3_bind_int(statement, 1, minute);
+
+	// Execute query
+	stepFish(db, statement, userId, [&allFish](const Fish& fish) {
+		allFish.push_back(fish);
+	});
+
+	// Finalize statement and close connection
+	sqlite3_finalize(statement);
+	readers.release(db);
+
+	return allFish;
+}
+
+
+
+/*
+	Function that returns all the Fish objects from the database that have not been caught by a specific user with the given username.
+	A fish with no Users_Fish row for the user was not caught.
+	Params:
+		userId - the id of the logged user
+*/
+vector<Fish> FishDBRepository::findAllUncaught(const long userId) const noexcept {
+	vector<Fish> uncaughtFish;
+	sqlite3* db;
+	sqlite3_stmt* statement;
+	int rc;
+
+	// Open connection to the database
+	rc = readers.acquire(&db);
+	if (rc != SQLITE_OK) {
+		qDebug() << "Failed to open database: " << sqlite3_errstr(rc);
+		readers.release(db);
 		return uncaughtFish;
 	}
 
@@ -1233,23 +1717,17 @@ vector<Fish> FishDBRepository::findAllUncaught(const long userId) const noexcept
 	rc = sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
 	if (rc != SQLITE_OK) {
 		qDebug() << "Failed to begin transaction: " << sqlite3_errmsg(db);
-		sqlite3_close(db);
+		readers.release(db);
 		return uncaughtFish;
 	}
 
 	// Prepare SQL query
 	string query = R"(
-        SELECT f.id, f.name, f.category, f.description, f.start_catching_hour, f.end_catching_hour, f.difficulty, f.movement, f.image 
+        SELECT )" FISH_ROW_COLUMNS R"(
 		FROM Fish f
-		JOIN Users_Fish uf ON f.id = uf.fish_id
-		JOIN Fish_Weather fw ON f.id = fw.fish_id
-		JOIN Weathers w ON fw.weather_id = w.id
-		JOIN Fish_Season fs ON f.id = fs.fish_id
-		JOIN Seasons s ON fs.season_id = s.id
-		JOIN Fish_FishLocation fl ON f.id = fl.fish_id
-		JOIN FishLocations l ON fl.location_id = l.id
-		WHERE uf.user_id = ? AND uf.is_caught = 0
-		GROUP BY f.id
+		LEFT JOIN Users_Fish uf ON uf.user_id = ? AND uf.fish_id = f.id
+		WHERE COALESCE(uf.is_caught, 0) = 0
+		ORDER BY f.id
     )";
 
 	// Prepare the SQL statement
@@ -1257,7 +1735,7 @@ vector<Fish> FishDBRepository::findAllUncaught(const long userId) const noexcept
 	if (rc != SQLITE_OK) {
 		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		readers.release(db);
 		return uncaughtFish;
 	}
 
@@ -1265,31 +1743,13 @@ vector<Fish> FishDBRepository::findAllUncaught(const long userId) const noexcept
 	sqlite3_bind_int(statement, 1, userId);
 
 	// Execute query and retrieve results
-	while ((rc = sqlite3_step(statement)) == SQLITE_ROW) {
-		int id = sqlite3_column_int(statement, 0);
-		string name = reinterpret_cast<const char*>(sqlite3_column_text(statement, 1));
-		string category = reinterpret_cast<const char*>(sqlite3_column_text(statement, 2));
-		string description = reinterpret_cast<const char*>(sqlite3_column_text(statement, 3));
-		string startCatchingHour = reinterpret_cast<const char*>(sqlite3_column_text(statement, 4));
-		string endCatchingHour = reinterpret_cast<const char*>(sqlite3_column_text(statement, 5));
-		long difficulty = sqlite3_column_int(statement, 6);
-		string movement = reinterpret_cast<const char*>(sqlite3_column_text(statement, 7));
-		const void* imageBlob = sqlite3_column_blob(statement, 8);
-		int imageSize = sqlite3_column_bytes(statement, 8);
-		std::vector<char> image(reinterpret_cast<const char*>(imageBlob), reinterpret_cast<const char*>(imageBlob) + imageSize);
-
-		vector<string> seasons = getSeasonsByFishId(db, id);
-		vector<string> weathers = getWeathersByFishId(db, id);
-		vector<string> locations = getLocationsByFishId(db, id);
-		long isCaught = getIsCaughtByFishId(db, id, userId);
-		long isFavorite = getIsFavoriteByFishId(db, id, userId);
-
-		uncaughtFish.push_back(Fish(id, name, category, description, seasons, weathers, locations, startCatchingHour, endCatchingHour, difficulty, movement, isCaught, isFavorite, image));
-	}
+	stepFish(db, statement, userId, [&uncaughtFish](const Fish& fish) {
+		uncaughtFish.push_back(fish);
+	});
 
 	// Finalize statement and close connection
 	sqlite3_finalize(statement);
-	sqlite3_close(db);
+	readers.release(db);
 
 	return uncaughtFish;
 }
@@ -1308,10 +1768,10 @@ vector<Fish> FishDBRepository::findAllFavorite(const long userId) const noexcept
 	int rc;
 
 	// Open connection to the database
-	rc = sqlite3_open(databasePath.c_str(), &db);
+	rc = readers.acquire(&db);
 	if (rc != SQLITE_OK) {
-		qDebug() << "Failed to open database: " << sqlite3_errmsg(db);
-		sqlite3_close(db);
+		qDebug() << "Failed to open database: " << sqlite3_errstr(rc);
+		readers.release(db);
 		return favoriteFish;
 	}
 
@@ -1319,23 +1779,17 @@ vector<Fish> FishDBRepository::findAllFavorite(const long userId) const noexcept
 	rc = sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
 	if (rc != SQLITE_OK) {
 		qDebug() << "Failed to begin transaction: " << sqlite3_errmsg(db);
-		sqlite3_close(db);
+		readers.release(db);
 		return favoriteFish;
 	}
 
 	// Prepare SQL query
 	string query = R"(
-        SELECT f.id, f.name, f.category, f.description, f.start_catching_hour, f.end_catching_hour, f.difficulty, f.movement, f.image 
-		FROM Fish f
-		JOIN Users_Fish uf ON f.id = uf.fish_id
-		JOIN Fish_Weather fw ON f.id = fw.fish_id
-		JOIN Weathers w ON fw.weather_id = w.id
-		JOIN Fish_Season fs ON f.id = fs.fish_id
-		JOIN Seasons s ON fs.season_id = s.id
-		JOIN Fish_FishLocation fl ON f.id = fl.fish_id
-		JOIN FishLocations l ON fl.location_id = l.id
+        SELECT )" FISH_ROW_COLUMNS R"(
+		FROM Users_Fish uf
+		CROSS JOIN Fish f ON f.id = uf.fish_id
 		WHERE uf.user_id = ? AND uf.is_favorite = 1
-		GROUP BY f.id
+		ORDER BY uf.fish_id
     )";
 
 	// Prepare the SQL statement
@@ -1343,7 +1797,7 @@ vector<Fish> FishDBRepository::findAllFavorite(const long userId) const noexcept
 	if (rc != SQLITE_OK) {
 		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		readers.release(db);
 		return favoriteFish;
 	}
 
@@ -1351,31 +1805,13 @@ vector<Fish> FishDBRepository::findAllFavorite(const long userId) const noexcept
 	sqlite3_bind_int(statement, 1, userId);
 
 	// Execute query and retrieve results
-	while ((rc = sqlite3_step(statement)) == SQLITE_ROW) {
-		int id = sqlite3_column_int(statement, 0);
-		string name = reinterpret_cast<const char*>(sqlite3_column_text(statement, 1));
-		string category = reinterpret_cast<const char*>(sqlite3_column_text(statement, 2));
-		string description = reinterpret_cast<const char*>(sqlite3_column_text(statement, 3));
-		string startCatchingHour = reinterpret_cast<const char*>(sqlite3_column_text(statement, 4));
-		string endCatchingHour = reinterpret_cast<const char*>(sqlite3_column_text(statement, 5));
-		long difficulty = sqlite3_column_int(statement, 6);
-		string movement = reinterpret_cast<const char*>(sqlite3_column_text(statement, 7));
-		const void* imageBlob = sqlite3_column_blob(statement, 8);
-		int imageSize = sqlite3_column_bytes(statement, 8);
-		std::vector<char> image(reinterpret_cast<const char*>(imageBlob), reinterpret_cast<const char*>(imageBlob) + imageSize);
-
-		vector<string> seasons = getSeasonsByFishId(db, id);
-		vector<string> weathers = getWeathersByFishId(db, id);
-		vector<string> locations = getLocationsByFishId(db, id);
-		long isCaught = getIsCaughtByFishId(db, id, userId);
-		long isFavorite = getIsFavoriteByFishId(db, id, userId);
-
-		favoriteFish.push_back(Fish(id, name, category, description, seasons, weathers, locations, startCatchingHour, endCatchingHour, difficulty, movement, isCaught, isFavorite, image));
-	}
+	stepFish(db, statement, userId, [&favoriteFish](const Fish& fish) {
+		favoriteFish.push_back(fish);
+	});
 
 	// Finalize statement and close connection
 	sqlite3_finalize(statement);
-	sqlite3_close(db);
+	readers.release(db);
 
 	return favoriteFish;
 }
@@ -1394,10 +1830,10 @@ const long FishDBRepository::getCaughtFishNumber(const long userId) const noexce
 	int rc;
 
 	// Open connection to the database
-	rc = sqlite3_open(databasePath.c_str(), &db);
+	rc = readers.acquire(&db);
 	if (rc != SQLITE_OK) {
-		qDebug() << "Failed to open database: " << sqlite3_errmsg(db);
-		sqlite3_close(db);
+		qDebug() << "Failed to open database: " << sqlite3_errstr(rc);
+		readers.release(db);
 		return 0;
 	}
 
@@ -1405,7 +1841,7 @@ const long FishDBRepository::getCaughtFishNumber(const long userId) const noexce
 	rc = sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
 	if (rc != SQLITE_OK) {
 		qDebug() << "Failed to begin transaction: " << sqlite3_errmsg(db);
-		sqlite3_close(db);
+		readers.release(db);
 		return 0;
 	}
 
@@ -1420,7 +1856,7 @@ const long FishDBRepository::getCaughtFishNumber(const long userId) const noexce
 	if (rc != SQLITE_OK) {
 		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		readers.release(db);
 		return 0;
 	}
 
@@ -1435,7 +1871,7 @@ const long FishDBRepository::getCaughtFishNumber(const long userId) const noexce
 
 	// Finalize statement and close connection
 	sqlite3_finalize(statement);
-	sqlite3_close(db);
+	readers.release(db);
 
 	return caughtFishNumber;
 }
@@ -1454,10 +1890,10 @@ const long FishDBRepository::getFavoriteFishNumber(const long userId) const noex
 	int rc;
 
 	// Open connection to the database
-	rc = sqlite3_open(databasePath.c_str(), &db);
+	rc = readers.acquire(&db);
 	if (rc != SQLITE_OK) {
-		qDebug() << "Failed to open database: " << sqlite3_errmsg(db);
-		sqlite3_close(db);
+		qDebug() << "Failed to open database: " << sqlite3_errstr(rc);
+		readers.release(db);
 		return 0;
 	}
 
@@ -1465,7 +1901,7 @@ const long FishDBRepository::getFavoriteFishNumber(const long userId) const noex
 	rc = sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
 	if (rc != SQLITE_OK) {
 		qDebug() << "Failed to begin transaction: " << sqlite3_errmsg(db);
-		sqlite3_close(db);
+		readers.release(db);
 		return 0;
 	}
 
@@ -1480,7 +1916,7 @@ const long FishDBRepository::getFavoriteFishNumber(const long userId) const noex
 	if (rc != SQLITE_OK) {
 		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		readers.release(db);
 		return 0;
 	}
 
@@ -1495,7 +1931,7 @@ const long FishDBRepository::getFavoriteFishNumber(const long userId) const noex
 
 	// Finalize statement and close connection
 	sqlite3_finalize(statement);
-	sqlite3_close(db);
+	readers.release(db);
 
 	return favoriteFishNumber;
 }
@@ -1512,10 +1948,10 @@ const long FishDBRepository::findAllFishNumber() const noexcept {
 	int rc;
 
 	// Open connection to the database
-	rc = sqlite3_open(databasePath.c_str(), &db);
+	rc = readers.acquire(&db);
 	if (rc != SQLITE_OK) {
-		qDebug() << "Failed to open database: " << sqlite3_errmsg(db);
-		sqlite3_close(db);
+		qDebug() << "Failed to open database: " << sqlite3_errstr(rc);
+		readers.release(db);
 		return 0;
 	}
 
@@ -1523,7 +1959,7 @@ const long FishDBRepository::findAllFishNumber() const noexcept {
 	rc = sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
 	if (rc != SQLITE_OK) {
 		qDebug() << "Failed to begin transaction: " << sqlite3_errmsg(db);
-		sqlite3_close(db);
+		readers.release(db);
 		return 0;
 	}
 
@@ -1537,7 +1973,7 @@ const long FishDBRepository::findAllFishNumber() const noexcept {
 	if (rc != SQLITE_OK) {
 		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
 		sqlite3_finalize(statement);
-		sqlite3_close(db);
+		readers.release(db);
 		return 0;
 	}
 
@@ -1548,7 +1984,7 @@ const long FishDBRepository::findAllFishNumber() const noexcept {
 
 	// Finalize statement and close connection
 	sqlite3_finalize(statement);
-	sqlite3_close(db);
+	readers.release(db);
 
 	return fishNo;
 }
@@ -1559,154 +1995,179 @@ const long FishDBRepository::findAllFishNumber() const noexcept {
 
 
 /*
-	Helper function that returns the seasons for a Fish object with the given id.
+	Helper function that maps the current row of a statement selecting the FISH_ROW_COLUMNS into a Fish object.
+	The columns are read at the positions declared by FishRow, and the text is assigned straight into the Fish.
 	Params:
 		db - the database connection
-		fishId - the id of the fish
-	return - vector<string> - the seasons for the fish
+		statement - the statement positioned on a row
+		userId - the id of the logged user
+		fish - the Fish object to be filled
 */
-vector<string> FishDBRepository::getSeasonsByFishId(sqlite3* db, long fishId) const {
-	vector<string> seasons;
-	sqlite3_stmt* statement;
-	const char* query = "SELECT s.name FROM Seasons s JOIN Fish_Season fs ON s.id = fs.season_id WHERE fs.fish_id = ?";
-	int rc = sqlite3_prepare_v2(db, query, -1, &statement, nullptr);
-	if (rc == SQLITE_OK) {
-		sqlite3_bind_int(statement, 1, fishId);
-
-		while ((rc = sqlite3_step(statement)) == SQLITE_ROW) {
-			const char* season = reinterpret_cast<const char*>(sqlite3_column_text(statement, 0));
-			if (season)
-				seasons.push_back(season);
-		}
-
-		sqlite3_finalize(statement);
+void FishDBRepository::readFish(sqlite3* db, sqlite3_stmt* statement, const long userId, Fish& fish) const {
+	const long id = FishRow::Id::read(statement);
+	fish.setId(id);
+	fish.setName(FishRow::Name::read(statement));
+	fish.setCategory(FishRow::Category::read(statement));
+	fish.setDescription(FishRow::Description::read(statement));
+	// The catch windows were parsed from the catching hours when they were saved, so they are only decoded
+	fish.setCatchingHours(FishRow::StartCatchingHour::read(statement), FishRow::EndCatchingHour::read(statement), CatchTimes::decode(FishRow::CatchWindows::read(statement)));
+	fish.setDifficulty(FishRow::Difficulty::read(statement));
+	fish.setMovement(FishRow::Movement::read(statement));
+
+	// The image is assigned even when the row has none, so a Fish reused by stepFish does not keep the image of the previous row.
+	// A view into the image store is kept as it is; an inline BLOB is copied, since its view ends with the row
+	const ImageView image = viewImage(statement, FishRow::Image::index, FishRow::ImageHash::index);
+	if (image.owner != nullptr) {
+		fish.setImage(image);
 	}
 	else {
-		cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
+		fish.setImage(vector<char>(image.begin(), image.end()));
 	}
-	return seasons;
+
+	// Images still stored inline were hashed when the database was opened, so the hash is only read
+	fish.setImageHash(FishRow::ImageHash::read(statement));
+
+	fish.setSeason(getSeasonsByFishId(db, id));
+	fish.setWeather(getWeathersByFishId(db, id));
+	fish.setLocation(getLocationsByFishId(db, id));
+	const auto [isCaught, isFavorite] = getFlagsByFishId(db, id, userId);
+	fish.setIsCaught(isCaught);
+	fish.setIsFavorite(isFavorite);
 }
 
 
 
 /*
-	Helper function that returns the weathers for a Fish object with the given id.
+	Helper function that steps a statement selecting the FISH_ROW_COLUMNS and passes the Fish of every row to a visitor.
+	The same Fish object is filled for every row: while the visitor does not keep a copy of it, its strings are reused instead of allocated again.
+	An image from the image store is only viewed, and the seasons, weathers, locations and flags of every row are read by statements cached on the connection.
 	Params:
 		db - the database connection
-		fishId - the id of the fish
-	return - vector<string> - the weathers for the fish
+		statement - the prepared statement, with its parameters bound
+		userId - the id of the logged user
+		visitor - the function called with every fish
+		limit - the maximum number of rows to step, or -1 for all of them
 */
-vector<string> FishDBRepository::getWeathersByFishId(sqlite3* db, long fishId) const {
-	vector<string> weathers;
-	sqlite3_stmt* statement;
-	const char* query = "SELECT w.name FROM Weathers w JOIN Fish_Weather fw ON w.id = fw.weather_id WHERE fw.fish_id = ?";
-	int rc = sqlite3_prepare_v2(db, query, -1, &statement, nullptr);
-	if (rc == SQLITE_OK) {
-		sqlite3_bind_int(statement, 1, fishId);
-
-		while ((rc = sqlite3_step(statement)) == SQLITE_ROW) {
-			const char* weather = reinterpret_cast<const char*>(sqlite3_column_text(statement, 0));
-			if (weather) {
-				weathers.push_back(weather);
-			}
+int FishDBRepository::stepFish(sqlite3* db, sqlite3_stmt* statement, const long userId, const function<void(const Fish&)>& visitor, const int limit) const {
+	Fish fish;
+	int rows = 0;
+	int rc = SQLITE_DONE;
+	while ((limit < 0 || rows < limit) && (rc = sqlite3_step(statement)) == SQLITE_ROW) {
+		readFish(db, statement, userId, fish);
+		visitor(fish);
+		rows++;
+
+		// A fish kept by the visitor is left to it, the next row is read into a new one instead of a copy of it
+		if (!fish.isDetached()) {
+			fish = Fish();
 		}
-
-		sqlite3_finalize(statement);
 	}
-	else {
-		cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
+
+	if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+		std::cerr << "Error stepping SQL statement: " << sqlite3_errmsg(db) << std::endl;
 	}
-	return weathers;
+	return rows;
 }
 
 
 
 /*
-	Helper function that returns the locations for a Fish object with the given id.
+	Helper function that reads the attributes of one fish with one of the cached attribute statements.
+	The attributes are interned by their id in the database; a name that was not in its table when the database was opened is interned by its name.
 	Params:
-		db - the database connection
+		statement - the cached statement, selecting the id and the name of every attribute of the fish at ?1
 		fishId - the id of the fish
-	return - vector<string> - the locations for the fish
+		internedIds - the interned id of every attribute, by its id in the database
+	return - the set of the attributes of the fish
 */
-vector<string> FishDBRepository::getLocationsByFishId(sqlite3* db, long fishId) const {
-	vector<string> locations;
-	sqlite3_stmt* statement;
-	const char* query = "SELECT l.name FROM FishLocations l JOIN Fish_FishLocation fl ON l.id = fl.location_id WHERE fl.fish_id = ?";
-	int rc = sqlite3_prepare_v2(db, query, -1, &statement, nullptr);
-	if (rc == SQLITE_OK) {
-		sqlite3_bind_int(statement, 1, fishId);
-
-		while ((rc = sqlite3_step(statement)) == SQLITE_ROW) {
-			const char* location = reinterpret_cast<const char*>(sqlite3_column_text(statement, 0));
-			if (location) {
-				locations.push_back(location);
-			}
+template <AttributeKind Kind>
+static AttributeSet<Kind> readAttributeSet(sqlite3_stmt* statement, const long fishId, const vector<uint16_t>& internedIds) {
+	AttributeSet<Kind> attributes;
+	if (statement == nullptr) {
+		return attributes;
+	}
+
+	sqlite3_bind_int64(statement, 1, fishId);
+	while (sqlite3_step(statement) == SQLITE_ROW) {
+		const sqlite3_int64 id = sqlite3_column_int64(statement, 0);
+		if (id >= 0 && id < static_cast<sqlite3_int64>(internedIds.size()) && internedIds[id] != NO_INTERNED_ID) {
+			attributes.insertId(internedIds[id]);
+			continue;
 		}
 
-		sqlite3_finalize(statement);
-	}
-	else {
-		cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
+		const unsigned char* name = sqlite3_column_text(statement, 1);
+		if (name != nullptr) {
+			attributes.insert(reinterpret_cast<const char*>(name));
+		}
 	}
-	return locations;
+	sqlite3_reset(statement);
+	return attributes;
 }
 
 
 
 /*
-	Helper function that returns whether a Fish object with the given id is caught by the user with the given username.
+	Helper function that returns the seasons for a Fish object with the given id.
 	Params:
 		db - the database connection
 		fishId - the id of the fish
-		userId - the id of the user
+	return - SeasonSet - the seasons for the fish
 */
-bool FishDBRepository::getIsCaughtByFishId(sqlite3* db, long fishId, const long userId) const {
-	bool isCaught = false;
-	sqlite3_stmt* statement;
+SeasonSet FishDBRepository::getSeasonsByFishId(sqlite3* db, long fishId) const {
+	return readAttributeSet<AttributeKind::Season>(fishDetailStatement(db, SEASONS_OF_FISH), fishId, internedAttributeIds[SEASONS_OF_FISH]);
+}
 
-	const char* caughtQuery = "SELECT is_caught FROM Users_Fish WHERE fish_id = ? AND user_id = ?";
-	int rc = sqlite3_prepare_v2(db, caughtQuery, -1, &statement, nullptr);
-	if (rc == SQLITE_OK) {
-		sqlite3_bind_int(statement, 1, fishId);
-		sqlite3_bind_int(statement, 2, userId);
-		rc = sqlite3_step(statement);
 
-		if (rc == SQLITE_ROW) {
-			isCaught = sqlite3_column_int(statement, 0);
-		}
-	}
 
-	sqlite3_finalize(statement);
-	return isCaught;
+/*
+	Helper function that returns the weathers for a Fish object with the given id.
+	Params:
+		db - the database connection
+		fishId - the id of the fish
+	return - WeatherSet - the weathers for the fish
+*/
+WeatherSet FishDBRepository::getWeathersByFishId(sqlite3* db, long fishId) const {
+	return readAttributeSet<AttributeKind::Weather>(fishDetailStatement(db, WEATHERS_OF_FISH), fishId, internedAttributeIds[WEATHERS_OF_FISH]);
 }
 
 
 
 /*
-	Helper function that returns whether a Fish object with the given id is caught by the user with the given username.
+	Helper function that returns the locations for a Fish object with the given id.
 	Params:
 		db - the database connection
 		fishId - the id of the fish
-		userId - the id of the user
+	return - LocationSet - the locations for the fish
 */
-bool FishDBRepository::getIsFavoriteByFishId(sqlite3* db, long fishId, const long userId) const {
-	bool isCaught = false;
-	sqlite3_stmt* statement;
+LocationSet FishDBRepository::getLocationsByFishId(sqlite3* db, long fishId) const {
+	return readAttributeSet<AttributeKind::Location>(fishDetailStatement(db, LOCATIONS_OF_FISH), fishId, internedAttributeIds[LOCATIONS_OF_FISH]);
+}
 
-	const char* caughtQuery = "SELECT is_favorite FROM Users_Fish WHERE fish_id = ? AND user_id = ?";
-	int rc = sqlite3_prepare_v2(db, caughtQuery, -1, &statement, nullptr);
-	if (rc == SQLITE_OK) {
-		sqlite3_bind_int(statement, 1, fishId);
-		sqlite3_bind_int(statement, 2, userId);
-		rc = sqlite3_step(statement);
 
-		if (rc == SQLITE_ROW) {
-			isCaught = sqlite3_column_int(statement, 0);
-		}
+
+/*
+	Helper function that returns whether a Fish object with the given id is caught and whether it is a favorite of the user with the given id.
+	Both flags are false if the user has no progress on the fish.
+	Params:
+		db - the database connection
+		fishId - the id of the fish
+		userId - the id of the user
+	return - pair<bool, bool> - whether the fish is caught, and whether it is a favorite
+*/
+pair<bool, bool> FishDBRepository::getFlagsByFishId(sqlite3* db, long fishId, const long userId) const {
+	pair<bool, bool> flags = { false, false };
+	sqlite3_stmt* statement = fishDetailStatement(db, FLAGS_OF_FISH);
+	if (statement == nullptr) {
+		return flags;
 	}
 
-	sqlite3_finalize(statement);
-	return isCaught;
+	sqlite3_bind_int64(statement, 1, fishId);
+	sqlite3_bind_int64(statement, 2, userId);
+	if (sqlite3_step(statement) == SQLITE_ROW) {
+		flags = { sqlite3_column_int(statement, 0) != 0, sqlite3_column_int(statement, 1) != 0 };
+	}
+	sqlite3_reset(statement);
+	return flags;
 }
 
 
@@ -1736,4 +2197,843 @@ void FishDBRepository::updateRelatedTable(sqlite3* db, const std::string& fishNa
 			sqlite3_finalize(statement);
 		}
 	}
+}
+
+
+
+/*
+	Function that checks if a table of the database has a column with the given name.
+	Params:
+		db - the database connection
+		tableName - the name of the table
+		columnName - the name of the column
+*/
+bool FishDBRepository::hasColumn(sqlite3* db, const string& tableName, const string& columnName) const {
+	sqlite3_stmt* statement;
+	string query = "PRAGMA table_info(" + tableName + ")";
+	int rc = sqlite3_prepare_v2(db, query.c_str(), -1, &statement, nullptr);
+	if (rc != SQLITE_OK) {
+		return false;
+	}
+
+	bool found = false;
+	while (!found && sqlite3_step(statement) == SQLITE_ROW) {
+		const unsigned char* name = sqlite3_column_text(statement, 1);
+		found = name != nullptr && columnName == reinterpret_cast<const char*>(name);
+	}
+
+	sqlite3_finalize(statement);
+	return found;
+}
+
+
+
+/*
+	Function that adds the image_hash column to the tables that hold images, if they do not have it yet.
+	Tables that do not exist are skipped.
+	Params:
+		db - the database connection
+*/
+void FishDBRepository::ensureImageHashColumns(sqlite3* db) const {
+	for (const string& tableName : IMAGE_TABLES) {
+		if (!hasColumn(db, tableName, "image") || hasColumn(db, tableName, "image_hash")) {
+			continue;
+		}
+
+		string query = "ALTER TABLE " + tableName + " ADD COLUMN image_hash TEXT";
+		if (sqlite3_exec(db, query.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK) {
+			std::cerr << "Failed to add image_hash column to " << tableName << ": " << sqlite3_errmsg(db) << std::endl;
+		}
+	}
+}
+
+
+
+/*
+	Function that writes the hash of every inline image without one into its image_hash column.
+	The images are left inline: readers look them up in the image store by their hash and fall back to the BLOB, so each image is hashed once, here.
+	Tables without the image_hash column are skipped.
+	Params:
+		db - the database connection
+*/
+void FishDBRepository::hashInlineImages(sqlite3* db) const {
+	for (const string& tableName : IMAGE_TABLES) {
+		if (!hasColumn(db, tableName, "image_hash")) {
+			continue;
+		}
+
+		sqlite3_stmt* selectStatement;
+		string selectQuery = "SELECT rowid, image FROM " + tableName + " WHERE length(image) > 0 AND (image_hash IS NULL OR image_hash = '')";
+		if (sqlite3_prepare_v2(db, selectQuery.c_str(), -1, &selectStatement, nullptr) != SQLITE_OK) {
+			std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
+			sqlite3_finalize(selectStatement);
+			continue;
+		}
+
+		// Collect the hashes first, the rows are updated only after the whole table was read
+		vector<pair<sqlite3_int64, string>> hashes;
+		while (sqlite3_step(selectStatement) == SQLITE_ROW) {
+			const char* imageBlob = reinterpret_cast<const char*>(sqlite3_column_blob(selectStatement, 1));
+			int imageSize = sqlite3_column_bytes(selectStatement, 1);
+			hashes.emplace_back(sqlite3_column_int64(selectStatement, 0), ImageStore::hashOf(imageBlob, imageSize));
+		}
+		sqlite3_finalize(selectStatement);
+		if (hashes.empty()) {
+			continue;
+		}
+
+		sqlite3_stmt* updateStatement;
+		string updateQuery = "UPDATE " + tableName + " SET image_hash = ? WHERE rowid = ?";
+		if (sqlite3_prepare_v2(db, updateQuery.c_str(), -1, &updateStatement, nullptr) != SQLITE_OK) {
+			std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
+			sqlite3_finalize(updateStatement);
+			continue;
+		}
+
+		sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
+		for (const auto& [rowId, hash] : hashes) {
+			sqlite3_bind_text(updateStatement, 1, hash.c_str(), -1, SQLITE_STATIC);
+			sqlite3_bind_int64(updateStatement, 2, rowId);
+			if (sqlite3_step(updateStatement) != SQLITE_DONE) {
+				std::cerr << "Failed to update " << tableName << " table: " << sqlite3_errmsg(db) << std::endl;
+			}
+			sqlite3_reset(updateStatement);
+		}
+		sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+		sqlite3_finalize(updateStatement);
+	}
+}
+
+
+
+/*
+	Function that interns the names of the seasons, weathers and locations, in the order of their ids.
+	The names interned first get the lowest bits of the attribute sets, so the sets of the fish list them in the table order.
+	The interned id of every attribute is kept by its id in the database, so the attributes of the fish are interned without their names.
+	Params:
+		db - the database connection
+*/
+void FishDBRepository::internAttributeNames(sqlite3* db) {
+	const vector<pair<string, AttributeKind>> attributeTables = { { "Seasons", AttributeKind::Season }, { "Weathers", AttributeKind::Weather }, { "FishLocations", AttributeKind::Location } };
+	for (size_t table = 0; table < attributeTables.size(); table++) {
+		const auto& [tableName, kind] = attributeTables[table];
+		sqlite3_stmt* statement;
+		string query = "SELECT id, name FROM " + tableName + " ORDER BY id";
+		if (sqlite3_prepare_v2(db, query.c_str(), -1, &statement, nullptr) != SQLITE_OK) {
+			std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
+			continue;
+		}
+
+		vector<uint16_t>& internedIds = internedAttributeIds[table];
+		while (sqlite3_step(statement) == SQLITE_ROW) {
+			const sqlite3_int64 id = sqlite3_column_int64(statement, 0);
+			const unsigned char* name = sqlite3_column_text(statement, 1);
+			if (name == nullptr) {
+				continue;
+			}
+
+			const uint16_t internedId = InternTable::of(kind).intern(reinterpret_cast<const char*>(name));
+			if (id >= 0 && id <= UINT16_MAX) {
+				if (static_cast<size_t>(id) >= internedIds.size()) {
+					internedIds.resize(id + 1, NO_INTERNED_ID);
+				}
+				internedIds[id] = internedId;
+			}
+		}
+
+		sqlite3_finalize(statement);
+	}
+}
+
+
+
+/*
+	Function that adds the catch_windows column to the Fish table, and fills it from the catching hours of the fish that have none.
+	Params:
+		db - the database connection
+*/
+void FishDBRepository::ensureCatchWindowsColumn(sqlite3* db) const {
+	if (!hasColumn(db, "Fish", "start_catching_hour")) {
+		return;
+	}
+	if (!hasColumn(db, "Fish", "catch_windows") && sqlite3_exec(db, "ALTER TABLE Fish ADD COLUMN catch_windows TEXT", nullptr, nullptr, nullptr) != SQLITE_OK) {
+		std::cerr << "Failed to add catch_windows column to Fish: " << sqlite3_errmsg(db) << std::endl;
+		return;
+	}
+
+	sqlite3_stmt* selectStatement;
+	sqlite3_stmt* updateStatement;
+	if (sqlite3_prepare_v2(db, "SELECT id, start_catching_hour, end_catching_hour FROM Fish WHERE catch_windows IS NULL", -1, &selectStatement, nullptr) != SQLITE_OK) {
+		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
+		return;
+	}
+	if (sqlite3_prepare_v2(db, "UPDATE Fish SET catch_windows = ? WHERE id = ?", -1, &updateStatement, nullptr) != SQLITE_OK) {
+		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
+		sqlite3_finalize(selectStatement);
+		return;
+	}
+
+	sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
+	while (sqlite3_step(selectStatement) == SQLITE_ROW) {
+		const string catchWindows = CatchTimes::parse(ColumnType<string_view>::read(selectStatement, 1), ColumnType<string_view>::read(selectStatement, 2)).encode();
+		sqlite3_bind_text(updateStatement, 1, catchWindows.c_str(), -1, SQLITE_TRANSIENT);
+		sqlite3_bind_int64(updateStatement, 2, sqlite3_column_int64(selectStatement, 0));
+		if (sqlite3_step(updateStatement) != SQLITE_DONE) {
+			std::cerr << "Failed to fill catch_windows: " << sqlite3_errmsg(db) << std::endl;
+		}
+		sqlite3_reset(updateStatement);
+	}
+	sqlite3_finalize(selectStatement);
+	sqlite3_finalize(updateStatement);
+	sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+}
+
+
+
+/*
+	Function that implements catchable_at(catch_windows, minute) for SQLite.
+	The windows are decoded from the text of the column without allocating, so the function is cheap to call for every row.
+	A NULL minute gives NULL, and windows that cannot be decoded give 0.
+*/
+static void catchableAt(sqlite3_context* context, int argc, sqlite3_value** argv) {
+	if (argc != 2 || sqlite3_value_type(argv[1]) == SQLITE_NULL) {
+		sqlite3_result_null(context);
+		return;
+	}
+	const unsigned char* text = sqlite3_value_text(argv[0]);
+	const string_view catchWindows = text == nullptr ? string_view() : string_view(reinterpret_cast<const char*>(text), static_cast<size_t>(sqlite3_value_bytes(argv[0])));
+	sqlite3_result_int(context, CatchTimes::decode(catchWindows).contains(sqlite3_value_int(argv[1])) ? 1 : 0);
+}
+
+
+
+/*
+	Function that registers the C++ functions used by the queries on a connection.
+	Params:
+		db - the database connection
+*/
+void FishDBRepository::registerSqlFunctions(sqlite3* db) {
+	if (sqlite3_create_function_v2(db, "catchable_at", 2, SQLITE_UTF8 | SQLITE_DETERMINISTIC, nullptr, catchableAt, nullptr, nullptr, nullptr) != SQLITE_OK) {
+		std::cerr << "Failed to register catchable_at: " << sqlite3_errmsg(db) << std::endl;
+	}
+}
+
+
+
+/*
+	Function that creates the indexes the fish pages are sorted and found by.
+	Every index ends with the id, so the rows with the same sort value keep a stable order across the pages.
+	Params:
+		db - the database connection
+*/
+void FishDBRepository::ensurePagingIndexes(sqlite3* db) const {
+	const vector<string> indexQueries = {
+		"CREATE INDEX IF NOT EXISTS Fish_name_id_index ON Fish (name, id)",
+		"CREATE INDEX IF NOT EXISTS Fish_difficulty_id_index ON Fish (difficulty, id)",
+		"CREATE INDEX IF NOT EXISTS Fish_category_id_index ON Fish (IFNULL(category, ''), id)"
+	};
+	for (const string& query : indexQueries) {
+		if (sqlite3_exec(db, query.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK) {
+			std::cerr << "Failed to create paging index: " << sqlite3_errmsg(db) << std::endl;
+		}
+	}
+}
+
+
+
+/*
+	Function that creates the indexes the fish are filtered by.
+	The primary keys of the junction tables start with the fish id, these start with the attribute id, so the fish of an attribute are found by a search.
+	The names are indexed with the NOCASE collation, so the names compared without case are found by a search too.
+	Params:
+		db - the database connection
+*/
+void FishDBRepository::ensureFilterIndexes(sqlite3* db) const {
+	vector<string> indexQueries = { "CREATE INDEX IF NOT EXISTS Fish_name_nocase_index ON Fish (name COLLATE NOCASE)" };
+	for (const FilterDimension& dimension : FILTER_DIMENSIONS) {
+		indexQueries.push_back(string("CREATE INDEX IF NOT EXISTS ") + dimension.table + "_" + dimension.idColumn + "_index ON " + dimension.table + " (" + dimension.idColumn + ", fish_id)");
+		indexQueries.push_back(string("CREATE INDEX IF NOT EXISTS ") + dimension.namesTable + "_name_nocase_index ON " + dimension.namesTable + " (name COLLATE NOCASE)");
+	}
+	for (const string& query : indexQueries) {
+		if (sqlite3_exec(db, query.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK) {
+			std::cerr << "Failed to create filter index: " << sqlite3_errmsg(db) << std::endl;
+		}
+	}
+}
+
+
+
+/*
+	Function that creates the Users_Fish table if the database has none, and the unique index the progress of a user is upserted on.
+	Before the index is created, the rows of the same user and fish are merged into the first of them, caught or favorite if any of them was.
+	Params:
+		db - the database connection
+*/
+void FishDBRepository::ensureUserProgressTable(sqlite3* db) const {
+	if (sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS Users_Fish (user_id integer not null, fish_id integer not null, is_caught boolean not null default 0, is_favorite boolean not null default 0)", nullptr, nullptr, nullptr) != SQLITE_OK) {
+		std::cerr << "Failed to create Users_Fish: " << sqlite3_errmsg(db) << std::endl;
+		return;
+	}
+	if (hasUniqueIndex(db, "Users_Fish", { "user_id", "fish_id" })) {
+		return;
+	}
+
+	const char* queries[] = {
+		"UPDATE Users_Fish SET "
+			"is_caught = (SELECT MAX(d.is_caught) FROM Users_Fish d WHERE d.user_id = Users_Fish.user_id AND d.fish_id = Users_Fish.fish_id), "
+			"is_favorite = (SELECT MAX(d.is_favorite) FROM Users_Fish d WHERE d.user_id = Users_Fish.user_id AND d.fish_id = Users_Fish.fish_id) "
+			"WHERE rowid IN (SELECT MIN(rowid) FROM Users_Fish GROUP BY user_id, fish_id HAVING COUNT(*) > 1)",
+		"DELETE FROM Users_Fish WHERE rowid NOT IN (SELECT MIN(rowid) FROM Users_Fish GROUP BY user_id, fish_id)",
+		"CREATE UNIQUE INDEX IF NOT EXISTS Users_Fish_user_id_fish_id_index ON Users_Fish (user_id, fish_id)"
+	};
+	sqlite3_exec(db, "BEGIN IMMEDIATE TRANSACTION;", nullptr, nullptr, nullptr);
+	for (const char* query : queries) {
+		if (sqlite3_exec(db, query, nullptr, nullptr, nullptr) != SQLITE_OK) {
+			std::cerr << "Failed to create the unique index of Users_Fish: " << sqlite3_errmsg(db) << std::endl;
+			sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+			return;
+		}
+	}
+	sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+}
+
+
+
+/*
+	Function that checks if a table has a unique index, its primary key included, on exactly the given columns, in any order.
+	Params:
+		db - the database connection
+		tableName - the name of the table
+		columns - the names of the columns
+*/
+bool FishDBRepository::hasUniqueIndex(sqlite3* db, const string& tableName, const vector<string>& columns) const {
+	sqlite3_stmt* indexes;
+	if (sqlite3_prepare_v2(db, "SELECT il.name FROM pragma_index_list(?) il WHERE il.\"unique\" = 1", -1, &indexes, nullptr) != SQLITE_OK) {
+		sqlite3_finalize(indexes);
+		return false;
+	}
+	sqlite3_bind_text(indexes, 1, tableName.c_str(), -1, SQLITE_TRANSIENT);
+
+	sqlite3_stmt* indexColumns;
+	if (sqlite3_prepare_v2(db, "SELECT name FROM pragma_index_info(?)", -1, &indexColumns, nullptr) != SQLITE_OK) {
+		sqlite3_finalize(indexColumns);
+		sqlite3_finalize(indexes);
+		return false;
+	}
+
+	bool found = false;
+	while (!found && sqlite3_step(indexes) == SQLITE_ROW) {
+		sqlite3_bind_text(indexColumns, 1, reinterpret_cast<const char*>(sqlite3_column_text(indexes, 0)), -1, SQLITE_TRANSIENT);
+		vector<string> indexed;
+		while (sqlite3_step(indexColumns) == SQLITE_ROW) {
+			const unsigned char* name = sqlite3_column_text(indexColumns, 0);
+			indexed.push_back(name != nullptr ? reinterpret_cast<const char*>(name) : "");
+		}
+		sqlite3_reset(indexColumns);
+		found = is_permutation(indexed.begin(), indexed.end(), columns.begin(), columns.end());
+	}
+
+	sqlite3_finalize(indexColumns);
+	sqlite3_finalize(indexes);
+	return found;
+}
+
+
+
+/*
+	Function that deletes the Users_Fish rows of the fish that are neither caught nor favorite.
+	A missing row reads as not caught and not favorite, so only the progress a user made is stored.
+	The rows are only compacted once: the user_version of the database records it, and the writes never add such rows afterwards.
+	Params:
+		db - the database connection
+*/
+void FishDBRepository::compactUserProgress(sqlite3* db) const {
+	sqlite3_stmt* statement;
+	int version = 0;
+	if (sqlite3_prepare_v2(db, "PRAGMA user_version", -1, &statement, nullptr) == SQLITE_OK && sqlite3_step(statement) == SQLITE_ROW) {
+		version = sqlite3_column_int(statement, 0);
+	}
+	sqlite3_finalize(statement);
+	if (version >= SPARSE_USER_PROGRESS_VERSION) {
+		return;
+	}
+
+	const string versionQuery = "PRAGMA user_version = " + to_string(SPARSE_USER_PROGRESS_VERSION);
+	sqlite3_exec(db, "BEGIN IMMEDIATE TRANSACTION;", nullptr, nullptr, nullptr);
+	if (sqlite3_exec(db, "DELETE FROM Users_Fish WHERE is_caught = 0 AND is_favorite = 0", nullptr, nullptr, nullptr) != SQLITE_OK
+		|| sqlite3_exec(db, versionQuery.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK) {
+		std::cerr << "Failed to compact Users_Fish: " << sqlite3_errmsg(db) << std::endl;
+		sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+		return;
+	}
+	sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+}
+
+
+
+/*
+	Function that gives the write connection back to the writer pool, after the change tracker has read the keys of the rows it committed.
+	Params:
+		db - the write connection
+*/
+void FishDBRepository::releaseWriteConnection(sqlite3* db) const {
+	changeTracker.detach(db);
+	writer.release(db);
+}
+
+
+
+/*
+	Function that returns the changes committed to the database since the last call, by this process or by another one.
+	The changes of other processes are checked on the write connection, only if it is free; a busy writer is checked on the next call.
+*/
+DataChanges FishDBRepository::takeDataChanges() const {
+	sqlite3* db;
+	const bool polled = writer.tryAcquire(&db);
+	DataChanges changes = changeTracker.take(db);
+	if (polled) {
+		writer.release(db);
+	}
+	return changes;
+}
+
+
+
+/*
+	Function that returns the counters of the writer and readers pools.
+*/
+vector<ConnectionPoolStats> FishDBRepository::getConnectionStats() const {
+	return { writer.getStats(), readers.getStats() };
+}
+
+
+
+/*
+	Function that copies the database into a snapshot with the online backup API, a few pages at a time.
+	Every step takes the writer connection and gives it back, so a write waits for at most one step. The backup reads from the
+	writer connection itself: SQLite copies the pages changed by the writes of that connection into the snapshot, while the
+	writes of any other connection would restart the backup from the first page.
+	The snapshot is written to a ".partial" file, renamed once complete, so a snapshot with its final name is never torn.
+	Params:
+		destinationPath - the path of the snapshot
+		pagesPerStep - the number of pages copied by every step
+		pause - the time the writer connection is left free between two steps
+		cancelled - if not null, stops the backup once it is true
+*/
+BackupReport FishDBRepository::backupTo(const string& destinationPath, const int pagesPerStep, const chrono::milliseconds pause, const atomic<bool>* cancelled) const {
+	BackupReport report;
+	report.path = destinationPath;
+	const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	const string partialPath = destinationPath + ".partial";
+
+	sqlite3* destination;
+	int rc = sqlite3_open(partialPath.c_str(), &destination);
+	if (rc != SQLITE_OK) {
+		std::cerr << "Error opening backup: " << sqlite3_errmsg(destination) << std::endl;
+		sqlite3_close(destination);
+		return report;
+	}
+	sqlite3_busy_timeout(destination, BUSY_TIMEOUT_MS);
+
+	sqlite3_backup* backup = nullptr;
+	int busySteps = 0;
+	while (cancelled == nullptr || !cancelled->load()) {
+		sqlite3* db;
+		rc = writer.acquire(&db);
+		if (rc != SQLITE_OK) {
+			std::cerr << "Failed to take the writer connection for the backup: " << sqlite3_errstr(rc) << std::endl;
+			break;
+		}
+
+		const chrono::steady_clock::time_point stepStart = chrono::steady_clock::now();
+		if (backup == nullptr) {
+			backup = sqlite3_backup_init(destination, "main", db, "main");
+			if (backup == nullptr) {
+				std::cerr << "Failed to start the backup: " << sqlite3_errmsg(destination) << std::endl;
+				writer.release(db);
+				rc = SQLITE_ERROR;
+				break;
+			}
+		}
+		rc = sqlite3_backup_step(backup, pagesPerStep > 0 ? pagesPerStep : -1);
+		const double stepMs = chrono::duration<double, milli>(chrono::steady_clock::now() - stepStart).count();
+		writer.release(db);
+
+		report.steps++;
+		report.longestStallMs = max(report.longestStallMs, stepMs);
+		report.pages = sqlite3_backup_pagecount(backup);
+
+		// A busy or locked step copied nothing and is tried again after the pause
+		busySteps = rc == SQLITE_BUSY || rc == SQLITE_LOCKED ? busySteps + 1 : 0;
+		if ((rc != SQLITE_OK && busySteps == 0) || busySteps > MAX_BUSY_BACKUP_STEPS) {
+			break;
+		}
+		this_thread::sleep_for(pause);
+	}
+
+	if (backup != nullptr && sqlite3_backup_finish(backup) != SQLITE_OK && rc == SQLITE_DONE) {
+		rc = sqlite3_errcode(destination);
+	}
+	if (rc != SQLITE_DONE && rc != SQLITE_OK) {
+		std::cerr << "Failed to back up the database: " << sqlite3_errstr(rc) << std::endl;
+	}
+
+	// The pages copied keep the WAL mode of the database, the snapshot is switched back so it is a single file
+	if (rc == SQLITE_DONE && sqlite3_exec(destination, "PRAGMA journal_mode=DELETE", nullptr, nullptr, nullptr) != SQLITE_OK) {
+		std::cerr << "Failed to switch the backup out of WAL mode: " << sqlite3_errmsg(destination) << std::endl;
+	}
+	sqlite3_close(destination);
+
+	// The images the rows point at live in the pack file, copied next to the snapshot before it gets its name,
+	// so a snapshot that has a name always has its images
+	std::error_code error;
+	const string imagesPath = destinationPath + ".images";
+	if (rc == SQLITE_DONE && !imageStore.copyTo(imagesPath)) {
+		std::cerr << "Failed to copy the images next to the backup: " << imagesPath << std::endl;
+		rc = SQLITE_IOERR;
+	}
+	if (rc == SQLITE_DONE) {
+		filesystem::rename(partialPath, destinationPath, error);
+		if (error) {
+			std::cerr << "Failed to rename the backup: " << error.message() << std::endl;
+		}
+		else {
+			report.succeeded = true;
+			report.bytes = filesystem::file_size(destinationPath, error);
+			for (const string& imageFile : { imagesPath, imagesPath + ".idx" }) {
+				if (filesystem::exists(imageFile, error)) {
+					report.bytes += filesystem::file_size(imageFile, error);
+				}
+			}
+		}
+	}
+	if (!report.succeeded) {
+		filesystem::remove(partialPath, error);
+		filesystem::remove(imagesPath, error);
+		filesystem::remove(imagesPath + ".idx", error);
+	}
+
+	report.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	return report;
+}
+
+
+
+/*
+	Function that replaces the content of the database with a snapshot, through the writer connection.
+	The snapshot is opened read-only and checked with PRAGMA quick_check first, so a damaged snapshot never overwrites the database.
+	The images of the snapshot are added to the image store before its rows are copied, so every restored row finds its image.
+	The copy is made in a single step, the writes wait for it; the readers see the restored database at their next read.
+	A reader in the middle of a read makes the step wait, for as long as the busy timeout of the writer connection.
+	Params:
+		snapshotPath - the path of the snapshot
+*/
+bool FishDBRepository::restoreFrom(const string& snapshotPath) {
+	sqlite3* snapshot;
+	int rc = sqlite3_open_v2(snapshotPath.c_str(), &snapshot, SQLITE_OPEN_READONLY, nullptr);
+	if (rc != SQLITE_OK) {
+		std::cerr << "Error opening snapshot: " << sqlite3_errmsg(snapshot) << std::endl;
+		sqlite3_close(snapshot);
+		return false;
+	}
+
+	sqlite3_stmt* statement;
+	rc = sqlite3_prepare_v2(snapshot, "PRAGMA quick_check", -1, &statement, nullptr);
+	const bool intact = rc == SQLITE_OK && sqlite3_step(statement) == SQLITE_ROW
+		&& string(reinterpret_cast<const char*>(sqlite3_column_text(statement, 0))) == "ok";
+	sqlite3_finalize(statement);
+	if (!intact) {
+		std::cerr << "The snapshot is damaged or is not a database: " << snapshotPath << std::endl;
+		sqlite3_close(snapshot);
+		return false;
+	}
+
+	// The store only grows, so the images of the rows read before the restore are still found after it
+	std::error_code error;
+	const string imagesPath = snapshotPath + ".images";
+	if (!filesystem::exists(imagesPath + ".idx", error)) {
+		std::cerr << "The snapshot has no images next to it, its rows keep the images of the store: " << snapshotPath << std::endl;
+	}
+	else if (!imageStore.importFrom(imagesPath)) {
+		std::cerr << "Failed to restore the images of the snapshot: " << imagesPath << std::endl;
+		sqlite3_close(snapshot);
+		return false;
+	}
+
+	sqlite3* db;
+	rc = writer.acquire(&db);
+	if (rc != SQLITE_OK) {
+		std::cerr << "Failed to take the writer connection for the restore: " << sqlite3_errstr(rc) << std::endl;
+		sqlite3_close(snapshot);
+		return false;
+	}
+
+	sqlite3_backup* backup = sqlite3_backup_init(db, "main", snapshot, "main");
+	if (backup == nullptr) {
+		std::cerr << "Failed to start the restore: " << sqlite3_errmsg(db) << std::endl;
+		writer.release(db);
+		sqlite3_close(snapshot);
+		return false;
+	}
+	rc = sqlite3_backup_step(backup, -1);
+	sqlite3_backup_finish(backup);
+
+	// Every cached row may be gone, even if the copy failed half way
+	changeTracker.markEverything();
+	writer.release(db);
+	sqlite3_close(snapshot);
+
+	if (rc != SQLITE_DONE) {
+		std::cerr << "Failed to restore the database: " << sqlite3_errstr(rc) << std::endl;
+		return false;
+	}
+	return true;
+}
+
+
+
+/*
+	Function that prepares a connection once it is opened: it waits for a lock held by another process instead of failing at once,
+	and gets the SQL functions of the repository.
+	Params:
+		db - the database connection
+*/
+void FishDBRepository::configureConnection(sqlite3* db) {
+	sqlite3_busy_timeout(db, BUSY_TIMEOUT_MS);
+	registerSqlFunctions(db);
+}
+
+
+
+/*
+	Function that returns the cached statement of a combination of the season, weather and location filters on a connection of the readers pool.
+	The statement is prepared on the first call on every connection, the query plan test checks that its plan only searches by index.
+	The caller holds the connection, so nobody else prepares or steps its statements; only the map of the statements is shared.
+	Params:
+		db - the connection, taken from the readers pool
+		shape - the filters that are set: 1 for the season, 2 for the weather, 4 for the location
+*/
+sqlite3_stmt* FishDBRepository::seasonWeatherLocationStatement(sqlite3* db, const int shape) const {
+	{
+		lock_guard<mutex> lock(statementsMutex);
+		sqlite3_stmt* statement = seasonWeatherLocationStatements[db][shape];
+		if (statement != nullptr) {
+			return statement;
+		}
+	}
+
+	const string query = buildSeasonWeatherLocationQuery(shape);
+	sqlite3_stmt* statement;
+	if (sqlite3_prepare_v3(db, query.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &statement, nullptr) != SQLITE_OK) {
+		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
+		sqlite3_finalize(statement);
+		return nullptr;
+	}
+
+	lock_guard<mutex> lock(statementsMutex);
+	seasonWeatherLocationStatements[db][shape] = statement;
+	return statement;
+}
+
+
+
+/*
+	Function that returns the cached statement reading the seasons, weathers, locations or flags of one fish on a connection.
+	The statement is prepared on the first call on every connection, as readFish runs it for every row it maps.
+	The caller holds the connection, so nobody else prepares or steps its statements; only the map of the statements is shared.
+	Params:
+		db - the connection, taken from the readers or the writer pool
+		detail - the position of the query in FISH_DETAIL_QUERIES
+*/
+sqlite3_stmt* FishDBRepository::fishDetailStatement(sqlite3* db, const int detail) const {
+	{
+		lock_guard<mutex> lock(statementsMutex);
+		sqlite3_stmt* statement = fishDetailStatements[db][detail];
+		if (statement != nullptr) {
+			return statement;
+		}
+	}
+
+	sqlite3_stmt* statement;
+	if (sqlite3_prepare_v3(db, FISH_DETAIL_QUERIES[detail], -1, SQLITE_PREPARE_PERSISTENT, &statement, nullptr) != SQLITE_OK) {
+		std::cerr << "Error preparing SQL statement: " << sqlite3_errmsg(db) << std::endl;
+		sqlite3_finalize(statement);
+		return nullptr;
+	}
+
+	lock_guard<mutex> lock(statementsMutex);
+	fishDetailStatements[db][detail] = statement;
+	return statement;
+}
+
+
+
+/*
+	Function that builds the query of a combination of the season, weather and location filters.
+	The first filtered junction table drives the query through its (attribute id, fish id) index, and the fish come out in id order.
+	Without filters, every fish is read in id order. The caught and favorite state is read for every fish, so the user is not part of the query.
+	Params:
+		shape - the filters that are set: 1 for the season, 2 for the weather, 4 for the location
+*/
+string FishDBRepository::buildSeasonWeatherLocationQuery(const int shape) {
+	auto condition = [](const FilterDimension& dimension) {
+		return string(dimension.alias) + "." + dimension.idColumn + " = (SELECT id FROM " + dimension.namesTable + " WHERE name = " + dimension.nameParameter + " COLLATE NOCASE)";
+	};
+
+	const FilterDimension* driver = nullptr;
+	for (const FilterDimension& dimension : FILTER_DIMENSIONS) {
+		if (shape & dimension.bit) {
+			driver = &dimension;
+			break;
+		}
+	}
+
+	string query = "SELECT " FISH_ROW_COLUMNS " FROM ";
+	if (driver == nullptr) {
+		return query + "Fish f ORDER BY f.id";
+	}
+	query += string(driver->table) + " " + driver->alias + " CROSS JOIN Fish f ON f.id = " + driver->alias + ".fish_id";
+
+	for (const FilterDimension& dimension : FILTER_DIMENSIONS) {
+		if ((shape & dimension.bit) && &dimension != driver) {
+			query += string(" JOIN ") + dimension.table + " " + dimension.alias + " ON " + dimension.alias + ".fish_id = f.id AND " + condition(dimension);
+		}
+	}
+
+	return query + " WHERE " + condition(*driver) + " ORDER BY " + driver->alias + ".fish_id";
+}
+
+
+
+/*
+	Function that builds the cursor of the page following a fish.
+	The cursor is the sort key, the direction, the id and the sort value, joined and Base64 encoded so callers treat it as opaque.
+	Params:
+		request - the request of the current page
+		id - the id of the last fish of the current page
+		sortValue - the sort value of the last fish of the current page
+*/
+string FishDBRepository::encodePageCursor(const FishPageRequest& request, const long id, const string_view sortValue) {
+	QByteArray cursor = QByteArray::number(static_cast<int>(request.sortKey)) + "|" + QByteArray::number(static_cast<int>(request.direction)) + "|" + QByteArray::number(static_cast<qlonglong>(id)) + "|";
+	cursor.append(sortValue.data(), static_cast<qsizetype>(sortValue.size()));
+	return cursor.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals).toStdString();
+}
+
+
+
+/*
+	Function that reads a cursor built by encodePageCursor.
+	A cursor built for another sort key or direction is rejected, its sort value would not match the order of the page.
+	Params:
+		request - the request holding the cursor
+		id - set to the id of the last fish of the previous page
+		sortValue - set to the sort value of the last fish of the previous page
+*/
+bool FishDBRepository::decodePageCursor(const FishPageRequest& request, long& id, string& sortValue) {
+	const QByteArray cursor = QByteArray::fromBase64(QByteArray::fromStdString(request.cursor), QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+
+	// The sort value is the last field, so it may contain the separator itself
+	qsizetype fieldStart = 0;
+	long fields[3];
+	for (int field = 0; field < 3; field++) {
+		const qsizetype separator = cursor.indexOf('|', fieldStart);
+		if (separator < 0) {
+			return false;
+		}
+		bool ok = false;
+		fields[field] = cursor.mid(fieldStart, separator - fieldStart).toLong(&ok);
+		if (!ok) {
+			return false;
+		}
+		fieldStart = separator + 1;
+	}
+
+	if (fields[0] != static_cast<int>(request.sortKey) || fields[1] != static_cast<int>(request.direction)) {
+		return false;
+	}
+
+	id = fields[2];
+	sortValue = cursor.mid(fieldStart).toStdString();
+	return true;
+}
+
+
+
+/*
+	Function that reads the image of the current row of a statement.
+	Rows with an image hash are read from the image store, the other rows from their inline BLOB.
+	Params:
+		statement - the statement positioned on a row
+		blobColumn - the index of the image column
+		hashColumn - the index of the image_hash column
+		imageHash - set to the hash of the image, or to an empty string for an inline image
+*/
+vector<char> FishDBRepository::readImage(sqlite3_stmt* statement, int blobColumn, int hashColumn, string& imageHash) const {
+	const unsigned char* hash = sqlite3_column_text(statement, hashColumn);
+	imageHash = hash != nullptr ? reinterpret_cast<const char*>(hash) : "";
+
+	const ImageView imageData = viewImage(statement, blobColumn, hashColumn);
+	return vector<char>(imageData.begin(), imageData.end());
+}
+
+
+
+/*
+	Function that returns a view over the image of the current row of a statement, without copying it.
+	A view over the inline BLOB is valid only until the statement is stepped or finalized.
+	Params:
+		statement - the statement positioned on a row
+		blobColumn - the index of the image column
+		hashColumn - the index of the image_hash column
+*/
+ImageView FishDBRepository::viewImage(sqlite3_stmt* statement, int blobColumn, int hashColumn) const {
+	const char* imageBlob = reinterpret_cast<const char*>(sqlite3_column_blob(statement, blobColumn));
+	int imageSize = sqlite3_column_bytes(statement, blobColumn);
+
+	const unsigned char* hash = sqlite3_column_text(statement, hashColumn);
+	if (hash != nullptr) {
+		ImageView imageData = imageStore.find(reinterpret_cast<const char*>(hash));
+		if (!imageData.empty()) {
+			return imageData;
+		}
+		if (imageSize == 0) {
+			qWarning() << "Image" << reinterpret_cast<const char*>(hash) << "is missing from the image store";
+		}
+	}
+
+	return ImageView{ imageBlob, static_cast<size_t>(imageSize) };
+}
+
+
+
+/*
+	Function that binds an image to the image and image_hash parameters of a statement.
+	The image is written to the image store and only its hash is bound. If the store cannot take it, the image is bound inline, along with its hash.
+	Params:
+		statement - the statement to bind to
+		blobParameter - the index of the image parameter
+		hashParameter - the index of the image_hash parameter
+		image - the image to be bound
+*/
+void FishDBRepository::bindImage(sqlite3_stmt* statement, int blobParameter, int hashParameter, const ImageView& image) {
+	string hash = imageStore.put(image.data, image.size);
+	if (hash.empty()) {
+		sqlite3_bind_blob(statement, blobParameter, image.data, static_cast<int>(image.size), SQLITE_TRANSIENT);
+		if (image.empty()) {
+			sqlite3_bind_null(statement, hashParameter);
+		}
+		else {
+			sqlite3_bind_text(statement, hashParameter, ImageStore::hashOf(image.data, image.size).c_str(), -1, SQLITE_TRANSIENT);
+		}
+		return;
+	}
+
+	sqlite3_bind_zeroblob(statement, blobParameter, 0);
+	sqlite3_bind_text(statement, hashParameter, hash.c_str(), -1, SQLITE_TRANSIENT);
+}
+
+
+
+void FishDBRepository::bindImage(sqlite3_stmt* statement, int blobParameter, int hashParameter, const std::vector<char>& image) {
+	bindImage(statement, blobParameter, hashParameter, ImageView{ image.data(), image.size() });
 }
\ No newline at end of file
@@ -2,23 +2,85 @@
 #define FISHDBREPOSITORY_H
 
 #include "IRepository.h"
+#include "ImageStore.h"
+#include "ChangeTracker.h"
+#include "ConnectionPool.h"
+#include "SpriteAtlas.h"
+#include "RowMapper.h"
+#include "FishPage.h"
 #include "../model/Fish.h"
 #include "../model/User.h"
+#include "../utils/CaseFolding.h"
 #include "../../resources/sqlite/sqlite3.h"
 #include <QImage>
 #include <QPixmap>
 #include <QMap>
+#include <functional>
+#include <mutex>
 #include <vector>
 #include <qDebug>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <string>
 #include <iostream>
+#include <unordered_map>
 
 using namespace std;
 
+// The caught and favorite flags of a fish for a user
+struct FishFlags {
+    bool caught = false;
+    bool favorite = false;
+};
+
+// The outcome of an online backup of the database
+struct BackupReport {
+    string path;
+    bool succeeded = false;
+    int pages = 0;
+    int steps = 0;
+    uint64_t bytes = 0;
+    double seconds = 0;
+
+    // The longest a step of the backup held the writer connection, so the longest a write waited because of the backup
+    double longestStallMs = 0;
+
+    // Get the number of megabytes copied every second
+    double megabytesPerSecond() const { return seconds > 0 ? bytes / seconds / (1024.0 * 1024.0) : 0; }
+};
+
 class FishDBRepository : public IRepository<Fish> {
 private:
     string databasePath;
+    ImageStore imageStore;
+
+    // One statement for every combination of the season (1), weather (2) and location (4) filters, prepared on first use
+    // on every connection of the readers pool; only the lookup is locked, a statement is used by the caller holding its connection
+    mutable unordered_map<sqlite3*, array<sqlite3_stmt*, 8>> seasonWeatherLocationStatements;
+
+    // The statements reading the seasons, weathers, locations and flags of one fish, prepared on first use on every connection
+    // that maps fish rows; they share the lock of the statements above
+    mutable unordered_map<sqlite3*, array<sqlite3_stmt*, 4>> fishDetailStatements;
+    mutable mutex statementsMutex;
+
+    // The interned id of every season, weather and location, by its id in the database, filled when the database is opened
+    array<vector<uint16_t>, 3> internedAttributeIds;
+
+    // The positions of the queries of fishDetailStatement, also the positions of the seasons, weathers and locations in internedAttributeIds
+    static constexpr int SEASONS_OF_FISH = 0;
+    static constexpr int WEATHERS_OF_FISH = 1;
+    static constexpr int LOCATIONS_OF_FISH = 2;
+    static constexpr int FLAGS_OF_FISH = 3;
+
+    // Every write goes through the one connection of the writer pool, in the order the writes came; the reads share
+    // the connections of the readers pool, each reading the last committed snapshot of the WAL while a write is running
+    mutable ConnectionPool writer;
+    mutable ConnectionPool readers;
+
+    // Records the rows committed by the write connection, and finds the changes made by other processes
+    mutable ChangeTracker changeTracker;
 
 public:
 
@@ -31,6 +93,8 @@ public:
 
     FishDBRepository(const string& databasePath);
 
+    ~FishDBRepository();
+
 
     /*
     * @brief Finds a fish by id
@@ -41,6 +105,15 @@ public:
     Fish findOne(long id, const long userId) const override;
 
 
+    /*
+    * @brief Finds the fish with the given ids, with one statement reused for all of them
+    * @param ids - the ids of the fish
+    * @param userId - the id of the user
+    * @return the fish that were found, in the order of the ids
+    */
+    vector<Fish> findMany(const vector<long>& ids, const long userId) const override;
+
+
     /*
     * @brief Finds a fish by name
     * @param name - the name of the fish
@@ -58,6 +131,34 @@ public:
     vector<Fish> findAll(const long userId) const override;
 
 
+    /*
+    * @brief Streams all the fish from a single statement, without collecting them
+    * The fish passed to the visitor is reused for the next row, so it must be copied to be kept
+    * @param userId - the id of the user
+    * @param visitor - called with every fish, as soon as its row is read
+    */
+    void forEach(const long userId, const function<void(const Fish&)>& visitor) const override;
+
+
+    /*
+    * @brief Finds one page of fish, sorted by the key of the request
+    * @param userId - the id of the user
+    * @param request - the sort key, direction, size and cursor of the page
+    * @return the fish of the page and the cursor of the next page
+    */
+    FishPage findPage(const long userId, const FishPageRequest& request) const;
+
+
+    /*
+    * @brief Streams one page of fish, sorted by the key of the request, without collecting them
+    * @param userId - the id of the user
+    * @param request - the sort key, direction, size and cursor of the page
+    * @param visitor - called with every fish of the page, as soon as its row is read
+    * @return the cursor of the next page, or an empty string if this is the last page
+    */
+    string forEachInPage(const long userId, const FishPageRequest& request, const function<void(const Fish&)>& visitor) const;
+
+
     /*
     * @brief Saves a fish
     * @param fish - the fish to be saved
@@ -66,6 +167,13 @@ public:
     void save(Fish& fish) override;
 
 
+    /*
+    * @brief Saves the fish in a single transaction, with one statement reused for all of them
+    * @param fishList - the fish to be saved, their ids are set to the ids they were saved with
+    */
+    void saveAll(vector<Fish>& fishList) override;
+
+
     /*
     * @brief Removes a fish by id
     * @param id - the id of the fish to be removed
@@ -83,6 +191,26 @@ public:
     Fish update(const Fish& fish, const long userId) override;
 
 
+    /*
+    * @brief Updates the fish in a single transaction, with the statements reused for all of them
+    * @param fishList - the fish to be updated
+    * @param userId - the id of the user
+    * @return the fish that were updated, or an empty vector if the transaction was rolled back
+    */
+    vector<Fish> updateAll(const vector<Fish>& fishList, const long userId) override;
+
+
+    /*
+    * @brief Updates the fish in a single transaction, reading the flags they had before in the same transaction
+    * @param fishList - the fish to be updated
+    * @param userId - the id of the user
+    * @param previousFlags - if not null, receives the flags every fish had before the update, in the order of the fish;
+    *                        the caller then updates its caches itself, and the rows are not handed out by takeDataChanges
+    * @return the fish that were updated, or an empty vector if the transaction was rolled back
+    */
+    vector<Fish> updateAll(const vector<Fish>& fishList, const long userId, vector<FishFlags>* previousFlags);
+
+
     /*
     * @brief Saves an image for a fish
     * @param fishId - the id of the fish
@@ -127,6 +255,60 @@ public:
     QMap<QString, QPixmap> getAllImages() const;
 
 
+    /*
+    * @brief Loads the images of the Images table as a sprite atlas
+    * The atlas saved next to the database is reused while the Images table is unchanged, otherwise it is packed and saved again
+    * @return the sprite atlas, with the images that are too large for it kept standalone
+    */
+    SpriteAtlas loadSpriteAtlas() const;
+
+
+    /*
+    * @brief Takes the changes committed to the database since the last call, by this process or by another one
+    * @return the fish, progress and images that changed, or everything if another process changed the database
+    */
+    DataChanges takeDataChanges() const;
+
+
+    /*
+    * @brief Gets the counters of the writer and readers connection pools
+    * @return the counters of the writer pool, then of the readers pool
+    */
+    vector<ConnectionPoolStats> getConnectionStats() const;
+
+
+    /*
+    * @brief Copies the database into a snapshot file while the app keeps running, a few pages at a time
+    * Every step runs on the writer connection, so the writes made between the steps are copied too instead of restarting the backup;
+    * the snapshot is written next to its path and only renamed to it once it is complete, after the image pack and its index
+    * were copied next to it as "<snapshot>.images" and "<snapshot>.images.idx"
+    * @param destinationPath - the path of the snapshot, replaced if it exists
+    * @param pagesPerStep - the number of pages copied by every step
+    * @param pause - the time the writer connection is left free between two steps
+    * @param cancelled - if not null, the backup stops before the next step once it is true
+    * @return the pages, bytes, time and longest writer stall of the backup
+    */
+    BackupReport backupTo(const string& destinationPath, const int pagesPerStep, const chrono::milliseconds pause, const atomic<bool>* cancelled = nullptr) const;
+
+
+    /*
+    * @brief Replaces the content of the database with a snapshot, after checking the snapshot is not damaged
+    * The images of the image pack next to the snapshot are added to the image store first
+    * The caches learn about it through takeDataChanges, which then reports everything as changed
+    * @param snapshotPath - the path of the snapshot
+    * @return true if the database was restored, false if the snapshot could not be read or the copy failed
+    */
+    bool restoreFrom(const string& snapshotPath);
+
+
+    /*
+    * @brief Moves the image BLOBs of the Fish, Images and Users tables into the image store
+    * Every row is left with the hash of its image in the image_hash column and an empty image BLOB
+    * @return true if the migration was committed, false otherwise
+    */
+    bool migrateImagesToStore();
+
+
     /*
     * @brief Finds all the users
     * @return a vector containing User objects
@@ -156,7 +338,7 @@ public:
 
 
     /*
-    * Convert a string to lower case
+    * Convert the ASCII letters of a string to lower case, the same way the NOCASE collation compares them
     * @param str - the string to convert
     * @return the string in lower case
     */
@@ -173,19 +355,30 @@ public:
 
     /*
     * @brief Finds all the fish by season, weather and location
+    * Every combination of the given filters has its own statement, that only joins the filtered tables
+    * and is prepared once on every connection of the readers pool
     * @param userId - the id of the user
-    * @param season - the season of the fish
-    * @param weather - the weather of the fish
-    * @param location - the location of the fish
+    * @param season - the season of the fish, or an empty string for any season
+    * @param weather - the weather of the fish, or an empty string for any weather
+    * @param location - the location of the fish, or an empty string for any location
     * @return a vector containing all the fish with the given season, weather and location
     */
     vector<Fish> findAllBySeasonWeatherLocation(const long userId, const string& season, const string& weather, const string& location) const noexcept;
 
 
+    /*
+    * @brief Explains the query of a combination of the season, weather and location filters
+    * The query plan test checks with it that every combination is searched by index
+    * @param shape - the filters that are set: 1 for the season, 2 for the weather, 4 for the location
+    * @return the detail of every step of the plan, as EXPLAIN QUERY PLAN describes it, or an empty vector if the query could not be explained
+    */
+    vector<string> explainSeasonWeatherLocationQuery(const int shape) const;
+
+
     /*
     * @brief Finds all the fish by weather
     * @param userId - the id of the user
-    * @param weather - the weather of the fish
+    * @param weather - the weather of the fish, matched without case
     * @return a vector containing all the fish with the given weather
     */
     vector<Fish> findAllByWeather(const long userId, const string& weather) const noexcept;
@@ -194,7 +387,7 @@ public:
     /*
     * @brief Finds all the fish by season
     * @param userId - the id of the user
-    * @param season - the season of the fish
+    * @param season - the season of the fish, matched without case
     * @return a vector containing all the fish with the given season
     */
     vector<Fish> findAllBySeason(const long userId, const string& season) const noexcept;
@@ -203,12 +396,21 @@ public:
     /*
     * @brief Finds all the fish by location
     * @param userId - the id of the user
-    * @param location - the location of the fish
+    * @param location - the location of the fish, matched without case
     * @return a vector containing all the fish with the given location
     */
     vector<Fish> findAllByLocation(const long userId, const string& location) const noexcept;
 
 
+    /*
+    * @brief Finds all the fish that can be caught at a time of the day
+    * @param userId - the id of the user
+    * @param minute - the minute of the day, from 0 (12am) to 1439 (11:59pm)
+    * @return a vector containing all the fish that can be caught at the given time
+    */
+    vector<Fish> findAllCatchableAt(const long userId, const int minute) const noexcept;
+
+
     /*
     * @brief Finds all the fish that are not caught by the user
     * @param userId - the id of the user
@@ -249,50 +451,64 @@ public:
 
 
     /*
-    * @brief Finds the seasons based on the fish id
+    * @brief Maps the current row of a statement selecting the FISH_ROW_COLUMNS into a fish
+    * The text columns are copied from the statement straight into the fish, without temporary strings
     * @param db - the database
-    * @param fishId - the id of the fish
-    * @return a vector containing all the seasons of the fish
+    * @param statement - the statement positioned on a row
+    * @param userId - the id of the logged user
+    * @param fish - the fish to be filled
     */
-    vector<string> getSeasonsByFishId(sqlite3* db, long fishId) const;
+    void readFish(sqlite3* db, sqlite3_stmt* statement, const long userId, Fish& fish) const;
 
 
     /*
-    * @brief Finds the weathers based on the fish id
+    * @brief Steps a statement selecting the FISH_ROW_COLUMNS and passes every row to a visitor
+    * A single fish is filled row after row, and it is copied only if the visitor keeps it
+    * @param db - the database
+    * @param statement - the prepared statement, with its parameters bound
+    * @param userId - the id of the logged user
+    * @param visitor - called with the fish of every row
+    * @param limit - the maximum number of rows to step, or -1 for all of them
+    * @return the number of rows passed to the visitor, the statement stays on the last one if the limit was reached
+    */
+    int stepFish(sqlite3* db, sqlite3_stmt* statement, const long userId, const function<void(const Fish&)>& visitor, const int limit = -1) const;
+
+
+    /*
+    * @brief Finds the seasons based on the fish id
     * @param db - the database
     * @param fishId - the id of the fish
-    * @return a vector containing all the weathers of the fish
+    * @return the set of the seasons of the fish
     */
-    vector<string> getWeathersByFishId(sqlite3* db, long fishId) const;
+    SeasonSet getSeasonsByFishId(sqlite3* db, long fishId) const;
 
 
     /*
-    * @brief Finds the locations based on the fish id
+    * @brief Finds the weathers based on the fish id
     * @param db - the database
     * @param fishId - the id of the fish
-    * @return a vector containing all the locations of the fish
+    * @return the set of the weathers of the fish
     */
-    vector<string> getLocationsByFishId(sqlite3* db, long fishId) const;
+    WeatherSet getWeathersByFishId(sqlite3* db, long fishId) const;
 
 
     /*
-    * @brief Checks if the fish is caught by the user based on the fish id
+    * @brief Finds the locations based on the fish id
     * @param db - the database
     * @param fishId - the id of the fish
-    * @param userId - the id of the user
-    * @return a bool that is true if the fish is caught by the user and false otherwise
+    * @return the set of the locations of the fish
     */
-    bool getIsCaughtByFishId(sqlite3* db, long fishId, const long userId) const;
+    LocationSet getLocationsByFishId(sqlite3* db, long fishId) const;
 
 
     /*
-    * @brief Checks if the fish is favorite by the user based on the fish id
+    * @brief Checks if the fish is caught by the user and if it is a favorite of the user, based on the fish id
     * @param db - the database
     * @param fishId - the id of the fish
     * @param userId - the id of the user
-    * @return a bool that is true if the fish is favorite by the user and false otherwise
+    * @return a pair of bools, true if the fish is caught by the user and true if it is a favorite of the user
     */
-    bool getIsFavoriteByFishId(sqlite3* db, long fishId, const long userId) const;
+    pair<bool, bool> getFlagsByFishId(sqlite3* db, long fishId, const long userId) const;
 
 
     /*
@@ -306,6 +522,189 @@ public:
     void updateRelatedTable(sqlite3* db, const std::string& fishName, const std::vector<std::string>& items, const std::string& tableName, const std::string& itemIdColumn);
 
 
+    /*
+    * @brief Checks if a table of the database has the given column
+    * @param db - the database
+    * @param tableName - the name of the table
+    * @param columnName - the name of the column
+    * @return true if the table exists and has the column, false otherwise
+    */
+    bool hasColumn(sqlite3* db, const string& tableName, const string& columnName) const;
+
+
+    /*
+    * @brief Adds the image_hash column to the tables holding images, if it is missing
+    * Rows with a non-empty image BLOB keep their image inline, so the old and the new layout can be read side by side
+    * @param db - the database
+    */
+    void ensureImageHashColumns(sqlite3* db) const;
+
+
+    /*
+    * @brief Writes the hash of every inline image that has none into its image_hash column
+    * The images stay inline, but they are hashed once here instead of on every read
+    * @param db - the database
+    */
+    void hashInlineImages(sqlite3* db) const;
+
+
+    /*
+    * @brief Interns the names of the seasons, weathers and locations in the order of their ids
+    * The sets of the fish list their names in this order, as the tables do
+    * @param db - the database
+    */
+    void internAttributeNames(sqlite3* db);
+
+
+    /*
+    * @brief Adds the catch_windows column to the Fish table if it is missing, and fills it for the fish that have none
+    * The column holds the catching hours parsed into minute ranges (CatchTimes::encode)
+    * @param db - the database
+    */
+    void ensureCatchWindowsColumn(sqlite3* db) const;
+
+
+    /*
+    * @brief Registers the C++ functions used by the queries on a connection
+    * catchable_at(catch_windows, minute) - 1 if a fish with the given catch windows can be caught at the minute of the day
+    * @param db - the database
+    */
+    static void registerSqlFunctions(sqlite3* db);
+
+
+    /*
+    * @brief Prepares a connection once it is opened, with the busy timeout and the SQL functions
+    * @param db - the database connection
+    */
+    static void configureConnection(sqlite3* db);
+
+
+    /*
+    * @brief Creates the (value, id) indexes the fish pages are sorted and found by, if they are missing
+    * @param db - the database
+    */
+    void ensurePagingIndexes(sqlite3* db) const;
+
+
+    /*
+    * @brief Creates the (attribute id, fish id) and NOCASE name indexes the fish are filtered by, if they are missing
+    * @param db - the database
+    */
+    void ensureFilterIndexes(sqlite3* db) const;
+
+
+    /*
+    * @brief Creates the Users_Fish table if it is missing, and its unique index on the user and the fish
+    * The rows of the same user and fish are merged before the index is created
+    * @param db - the database
+    */
+    void ensureUserProgressTable(sqlite3* db) const;
+
+
+    /*
+    * @brief Checks if a table has a unique index on exactly the given columns
+    * @param db - the database
+    * @param tableName - the name of the table
+    * @param columns - the names of the columns, in any order
+    */
+    bool hasUniqueIndex(sqlite3* db, const string& tableName, const vector<string>& columns) const;
+
+
+    /*
+    * @brief Deletes the Users_Fish rows that hold neither a caught nor a favorite fish, once for every database
+    * @param db - the database
+    */
+    void compactUserProgress(sqlite3* db) const;
+
+
+    /*
+    * @brief Gives the write connection back to the writer pool, once the change tracker read the keys of its committed rows
+    * @param db - the write connection
+    */
+    void releaseWriteConnection(sqlite3* db) const;
+
+
+    /*
+    * @brief Gets the cached statement of a combination of the season, weather and location filters, preparing it on first use
+    * @param db - a connection of the readers pool, held by the caller
+    * @param shape - the filters that are set: 1 for the season, 2 for the weather, 4 for the location
+    * @return the statement of the connection, or nullptr if it could not be prepared
+    */
+    sqlite3_stmt* seasonWeatherLocationStatement(sqlite3* db, const int shape) const;
+
+
+    /*
+    * @brief Returns the statement reading the seasons, weathers, locations or flags of one fish, prepared once on every connection
+    * @param db - the connection, held by the caller
+    * @param detail - SEASONS_OF_FISH, WEATHERS_OF_FISH, LOCATIONS_OF_FISH or FLAGS_OF_FISH
+    * @return the statement of the connection, or nullptr if it could not be prepared
+    */
+    sqlite3_stmt* fishDetailStatement(sqlite3* db, const int detail) const;
+
+
+    /*
+    * @brief Builds the query of a combination of the season, weather and location filters
+    * The first filtered table drives the query, so the fish are found by an index search on the id of the attribute
+    * @param shape - the filters that are set: 1 for the season, 2 for the weather, 4 for the location
+    * @return the query, with the season, weather and location names at ?1, ?2 and ?3
+    */
+    static string buildSeasonWeatherLocationQuery(const int shape);
+
+
+    /*
+    * @brief Builds the opaque cursor of the page that follows a fish
+    * @param request - the request of the current page
+    * @param id - the id of the last fish of the current page
+    * @param sortValue - the sort value of the last fish of the current page
+    * @return the cursor
+    */
+    static string encodePageCursor(const FishPageRequest& request, const long id, const string_view sortValue);
+
+
+    /*
+    * @brief Reads a cursor built by encodePageCursor
+    * @param request - the request holding the cursor
+    * @param id - receives the id of the last fish of the previous page
+    * @param sortValue - receives the sort value of the last fish of the previous page
+    * @return true if the cursor is valid for the sort key and direction of the request
+    */
+    static bool decodePageCursor(const FishPageRequest& request, long& id, string& sortValue);
+
+
+    /*
+    * @brief Reads the image of the current row, either from the image store or from the inline BLOB
+    * @param statement - the statement positioned on a row
+    * @param blobColumn - the index of the image column
+    * @param hashColumn - the index of the image hash column
+    * @param imageHash - receives the hash of the image, or an empty string if the image is stored inline
+    * @return the image of the row
+    */
+    vector<char> readImage(sqlite3_stmt* statement, int blobColumn, int hashColumn, string& imageHash) const;
+
+
+    /*
+    * @brief Returns a view over the image of the current row without copying it
+    * The view points into the image store or into the statement, so it is valid until the statement is stepped again
+    * @param statement - the statement positioned on a row
+    * @param blobColumn - the index of the image column
+    * @param hashColumn - the index of the image hash column
+    * @return a view over the image of the row
+    */
+    ImageView viewImage(sqlite3_stmt* statement, int blobColumn, int hashColumn) const;
+
+
+    /*
+    * @brief Binds an image to the image and image_hash parameters of a statement
+    * The image is added to the image store and only its hash is bound, the BLOB is bound inline only if the store is unavailable
+    * @param statement - the statement
+    * @param blobParameter - the index of the image parameter
+    * @param hashParameter - the index of the image_hash parameter
+    * @param image - the image to be bound
+    */
+    void bindImage(sqlite3_stmt* statement, int blobParameter, int hashParameter, const ImageView& image);
+    void bindImage(sqlite3_stmt* statement, int blobParameter, int hashParameter, const std::vector<char>& image);
+
+
 };
 
 #endif // FISHDBREPOSITORY_H
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef FISHPAGE_H
+#define FISHPAGE_H
+
+#include "../model/Fish.h"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// The values the fish pages can be sorted by, each backed by a (value, id) index
+enum class FishSortKey { Name, Difficulty, Category };
+
+enum class SortDirection { Ascending, Descending };
+
+
+/**
+ * @brief A request for one page of fish
+ * Pages are found by keyset: the cursor holds the sort value and the id of the last fish of the previous page,
+ * so every page costs the same to read no matter how deep it is
+ */
+struct FishPageRequest {
+	FishSortKey sortKey = FishSortKey::Name;
+	SortDirection direction = SortDirection::Ascending;
+
+	// Maximum number of fish in the page
+	int limit = 50;
+
+	// The cursor returned with the previous page, or an empty string for the first page
+	string cursor;
+};
+
+
+/**
+ * @brief One page of fish, with the cursor of the page that follows it
+ */
+struct FishPage {
+	vector<Fish> fish;
+
+	// The cursor of the next page, or an empty string if this is the last page
+	string nextCursor;
+};
+
+#endif // FISHPAGE_H
@@ -1,6 +1,7 @@
 #ifndef REPOSITORY_H
 #define REPOSITORY_H
 
+#include <functional>
 #include <memory>
 #include <vector>
 #include <string>
@@ -24,18 +25,39 @@ public:
      */
     virtual T findOne(long id, const long userId) const = 0;
 
+    /**
+     *  @brief Searches and returns the entities with the given IDs, reading all of them in a single transaction
+     *  @param ids - the IDs of the entities to be returned
+     *  @return the entities that were found, in the order of their IDs
+     */
+    virtual vector<T> findMany(const vector<long>& ids, const long userId) const = 0;
+
     /**
      *  @brief Returns all the entities from the database
      *  @return all entities
      */
     virtual vector<T> findAll(const long userId) const = 0;
 
+    /**
+     * @brief Streams all the entities from the database, one at a time, without collecting them
+     * The entity passed to the visitor is only valid during the call, the visitor copies it if it keeps it
+     * @param visitor - called with every entity, in the order in which they are read
+     */
+    virtual void forEach(const long userId, const function<void(const T&)>& visitor) const = 0;
+
     /**
      * @brief Saves the given entity in the database
      * @param entity
      */
     virtual void save(T& entity) = 0;
 
+    /**
+     * @brief Saves the given entities in the database, in a single transaction
+     * Either all the entities are saved or, if one of them fails, none of them
+     * @param entities
+     */
+    virtual void saveAll(vector<T>& entities) = 0;
+
     /**
      * @brief Removes the entity with the specified ID
      * @param id - ID must not be null
@@ -48,6 +70,14 @@ public:
      */
     virtual T update(const T& entity, const long userId) = 0;
 
+    /**
+     * @brief Updates the entities with their new values, in a single transaction
+     * Either all the entities are updated or, if one of them fails, none of them
+     * @param entities
+     * @return the updated entities, or an empty vector if the update failed
+     */
+    virtual vector<T> updateAll(const vector<T>& entities, const long userId) = 0;
+
     virtual ~IRepository() {}
 };
 
@@ -0,0 +1,266 @@
+#include "ImageStore.h"
+#include <QFileInfo>
+#include <qDebug>
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+// Every index record holds the raw SHA-256 hash of an image followed by its offset and size in the pack file
+static const int HASH_BYTES = 32;
+static const int INDEX_RECORD_BYTES = HASH_BYTES + 2 * sizeof(quint64);
+
+// The size of the chunks the pack file is copied in
+static const qint64 COPY_CHUNK_BYTES = 1024 * 1024;
+
+
+
+/*
+	Function that copies the first bytes of a file into another file, replacing it.
+	Params:
+		sourcePath - the path to the file that is copied
+		destinationPath - the path to the copy
+		size - the number of bytes copied
+*/
+static bool copyFilePrefix(const string& sourcePath, const string& destinationPath, const qint64 size) {
+	QFile source(QString::fromStdString(sourcePath));
+	QFile destination(QString::fromStdString(destinationPath));
+	if (!source.open(QIODevice::ReadOnly) || !destination.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		qWarning() << "Failed to copy the image file " << sourcePath.c_str() << ": " << source.errorString() << destination.errorString();
+		return false;
+	}
+
+	for (qint64 left = size; left > 0;) {
+		const QByteArray chunk = source.read(min(left, COPY_CHUNK_BYTES));
+		if (chunk.isEmpty() || destination.write(chunk) != chunk.size()) {
+			qWarning() << "Failed to copy the image file " << sourcePath.c_str() << ": " << destination.errorString();
+			return false;
+		}
+		left -= chunk.size();
+	}
+	destination.close();
+	return true;
+}
+
+
+
+/*
+	Constructor for the ImageStore class.
+	Loads the offset index, the pack file is mapped by the first lookup.
+	Params:
+		packPath - the path to the pack file
+*/
+ImageStore::ImageStore(const string& packPath) : packPath(packPath), indexPath(packPath + ".idx") {
+	loadIndex();
+}
+
+
+
+bool ImageStore::isOpen() const {
+	return !packPath.empty();
+}
+
+
+
+/*
+	Function that reads every record of the index file into the in-memory index.
+	Records pointing past the end of the pack file (e.g. after an interrupted write) are ignored when the images are looked up.
+	A partial record at the end of the index file is cut off, so the records appended after it stay aligned.
+*/
+void ImageStore::loadIndex() {
+	QFile indexFile(QString::fromStdString(indexPath));
+	if (!indexFile.open(QIODevice::ReadOnly)) {
+		return;
+	}
+
+	const QByteArray records = indexFile.readAll();
+	indexFile.close();
+
+	const qsizetype alignedSize = records.size() - records.size() % INDEX_RECORD_BYTES;
+	if (alignedSize != records.size() && !indexFile.resize(alignedSize)) {
+		qWarning() << "Failed to cut the partial record off the image index file: " << indexFile.errorString();
+	}
+
+	for (qsizetype position = 0; position + INDEX_RECORD_BYTES <= records.size(); position += INDEX_RECORD_BYTES) {
+		const char* record = records.constData() + position;
+
+		Entry entry;
+		memcpy(&entry.offset, record + HASH_BYTES, sizeof(quint64));
+		memcpy(&entry.size, record + HASH_BYTES + sizeof(quint64), sizeof(quint64));
+
+		index[QByteArray::fromRawData(record, HASH_BYTES).toHex().toStdString()] = entry;
+	}
+}
+
+
+
+/*
+	Function that maps the whole pack file into memory.
+	The previous mapping is only released once the views handed out over it are gone, so they stay valid.
+*/
+void ImageStore::mapPack() const {
+	shared_ptr<Mapping> packMapping = make_shared<Mapping>();
+	packMapping->file.setFileName(QString::fromStdString(packPath));
+	if (!packMapping->file.open(QIODevice::ReadOnly) || packMapping->file.size() == 0) {
+		return;
+	}
+
+	packMapping->size = packMapping->file.size();
+	packMapping->data = packMapping->file.map(0, packMapping->size);
+	if (packMapping->data == nullptr) {
+		qWarning() << "Failed to map the image pack file: " << packMapping->file.errorString();
+		return;
+	}
+
+	mapping = std::move(packMapping);
+}
+
+
+
+/*
+	Function that adds an image to the pack file and to the index.
+	If an image with the same content is already stored, nothing is written. The pack file is not mapped again here: a batch of images,
+	like a migration, is written without remapping, and the first lookup past the end of the mapping maps the grown file once.
+	Params:
+		data - the image bytes
+		size - the number of image bytes
+*/
+string ImageStore::put(const char* data, size_t size) {
+	if (size == 0 || !isOpen()) {
+		return "";
+	}
+
+	string hash = hashOf(data, size);
+
+	lock_guard<mutex> lock(storeMutex);
+	if (index.find(hash) != index.end()) {
+		return hash;
+	}
+
+	// Append the image to the pack file
+	QFile packFile(QString::fromStdString(packPath));
+	if (!packFile.open(QIODevice::Append)) {
+		qWarning() << "Failed to open the image pack file: " << packFile.errorString();
+		return "";
+	}
+	Entry entry{ static_cast<quint64>(packFile.size()), static_cast<quint64>(size) };
+	if (packFile.write(data, size) != static_cast<qint64>(size)) {
+		qWarning() << "Failed to write to the image pack file: " << packFile.errorString();
+		return "";
+	}
+	packFile.close();
+
+	// Append the record to the index file, only after the image itself was written
+	QByteArray record = QByteArray::fromHex(QByteArray::fromStdString(hash));
+	record.append(reinterpret_cast<const char*>(&entry.offset), sizeof(quint64));
+	record.append(reinterpret_cast<const char*>(&entry.size), sizeof(quint64));
+
+	QFile indexFile(QString::fromStdString(indexPath));
+	if (!indexFile.open(QIODevice::Append) || indexFile.write(record) != record.size()) {
+		qWarning() << "Failed to write to the image index file: " << indexFile.errorString();
+		return "";
+	}
+	indexFile.close();
+
+	index[hash] = entry;
+	return hash;
+}
+
+
+
+/*
+	Function that returns a view over the bytes of the image with the given hash.
+	Params:
+		hash - the hash of the image
+*/
+ImageView ImageStore::find(const string& hash) const {
+	lock_guard<mutex> lock(storeMutex);
+
+	auto entry = index.find(hash);
+	if (entry == index.end()) {
+		return ImageView();
+	}
+
+	// The image was added after the pack file was mapped
+	const quint64 end = entry->second.offset + entry->second.size;
+	if (mapping == nullptr || end > static_cast<quint64>(mapping->size)) {
+		mapPack();
+	}
+	if (mapping == nullptr || end > static_cast<quint64>(mapping->size)) {
+		return ImageView();
+	}
+
+	return ImageView{ reinterpret_cast<const char*>(mapping->data) + entry->second.offset, static_cast<size_t>(entry->second.size), mapping };
+}
+
+
+
+/*
+	Function that copies the pack file and its index next to a snapshot.
+	The sizes are read under the lock, where an image is always written to the pack before its record is written to the index,
+	so every record copied points at bytes that are copied too. The images added while the copy runs are left out.
+	Params:
+		destinationPackPath - the path to the copy of the pack file
+*/
+bool ImageStore::copyTo(const string& destinationPackPath) const {
+	if (!isOpen()) {
+		return true;
+	}
+
+	qint64 packSize = 0;
+	qint64 indexSize = 0;
+	{
+		lock_guard<mutex> lock(storeMutex);
+		packSize = QFileInfo(QString::fromStdString(packPath)).size();
+		indexSize = QFileInfo(QString::fromStdString(indexPath)).size();
+	}
+	if (indexSize == 0) {
+		return true;
+	}
+
+	return copyFilePrefix(packPath, destinationPackPath, packSize) && copyFilePrefix(indexPath, destinationPackPath + ".idx", indexSize);
+}
+
+
+
+/*
+	Function that appends the images of another pack file that are not in the store yet.
+	Every image is hashed again when it is added, so a damaged image of the other pack is not stored under the hash of the original.
+	Params:
+		sourcePackPath - the path to the other pack file
+*/
+bool ImageStore::importFrom(const string& sourcePackPath) {
+	if (!isOpen()) {
+		return false;
+	}
+
+	const ImageStore source(sourcePackPath);
+	bool imported = true;
+	for (const auto& [hash, entry] : source.index) {
+		{
+			lock_guard<mutex> lock(storeMutex);
+			if (index.find(hash) != index.end()) {
+				continue;
+			}
+		}
+
+		const ImageView image = source.find(hash);
+		if (image.empty() || put(image.data, image.size) != hash) {
+			qWarning() << "The image " << hash.c_str() << " of " << sourcePackPath.c_str() << " is missing or damaged";
+			imported = false;
+		}
+	}
+	return imported;
+}
+
+
+
+bool ImageStore::contains(const string& hash) const {
+	return !find(hash).empty();
+}
+
+
+
+string ImageStore::hashOf(const char* data, size_t size) {
+	return QCryptographicHash::hash(QByteArray::fromRawData(data, size), QCryptographicHash::Sha256).toHex().toStdString();
+}
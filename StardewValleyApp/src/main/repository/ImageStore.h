@@ -0,0 +1,128 @@
+#ifndef IMAGESTORE_H
+#define IMAGESTORE_H
+
+#include "../model/ImageView.h"
+#include <QFile>
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief The ImageStore class
+ * Content-addressed storage for the image BLOBs of the Fish, Images and Users tables
+ * Images are appended once to a pack file and found through an offset index keyed by their SHA-256 hash,
+ * so duplicated images are stored only once and database rows only keep the hash of their image
+ */
+class ImageStore {
+private:
+	struct Entry {
+		quint64 offset;
+		quint64 size;
+	};
+
+	// The file is unmapped and closed when the last view of the mapping is dropped
+	struct Mapping {
+		QFile file;
+		const uchar* data = nullptr;
+		qint64 size = 0;
+	};
+
+	string packPath;
+	string indexPath;
+	unordered_map<string, Entry> index;
+
+	// The mapping of the pack file, replaced by a larger one when an image past its end is looked up
+	mutable shared_ptr<const Mapping> mapping;
+	mutable mutex storeMutex;
+
+	void loadIndex();
+
+	/*
+	* @brief Maps the whole pack file, replacing the current mapping
+	* Must be called with storeMutex locked
+	*/
+	void mapPack() const;
+
+public:
+
+	/*
+	* Default constructor, the store stays closed
+	*/
+	ImageStore() = default;
+
+	ImageStore(const ImageStore& other) = delete;
+
+	/*
+	* @brief Opens the store backed by the given pack file and its ".idx" index file
+	* @param packPath - the path to the pack file
+	*/
+	ImageStore(const string& packPath);
+
+
+	/*
+	* @brief Checks if the store is backed by a pack file
+	* @return true if the store was opened with a pack path
+	*/
+	bool isOpen() const;
+
+
+	/*
+	* @brief Adds an image to the store, if it is not already stored
+	* @param data - the image bytes
+	* @param size - the number of image bytes
+	* @return the hash under which the image is stored, or an empty string for an empty image
+	*/
+	string put(const char* data, size_t size);
+
+
+	/*
+	* @brief Finds an image by its hash
+	* The returned view stays valid for as long as it is kept, even if other images are added later or the store is destroyed
+	* @param hash - the hash of the image
+	* @return a view over the image bytes, or an empty view if there is no image with the given hash
+	*/
+	ImageView find(const string& hash) const;
+
+
+	/*
+	* @brief Checks if an image with the given hash is stored
+	* @param hash - the hash of the image
+	* @return true if the image is stored
+	*/
+	bool contains(const string& hash) const;
+
+
+	/*
+	* @brief Copies the pack file and its index next to a snapshot of the database
+	* The two files only grow, so the bytes they hold when the copy starts are copied without keeping the images locked
+	* @param destinationPackPath - the path of the copy of the pack file, its index is copied next to it with ".idx"
+	* @return true if the files were copied, or if there is no image to copy
+	*/
+	bool copyTo(const string& destinationPackPath) const;
+
+
+	/*
+	* @brief Adds the images of another pack file that are not stored yet, like the pack copied next to a snapshot
+	* The images already stored are kept, so the views handed out and the rows pointing at them stay valid
+	* @param sourcePackPath - the path of the other pack file, with its index next to it
+	* @return true if every image of the other pack is stored
+	*/
+	bool importFrom(const string& sourcePackPath);
+
+
+	/*
+	* @brief Computes the hash used to address an image
+	* @param data - the image bytes
+	* @param size - the number of image bytes
+	* @return the hexadecimal SHA-256 hash of the image
+	*/
+	static string hashOf(const char* data, size_t size);
+};
+
+#endif // IMAGESTORE_H
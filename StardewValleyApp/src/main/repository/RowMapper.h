@@ -0,0 +1,89 @@
+#ifndef ROWMAPPER_H
+#define ROWMAPPER_H
+
+#include "../../resources/sqlite/sqlite3.h"
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+/**
+ * @brief Reads a column of the current row of a statement as the given type
+ * Text is returned as a view into the statement, valid until the statement is stepped, reset or finalized
+ */
+template <typename T>
+struct ColumnType;
+
+template <>
+struct ColumnType<long> {
+	static long read(sqlite3_stmt* statement, int index) {
+		return static_cast<long>(sqlite3_column_int64(statement, index));
+	}
+};
+
+template <>
+struct ColumnType<bool> {
+	static bool read(sqlite3_stmt* statement, int index) {
+		return sqlite3_column_int(statement, index) != 0;
+	}
+};
+
+template <>
+struct ColumnType<string_view> {
+	static string_view read(sqlite3_stmt* statement, int index) {
+		// sqlite3_column_text has to be called before sqlite3_column_bytes, so the byte count is the one of the text
+		const unsigned char* text = sqlite3_column_text(statement, index);
+		if (text == nullptr) {
+			return string_view();
+		}
+		return string_view(reinterpret_cast<const char*>(text), static_cast<size_t>(sqlite3_column_bytes(statement, index)));
+	}
+};
+
+
+/**
+ * @brief A column of a result row, with its position in the SELECT list and the type it is read as
+ */
+template <int Index, typename T>
+struct Column {
+	static constexpr int index = Index;
+	using type = T;
+
+	/*
+	* @brief Reads the column from the current row
+	* @param statement - the statement positioned on a row
+	* @return the value of the column
+	*/
+	static T read(sqlite3_stmt* statement) {
+		return ColumnType<T>::read(statement, Index);
+	}
+};
+
+
+// The columns selected by every query that returns fish, in the order of the FishRow positions
+// Kept as a macro so the queries are concatenated with it at compile time
+#define FISH_ROW_COLUMNS "f.id, f.name, f.category, f.description, f.start_catching_hour, f.end_catching_hour, f.difficulty, f.movement, f.image, f.image_hash, f.catch_windows"
+
+
+/**
+ * @brief The positions and types of the FISH_ROW_COLUMNS
+ * The text columns are read as views into the statement and copied straight into the Fish they are mapped to
+ */
+struct FishRow {
+	using Id = Column<0, long>;
+	using Name = Column<1, string_view>;
+	using Category = Column<2, string_view>;
+	using Description = Column<3, string_view>;
+	using StartCatchingHour = Column<4, string_view>;
+	using EndCatchingHour = Column<5, string_view>;
+	using Difficulty = Column<6, long>;
+	using Movement = Column<7, string_view>;
+	using Image = Column<8, string_view>;
+	using ImageHash = Column<9, string_view>;
+	using CatchWindows = Column<10, string_view>;
+
+	// Number of columns of the row
+	static constexpr int COUNT = 11;
+};
+
+#endif // ROWMAPPER_H
@@ -0,0 +1,190 @@
+#include "SpriteAtlas.h"
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+#include <qDebug>
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+
+
+bool SpriteAtlas::fitsAtlas(const QSize& size, qsizetype encodedBytes) {
+	return qMax(size.width(), size.height()) <= MAX_SPRITE_SIDE || encodedBytes <= MAX_PACKED_BYTES;
+}
+
+
+
+/*
+	Function that packs the given images into a new atlas texture.
+	Every image is scaled down to MAX_SPRITE_SIDE if needed, then placed on shelves: the images are sorted by height
+	and laid left to right, and a new shelf is started under the tallest image of the previous one when the row is full.
+	Params:
+		images - the images to pack, by name
+		signature - the signature of the source images
+*/
+void SpriteAtlas::pack(const QMap<QString, QImage>& images, const QByteArray& signature) {
+	this->signature = signature;
+	rects.clear();
+
+	// Scale the images down and sort them from the tallest to the shortest
+	vector<pair<QString, QImage>> sprites;
+	for (auto image = images.cbegin(); image != images.cend(); ++image) {
+		QImage sprite = image.value();
+		if (qMax(sprite.width(), sprite.height()) > MAX_SPRITE_SIDE) {
+			sprite = sprite.scaled(MAX_SPRITE_SIDE, MAX_SPRITE_SIDE, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+		}
+		sprites.emplace_back(image.key(), sprite);
+	}
+	stable_sort(sprites.begin(), sprites.end(), [](const auto& first, const auto& second) {
+		return first.second.height() > second.second.height();
+	});
+
+	// Place the sprites on shelves
+	int x = PADDING;
+	int y = PADDING;
+	int shelfHeight = 0;
+	for (const auto& [name, sprite] : sprites) {
+		if (x + sprite.width() + PADDING > ATLAS_WIDTH) {
+			x = PADDING;
+			y += shelfHeight + PADDING;
+			shelfHeight = 0;
+		}
+		rects.insert(name, QRect(x, y, sprite.width(), sprite.height()));
+		x += sprite.width() + PADDING;
+		shelfHeight = qMax(shelfHeight, sprite.height());
+	}
+
+	// Draw the sprites into the texture
+	QImage atlas(ATLAS_WIDTH, qMax(y + shelfHeight + PADDING, 1), QImage::Format_ARGB32_Premultiplied);
+	atlas.fill(Qt::transparent);
+
+	QPainter painter(&atlas);
+	for (const auto& [name, sprite] : sprites) {
+		painter.drawImage(rects.value(name).topLeft(), sprite);
+	}
+	painter.end();
+
+	texture = QPixmap::fromImage(atlas);
+}
+
+
+
+/*
+	Function that saves the atlas texture as PNG and its rectangle table as text.
+	The first line of the table holds the signature, every other line a tab separated name and rectangle.
+	Params:
+		atlasPath - the path of the texture
+*/
+bool SpriteAtlas::save(const QString& atlasPath) const {
+	if (!texture.save(atlasPath, "PNG")) {
+		qWarning() << "Failed to save the sprite atlas: " << atlasPath;
+		return false;
+	}
+
+	QFile indexFile(atlasPath + ".idx");
+	if (!indexFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+		qWarning() << "Failed to save the sprite atlas index: " << indexFile.errorString();
+		return false;
+	}
+
+	QTextStream stream(&indexFile);
+	stream << signature << "\n";
+	for (auto rect = rects.cbegin(); rect != rects.cend(); ++rect) {
+		stream << rect.key() << "\t" << rect.value().x() << "\t" << rect.value().y() << "\t" << rect.value().width() << "\t" << rect.value().height() << "\n";
+	}
+	return true;
+}
+
+
+
+/*
+	Function that loads an atlas saved before.
+	The atlas is rejected if it was built from other source images than the current ones.
+	Params:
+		atlasPath - the path of the texture
+		signature - the signature of the current source images
+*/
+bool SpriteAtlas::load(const QString& atlasPath, const QByteArray& signature) {
+	QFile indexFile(atlasPath + ".idx");
+	if (!indexFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		return false;
+	}
+
+	QTextStream stream(&indexFile);
+	if (stream.readLine().toLatin1() != signature) {
+		return false;
+	}
+
+	QHash<QString, QRect> loadedRects;
+	while (!stream.atEnd()) {
+		const QStringList fields = stream.readLine().split('\t');
+		if (fields.size() != 5) {
+			continue;
+		}
+		loadedRects.insert(fields[0], QRect(fields[1].toInt(), fields[2].toInt(), fields[3].toInt(), fields[4].toInt()));
+	}
+
+	QImage atlas;
+	if (!atlas.load(atlasPath, "PNG")) {
+		return false;
+	}
+
+	this->signature = signature;
+	rects = loadedRects;
+	texture = QPixmap::fromImage(atlas);
+	return true;
+}
+
+
+
+void SpriteAtlas::insertStandalone(const QString& name, const QPixmap& pixmap) {
+	standalone.insert(name, pixmap);
+}
+
+
+
+bool SpriteAtlas::contains(const QString& name) const {
+	return rects.contains(name) || standalone.contains(name);
+}
+
+
+
+bool SpriteAtlas::isPacked(const QString& name) const {
+	return rects.contains(name);
+}
+
+
+
+/*
+	Function that returns the sprite of an image, from the atlas texture or from the standalone images.
+	Params:
+		name - the name of the image
+*/
+Sprite SpriteAtlas::value(const QString& name) const {
+	auto rect = rects.constFind(name);
+	if (rect != rects.cend()) {
+		return Sprite(texture, rect.value());
+	}
+
+	auto pixmap = standalone.constFind(name);
+	if (pixmap != standalone.cend()) {
+		return Sprite(pixmap.value());
+	}
+
+	qWarning() << "Image not found in the sprite atlas: " << name;
+	return Sprite();
+}
+
+
+
+QPixmap SpriteAtlas::pixmap(const QString& name) const {
+	return value(name).toPixmap();
+}
+
+
+
+void SpriteAtlas::draw(QPainter& painter, const QRectF& target, const QString& name) const {
+	value(name).draw(painter, target);
+}
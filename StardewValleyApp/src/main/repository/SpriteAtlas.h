@@ -0,0 +1,201 @@
+#ifndef SPRITEATLAS_H
+#define SPRITEATLAS_H
+
+#include <QPixmap>
+#include <QImage>
+#include <QPainter>
+#include <QHash>
+#include <QMap>
+#include <QRect>
+#include <QString>
+#include <QByteArray>
+
+using namespace std;
+
+/**
+ * @brief A rectangle of a pixmap, drawn without being copied out of it
+ * Sprites of the atlas share the single atlas texture, standalone images use their whole pixmap
+ */
+class Sprite {
+private:
+	QPixmap texture;
+	QRect source;
+
+public:
+
+	/*
+	* Default constructor, the sprite is null
+	*/
+	Sprite() = default;
+
+	/*
+	* @brief Wraps a whole pixmap into a sprite
+	* @param pixmap - the pixmap
+	*/
+	Sprite(const QPixmap& pixmap) : texture(pixmap), source(pixmap.rect()) {}
+
+	/*
+	* @brief Creates a sprite from a rectangle of a texture
+	* @param texture - the texture holding the sprite
+	* @param source - the rectangle of the sprite in the texture
+	*/
+	Sprite(const QPixmap& texture, const QRect& source) : texture(texture), source(source) {}
+
+
+	/*
+	* @brief Checks if the sprite has no image
+	* @return true if the sprite has no image
+	*/
+	bool isNull() const { return texture.isNull() || source.isEmpty(); }
+
+
+	/*
+	* @brief Returns the texture holding the sprite
+	* @return the texture
+	*/
+	const QPixmap& getTexture() const { return texture; }
+
+
+	/*
+	* @brief Returns the rectangle of the sprite in its texture
+	* @return the rectangle of the sprite
+	*/
+	const QRect& getSource() const { return source; }
+
+
+	/*
+	* @brief Returns the size of the sprite in the texture
+	* @return the size of the sprite
+	*/
+	QSize size() const { return source.size(); }
+
+
+	/*
+	* @brief Draws the sprite scaled into the target rectangle
+	* @param painter - the painter to draw with
+	* @param target - the rectangle to draw into
+	*/
+	void draw(QPainter& painter, const QRectF& target) const { painter.drawPixmap(target, texture, QRectF(source)); }
+
+
+	/*
+	* @brief Returns the sprite as a pixmap of its own, for the widgets that need one (QLabel, QIcon)
+	* Sprites from the atlas are copied out of the texture, standalone images are returned as they are
+	* @return the pixmap of the sprite
+	*/
+	QPixmap toPixmap() const { return source == texture.rect() ? texture : texture.copy(source); }
+};
+
+
+/**
+ * @brief The SpriteAtlas class
+ * Packs the small UI images of the Images table into one texture, with a name to rectangle table
+ * The texture and the table are saved next to the database, so later runs decode a single image at startup
+ * Images that are too large for the atlas are kept as standalone pixmaps under the same names
+ */
+class SpriteAtlas {
+private:
+	QPixmap texture;
+	QHash<QString, QRect> rects;
+	QHash<QString, QPixmap> standalone;
+	QByteArray signature;
+
+public:
+
+	// Longest side of a sprite in the atlas, larger images are scaled down to it
+	static const int MAX_SPRITE_SIDE = 512;
+
+	// Larger images are packed only if their encoded size shows they are simple (flat, upscaled pixel art)
+	static const int MAX_PACKED_BYTES = 16 * 1024;
+
+	// Width of the atlas texture
+	static const int ATLAS_WIDTH = 2048;
+
+	// Transparent gap around every sprite, so smooth scaling does not bleed neighbouring sprites in
+	static const int PADDING = 2;
+
+
+	/*
+	* @brief Checks if an image belongs in the atlas
+	* @param size - the size of the image
+	* @param encodedBytes - the size of the encoded image
+	* @return true if the image should be packed, false if it should stay standalone
+	*/
+	static bool fitsAtlas(const QSize& size, qsizetype encodedBytes);
+
+
+	/*
+	* @brief Packs images into the atlas texture, replacing its content
+	* @param images - the images to pack, by name
+	* @param signature - the signature of the source images, saved with the atlas
+	*/
+	void pack(const QMap<QString, QImage>& images, const QByteArray& signature);
+
+
+	/*
+	* @brief Saves the atlas texture and its rectangle table
+	* @param atlasPath - the path of the texture, the table is saved to atlasPath + ".idx"
+	* @return true if both files were written
+	*/
+	bool save(const QString& atlasPath) const;
+
+
+	/*
+	* @brief Loads an atlas saved before, if it was built from the same source images
+	* @param atlasPath - the path of the texture
+	* @param signature - the signature of the current source images
+	* @return true if the atlas was loaded, false if it is missing or stale
+	*/
+	bool load(const QString& atlasPath, const QByteArray& signature);
+
+
+	/*
+	* @brief Adds an image that is not packed into the atlas
+	* @param name - the name of the image
+	* @param pixmap - the image
+	*/
+	void insertStandalone(const QString& name, const QPixmap& pixmap);
+
+
+	/*
+	* @brief Checks if the atlas holds an image, packed or standalone
+	* @param name - the name of the image
+	* @return true if the image is known
+	*/
+	bool contains(const QString& name) const;
+
+
+	/*
+	* @brief Checks if an image is packed in the atlas texture
+	* @param name - the name of the image
+	* @return true if the image is packed
+	*/
+	bool isPacked(const QString& name) const;
+
+
+	/*
+	* @brief Returns the sprite of an image
+	* @param name - the name of the image
+	* @return the sprite, or a null sprite if the image is unknown
+	*/
+	Sprite value(const QString& name) const;
+
+
+	/*
+	* @brief Returns an image as a pixmap of its own, for the widgets that cannot draw sprites
+	* @param name - the name of the image
+	* @return the pixmap, or a null pixmap if the image is unknown
+	*/
+	QPixmap pixmap(const QString& name) const;
+
+
+	/*
+	* @brief Draws an image scaled into the target rectangle
+	* @param painter - the painter to draw with
+	* @param target - the rectangle to draw into
+	* @param name - the name of the image
+	*/
+	void draw(QPainter& painter, const QRectF& target, const QString& name) const;
+};
+
+#endif // SPRITEATLAS_H
@@ -0,0 +1,488 @@
+#include "CatalogHttpServer.h"
+#include "../service/FishQuery.h"
+#include "../utils/JsonWriter.h"
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUrlQuery>
+#include <QRandomGenerator>
+#include <QDebug>
+#include <utility>
+
+static const char* reasonPhrase(const int status)
+{
+    switch (status) {
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 413: return "Payload Too Large";
+    case 431: return "Request Header Fields Too Large";
+    case 501: return "Not Implemented";
+    default: return "Internal Server Error";
+    }
+}
+
+static int errorBody(string& body, const int status, const string_view message)
+{
+    JsonWriter(body).beginObject().key("error").text(message).endObject();
+    return status;
+}
+
+// Tell if the Host of a request names the loopback interface the server listens on, with or without a port
+static bool isLocalHost(const QByteArray& host)
+{
+    const qsizetype colon = host.indexOf(':');
+    const QByteArray name = colon < 0 ? host : host.left(colon);
+    if (colon >= 0) {
+        bool isPort = false;
+        host.mid(colon + 1).toUShort(&isPort);
+        if (!isPort) {
+            return false;
+        }
+    }
+    return name == "127.0.0.1" || name.toLower() == "localhost";
+}
+
+CatalogHttpServer::CatalogHttpServer(Service& service, const vector<string>& allowedOrigins)
+    : QObject(nullptr), service(service)
+{
+    quint32 words[4];
+    QRandomGenerator::system()->fillRange(words);
+    token = QByteArray(reinterpret_cast<const char*>(words), sizeof(words)).toHex();
+
+    for (const string& origin : allowedOrigins) {
+        this->allowedOrigins.append(QByteArray::fromStdString(origin));
+    }
+}
+
+CatalogHttpServer::~CatalogHttpServer()
+{
+    stop();
+}
+
+bool CatalogHttpServer::start(const quint16 port)
+{
+    if (thread.isRunning()) {
+        return false;
+    }
+    thread.setObjectName("CatalogHttpServer");
+    moveToThread(&thread);
+    thread.start();
+
+    // The server and its sockets are created in the server thread, so their events are handled there
+    bool listening = false;
+    QMetaObject::invokeMethod(this, [this, port, &listening]() {
+        tcpServer = new QTcpServer(this);
+        connect(tcpServer, &QTcpServer::newConnection, this, &CatalogHttpServer::onNewConnection);
+        listening = tcpServer->listen(QHostAddress::LocalHost, port);
+        if (!listening) {
+            qDebug() << "Failed to start the HTTP server on port " << port << ": " << tcpServer->errorString();
+        }
+    }, Qt::BlockingQueuedConnection);
+
+    if (!listening) {
+        stop();
+    }
+    return listening;
+}
+
+const QByteArray& CatalogHttpServer::getToken() const
+{
+    return token;
+}
+
+void CatalogHttpServer::stop()
+{
+    if (!thread.isRunning()) {
+        return;
+    }
+    QMetaObject::invokeMethod(this, [this]() {
+        for (auto socket = receivedBytes.keyBegin(); socket != receivedBytes.keyEnd(); ++socket) {
+            (*socket)->disconnect(this);
+            (*socket)->abort();
+        }
+        receivedBytes.clear();
+        delete tcpServer;
+        tcpServer = nullptr;
+        catalogs.clear();
+        userIds.clear();
+        userIdsVersion = 0;
+    }, Qt::BlockingQueuedConnection);
+    thread.quit();
+    thread.wait();
+}
+
+void CatalogHttpServer::onNewConnection()
+{
+    while (QTcpSocket* socket = tcpServer->nextPendingConnection()) {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        receivedBytes.insert(socket, QByteArray());
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            receivedBytes.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void CatalogHttpServer::onReadyRead(QTcpSocket* socket)
+{
+    auto bytes = receivedBytes.find(socket);
+    if (bytes == receivedBytes.end()) {
+        return;
+    }
+    bytes->append(socket->readAll());
+
+    // A connection kept alive may send the next requests before the answer of the first one
+    while (true) {
+        HttpRequest request;
+        const int result = takeRequest(*bytes, request);
+        if (result == 0) {
+            return;
+        }
+
+        string body = acquireBuffer();
+        if (result != 1) {
+            errorBody(body, result, reasonPhrase(result));
+            writeResponse(socket, result, body, 0, false, QByteArray());
+            releaseBuffer(move(body));
+            socket->disconnectFromHost();
+            return;
+        }
+
+        // Any page may read the answers, but only the allowed origins are told they may write
+        const QByteArray allowOrigin = isAllowedOrigin(request.origin) ? request.origin
+            : request.method == "GET" || request.method == "OPTIONS" ? QByteArray("*") : QByteArray();
+
+        uint64_t version = 0;
+        const int status = handle(request, body, version);
+        writeResponse(socket, status, body, version, request.keepAlive, allowOrigin);
+        releaseBuffer(move(body));
+        if (!request.keepAlive) {
+            socket->disconnectFromHost();
+            return;
+        }
+    }
+}
+
+int CatalogHttpServer::takeRequest(QByteArray& bytes, HttpRequest& request)
+{
+    const qsizetype headerEnd = bytes.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        return bytes.size() > MAX_HEADER_SIZE ? 431 : 0;
+    }
+    if (headerEnd > MAX_HEADER_SIZE) {
+        return 431;
+    }
+
+    const QList<QByteArray> lines = bytes.left(headerEnd).split('\n');
+    const QList<QByteArray> requestLine = lines.front().trimmed().split(' ');
+    if (requestLine.size() != 3 || !requestLine[2].startsWith("HTTP/1.")) {
+        return 400;
+    }
+    request.method = requestLine[0];
+    request.keepAlive = requestLine[2] == "HTTP/1.1";
+
+    qsizetype contentLength = 0;
+    for (qsizetype i = 1; i < lines.size(); i++) {
+        const qsizetype colon = lines[i].indexOf(':');
+        if (colon <= 0) {
+            return 400;
+        }
+        const QByteArray name = lines[i].left(colon).trimmed().toLower();
+        const QByteArray value = lines[i].mid(colon + 1).trimmed();
+        if (name == "content-length") {
+            bool ok = false;
+            contentLength = value.toLongLong(&ok);
+            if (!ok || contentLength < 0) {
+                return 400;
+            }
+            if (contentLength > MAX_BODY_SIZE) {
+                return 413;
+            }
+        }
+        else if (name == "connection") {
+            const QByteArray connection = value.toLower();
+            request.keepAlive = connection == "close" ? false : connection == "keep-alive" ? true : request.keepAlive;
+        }
+        else if (name == "if-none-match") {
+            request.ifNoneMatch = value;
+        }
+        else if (name == "host") {
+            request.host = value;
+        }
+        else if (name == "origin") {
+            request.origin = value;
+        }
+        else if (name == "authorization" && value.left(7).toLower() == "bearer ") {
+            request.token = value.mid(7).trimmed();
+        }
+        else if (name == "transfer-encoding") {
+            return 501;
+        }
+    }
+
+    if (bytes.size() < headerEnd + 4 + contentLength) {
+        return 0;
+    }
+    request.body = bytes.mid(headerEnd + 4, contentLength);
+
+    const QByteArray& target = requestLine[1];
+    const qsizetype question = target.indexOf('?');
+    request.path = question < 0 ? target : target.left(question);
+    request.query = question < 0 ? QByteArray() : target.mid(question + 1);
+
+    bytes.remove(0, headerEnd + 4 + contentLength);
+    return 1;
+}
+
+int CatalogHttpServer::handle(const HttpRequest& request, string& body, uint64_t& version)
+{
+    JsonWriter json(body);
+    if (!isLocalHost(request.host)) {
+        return errorBody(body, 403, "The Host of the request must be 127.0.0.1 or localhost");
+    }
+    if (request.method == "OPTIONS") {
+        return 204;
+    }
+    const bool isGet = request.method == "GET";
+    const bool isPut = request.method == "PUT";
+    if (!isGet && !isPut) {
+        return errorBody(body, 405, "Only GET, PUT and OPTIONS requests are answered");
+    }
+    if (isPut && request.token != token && !isAllowedOrigin(request.origin)) {
+        return errorBody(body, 403, "A PUT request needs the token of the server or an allowed Origin");
+    }
+
+    QList<QByteArray> segments = request.path.split('/');
+    segments.removeAll(QByteArray());
+    if (segments.isEmpty()) {
+        return errorBody(body, 404, "Unknown path");
+    }
+    QString queryText = QString::fromUtf8(request.query);
+    const QUrlQuery query(queryText.replace('+', ' '));
+
+    // => ATTRIBUTE NAMES (the same for every user, read once)
+    static const char* attributePaths[3] = { "seasons", "weathers", "locations" };
+    for (int kind = 0; kind < 3; kind++) {
+        if (segments.size() == 1 && segments.front() == attributePaths[kind]) {
+            if (!isGet) {
+                return errorBody(body, 405, "Only GET requests are answered on this path");
+            }
+            vector<string>& names = attributeNames[kind];
+            if (names.empty()) {
+                names = kind == 0 ? service.getAllSeasons() : kind == 1 ? service.getAllWeathers() : service.getAllLocations();
+            }
+            json.textArray(names);
+            return 200;
+        }
+    }
+    // <= END
+
+    if (segments.front() != "fish" && segments.front() != "stats") {
+        return errorBody(body, 404, "Unknown path");
+    }
+    bool isUserId = false;
+    const long userId = query.queryItemValue("user").toLong(&isUserId);
+    if (!isUserId) {
+        return errorBody(body, 400, "The user parameter must be the id of a user");
+    }
+    if (!isUser(userId)) {
+        return errorBody(body, 404, "Unknown user");
+    }
+
+    const Catalog& catalog = catalogOf(userId);
+    const QByteArray etag = '"' + QByteArray::number(static_cast<qulonglong>(catalog.version)) + '"';
+    if (isGet && (request.ifNoneMatch == "*" || request.ifNoneMatch.contains(etag))) {
+        version = catalog.version;
+        return 304;
+    }
+
+    // => STATS
+    if (segments.front() == "stats") {
+        if (!isGet || segments.size() != 1) {
+            return errorBody(body, isGet ? 404 : 405, isGet ? "Unknown path" : "Only GET requests are answered on this path");
+        }
+        long caught = 0;
+        long favorite = 0;
+        for (const Fish& fish : catalog.fishList) {
+            caught += fish.getIsCaught() ? 1 : 0;
+            favorite += fish.getIsFavorite() ? 1 : 0;
+        }
+        const long fishNumber = static_cast<long>(catalog.fishList.size());
+        json.beginObject()
+            .key("user").integer(userId)
+            .key("fish").integer(fishNumber)
+            .key("caught").integer(caught)
+            .key("uncaught").integer(fishNumber - caught)
+            .key("favorite").integer(favorite)
+            .endObject();
+        version = catalog.version;
+        return 200;
+    }
+    // <= END
+
+    // => FISH LISTS
+    if (segments.size() == 1 || (segments.size() == 2 && (segments[1] == "uncaught" || segments[1] == "favorite"))) {
+        if (!isGet) {
+            return errorBody(body, 405, "Only GET requests are answered on this path");
+        }
+        FishQuery fishQuery;
+        if (segments.size() == 1 && query.hasQueryItem("q")) {
+            fishQuery = FishQuery::compile(query.queryItemValue("q", QUrl::FullyDecoded).toStdString());
+            if (!fishQuery.getErrors().empty()) {
+                json.beginObject().key("errors").textArray(fishQuery.getErrors()).endObject();
+                return 400;
+            }
+        }
+        const bool uncaughtOnly = segments.size() == 2 && segments[1] == "uncaught";
+        const bool favoriteOnly = segments.size() == 2 && segments[1] == "favorite";
+
+        json.beginArray();
+        for (const Fish& fish : catalog.fishList) {
+            if ((uncaughtOnly && fish.getIsCaught()) || (favoriteOnly && !fish.getIsFavorite()) || !fishQuery.matches(fish)) {
+                continue;
+            }
+            json.fish(fish);
+        }
+        json.endArray();
+        version = catalog.version;
+        return 200;
+    }
+    // <= END
+
+    // => ONE FISH
+    bool isFishId = false;
+    const long fishId = segments[1].toLong(&isFishId);
+    auto index = isFishId && segments.size() == 2 ? catalog.indexById.find(fishId) : catalog.indexById.end();
+    if (index == catalog.indexById.end()) {
+        return errorBody(body, 404, "Unknown fish");
+    }
+    if (isGet) {
+        json.fish(catalog.fishList[index->second]);
+        version = catalog.version;
+        return 200;
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(request.body, &parseError);
+    const QJsonObject changes = document.object();
+    if (parseError.error != QJsonParseError::NoError || !document.isObject()
+        || (!changes.value("caught").isBool() && !changes.value("favorite").isBool())) {
+        return errorBody(body, 400, "The body must be an object with a caught or favorite boolean");
+    }
+
+    Fish fish = catalog.fishList[index->second];
+    if (changes.value("caught").isBool()) {
+        fish.setIsCaught(changes.value("caught").toBool());
+    }
+    if (changes.value("favorite").isBool()) {
+        fish.setIsFavorite(changes.value("favorite").toBool());
+    }
+    const Fish updated = service.updateFish(fish, userId);
+    if (updated.getId() != fishId) {
+        return errorBody(body, 500, "The fish could not be updated");
+    }
+    json.fish(updated);
+    return 200;
+    // <= END
+}
+
+const CatalogHttpServer::Catalog& CatalogHttpServer::catalogOf(const long userId)
+{
+    // The version is read before the fish, so an update made while they are read makes the next request read them again
+    const uint64_t version = service.getDataVersion();
+    Catalog& catalog = catalogs[userId];
+    if (catalog.version != version) {
+        catalog.fishList = service.getAllFish(userId);
+        catalog.indexById.clear();
+        for (size_t i = 0; i < catalog.fishList.size(); i++) {
+            catalog.indexById[catalog.fishList[i].getId()] = i;
+        }
+        catalog.version = version;
+    }
+    return catalog;
+}
+
+bool CatalogHttpServer::isUser(const long userId)
+{
+    const uint64_t version = service.getDataVersion();
+    if (userIdsVersion != version) {
+        userIds.clear();
+        for (const User& user : service.getAllUsers()) {
+            userIds.insert(user.getId());
+        }
+        for (auto catalog = catalogs.begin(); catalog != catalogs.end();) {
+            catalog = userIds.count(catalog->first) == 0 ? catalogs.erase(catalog) : next(catalog);
+        }
+        userIdsVersion = version;
+    }
+    return userIds.count(userId) != 0;
+}
+
+bool CatalogHttpServer::isAllowedOrigin(const QByteArray& origin) const
+{
+    return !origin.isEmpty() && allowedOrigins.contains(origin);
+}
+
+void CatalogHttpServer::writeResponse(QTcpSocket* socket, const int status, const string& body, const uint64_t version, const bool keepAlive, const QByteArray& allowOrigin)
+{
+    const bool hasBody = status != 204 && status != 304;
+
+    string head = acquireBuffer();
+    head += "HTTP/1.1 ";
+    head += to_string(status);
+    head += ' ';
+    head += reasonPhrase(status);
+    head += "\r\nContent-Type: application/json; charset=utf-8\r\n";
+    if (!allowOrigin.isEmpty()) {
+        head += "Access-Control-Allow-Origin: ";
+        head.append(allowOrigin.constData(), static_cast<size_t>(allowOrigin.size()));
+        head += allowOrigin == "*" ? "\r\n" : "\r\nVary: Origin\r\n";
+    }
+    if (status == 204) {
+        head += allowOrigin == "*"
+            ? "Access-Control-Allow-Methods: GET, OPTIONS\r\nAccess-Control-Allow-Headers: If-None-Match\r\n"
+            : "Access-Control-Allow-Methods: GET, PUT, OPTIONS\r\nAccess-Control-Allow-Headers: Authorization, Content-Type, If-None-Match\r\n";
+    }
+    if (version != 0) {
+        head += "ETag: \"";
+        head += to_string(version);
+        head += "\"\r\nCache-Control: no-cache\r\n";
+    }
+    head += "Content-Length: ";
+    head += to_string(hasBody ? body.size() : 0);
+    head += keepAlive ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n";
+
+    // The socket copies the bytes it is given, so both buffers can be reused as soon as they are written
+    socket->write(head.data(), static_cast<qint64>(head.size()));
+    if (hasBody) {
+        socket->write(body.data(), static_cast<qint64>(body.size()));
+    }
+    releaseBuffer(move(head));
+}
+
+string CatalogHttpServer::acquireBuffer()
+{
+    if (bufferPool.empty()) {
+        string buffer;
+        buffer.reserve(4096);
+        return buffer;
+    }
+    string buffer = move(bufferPool.back());
+    bufferPool.pop_back();
+    buffer.clear();
+    return buffer;
+}
+
+void CatalogHttpServer::releaseBuffer(string&& buffer)
+{
+    // A buffer grown by an unusually large answer is given back instead of being kept
+    if (bufferPool.size() < 8 && buffer.capacity() <= 1024 * 1024) {
+        bufferPool.push_back(move(buffer));
+    }
+}
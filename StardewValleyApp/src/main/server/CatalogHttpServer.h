@@ -0,0 +1,145 @@
+#pragma once
+
+#include "../model/Fish.h"
+#include "../service/Service.h"
+#include <QObject>
+#include <QThread>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHash>
+#include <QByteArray>
+#include <QList>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+class CatalogHttpServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    /*
+    * Localhost HTTP server answering JSON requests about the fish, for overlays and stream deck buttons
+    * It runs in a thread of its own, so the requests are never handled by the GUI thread:
+    *   GET /fish?user=1[&q=<filter query>]   all the fish of the user, or the ones matching the query
+    *   GET /fish/uncaught?user=1             the fish the user did not catch
+    *   GET /fish/favorite?user=1             the favorite fish of the user
+    *   GET /fish/<id>?user=1                 one fish
+    *   PUT /fish/<id>?user=1                 update a fish with a body like {"caught": true, "favorite": false}
+    *   GET /stats?user=1                     the number of fish, caught fish and favorite fish
+    *   GET /seasons, /weathers, /locations   the names of the attributes
+    * The fish are answered from a copy of the fish of every user, read again once the data version of the service
+    * changes, and the ETag of the answers is that data version
+    * Only requests whose Host is 127.0.0.1 or localhost are answered, so a page of another site can not reach the server
+    * by rebinding its own name to the loopback address. Any page may read, but a PUT needs either the token of the server,
+    * sent as "Authorization: Bearer <token>", or an Origin of the allowed ones; only those origins are told they may send it
+    * @param service - the service the fish are read and updated through
+    * @param allowedOrigins - the origins of the pages allowed to update the fish, like "http://localhost:8080"
+    */
+    explicit CatalogHttpServer(Service& service, const vector<string>& allowedOrigins = {});
+    ~CatalogHttpServer();
+
+    /*
+    * Start the server thread and listen on the localhost interface
+    * @param port - the port to listen on
+    * @return true if the server is listening
+    */
+    bool start(const quint16 port);
+
+    // Stop listening, close the connections and wait for the server thread to end
+    void stop();
+
+    // Get the token a PUT request must carry, drawn again every time the server is created
+    const QByteArray& getToken() const;
+
+private:
+    // One request, read from the bytes received on a connection
+    struct HttpRequest {
+        QByteArray method;
+        QByteArray path;
+        QByteArray query;
+        QByteArray ifNoneMatch;
+        QByteArray host;
+        QByteArray origin;
+        QByteArray token;
+        QByteArray body;
+        bool keepAlive = true;
+    };
+
+    // The copy of the fish of a user the answers are written from
+    struct Catalog {
+        uint64_t version = 0;
+        vector<Fish> fishList;
+        unordered_map<long, size_t> indexById;
+    };
+
+    // Limits of a request, a larger one is answered with an error and its connection is closed
+    static constexpr int MAX_HEADER_SIZE = 16 * 1024;
+    static constexpr int MAX_BODY_SIZE = 64 * 1024;
+
+    Service& service;
+    QThread thread;
+    QByteArray token;
+    QList<QByteArray> allowedOrigins;
+
+    // Owned by the server thread: created when the server starts and deleted when it stops
+    QTcpServer* tcpServer = nullptr;
+    QHash<QTcpSocket*, QByteArray> receivedBytes;
+    unordered_map<long, Catalog> catalogs;
+    unordered_set<long> userIds;
+    uint64_t userIdsVersion = 0;
+    vector<string> attributeNames[3];
+
+    // The buffers the answers are written to, kept with their memory to be reused by the next answers
+    vector<string> bufferPool;
+
+    void onNewConnection();
+    void onReadyRead(QTcpSocket* socket);
+
+    /*
+    * Read the next complete request from the received bytes of a connection
+    * @param bytes - the received bytes, the request is removed from them
+    * @param request - receives the request
+    * @return 1 if a request was read, 0 if more bytes are needed, or the HTTP status of an invalid request
+    */
+    static int takeRequest(QByteArray& bytes, HttpRequest& request);
+
+    /*
+    * Answer a request, the answer is written to the body
+    * @param request - the request
+    * @param body - the buffer the JSON answer is written to
+    * @param version - receives the data version the answer was written from, or 0 if it has no ETag
+    * @return the HTTP status of the answer
+    */
+    int handle(const HttpRequest& request, string& body, uint64_t& version);
+
+    /*
+    * Get the copy of the fish of a user, read again if a fish was updated since it was read
+    * @param userId - the id of the user
+    */
+    const Catalog& catalogOf(const long userId);
+
+    /*
+    * Tell if a user exists, the ids are read again once the data version of the service changes
+    * The copies of the users that are gone are dropped then, so there is never a copy for more than the users of the database
+    * @param userId - the id of the user
+    */
+    bool isUser(const long userId);
+
+    // Tell if the Origin of a request is one of the allowed ones
+    bool isAllowedOrigin(const QByteArray& origin) const;
+
+    /*
+    * Write the answer of a request
+    * @param allowOrigin - the Access-Control-Allow-Origin of the answer, none if it is empty;
+    *                      an allowed origin is echoed and is told it may send PUT requests, "*" only lets pages read
+    */
+    void writeResponse(QTcpSocket* socket, const int status, const string& body, const uint64_t version, const bool keepAlive, const QByteArray& allowOrigin);
+
+    string acquireBuffer();
+    void releaseBuffer(string&& buffer);
+};
@@ -0,0 +1,109 @@
+#include "BackupManager.h"
+#include <algorithm>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+
+BackupManager::BackupManager(const Service& service, const string& databasePath, const string& directory, const size_t keep, const int pagesPerStep, const chrono::milliseconds pause)
+	: service(service), databasePath(databasePath), directory(directory), keep(max<size_t>(keep, 1)), pagesPerStep(pagesPerStep), pause(pause) {
+}
+
+BackupManager::~BackupManager() {
+	cancelled = true;
+	if (worker.joinable()) {
+		worker.join();
+	}
+}
+
+bool BackupManager::start() {
+	if (running.exchange(true)) {
+		return false;
+	}
+	if (worker.joinable()) {
+		worker.join();
+	}
+	cancelled = false;
+	worker = thread(&BackupManager::run, this);
+	return true;
+}
+
+BackupReport BackupManager::wait() {
+	if (worker.joinable()) {
+		worker.join();
+	}
+	return getLastReport();
+}
+
+bool BackupManager::isRunning() const {
+	return running.load();
+}
+
+BackupReport BackupManager::getLastReport() const {
+	lock_guard<mutex> lock(reportMutex);
+	return lastReport;
+}
+
+vector<string> BackupManager::getSnapshots() const {
+	vector<string> snapshots;
+	error_code error;
+	const string prefix = snapshotPrefix() + "-";
+	for (const filesystem::directory_entry& entry : filesystem::directory_iterator(directory, error)) {
+		const string name = entry.path().filename().string();
+		if (entry.is_regular_file(error) && name.rfind(prefix, 0) == 0 && entry.path().extension() == ".db") {
+			snapshots.push_back(entry.path().string());
+		}
+	}
+
+	// The dates in the names sort the same way as the times
+	sort(snapshots.rbegin(), snapshots.rend());
+	return snapshots;
+}
+
+void BackupManager::run() {
+	BackupReport report;
+	error_code error;
+	filesystem::create_directories(directory, error);
+	if (error) {
+		cerr << "Failed to create the backup directory " << directory << ": " << error.message() << "\n";
+	}
+	else {
+		char date[32];
+		const time_t now = time(nullptr);
+		tm local{};
+#ifdef _WIN32
+		localtime_s(&local, &now);
+#else
+		localtime_r(&now, &local);
+#endif
+		strftime(date, sizeof(date), "%Y%m%d-%H%M%S", &local);
+
+		const string path = (filesystem::path(directory) / (snapshotPrefix() + "-" + date + ".db")).string();
+		report = service.backupDatabase(path, pagesPerStep, pause, &cancelled);
+	}
+
+	// Only a complete backup makes room for itself, so a failed one never leaves fewer snapshots behind
+	if (report.succeeded) {
+		const vector<string> snapshots = getSnapshots();
+		for (size_t i = keep; i < snapshots.size(); i++) {
+			filesystem::remove(snapshots[i], error);
+			filesystem::remove(snapshots[i] + ".images", error);
+			filesystem::remove(snapshots[i] + ".images.idx", error);
+		}
+	}
+
+	{
+		lock_guard<mutex> lock(reportMutex);
+		lastReport = report;
+	}
+	running = false;
+}
+
+string BackupManager::defaultDirectory(const string& databasePath) {
+	error_code error;
+	const filesystem::path database = filesystem::absolute(databasePath, error);
+	return ((error ? filesystem::path(databasePath) : database).parent_path() / "backups").string();
+}
+
+string BackupManager::snapshotPrefix() const {
+	return filesystem::path(databasePath).stem().string();
+}
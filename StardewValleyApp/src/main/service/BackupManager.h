@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Service.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+class BackupManager {
+
+public:
+	/*
+	* Takes dated snapshots of the database on a background thread, and keeps only the newest ones
+	* The snapshots are named after the database and the time they were started, like stardewValleyDatabase-20240131-184502.db,
+	* and the image pack of every snapshot is next to it, like stardewValleyDatabase-20240131-184502.db.images
+	* @param service - the service the database is backed up through
+	* @param databasePath - the path to the database, its name prefixes the snapshots
+	* @param directory - the directory of the snapshots, created by the first backup
+	* @param keep - the number of snapshots kept, the oldest ones are removed after every backup
+	* @param pagesPerStep - the number of pages copied by every step of a backup
+	* @param pause - the time the writes get between two steps
+	*/
+	BackupManager(const Service& service, const string& databasePath, const string& directory, const size_t keep = 7, const int pagesPerStep = 64, const chrono::milliseconds pause = chrono::milliseconds(10));
+
+	BackupManager(const BackupManager& other) = delete;
+
+	/*
+	* Stops the running backup, its snapshot is not kept
+	*/
+	~BackupManager();
+
+
+	/*
+	* @brief Starts a backup on a background thread
+	* @return false if a backup is already running
+	*/
+	bool start();
+
+
+	/*
+	* @brief Waits for the running backup to end
+	* @return the report of the last backup
+	*/
+	BackupReport wait();
+
+
+	/*
+	* @brief Tells if a backup is running
+	*/
+	bool isRunning() const;
+
+
+	/*
+	* @brief Gets the report of the last backup that ended
+	*/
+	BackupReport getLastReport() const;
+
+
+	/*
+	* @brief Gets the paths of the snapshots of the database, the newest first
+	*/
+	vector<string> getSnapshots() const;
+
+
+	/*
+	* @brief Gets the directory the snapshots of a database go to when none is given, the "backups" directory next to the database
+	* @param databasePath - the path to the database
+	*/
+	static string defaultDirectory(const string& databasePath);
+
+private:
+	const Service& service;
+	string databasePath;
+	string directory;
+	size_t keep;
+	int pagesPerStep;
+	chrono::milliseconds pause;
+
+	thread worker;
+	atomic<bool> running{ false };
+	atomic<bool> cancelled{ false };
+	BackupReport lastReport;
+	mutable mutex reportMutex;
+
+	// Run a backup into a new snapshot, then remove the snapshots beyond the ones kept
+	void run();
+
+	// Get the prefix of the names of the snapshots, the name of the database without its extension
+	string snapshotPrefix() const;
+};
@@ -0,0 +1,236 @@
+#include "CatchQueryEngine.h"
+#include <algorithm>
+
+CatchQueryEngine::CatchQueryEngine(const vector<Fish>& fishList) {
+	build(fishList);
+}
+
+void CatchQueryEngine::build(const vector<Fish>& newFishList) {
+	fishList = newFishList;
+	indexById.clear();
+	buckets.clear();
+	seasonIds = 0;
+	weatherIds = 0;
+	locationIds = 0;
+
+	// A fish that bites in All weathers goes in the buckets of every weather, All is not a weather of its own; the same goes for the seasons and locations
+	everySeason = everyValueBits(AttributeKind::Season);
+	everyWeather = everyValueBits(AttributeKind::Weather);
+	everyLocation = everyValueBits(AttributeKind::Location);
+	concreteSeasons = concreteValueBits(AttributeKind::Season, everySeason);
+	concreteWeathers = concreteValueBits(AttributeKind::Weather, everyWeather);
+	concreteLocations = concreteValueBits(AttributeKind::Location, everyLocation);
+
+	for (uint32_t fishIndex = 0; fishIndex < fishList.size(); fishIndex++) {
+		const Fish& fish = fishList[fishIndex];
+		indexById[fish.getId()] = fishIndex;
+
+		const uint64_t fishSeasons = expandBits(fish.getSeason().getBits(), everySeason, concreteSeasons);
+		const uint64_t fishWeathers = expandBits(fish.getWeather().getBits(), everyWeather, concreteWeathers);
+		const uint64_t fishLocations = expandBits(fish.getLocation().getBits(), everyLocation, concreteLocations);
+		seasonIds |= fishSeasons;
+		weatherIds |= fishWeathers;
+		locationIds |= fishLocations;
+
+		// A fish goes in every bucket of its seasons, weathers and locations, once for every catch window
+		const CatchTimes& catchTimes = fish.getCatchTimes();
+		for (uint64_t seasons = fishSeasons; seasons != 0; seasons &= seasons - 1) {
+			for (uint64_t weathers = fishWeathers; weathers != 0; weathers &= weathers - 1) {
+				for (uint64_t locations = fishLocations; locations != 0; locations &= locations - 1) {
+					IntervalTree& bucket = buckets[bucketKey(seasons & (~seasons + 1), weathers & (~weathers + 1), locations & (~locations + 1))];
+					for (size_t window = 0; window < catchTimes.size(); window++) {
+						bucket.add({ catchTimes[window].start, catchTimes[window].end, fishIndex });
+					}
+				}
+			}
+		}
+	}
+
+	for (auto& bucket : buckets) {
+		bucket.second.build();
+	}
+}
+
+bool CatchQueryEngine::update(const Fish& fish) {
+	auto found = indexById.find(fish.getId());
+	if (found == indexById.end()) {
+		return false;
+	}
+
+	Fish& indexed = fishList[found->second];
+	const bool sameBuckets = indexed.getSeason() == fish.getSeason() && indexed.getWeather() == fish.getWeather() && indexed.getLocation() == fish.getLocation() && indexed.getCatchTimes() == fish.getCatchTimes();
+	indexed = fish;
+	if (!sameBuckets) {
+		const vector<Fish> rebuilt = fishList;
+		build(rebuilt);
+	}
+	return true;
+}
+
+vector<Fish> CatchQueryEngine::findCatchable(const string& season, const string& weather, const string& location, const int minute, const bool uncaughtOnly) const {
+	const uint64_t seasons = idsOf(AttributeKind::Season, season, seasonIds, everySeason, concreteSeasons);
+	const uint64_t weathers = idsOf(AttributeKind::Weather, weather, weatherIds, everyWeather, concreteWeathers);
+	const uint64_t locations = idsOf(AttributeKind::Location, location, locationIds, everyLocation, concreteLocations);
+
+	// A window past midnight holds the minutes of the next day after MINUTES_PER_DAY, so both points are searched
+	const int dayMinute = minute == ANY_TIME ? ANY_TIME : ((minute % CatchTimes::MINUTES_PER_DAY) + CatchTimes::MINUTES_PER_DAY) % CatchTimes::MINUTES_PER_DAY;
+
+	vector<uint32_t> fishIndexes;
+	for (uint64_t s = seasons; s != 0; s &= s - 1) {
+		for (uint64_t w = weathers; w != 0; w &= w - 1) {
+			for (uint64_t l = locations; l != 0; l &= l - 1) {
+				auto bucket = buckets.find(bucketKey(s & (~s + 1), w & (~w + 1), l & (~l + 1)));
+				if (bucket == buckets.end()) {
+					continue;
+				}
+				if (dayMinute == ANY_TIME) {
+					bucket->second.stab(ANY_TIME, fishIndexes);
+				}
+				else {
+					bucket->second.stab(dayMinute, fishIndexes);
+					bucket->second.stab(dayMinute + CatchTimes::MINUTES_PER_DAY, fishIndexes);
+				}
+			}
+		}
+	}
+
+	// A fish is found once for every bucket and window that matches
+	sort(fishIndexes.begin(), fishIndexes.end());
+	fishIndexes.erase(unique(fishIndexes.begin(), fishIndexes.end()), fishIndexes.end());
+
+	vector<Fish> catchable;
+	catchable.reserve(fishIndexes.size());
+	for (const uint32_t fishIndex : fishIndexes) {
+		if (!uncaughtOnly || !fishList[fishIndex].getIsCaught()) {
+			catchable.push_back(fishList[fishIndex]);
+		}
+	}
+	return catchable;
+}
+
+size_t CatchQueryEngine::size() const {
+	return fishList.size();
+}
+
+const vector<Fish>& CatchQueryEngine::getFishList() const {
+	return fishList;
+}
+
+size_t CatchQueryEngine::bucketCount() const {
+	return buckets.size();
+}
+
+uint64_t CatchQueryEngine::bucketKey(const uint64_t season, const uint64_t weather, const uint64_t location) {
+	// The bits are single ids below 64, so their positions fit in 6 bits each
+	auto position = [](uint64_t bit) {
+		uint64_t index = 0;
+		while (bit >>= 1) {
+			index++;
+		}
+		return index;
+	};
+	return (position(season) << 12) | (position(weather) << 6) | position(location);
+}
+
+uint64_t CatchQueryEngine::idsOf(const AttributeKind kind, const string& name, const uint64_t allIds, const uint64_t everyValue, const uint64_t concrete) {
+	if (name.empty()) {
+		return allIds;
+	}
+	const int id = InternTable::of(kind).find(name);
+	return id < 0 || id >= 64 ? 0 : allIds & expandBits(uint64_t(1) << id, everyValue, concrete);
+}
+
+
+
+void CatchQueryEngine::IntervalTree::add(const Interval& interval) {
+	pending.push_back(interval);
+}
+
+void CatchQueryEngine::IntervalTree::build() {
+	nodes.clear();
+	nodes.reserve(pending.size());
+	buildNode(pending);
+	pending.clear();
+	pending.shrink_to_fit();
+}
+
+int CatchQueryEngine::IntervalTree::buildNode(vector<Interval>& intervals) {
+	if (intervals.empty()) {
+		return -1;
+	}
+
+	// The center is the median start, so every level leaves at most half of the intervals to each side
+	vector<uint16_t> starts;
+	starts.reserve(intervals.size());
+	for (const Interval& interval : intervals) {
+		starts.push_back(interval.start);
+	}
+	nth_element(starts.begin(), starts.begin() + starts.size() / 2, starts.end());
+	const int center = starts[starts.size() / 2];
+
+	vector<Interval> leftIntervals;
+	vector<Interval> rightIntervals;
+	const int node = static_cast<int>(nodes.size());
+	nodes.emplace_back();
+	nodes[node].center = center;
+	for (const Interval& interval : intervals) {
+		if (interval.end <= center) {
+			leftIntervals.push_back(interval);
+		}
+		else if (interval.start > center) {
+			rightIntervals.push_back(interval);
+		}
+		else {
+			nodes[node].byStart.push_back(interval);
+		}
+	}
+	nodes[node].byEnd = nodes[node].byStart;
+	sort(nodes[node].byStart.begin(), nodes[node].byStart.end(), [](const Interval& a, const Interval& b) { return a.start < b.start; });
+	sort(nodes[node].byEnd.begin(), nodes[node].byEnd.end(), [](const Interval& a, const Interval& b) { return a.end > b.end; });
+
+	const int left = buildNode(leftIntervals);
+	const int right = buildNode(rightIntervals);
+	nodes[node].left = left;
+	nodes[node].right = right;
+	return node;
+}
+
+void CatchQueryEngine::IntervalTree::stab(const int point, vector<uint32_t>& fishIndexes) const {
+	if (nodes.empty()) {
+		return;
+	}
+
+	// Any time: every interval of the tree
+	if (point == ANY_TIME) {
+		for (const IntervalNode& node : nodes) {
+			for (const Interval& interval : node.byStart) {
+				fishIndexes.push_back(interval.fishIndex);
+			}
+		}
+		return;
+	}
+
+	// Every node only reports the intervals that contain the point, and one side of the tree is left at every level
+	int current = 0;
+	while (current >= 0) {
+		const IntervalNode& node = nodes[current];
+		if (point < node.center) {
+			for (const Interval& interval : node.byStart) {
+				if (interval.start > point) {
+					break;
+				}
+				fishIndexes.push_back(interval.fishIndex);
+			}
+			current = node.left;
+		}
+		else {
+			for (const Interval& interval : node.byEnd) {
+				if (interval.end <= point) {
+					break;
+				}
+				fishIndexes.push_back(interval.fishIndex);
+			}
+			current = node.right;
+		}
+	}
+}
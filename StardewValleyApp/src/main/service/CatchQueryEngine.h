@@ -0,0 +1,139 @@
+#pragma once
+
+#include "../model/Fish.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+class CatchQueryEngine {
+
+public:
+	// The minute passed to findCatchable to ignore the time of the day
+	static constexpr int ANY_TIME = -1;
+
+	/*
+	* In-memory index of the fish of one user, answering "which fish can be caught here, now, in this weather"
+	* The fish are grouped in (season, weather, location) buckets, and every bucket keeps a centered interval tree
+	* over the catch windows of its fish, so a point in time is answered in O(log n + k) for the bucket
+	*/
+	CatchQueryEngine() = default;
+
+
+	/*
+	* @brief Builds the index of the given fish
+	* @param fishList - the fish of the user, with their caught state
+	*/
+	explicit CatchQueryEngine(const vector<Fish>& fishList);
+
+
+	/*
+	* @brief Rebuilds the index from the given fish
+	* @param fishList - the fish of the user, with their caught state
+	*/
+	void build(const vector<Fish>& fishList);
+
+
+	/*
+	* @brief Replaces a fish of the index with its new values
+	* Only the fish is replaced if its seasons, weathers, locations and catch times did not change, the buckets are rebuilt otherwise
+	* @param fish - the updated fish
+	* @return false if the fish is not in the index, it must then be built again to hold it
+	*/
+	bool update(const Fish& fish);
+
+
+	/*
+	* @brief Finds the fish that can be caught in a season, weather, location and minute of the day
+	* @param season - the name of the season, or an empty string for any season
+	* @param weather - the name of the weather, or an empty string for any weather
+	* @param location - the name of the location, or an empty string for any location
+	* @param minute - the minute of the day, or ANY_TIME for any time
+	* @param uncaughtOnly - true to leave out the fish the user already caught
+	* @return the fish found, in the order in which they were given to the index
+	*/
+	vector<Fish> findCatchable(const string& season, const string& weather, const string& location, const int minute, const bool uncaughtOnly) const;
+
+
+	/*
+	* @brief Gets the number of fish in the index
+	*/
+	size_t size() const;
+
+
+	/*
+	* @brief Gets all the fish of the index, as they were last updated
+	*/
+	const vector<Fish>& getFishList() const;
+
+
+	/*
+	* @brief Gets the number of (season, weather, location) buckets of the index
+	*/
+	size_t bucketCount() const;
+
+private:
+	// A catch window of a fish, from start (included) to end (excluded), in minutes that may go past midnight
+	struct Interval {
+		uint16_t start;
+		uint16_t end;
+		uint32_t fishIndex;
+	};
+
+	// A node of a centered interval tree, holding the intervals that contain its center
+	struct IntervalNode {
+		int center = 0;
+		vector<Interval> byStart;
+		vector<Interval> byEnd;
+		int left = -1;
+		int right = -1;
+	};
+
+	// A centered interval tree over the intervals of one bucket
+	class IntervalTree {
+	private:
+		vector<IntervalNode> nodes;
+		vector<Interval> pending;
+
+	public:
+		void add(const Interval& interval);
+		void build();
+		void stab(const int point, vector<uint32_t>& fishIndexes) const;
+
+	private:
+		int buildNode(vector<Interval>& intervals);
+	};
+
+	vector<Fish> fishList;
+	unordered_map<long, uint32_t> indexById;
+	unordered_map<uint64_t, IntervalTree> buckets;
+
+	// The ids of the seasons, weathers and locations that have at least one fish, used for the names left empty
+	uint64_t seasonIds = 0;
+	uint64_t weatherIds = 0;
+	uint64_t locationIds = 0;
+
+	// The ids whose names stand for every season, weather or location (All, Any), and the concrete ids they stand for, as of the last build
+	uint64_t everySeason = 0;
+	uint64_t everyWeather = 0;
+	uint64_t everyLocation = 0;
+	uint64_t concreteSeasons = 0;
+	uint64_t concreteWeathers = 0;
+	uint64_t concreteLocations = 0;
+
+	static uint64_t bucketKey(const uint64_t season, const uint64_t weather, const uint64_t location);
+
+	/*
+	* @brief Gets the ids to search for a name of an attribute kind
+	* A name that stands for every value of the kind (All, Any) searches all the ids, as the fish with that name are in the buckets of every concrete id
+	* @param kind - the kind of the attribute
+	* @param name - the name, or an empty string for all the ids
+	* @param allIds - the ids that have at least one fish
+	* @param everyValue - the ids whose names stand for every value of the kind
+	* @param concrete - the ids those names stand for
+	* @return a bitset of ids, empty if the name is unknown
+	*/
+	static uint64_t idsOf(const AttributeKind kind, const string& name, const uint64_t allIds, const uint64_t everyValue, const uint64_t concrete);
+};
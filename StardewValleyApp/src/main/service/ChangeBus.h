@@ -0,0 +1,37 @@
+#pragma once
+
+#include "../model/Fish.h"
+#include <QObject>
+#include <QList>
+
+using namespace std;
+
+/*
+* The changes the service makes to the fish, published as signals once they are committed
+* The windows patch what they show from the changes instead of reading the fish again. The changes can be made
+* from another thread (the HTTP server), so the windows connect with themselves as context and get them in the GUI thread.
+*/
+class ChangeBus : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit ChangeBus(QObject* parent = nullptr) : QObject(parent) {}
+
+signals:
+	/*
+	* The caught or favorite flag of a fish changed for a user
+	* @param userId - the id of the user
+	* @param fish - the fish, with its new flags
+	* @param wasCaught - true if the fish was caught before the change
+	* @param wasFavorite - true if the fish was favorite before the change
+	*/
+	void fishFlagsChanged(long userId, const Fish& fish, bool wasCaught, bool wasFavorite);
+
+	/*
+	* Fish were updated for a user, sent once for every update after the changes of its fish
+	* @param userId - the id of the user
+	* @param fishIds - the ids of the updated fish
+	*/
+	void catalogChanged(long userId, const QList<long>& fishIds);
+};
@@ -0,0 +1,240 @@
+#include "FishQuery.h"
+#include "../utils/CaseFolding.h"
+#include <algorithm>
+#include <cctype>
+
+FishQuery FishQuery::compile(const string_view text) {
+	FishQuery query;
+
+	size_t position = 0;
+	while (position < text.size()) {
+		while (position < text.size() && isspace(static_cast<unsigned char>(text[position]))) {
+			position++;
+		}
+		if (position == text.size()) {
+			break;
+		}
+
+		bool negate = false;
+		if (text[position] == '-') {
+			negate = true;
+			position++;
+		}
+
+		// A term ends at the first space outside of quotes, and the quotes are not part of it
+		string term;
+		bool quoted = false;
+		while (position < text.size() && (quoted || !isspace(static_cast<unsigned char>(text[position])))) {
+			if (text[position] == '"') {
+				quoted = !quoted;
+			}
+			else {
+				term += text[position];
+			}
+			position++;
+		}
+		if (!term.empty()) {
+			query.compileTerm(term, negate);
+		}
+	}
+
+	// The cheap predicates run first, so most fish are rejected before any text is compared
+	stable_sort(query.program.begin(), query.program.end(), [](const Instruction& a, const Instruction& b) {
+		return a.op < b.op;
+	});
+	return query;
+}
+
+void FishQuery::compileTerm(const string_view term, const bool negate) {
+	Instruction instruction;
+	instruction.negate = negate;
+
+	const size_t operatorPosition = term.find_first_of(":=<>");
+	if (operatorPosition == string_view::npos) {
+		const string word = CaseFolding::toLower(term);
+		if (word == "caught" || word == "uncaught") {
+			instruction.op = Op::Caught;
+			instruction.negate = negate != (word == "uncaught");
+		}
+		else if (word == "favorite" || word == "fav") {
+			instruction.op = Op::Favorite;
+		}
+		else {
+			instruction.op = Op::AnyContains;
+			instruction.text = word;
+			instruction.seasons = bitsContaining(AttributeKind::Season, word);
+			instruction.weathers = bitsContaining(AttributeKind::Weather, word);
+			instruction.locations = bitsContaining(AttributeKind::Location, word);
+		}
+		program.push_back(instruction);
+		return;
+	}
+
+	const string key = CaseFolding::toLower(term.substr(0, operatorPosition));
+	string comparison(1, term[operatorPosition]);
+	size_t valuePosition = operatorPosition + 1;
+	if ((comparison == "<" || comparison == ">") && valuePosition < term.size() && term[valuePosition] == '=') {
+		comparison += '=';
+		valuePosition++;
+	}
+	const string value = CaseFolding::toLower(term.substr(valuePosition));
+
+	// A term still being typed has no value yet, it is left out without an error
+	if (value.empty()) {
+		return;
+	}
+
+	const bool isEquality = comparison == ":" || comparison == "=";
+	if (key == "difficulty" || key == "diff" || key == "d") {
+		char* end = nullptr;
+		instruction.number = strtol(value.c_str(), &end, 10);
+		if (end == value.c_str() || *end != '\0') {
+			errors.push_back("Not a number: " + string(term));
+			return;
+		}
+		instruction.op = isEquality ? Op::DifficultyEquals
+			: comparison == "<" ? Op::DifficultyLess
+			: comparison == "<=" ? Op::DifficultyLessOrEqual
+			: comparison == ">" ? Op::DifficultyGreater
+			: Op::DifficultyGreaterOrEqual;
+		program.push_back(instruction);
+		return;
+	}
+
+	if (!isEquality) {
+		errors.push_back("Only difficulty can be compared: " + string(term));
+		return;
+	}
+
+	if (key == "season" || key == "s") {
+		instruction.op = Op::SeasonBits;
+		instruction.seasons = bitsContaining(AttributeKind::Season, value);
+	}
+	else if (key == "weather" || key == "w") {
+		instruction.op = Op::WeatherBits;
+		instruction.weathers = bitsContaining(AttributeKind::Weather, value);
+	}
+	else if (key == "location" || key == "loc" || key == "l") {
+		instruction.op = Op::LocationBits;
+		instruction.locations = bitsContaining(AttributeKind::Location, value);
+	}
+	else if (key == "time" || key == "t") {
+		instruction.op = Op::CatchableAt;
+		instruction.number = CatchTimes::parseTime(value);
+		if (instruction.number < 0) {
+			errors.push_back("Not a time: " + string(term));
+			return;
+		}
+	}
+	else if (key == "category" || key == "cat") {
+		instruction.op = Op::CategoryContains;
+		instruction.text = value;
+	}
+	else if (key == "movement" || key == "move") {
+		instruction.op = Op::MovementContains;
+		instruction.text = value;
+	}
+	else if (key == "name" || key == "n") {
+		instruction.op = Op::NameContains;
+		instruction.text = value;
+	}
+	else {
+		errors.push_back("Unknown filter: " + key);
+		return;
+	}
+	program.push_back(instruction);
+}
+
+bool FishQuery::matches(const Fish& fish) const {
+	for (const Instruction& instruction : program) {
+		if (evaluate(instruction, fish) == instruction.negate) {
+			return false;
+		}
+	}
+	return true;
+}
+
+vector<Fish> FishQuery::filter(const vector<Fish>& fishList) const {
+	vector<Fish> matching;
+	for (const Fish& fish : fishList) {
+		if (matches(fish)) {
+			matching.push_back(fish);
+		}
+	}
+	return matching;
+}
+
+bool FishQuery::empty() const {
+	return program.empty();
+}
+
+const vector<string>& FishQuery::getErrors() const {
+	return errors;
+}
+
+bool FishQuery::evaluate(const Instruction& instruction, const Fish& fish) const {
+	switch (instruction.op) {
+	case Op::SeasonBits:
+		return (fish.getSeason().getBits() & instruction.seasons) != 0;
+	case Op::WeatherBits:
+		return (fish.getWeather().getBits() & instruction.weathers) != 0;
+	case Op::LocationBits:
+		return (fish.getLocation().getBits() & instruction.locations) != 0;
+	case Op::Caught:
+		return fish.getIsCaught();
+	case Op::Favorite:
+		return fish.getIsFavorite();
+	case Op::DifficultyEquals:
+		return fish.getDifficulty() == instruction.number;
+	case Op::DifficultyLess:
+		return fish.getDifficulty() < instruction.number;
+	case Op::DifficultyLessOrEqual:
+		return fish.getDifficulty() <= instruction.number;
+	case Op::DifficultyGreater:
+		return fish.getDifficulty() > instruction.number;
+	case Op::DifficultyGreaterOrEqual:
+		return fish.getDifficulty() >= instruction.number;
+	case Op::CatchableAt:
+		return fish.getCatchTimes().contains(static_cast<int>(instruction.number));
+	case Op::CategoryContains:
+		return CaseFolding::containsNoCase(fish.getCategory(), instruction.text);
+	case Op::MovementContains:
+		return CaseFolding::containsNoCase(fish.getMovement(), instruction.text);
+	case Op::NameContains:
+		return CaseFolding::containsNoCase(fish.getName(), instruction.text);
+	case Op::AnyContains:
+		return (fish.getSeason().getBits() & instruction.seasons) != 0
+			|| (fish.getWeather().getBits() & instruction.weathers) != 0
+			|| (fish.getLocation().getBits() & instruction.locations) != 0
+			|| CaseFolding::containsNoCase(fish.getName(), instruction.text);
+	}
+	return false;
+}
+
+uint64_t FishQuery::bitsContaining(const AttributeKind kind, const string_view values) {
+	const InternTable& table = InternTable::of(kind);
+	const size_t size = min<size_t>(table.size(), 64);
+
+	uint64_t bits = 0;
+	string_view rest = values;
+	while (!rest.empty()) {
+		const size_t comma = rest.find(',');
+		const string_view value = rest.substr(0, comma);
+		rest = comma == string_view::npos ? string_view() : rest.substr(comma + 1);
+		if (value.empty()) {
+			continue;
+		}
+		for (size_t id = 0; id < size; id++) {
+			if (CaseFolding::containsNoCase(table.name(static_cast<uint16_t>(id)), value)) {
+				bits |= uint64_t(1) << id;
+			}
+		}
+	}
+
+	// A fish that bites in All weathers bites in the Rain as well
+	const uint64_t everyValue = everyValueBits(kind);
+	if ((bits & ~everyValue) != 0) {
+		bits |= everyValue;
+	}
+	return bits;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "../model/Fish.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+class FishQuery {
+
+public:
+	/*
+	* A filter typed as text, compiled once into a flat program of predicates that is run over the fish in memory
+	* The terms are separated by spaces, and a fish matches the query if it matches all of them:
+	*   season:summer  s:summer,fall   - one of its seasons contains one of the values
+	*   weather:rain   w:rain          - one of its weathers contains the value
+	*   location:ocean loc:ocean l:... - one of its locations contains the value
+	*   category:...   cat:...         - its category contains the value
+	*   movement:...   move:...        - its movement contains the value
+	*   name:...       n:...           - its name contains the value
+	*   time:7pm       t:7pm           - it can be caught at that time of the day
+	*   difficulty>70  diff<=50 d:80   - its difficulty compared to the number (:, =, <, <=, >, >=)
+	*   caught  favorite  fav          - it was caught / marked as favorite
+	*   any other word                 - its name, or one of its seasons, weathers or locations, contains the word
+	* A term starting with - is negated, values with spaces are written between quotes (loc:"the mines"),
+	* and the names are compared without case
+	*/
+	FishQuery() = default;
+
+
+	/*
+	* @brief Compiles the text of a query
+	* The seasons, weathers and locations of the values are resolved to bitsets of interned ids, so running
+	* the query compares bits instead of names
+	* @param text - the text of the query
+	* @return the compiled query, with an error for every term that could not be compiled (those terms are left out)
+	*/
+	static FishQuery compile(const string_view text);
+
+
+	/*
+	* @brief Checks if a fish matches all the terms of the query
+	* @param fish - the fish
+	*/
+	bool matches(const Fish& fish) const;
+
+
+	/*
+	* @brief Gets the fish that match the query
+	* @param fishList - the fish to filter
+	* @return the matching fish, in the order of the list
+	*/
+	vector<Fish> filter(const vector<Fish>& fishList) const;
+
+
+	/*
+	* @brief Checks if the query has no terms, so every fish matches it
+	*/
+	bool empty() const;
+
+
+	/*
+	* @brief Gets the errors of the terms that could not be compiled
+	*/
+	const vector<string>& getErrors() const;
+
+private:
+	enum class Op : uint8_t {
+		SeasonBits,
+		WeatherBits,
+		LocationBits,
+		Caught,
+		Favorite,
+		DifficultyEquals,
+		DifficultyLess,
+		DifficultyLessOrEqual,
+		DifficultyGreater,
+		DifficultyGreaterOrEqual,
+		CatchableAt,
+		CategoryContains,
+		MovementContains,
+		NameContains,
+		AnyContains
+	};
+
+	// One predicate of the program: the fish is rejected if the predicate is equal to negate
+	struct Instruction {
+		Op op;
+		bool negate = false;
+		uint64_t seasons = 0;
+		uint64_t weathers = 0;
+		uint64_t locations = 0;
+		long number = 0;
+		string text;
+	};
+
+	vector<Instruction> program;
+	vector<string> errors;
+
+	/*
+	* @brief Compiles one term of the query
+	* @param term - the term, without its - prefix
+	* @param negate - true if the term was negated
+	*/
+	void compileTerm(const string_view term, const bool negate);
+
+
+	/*
+	* @brief Gets the bits of the interned names of a kind that contain one of the comma separated values
+	* When a concrete name matches, the names that stand for every value of the kind (All, Any) are added, as their fish match every value
+	* @param kind - the kind of the names
+	* @param values - the values, in lower case
+	*/
+	static uint64_t bitsContaining(const AttributeKind kind, const string_view values);
+
+	bool evaluate(const Instruction& instruction, const Fish& fish) const;
+};
@@ -0,0 +1,206 @@
+#include "FishResultCache.h"
+
+double FishResultCacheStats::hitRatio() const {
+	const uint64_t lookups = hits + misses;
+	return lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+}
+
+FishResultCache::FishResultCache(const size_t capacity) : capacity(capacity > 0 ? capacity : 1) {
+}
+
+bool FishResultCache::find(const long userId, const string& filter, vector<Fish>& fishList) {
+	lock_guard<mutex> lock(cacheMutex);
+	auto found = entryByKey.find(keyOf(userId, filter));
+	auto catalog = catalogs.find(userId);
+	if (found == entryByKey.end() || catalog == catalogs.end()) {
+		stats.misses++;
+		return false;
+	}
+
+	const Entry& entry = *found->second;
+	vector<Fish> result;
+	result.reserve(entry.ids.size());
+	for (const long id : entry.ids) {
+		auto fish = catalog->second.find(id);
+		if (fish == catalog->second.end()) {
+			// The fish was removed from the catalog, the result is run again
+			stats.bytes -= bytesOf(entry);
+			entries.erase(found->second);
+			entryByKey.erase(found);
+			stats.misses++;
+			return false;
+		}
+		result.push_back(fish->second);
+	}
+
+	entries.splice(entries.begin(), entries, found->second);
+	stats.hits++;
+	fishList = std::move(result);
+	return true;
+}
+
+void FishResultCache::insert(const long userId, const string& filter, const uint8_t dependencies, const vector<Fish>& fishList, const uint64_t expectedGeneration, const function<vector<Fish>()>& loadCatalog) {
+	bool hasCatalog = false;
+	{
+		lock_guard<mutex> lock(cacheMutex);
+		if (expectedGeneration != generation) {
+			return;
+		}
+		hasCatalog = catalogs.count(userId) != 0;
+	}
+
+	// The catalog is read without the lock, so the other lookups are not held up by the database
+	unordered_map<long, Fish> loaded;
+	if (!hasCatalog) {
+		for (const Fish& fish : loadCatalog()) {
+			loaded.emplace(fish.getId(), fish);
+		}
+	}
+
+	// An update made while the catalog was read changed the generation, the catalog may have missed it and is not kept
+	lock_guard<mutex> lock(cacheMutex);
+	if (expectedGeneration != generation) {
+		return;
+	}
+	auto catalog = catalogs.find(userId);
+	if (catalog == catalogs.end()) {
+		if (hasCatalog) {
+			return;
+		}
+		catalog = catalogs.emplace(userId, std::move(loaded)).first;
+	}
+
+	Entry entry{ keyOf(userId, filter), userId, dependencies, {} };
+	entry.ids.reserve(fishList.size());
+	for (const Fish& fish : fishList) {
+		entry.ids.push_back(fish.getId());
+		catalog->second[fish.getId()] = fish;
+	}
+
+	auto existing = entryByKey.find(entry.key);
+	if (existing != entryByKey.end()) {
+		stats.bytes -= bytesOf(*existing->second);
+		entries.erase(existing->second);
+		entryByKey.erase(existing);
+	}
+
+	stats.bytes += bytesOf(entry);
+	entries.push_front(std::move(entry));
+	entryByKey[entries.front().key] = entries.begin();
+
+	while (entries.size() > capacity) {
+		stats.bytes -= bytesOf(entries.back());
+		entryByKey.erase(entries.back().key);
+		entries.pop_back();
+		stats.evictions++;
+	}
+}
+
+uint64_t FishResultCache::getGeneration() const {
+	lock_guard<mutex> lock(cacheMutex);
+	return generation;
+}
+
+void FishResultCache::onFishUpdated(const long userId, const Fish& fish) {
+	lock_guard<mutex> lock(cacheMutex);
+	generation++;
+
+	// The shared values are compared with the copy of any catalog, a fish in none of them is a new fish
+	const uint8_t allValues = DEPENDS_ON_ATTRIBUTES | DEPENDS_ON_CAUGHT | DEPENDS_ON_FAVORITE;
+	uint8_t sharedChanged = allValues;
+	for (const auto& [catalogUserId, catalog] : catalogs) {
+		auto previous = catalog.find(fish.getId());
+		if (previous != catalog.end()) {
+			sharedChanged = changedValues(previous->second, fish) & DEPENDS_ON_ATTRIBUTES;
+			break;
+		}
+	}
+
+	for (auto& [catalogUserId, catalog] : catalogs) {
+		auto previous = catalog.find(fish.getId());
+		if (catalogUserId == userId) {
+			invalidate(catalogUserId, previous == catalog.end() ? allValues : changedValues(previous->second, fish));
+			catalog[fish.getId()] = fish;
+			continue;
+		}
+
+		// The other users keep their own flags, a new fish is neither caught nor favorite for them
+		Fish copy = fish;
+		copy.setIsCaught(previous != catalog.end() && previous->second.getIsCaught());
+		copy.setIsFavorite(previous != catalog.end() && previous->second.getIsFavorite());
+		invalidate(catalogUserId, sharedChanged);
+		catalog[fish.getId()] = copy;
+	}
+}
+
+vector<long> FishResultCache::getCatalogUsers() const {
+	lock_guard<mutex> lock(cacheMutex);
+	vector<long> userIds;
+	userIds.reserve(catalogs.size());
+	for (const auto& [userId, catalog] : catalogs) {
+		userIds.push_back(userId);
+	}
+	return userIds;
+}
+
+void FishResultCache::clear() {
+	lock_guard<mutex> lock(cacheMutex);
+	generation++;
+	stats.invalidations += entries.size();
+	stats.bytes = 0;
+	entries.clear();
+	entryByKey.clear();
+	catalogs.clear();
+}
+
+FishResultCacheStats FishResultCache::getStats() const {
+	lock_guard<mutex> lock(cacheMutex);
+	FishResultCacheStats current = stats;
+	current.entries = entries.size();
+	current.capacity = capacity;
+	for (const auto& [userId, catalog] : catalogs) {
+		current.catalogFish += catalog.size();
+	}
+	return current;
+}
+
+string FishResultCache::keyOf(const long userId, const string& filter) {
+	return to_string(userId) + '\x1f' + filter;
+}
+
+uint8_t FishResultCache::changedValues(const Fish& previous, const Fish& fish) {
+	uint8_t changed = 0;
+	if (previous.getName() != fish.getName() || !(previous.getSeason() == fish.getSeason()) || !(previous.getWeather() == fish.getWeather()) || !(previous.getLocation() == fish.getLocation())
+		|| previous.getStartCatchingHour() != fish.getStartCatchingHour() || previous.getEndCatchingHour() != fish.getEndCatchingHour()) {
+		changed |= DEPENDS_ON_ATTRIBUTES;
+	}
+	if (previous.getIsCaught() != fish.getIsCaught()) {
+		changed |= DEPENDS_ON_CAUGHT;
+	}
+	if (previous.getIsFavorite() != fish.getIsFavorite()) {
+		changed |= DEPENDS_ON_FAVORITE;
+	}
+	return changed;
+}
+
+size_t FishResultCache::bytesOf(const Entry& entry) {
+	// The key is held by the entry and by the map of the entries
+	return sizeof(Entry) + 2 * entry.key.capacity() + entry.ids.capacity() * sizeof(long);
+}
+
+void FishResultCache::invalidate(const long userId, const uint8_t changed) {
+	if (changed == 0) {
+		return;
+	}
+	for (auto entry = entries.begin(); entry != entries.end();) {
+		if (entry->userId == userId && (entry->dependencies & changed) != 0) {
+			stats.bytes -= bytesOf(*entry);
+			entryByKey.erase(entry->key);
+			entry = entries.erase(entry);
+			stats.invalidations++;
+		}
+		else {
+			++entry;
+		}
+	}
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "../model/Fish.h"
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// The counters of a FishResultCache, to tune its capacity
+struct FishResultCacheStats {
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	uint64_t invalidations = 0;
+	uint64_t evictions = 0;
+	size_t entries = 0;
+	size_t capacity = 0;
+	size_t bytes = 0;
+	size_t catalogFish = 0;
+
+	// Get the part of the lookups that were answered from the cache, from 0 to 1
+	double hitRatio() const;
+};
+
+
+class FishResultCache {
+
+public:
+	// The values of a fish a filter result depends on, an update of one of them drops the results that depend on it
+	static constexpr uint8_t DEPENDS_ON_ATTRIBUTES = 1;
+	static constexpr uint8_t DEPENDS_ON_CAUGHT = 2;
+	static constexpr uint8_t DEPENDS_ON_FAVORITE = 4;
+
+	/*
+	* Bounded LRU cache of the results of the fish filters, keyed by the user and the normalized filter
+	* A result only keeps the ids of its fish; the fish are taken from a catalog of all the fish of the user, loaded once
+	* and kept up to date by the updates, so a result is only dropped when an updated value can change which fish it holds
+	* @param capacity - the number of results kept, the least recently used one is dropped beyond it
+	*/
+	explicit FishResultCache(const size_t capacity = 64);
+
+
+	/*
+	* @brief Finds the result of a filter
+	* @param userId - the id of the user
+	* @param filter - the normalized filter
+	* @param fishList - receives the fish of the result, from the catalog of the user
+	* @return true if the result was cached
+	*/
+	bool find(const long userId, const string& filter, vector<Fish>& fishList);
+
+
+	/*
+	* @brief Keeps the result of a filter, unless a fish was updated since the filter was run
+	* @param userId - the id of the user
+	* @param filter - the normalized filter
+	* @param dependencies - the DEPENDS_ON values the filter reads
+	* @param fishList - the fish of the result
+	* @param expectedGeneration - the generation read before the filter was run
+	* @param loadCatalog - called without the lock to get all the fish of the user, only if the catalog of the user is not loaded yet
+	*/
+	void insert(const long userId, const string& filter, const uint8_t dependencies, const vector<Fish>& fishList, const uint64_t expectedGeneration, const function<vector<Fish>()>& loadCatalog);
+
+
+	/*
+	* @brief Gets the generation of the cache, changed by every update, to be read before running a filter
+	*/
+	uint64_t getGeneration() const;
+
+
+	/*
+	* @brief Replaces a fish in the catalogs, and drops the results its changed values can change
+	* The seasons, weathers, locations, name and catch hours are the same for every user, so they are replaced in every catalog
+	* @param userId - the id of the user the fish was read or updated for
+	* @param fish - the fish, with the caught and favorite flags of the user
+	*/
+	void onFishUpdated(const long userId, const Fish& fish);
+
+
+	/*
+	* @brief Gets the users whose catalog is loaded, and whose fish must be read again when the database changes
+	*/
+	vector<long> getCatalogUsers() const;
+
+
+	/*
+	* @brief Drops all the results and the catalogs
+	*/
+	void clear();
+
+
+	/*
+	* @brief Gets the counters of the cache
+	*/
+	FishResultCacheStats getStats() const;
+
+private:
+	struct Entry {
+		string key;
+		long userId;
+		uint8_t dependencies;
+		vector<long> ids;
+	};
+
+	size_t capacity;
+
+	// The results, the most recently used first
+	list<Entry> entries;
+	unordered_map<string, list<Entry>::iterator> entryByKey;
+
+	// The fish of every user by id
+	unordered_map<long, unordered_map<long, Fish>> catalogs;
+
+	uint64_t generation = 0;
+	FishResultCacheStats stats;
+	mutable mutex cacheMutex;
+
+	static string keyOf(const long userId, const string& filter);
+
+	// Get the DEPENDS_ON values that differ between two versions of a fish
+	static uint8_t changedValues(const Fish& previous, const Fish& fish);
+
+	// Get the approximate number of bytes held by a result
+	static size_t bytesOf(const Entry& entry);
+
+	/*
+	* @brief Drops the results of a user that depend on the given values
+	* Must be called with cacheMutex locked
+	* @param userId - the id of the user
+	* @param changed - the DEPENDS_ON values that changed
+	*/
+	void invalidate(const long userId, const uint8_t changed);
+};
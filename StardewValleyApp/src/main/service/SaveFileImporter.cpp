@@ -0,0 +1,258 @@
+#include "SaveFileImporter.h"
+#include "../utils/CaseFolding.h"
+#include <QFile>
+#include <QString>
+#include <QDebug>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+// The Stardew Valley item ids of the fish, the ids added by 1.6 are their names
+static const unordered_map<string_view, string_view> FISH_ITEM_NAMES = {
+	{ "128", "Pufferfish" }, { "129", "Anchovy" }, { "130", "Tuna" }, { "131", "Sardine" }, { "132", "Bream" },
+	{ "136", "Largemouth Bass" }, { "137", "Smallmouth Bass" }, { "138", "Rainbow Trout" }, { "139", "Salmon" },
+	{ "140", "Walleye" }, { "141", "Perch" }, { "142", "Carp" }, { "143", "Catfish" }, { "144", "Pike" },
+	{ "145", "Sunfish" }, { "146", "Red Mullet" }, { "147", "Herring" }, { "148", "Eel" }, { "149", "Octopus" },
+	{ "150", "Red Snapper" }, { "151", "Squid" }, { "154", "Sea Cucumber" }, { "155", "Super Cucumber" },
+	{ "156", "Ghostfish" }, { "158", "Stonefish" }, { "159", "Crimsonfish" }, { "160", "Angler" }, { "161", "Ice Pip" },
+	{ "162", "Lava Eel" }, { "163", "Legend" }, { "164", "Sandfish" }, { "165", "Scorpion Carp" }, { "267", "Flounder" },
+	{ "269", "Midnight Carp" }, { "372", "Clam" }, { "682", "Mutant Carp" }, { "698", "Sturgeon" }, { "699", "Tiger Trout" },
+	{ "700", "Bullhead" }, { "701", "Tilapia" }, { "702", "Chub" }, { "704", "Dorado" }, { "705", "Albacore" },
+	{ "706", "Shad" }, { "707", "Lingcod" }, { "708", "Halibut" }, { "715", "Lobster" }, { "716", "Crayfish" },
+	{ "717", "Crab" }, { "718", "Cockle" }, { "719", "Mussel" }, { "720", "Shrimp" }, { "721", "Snail" },
+	{ "722", "Periwinkle" }, { "723", "Oyster" }, { "734", "Woodskip" }, { "775", "Glacierfish" }, { "795", "Void Salmon" },
+	{ "796", "Slimejack" }, { "798", "Midnight Squid" }, { "799", "Spook Fish" }, { "800", "Blobfish" },
+	{ "836", "Stingray" }, { "837", "Lionfish" }, { "838", "Blue Discus" }, { "898", "Son of Crimsonfish" },
+	{ "899", "Ms. Angler" }, { "900", "Legend II" }, { "901", "Radioactive Carp" }, { "902", "Glacierfish Jr." },
+	{ "Goby", "Goby" }
+};
+
+static string_view trim(string_view text) {
+	const size_t first = text.find_first_not_of(" \t\r\n");
+	if (first == string_view::npos) {
+		return string_view();
+	}
+	return text.substr(first, text.find_last_not_of(" \t\r\n") - first + 1);
+}
+
+// Reads the fishCaught entries of the player: <fishCaught><item><key><int>145</int></key><value><ArrayOfInt><int>3</int>...
+class FishCaughtHandler : public SaveFileImporter::SaxHandler {
+public:
+	// The item id and the number caught of every entry
+	vector<pair<string_view, long>> entries;
+	bool sawPlayer = false;
+
+	bool startElement(const string_view name) override {
+		elements.push_back(name);
+		if (name == "player" && elements.size() == 2) {
+			sawPlayer = true;
+		}
+		if (fishCaughtIndex < 0 && name == "fishCaught" && elements.size() == 3 && elements[1] == "player") {
+			fishCaughtIndex = static_cast<int>(elements.size()) - 1;
+		}
+		if (fishCaughtIndex >= 0 && elements.size() == static_cast<size_t>(fishCaughtIndex) + 2 && name == "item") {
+			key = string_view();
+			count = -1;
+		}
+		return true;
+	}
+
+	bool endElement(const string_view name) override {
+		if (elements.empty()) {
+			return false;
+		}
+		const size_t depth = elements.size() - 1;
+		elements.pop_back();
+		if (fishCaughtIndex < 0) {
+			return true;
+		}
+
+		// The fish of the player are all read, the rest of the save is not needed
+		if (depth == static_cast<size_t>(fishCaughtIndex)) {
+			fishCaughtIndex = -1;
+			done = true;
+			return false;
+		}
+		if (depth == static_cast<size_t>(fishCaughtIndex) + 1 && name == "item" && !key.empty()) {
+			entries.emplace_back(key, count);
+		}
+		return true;
+	}
+
+	bool characters(const string_view text) override {
+		if (fishCaughtIndex < 0) {
+			return true;
+		}
+		const size_t item = static_cast<size_t>(fishCaughtIndex) + 1;
+		if (elements.size() == item + 3 && elements[item + 1] == "key") {
+			key = trim(text);
+		}
+		else if (elements.size() == item + 4 && elements[item + 1] == "value" && elements[item + 3] == "int" && count < 0) {
+			// The first number of the value is the number of times the fish was caught
+			const string number(trim(text));
+			count = strtol(number.c_str(), nullptr, 10);
+		}
+		return true;
+	}
+
+	bool isDone() const {
+		return done;
+	}
+
+private:
+	vector<string_view> elements;
+	int fishCaughtIndex = -1;
+	bool done = false;
+	string_view key;
+	long count = -1;
+};
+
+double SaveFileImport::megabytesPerSecond() const {
+	return seconds > 0 ? bytes / (1024.0 * 1024.0) / seconds : 0;
+}
+
+SaveFileImporter::SaveFileImporter(const vector<Fish>& fishList) {
+	for (const Fish& fish : fishList) {
+		fishIdsByName[CaseFolding::toLower(fish.getName())] = fish.getId();
+	}
+}
+
+SaveFileImport SaveFileImporter::readFile(const string& path) const {
+	const auto start = chrono::steady_clock::now();
+
+	QFile file(QString::fromStdString(path));
+	if (!file.open(QIODevice::ReadOnly)) {
+		qDebug() << "Failed to open save file: " << QString::fromStdString(path);
+		return SaveFileImport();
+	}
+
+	// The save is read in place from the mapping, a copy of it is only made if it cannot be mapped
+	SaveFileImport saveImport;
+	const qint64 size = file.size();
+	const uchar* data = size > 0 ? file.map(0, size) : nullptr;
+	if (data != nullptr) {
+		saveImport = readXml(string_view(reinterpret_cast<const char*>(data), static_cast<size_t>(size)));
+		file.unmap(const_cast<uchar*>(data));
+	}
+	else {
+		const QByteArray contents = file.readAll();
+		saveImport = readXml(string_view(contents.constData(), static_cast<size_t>(contents.size())));
+	}
+	file.close();
+
+	saveImport.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	qDebug() << "Read save file: " << saveImport.entries << " entries, " << saveImport.bytes << " bytes, " << saveImport.megabytesPerSecond() << " MB/s";
+	return saveImport;
+}
+
+SaveFileImport SaveFileImporter::readXml(const string_view xml) const {
+	const auto start = chrono::steady_clock::now();
+
+	SaveFileImport saveImport;
+	FishCaughtHandler handler;
+	const bool parsed = parseXml(xml, handler, &saveImport.bytes);
+	saveImport.valid = handler.sawPlayer && (parsed || handler.isDone());
+
+	for (const auto& [itemId, count] : handler.entries) {
+		saveImport.entries++;
+		if (count == 0) {
+			continue;
+		}
+		const string_view name = fishNameOfItem(itemId);
+		auto fishId = name.empty() ? fishIdsByName.end() : fishIdsByName.find(CaseFolding::toLower(name));
+		if (fishId == fishIdsByName.end()) {
+			saveImport.unknownItems.emplace_back(itemId);
+		}
+		else if (find(saveImport.caughtFishIds.begin(), saveImport.caughtFishIds.end(), fishId->second) == saveImport.caughtFishIds.end()) {
+			saveImport.caughtFishIds.push_back(fishId->second);
+		}
+	}
+
+	saveImport.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	return saveImport;
+}
+
+bool SaveFileImporter::parseXml(const string_view xml, SaxHandler& handler, size_t* parsedBytes) {
+	size_t position = 0;
+	bool completed = true;
+	auto startsWith = [&xml](const size_t at, const string_view prefix) {
+		return xml.compare(at, prefix.size(), prefix) == 0;
+	};
+
+	while (position < xml.size()) {
+		const void* found = memchr(xml.data() + position, '<', xml.size() - position);
+		const size_t tagStart = found != nullptr ? static_cast<const char*>(found) - xml.data() : xml.size();
+		if (tagStart > position && !handler.characters(xml.substr(position, tagStart - position))) {
+			position = tagStart;
+			completed = false;
+			break;
+		}
+		if (tagStart == xml.size()) {
+			position = tagStart;
+			break;
+		}
+
+		// Comments, processing instructions and declarations hold no elements, a CDATA section is text
+		if (startsWith(tagStart, "<!--") || startsWith(tagStart, "<?") || startsWith(tagStart, "<![CDATA[") || startsWith(tagStart, "<!")) {
+			const bool isCdata = startsWith(tagStart, "<![CDATA[");
+			const string_view terminator = startsWith(tagStart, "<!--") ? "-->" : startsWith(tagStart, "<?") ? "?>" : isCdata ? "]]>" : ">";
+			const size_t end = xml.find(terminator, tagStart + 2);
+			if (end == string_view::npos) {
+				completed = false;
+				break;
+			}
+			position = end + terminator.size();
+			if (isCdata && !handler.characters(xml.substr(tagStart + 9, end - tagStart - 9))) {
+				completed = false;
+				break;
+			}
+			continue;
+		}
+
+		// The tag ends at the first > outside of a quoted attribute value
+		size_t end = tagStart + 1;
+		char quote = 0;
+		while (end < xml.size() && (quote != 0 || xml[end] != '>')) {
+			if (quote != 0) {
+				quote = xml[end] == quote ? 0 : quote;
+			}
+			else if (xml[end] == '"' || xml[end] == '\'') {
+				quote = xml[end];
+			}
+			end++;
+		}
+		if (end == xml.size()) {
+			position = tagStart;
+			completed = false;
+			break;
+		}
+		position = end + 1;
+
+		if (xml[tagStart + 1] == '/') {
+			if (!handler.endElement(trim(xml.substr(tagStart + 2, end - tagStart - 2)))) {
+				completed = false;
+				break;
+			}
+			continue;
+		}
+
+		const size_t nameEnd = min(xml.find_first_of(" \t\r\n/>", tagStart + 1), end);
+		const string_view name = xml.substr(tagStart + 1, nameEnd - tagStart - 1);
+		if (!handler.startElement(name) || (xml[end - 1] == '/' && !handler.endElement(name))) {
+			completed = false;
+			break;
+		}
+	}
+
+	if (parsedBytes != nullptr) {
+		*parsedBytes = position;
+	}
+	return completed;
+}
+
+string_view SaveFileImporter::fishNameOfItem(const string_view itemId) {
+	// The ids of the 1.6 saves are qualified by the type of the item, like (O)145
+	const string_view unqualified = itemId.substr(0, 3) == "(O)" ? itemId.substr(3) : itemId;
+	auto name = FISH_ITEM_NAMES.find(unqualified);
+	return name != FISH_ITEM_NAMES.end() ? name->second : string_view();
+}
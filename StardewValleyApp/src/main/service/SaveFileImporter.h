@@ -0,0 +1,98 @@
+#pragma once
+
+#include "../model/Fish.h"
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// What an import found in a save file, and how fast the file was read
+struct SaveFileImport {
+	// The fishCaught entries of the player
+	size_t entries = 0;
+
+	// The ids of the fish of the entries that were matched to a fish, in the order of the file
+	vector<long> caughtFishIds;
+
+	// The item ids of the entries that are not a known fish
+	vector<string> unknownItems;
+
+	// The bytes of the file that were parsed, and the time taken to map and parse them
+	size_t bytes = 0;
+	double seconds = 0;
+
+	// True if the file could be read and holds a player
+	bool valid = false;
+
+	// The matched fish that were not caught before, set when the import is applied
+	size_t newlyCaught = 0;
+
+	// Get the number of megabytes read every second
+	double megabytesPerSecond() const;
+};
+
+
+class SaveFileImporter {
+
+public:
+	/*
+	* Importer of the fish caught in a Stardew Valley save file
+	* The save is memory-mapped and read by a streaming SAX-style parser, so its XML is never loaded as a tree
+	* and the parser stops as soon as the fishCaught entries of the player were read
+	* @param fishList - the fish the entries are matched to, by name
+	*/
+	explicit SaveFileImporter(const vector<Fish>& fishList);
+
+
+	/*
+	* @brief Reads the fish caught by the player of a save file
+	* @param path - the path to the save file
+	* @return the import, not valid if the file could not be opened
+	*/
+	SaveFileImport readFile(const string& path) const;
+
+
+	/*
+	* @brief Reads the fish caught by the player of the XML of a save
+	* @param xml - the XML of the save
+	* @return the import
+	*/
+	SaveFileImport readXml(const string_view xml) const;
+
+
+	/*
+	* The events a SAX-style parser passes to its handler, every one of them returns false to stop the parsing
+	* The names and texts are views into the parsed XML, they are valid as long as the XML is
+	*/
+	class SaxHandler {
+	public:
+		virtual ~SaxHandler() = default;
+		virtual bool startElement(const string_view name) = 0;
+		virtual bool endElement(const string_view name) = 0;
+		virtual bool characters(const string_view text) = 0;
+	};
+
+
+	/*
+	* @brief Parses an XML document, passing its elements and texts to a handler as they are found
+	* The attributes, comments, processing instructions and declarations are skipped, and the entities are not decoded
+	* @param xml - the XML document
+	* @param handler - the handler of the events
+	* @param parsedBytes - if not null, receives the number of bytes parsed before the parsing ended
+	* @return true if the whole document was parsed, false if the handler stopped it or the XML is broken
+	*/
+	static bool parseXml(const string_view xml, SaxHandler& handler, size_t* parsedBytes = nullptr);
+
+private:
+	// The ids of the fish, by their name folded to lower case
+	unordered_map<string, long> fishIdsByName;
+
+	/*
+	* @brief Gets the name of the fish of a Stardew Valley item id, like "145", "(O)145" or "Goby"
+	* @param itemId - the item id of a fishCaught entry
+	* @return the name of the fish, or an empty view if the item is not a known fish
+	*/
+	static string_view fishNameOfItem(const string_view itemId);
+};
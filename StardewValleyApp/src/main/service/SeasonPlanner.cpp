@@ -0,0 +1,341 @@
+#include "SeasonPlanner.h"
+#include <algorithm>
+#include <bitset>
+#include <thread>
+
+// Get the ids of the set bits, from the lowest one
+static vector<uint16_t> idsOfBits(uint64_t bits) {
+	vector<uint16_t> ids;
+	for (uint16_t id = 0; bits != 0; id++, bits >>= 1) {
+		if (bits & 1) {
+			ids.push_back(id);
+		}
+	}
+	return ids;
+}
+
+static int popcount(const uint64_t bits) {
+	return static_cast<int>(bitset<64>(bits).count());
+}
+
+string PlanStep::toString() const {
+	string text = season + " " + to_string(day) + ", " + CatchTimes::formatTime(minute) + ", " + weather + ", " + location + ":";
+	for (size_t i = 0; i < fish.size(); i++) {
+		text += (i == 0 ? " " : ", ") + fish[i].getName();
+	}
+	return text;
+}
+
+size_t SeasonPlan::plannedCount() const {
+	size_t count = 0;
+	for (const PlanStep& step : steps) {
+		count += step.fish.size();
+	}
+	return count;
+}
+
+SeasonPlanner::SeasonPlanner(const int sessionsPerDay) : sessionsPerDay(max(1, min(sessionsPerDay, HOURS_PER_DAY))) {}
+
+shared_ptr<const SeasonPlan> SeasonPlanner::plan(const long userId, const function<vector<Fish>()>& loadFish) {
+	shared_ptr<const AvailabilityMatrix> currentMatrix;
+	uint64_t startGeneration = 0;
+	{
+		lock_guard<mutex> lock(plansMutex);
+		auto cached = plans.find(userId);
+		if (cached != plans.end()) {
+			return cached->second;
+		}
+		currentMatrix = matrix;
+		startGeneration = generation;
+	}
+
+	// The fish are read, the matrix built and the plan made without the lock, so the other users get their cached plans meanwhile
+	const vector<Fish> newFishList = loadFish();
+	const bool rebuilt = currentMatrix == nullptr || !currentMatrix->matches(newFishList);
+	if (rebuilt) {
+		currentMatrix = buildMatrix(newFishList);
+	}
+
+	vector<uint64_t> uncaught(currentMatrix->words, 0);
+	for (const Fish& fish : newFishList) {
+		auto index = currentMatrix->indexById.find(fish.getId());
+		if (index != currentMatrix->indexById.end() && !fish.getIsCaught()) {
+			uncaught[index->second / 64] |= uint64_t(1) << (index->second % 64);
+		}
+	}
+	shared_ptr<SeasonPlan> userPlan = planGreedy(*currentMatrix, std::move(uncaught));
+
+	lock_guard<mutex> lock(plansMutex);
+	if (generation != startGeneration) {
+		// A fish changed while the plan was made, it may already be out of date
+		return userPlan;
+	}
+	if (rebuilt) {
+		// The plans of the other users were made from the fish before they changed
+		matrix = currentMatrix;
+		plans.clear();
+		generation++;
+	}
+	return plans.emplace(userId, userPlan).first->second;
+}
+
+bool SeasonPlanner::hasPlan(const long userId) const {
+	lock_guard<mutex> lock(plansMutex);
+	return plans.count(userId) > 0;
+}
+
+void SeasonPlanner::onFishUpdated(const long userId, const Fish& fish) {
+	lock_guard<mutex> lock(plansMutex);
+	generation++;
+	auto cached = plans.find(userId);
+	if (cached == plans.end()) {
+		return;
+	}
+	auto index = matrix->indexById.find(fish.getId());
+	if (index == matrix->indexById.end()) {
+		plans.erase(cached);
+		return;
+	}
+
+	const Fish& indexed = matrix->fishList[index->second];
+	const bool sameCells = indexed.getSeason() == fish.getSeason() && indexed.getWeather() == fish.getWeather() && indexed.getLocation() == fish.getLocation() && indexed.getCatchTimes() == fish.getCatchTimes();
+	if (!sameCells || !fish.getIsCaught()) {
+		// A fish that can be caught elsewhere, or that has to be caught again, needs a new plan
+		plans.erase(cached);
+		return;
+	}
+
+	// The plan is shared with the callers that got it, so the change is made on a copy
+	shared_ptr<SeasonPlan> updated = make_shared<SeasonPlan>(*cached->second);
+	for (auto step = updated->steps.begin(); step != updated->steps.end(); ++step) {
+		auto planned = find_if(step->fish.begin(), step->fish.end(), [&fish](const Fish& other) { return other.getId() == fish.getId(); });
+		if (planned != step->fish.end()) {
+			step->fish.erase(planned);
+			if (step->fish.empty()) {
+				updated->steps.erase(step);
+			}
+			break;
+		}
+	}
+	updated->unreachable.erase(remove_if(updated->unreachable.begin(), updated->unreachable.end(), [&fish](const Fish& other) { return other.getId() == fish.getId(); }), updated->unreachable.end());
+	cached->second = updated;
+}
+
+void SeasonPlanner::evict(const long userId) {
+	lock_guard<mutex> lock(plansMutex);
+	generation++;
+	plans.erase(userId);
+}
+
+void SeasonPlanner::clear() {
+	lock_guard<mutex> lock(plansMutex);
+	generation++;
+	plans.clear();
+	matrix.reset();
+}
+
+shared_ptr<const SeasonPlanner::AvailabilityMatrix> SeasonPlanner::buildMatrix(const vector<Fish>& fishList) {
+	shared_ptr<AvailabilityMatrix> built = make_shared<AvailabilityMatrix>();
+	built->fishList = fishList;
+	built->words = (fishList.size() + 63) / 64;
+
+	// A fish that bites in All weathers is put in the cells of every weather, All is not a weather of its own; the same goes for the seasons and locations
+	const uint64_t everySeason = everyValueBits(AttributeKind::Season);
+	const uint64_t everyWeather = everyValueBits(AttributeKind::Weather);
+	const uint64_t everyLocation = everyValueBits(AttributeKind::Location);
+	const uint64_t concreteSeasons = concreteValueBits(AttributeKind::Season, everySeason);
+	const uint64_t concreteWeathers = concreteValueBits(AttributeKind::Weather, everyWeather);
+	const uint64_t concreteLocations = concreteValueBits(AttributeKind::Location, everyLocation);
+
+	vector<uint64_t> fishSeasons(fishList.size());
+	vector<uint64_t> fishWeathers(fishList.size());
+	vector<uint64_t> fishLocations(fishList.size());
+	uint64_t seasons = 0;
+	uint64_t weathers = 0;
+	uint64_t locations = 0;
+	for (size_t i = 0; i < fishList.size(); i++) {
+		built->indexById[fishList[i].getId()] = i;
+		fishSeasons[i] = expandBits(fishList[i].getSeason().getBits(), everySeason, concreteSeasons);
+		fishWeathers[i] = expandBits(fishList[i].getWeather().getBits(), everyWeather, concreteWeathers);
+		fishLocations[i] = expandBits(fishList[i].getLocation().getBits(), everyLocation, concreteLocations);
+		seasons |= fishSeasons[i];
+		weathers |= fishWeathers[i];
+		locations |= fishLocations[i];
+	}
+	built->seasonIds = idsOfBits(seasons);
+	built->weatherIds = idsOfBits(weathers);
+	built->locationIds = idsOfBits(locations);
+
+	const size_t words = built->words;
+	built->cells.assign(built->seasonIds.size() * built->weatherIds.size() * HOURS_PER_DAY * built->locationIds.size() * words, 0);
+
+	// Every thread fills the cells of its own (season, weather) pairs, so no two threads write the same cell
+	const size_t pairs = built->seasonIds.size() * built->weatherIds.size();
+	const size_t threadCount = max<size_t>(1, min<size_t>(thread::hardware_concurrency(), pairs));
+	auto fillPairs = [&, pairs, threadCount](const size_t first) {
+		for (size_t pair = first; pair < pairs; pair += threadCount) {
+			const size_t season = pair / built->weatherIds.size();
+			const size_t weather = pair % built->weatherIds.size();
+			for (size_t fishIndex = 0; fishIndex < fishList.size(); fishIndex++) {
+				if (((fishSeasons[fishIndex] >> built->seasonIds[season]) & 1) == 0 || ((fishWeathers[fishIndex] >> built->weatherIds[weather]) & 1) == 0) {
+					continue;
+				}
+				for (size_t hour = 0; hour < HOURS_PER_DAY; hour++) {
+					if (!fishList[fishIndex].getCatchTimes().contains(static_cast<int>(FIRST_HOUR + hour) * 60)) {
+						continue;
+					}
+					for (size_t location = 0; location < built->locationIds.size(); location++) {
+						if ((fishLocations[fishIndex] >> built->locationIds[location]) & 1) {
+							built->cells[built->cellIndex(season, weather, hour, location) * words + fishIndex / 64] |= uint64_t(1) << (fishIndex % 64);
+						}
+					}
+				}
+			}
+		}
+	};
+
+	vector<thread> threads;
+	for (size_t first = 1; first < threadCount; first++) {
+		threads.emplace_back(fillPairs, first);
+	}
+	fillPairs(0);
+	for (thread& worker : threads) {
+		worker.join();
+	}
+	return built;
+}
+
+bool SeasonPlanner::AvailabilityMatrix::matches(const vector<Fish>& newFishList) const {
+	if (newFishList.size() != fishList.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < fishList.size(); i++) {
+		const Fish& fish = fishList[i];
+		const Fish& other = newFishList[i];
+		if (fish.getId() != other.getId() || fish.getSeason() != other.getSeason() || fish.getWeather() != other.getWeather() || fish.getLocation() != other.getLocation() || !(fish.getCatchTimes() == other.getCatchTimes())) {
+			return false;
+		}
+	}
+	return true;
+}
+
+shared_ptr<SeasonPlan> SeasonPlanner::planGreedy(const AvailabilityMatrix& matrix, vector<uint64_t> uncaught) const {
+	shared_ptr<SeasonPlan> seasonPlan = make_shared<SeasonPlan>();
+
+	// Every day of a season has one weather, fixed by its first session, and every hour of it holds one session
+	const size_t days = matrix.seasonIds.size() * DAYS_PER_SEASON;
+	vector<int> dayWeather(days, -1);
+	vector<int> daySessions(days, 0);
+	vector<uint32_t> dayHours(days, 0);
+
+	auto freeDay = [&](const size_t season, const size_t weather, const size_t hour) -> int {
+		int firstFree = -1;
+		for (int day = 0; day < DAYS_PER_SEASON; day++) {
+			const size_t slot = season * DAYS_PER_SEASON + day;
+			if (daySessions[slot] >= sessionsPerDay || (dayHours[slot] >> hour) & 1) {
+				continue;
+			}
+			// A day that already has the weather is filled before a new day is started
+			if (dayWeather[slot] == static_cast<int>(weather)) {
+				return day;
+			}
+			if (dayWeather[slot] == -1 && firstFree == -1) {
+				firstFree = day;
+			}
+		}
+		return firstFree;
+	};
+
+	while (true) {
+		int bestGain = 0;
+		size_t bestCell = 0;
+		int bestDay = -1;
+		bool bestStarted = false;
+		for (size_t season = 0; season < matrix.seasonIds.size(); season++) {
+			for (size_t weather = 0; weather < matrix.weatherIds.size(); weather++) {
+				for (size_t hour = 0; hour < HOURS_PER_DAY; hour++) {
+					for (size_t location = 0; location < matrix.locationIds.size(); location++) {
+						const size_t cell = matrix.cellIndex(season, weather, hour, location);
+						int gain = 0;
+						for (size_t word = 0; word < matrix.words; word++) {
+							gain += popcount(matrix.cells[cell * matrix.words + word] & uncaught[word]);
+						}
+						if (gain < bestGain || gain == 0 || (gain == bestGain && bestStarted)) {
+							continue;
+						}
+						const int day = freeDay(season, weather, hour);
+						if (day < 0) {
+							continue;
+						}
+
+						// Between cells that catch as many fish, a day that is already planned is filled before a new one
+						const bool started = dayWeather[season * DAYS_PER_SEASON + day] != -1;
+						if (gain > bestGain || started) {
+							bestGain = gain;
+							bestCell = cell;
+							bestDay = day;
+							bestStarted = started;
+						}
+					}
+				}
+			}
+		}
+		if (bestDay < 0) {
+			break;
+		}
+
+		const size_t location = bestCell % matrix.locationIds.size();
+		const size_t hour = (bestCell / matrix.locationIds.size()) % HOURS_PER_DAY;
+		const size_t weather = (bestCell / matrix.locationIds.size() / HOURS_PER_DAY) % matrix.weatherIds.size();
+		const size_t season = bestCell / matrix.locationIds.size() / HOURS_PER_DAY / matrix.weatherIds.size();
+
+		PlanStep step;
+		step.season = InternTable::of(AttributeKind::Season).name(matrix.seasonIds[season]);
+		step.day = bestDay + 1;
+		step.weather = InternTable::of(AttributeKind::Weather).name(matrix.weatherIds[weather]);
+		step.minute = static_cast<int>((FIRST_HOUR + hour) * 60 % CatchTimes::MINUTES_PER_DAY);
+		step.location = InternTable::of(AttributeKind::Location).name(matrix.locationIds[location]);
+		for (size_t word = 0; word < matrix.words; word++) {
+			for (uint64_t caught = matrix.cells[bestCell * matrix.words + word] & uncaught[word]; caught != 0; caught &= caught - 1) {
+				step.fish.push_back(matrix.fishList[word * 64 + popcount((caught & (~caught + 1)) - 1)]);
+			}
+			uncaught[word] &= ~matrix.cells[bestCell * matrix.words + word];
+		}
+		seasonPlan->steps.push_back(std::move(step));
+
+		const size_t slot = season * DAYS_PER_SEASON + bestDay;
+		dayWeather[slot] = static_cast<int>(weather);
+		daySessions[slot]++;
+		dayHours[slot] |= uint32_t(1) << hour;
+	}
+
+	// The sessions are listed in the order they are played: by season, day and hour of the fishing day
+	auto seasonOrder = [&matrix](const string& name) {
+		return find(matrix.seasonIds.begin(), matrix.seasonIds.end(), static_cast<uint16_t>(InternTable::of(AttributeKind::Season).find(name))) - matrix.seasonIds.begin();
+	};
+	auto fishingMinute = [](const int minute) {
+		return (minute - FIRST_HOUR * 60 + CatchTimes::MINUTES_PER_DAY) % CatchTimes::MINUTES_PER_DAY;
+	};
+	stable_sort(seasonPlan->steps.begin(), seasonPlan->steps.end(), [&](const PlanStep& a, const PlanStep& b) {
+		const auto seasonA = seasonOrder(a.season);
+		const auto seasonB = seasonOrder(b.season);
+		if (seasonA != seasonB) {
+			return seasonA < seasonB;
+		}
+		if (a.day != b.day) {
+			return a.day < b.day;
+		}
+		return fishingMinute(a.minute) < fishingMinute(b.minute);
+	});
+
+	for (size_t word = 0; word < matrix.words; word++) {
+		for (uint64_t left = uncaught[word]; left != 0; left &= left - 1) {
+			seasonPlan->unreachable.push_back(matrix.fishList[word * 64 + popcount((left & (~left + 1)) - 1)]);
+		}
+	}
+	return seasonPlan;
+}
+
+size_t SeasonPlanner::AvailabilityMatrix::cellIndex(const size_t season, const size_t weather, const size_t hour, const size_t location) const {
+	return ((season * weatherIds.size() + weather) * HOURS_PER_DAY + hour) * locationIds.size() + location;
+}
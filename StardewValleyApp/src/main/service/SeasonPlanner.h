@@ -0,0 +1,144 @@
+#pragma once
+
+#include "../model/Fish.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// One fishing session of a plan: where and when to fish, and the new fish it catches
+struct PlanStep {
+	string season;
+	int day = 1;
+	string weather;
+	int minute = 0;
+	string location;
+	vector<Fish> fish;
+
+	// Get the step as it is shown to the user, like "Spring 1, 6am, Sun, Ocean: Tuna, Sardine"
+	string toString() const;
+};
+
+
+// A schedule of fishing sessions, in the order of the days, for the fish a user has not caught yet
+struct SeasonPlan {
+	vector<PlanStep> steps;
+
+	// The uncaught fish that no session of the plan can catch
+	vector<Fish> unreachable;
+
+	// Get the number of fish the plan catches
+	size_t plannedCount() const;
+};
+
+
+class SeasonPlanner {
+
+public:
+	static constexpr int DAYS_PER_SEASON = 28;
+
+	// The fishing day goes from 6am to 2am, one session can start at every hour of it
+	static constexpr int FIRST_HOUR = 6;
+	static constexpr int HOURS_PER_DAY = 20;
+
+	/*
+	* Planner of the fish a user has not caught yet
+	* Builds a season x weather x hour x location availability matrix of the fish, in parallel, and plans
+	* the sessions greedily: every session is the cell that catches the most fish that are not planned yet
+	* @param sessionsPerDay - the number of sessions the plan can put in one day
+	*/
+	explicit SeasonPlanner(const int sessionsPerDay = 3);
+
+
+	/*
+	* @brief Plans the uncaught fish of a user, or returns the plan cached for the user
+	* @param userId - the id of the user
+	* @param loadFish - called to get all the fish, with the caught state of the user, only if no plan is cached
+	* @return the plan of the user
+	*/
+	shared_ptr<const SeasonPlan> plan(const long userId, const function<vector<Fish>()>& loadFish);
+
+
+	/*
+	* @brief Checks if a plan is cached for a user
+	* @param userId - the id of the user
+	*/
+	bool hasPlan(const long userId) const;
+
+
+	/*
+	* @brief Updates the plan of a user after a fish was changed
+	* A fish marked caught is only removed from its session; any other change drops the plan, so it is planned again
+	* @param userId - the id of the user
+	* @param fish - the updated fish
+	*/
+	void onFishUpdated(const long userId, const Fish& fish);
+
+
+	/*
+	* @brief Drops the plan of a user, so it is planned again on the next call
+	* @param userId - the id of the user
+	*/
+	void evict(const long userId);
+
+
+	/*
+	* @brief Drops the plans of all the users, and the availability matrix
+	*/
+	void clear();
+
+private:
+	// The availability of the fish, it does not depend on the user and is only built again when the fish themselves changed
+	struct AvailabilityMatrix {
+		// The fish of the matrix, and the position of every fish in the rows of bits
+		vector<Fish> fishList;
+		unordered_map<long, size_t> indexById;
+		size_t words = 0;
+
+		// The interned ids of every dimension of the matrix, without the names that stand for all of their kind
+		vector<uint16_t> seasonIds;
+		vector<uint16_t> weatherIds;
+		vector<uint16_t> locationIds;
+
+		// One row of bits (one bit for every fish) for every cell of the matrix, the cells in season, weather, hour, location order
+		vector<uint64_t> cells;
+
+		size_t cellIndex(const size_t season, const size_t weather, const size_t hour, const size_t location) const;
+
+		/*
+		* @brief Checks if the matrix was built from the same fish, with the same seasons, weathers, locations and catch times
+		* @param fishList - the fish
+		*/
+		bool matches(const vector<Fish>& fishList) const;
+	};
+
+	int sessionsPerDay;
+
+	shared_ptr<const AvailabilityMatrix> matrix;
+	unordered_map<long, shared_ptr<SeasonPlan>> plans;
+
+	// Counts the changes that dropped plans, a plan made from fish read before one of them is returned but not cached
+	uint64_t generation = 0;
+	mutable mutex plansMutex;
+
+	/*
+	* @brief Builds the availability matrix of the fish, one thread for every part of the (season, weather) pairs
+	* A season, weather or location named All or Any stands for every season, weather or location
+	* @param fishList - the fish
+	*/
+	static shared_ptr<const AvailabilityMatrix> buildMatrix(const vector<Fish>& fishList);
+
+
+	/*
+	* @brief Plans the sessions that catch the most of the given fish
+	* @param matrix - the availability matrix of the fish
+	* @param uncaught - the bits of the fish to plan
+	* @return the plan
+	*/
+	shared_ptr<SeasonPlan> planGreedy(const AvailabilityMatrix& matrix, vector<uint64_t> uncaught) const;
+};
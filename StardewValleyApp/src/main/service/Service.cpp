@@ -1,59 +1,222 @@
 #include "Service.h"
 
-const vector<Fish> Service::getAllFish(const long userId) const noexcept {
+vector<Fish> Service::getAllFish(const long userId) const noexcept {
 	return fishRepository.findAll(userId);
 }
 
+void Service::forEachFish(const long userId, const function<void(const Fish&)>& visitor) const {
+	fishRepository.forEach(userId, visitor);
+}
+
+FishPage Service::getFishPage(const long userId, const FishPageRequest& request) const {
+	return fishRepository.findPage(userId, request);
+}
+
+string Service::forEachFishInPage(const long userId, const FishPageRequest& request, const function<void(const Fish&)>& visitor) const {
+	return fishRepository.forEachInPage(userId, request, visitor);
+}
+
 const long Service::getAllFishNumber() const noexcept {
 	return fishRepository.findAllFishNumber();
 }
 
-const vector<User> Service::getAllUsers() const noexcept {
+vector<User> Service::getAllUsers() const noexcept {
 	return fishRepository.findAllUsers();
 }
 
-const Fish Service::getFishById(const long id, const long userId) const {
+Fish Service::getFishById(const long id, const long userId) const {
 	return fishRepository.findOne(id, userId);
 }
 
-const vector<Fish> Service::getAllFishFiltered(const long userId, const string& input) const noexcept {
-    return fishRepository.findAllFiltered(userId, input);
+vector<Fish> Service::getAllFishFiltered(const long userId, const string& input) const noexcept {
+	// The input is matched with LIKE, which ignores the case of ASCII letters
+	return cachedResult(userId, "search\x1f" + CaseFolding::toLower(input), FishResultCache::DEPENDS_ON_ATTRIBUTES, [this, userId, &input]() {
+		return fishRepository.findAllFiltered(userId, input);
+	});
 }
 
-const vector<string> Service::getAllWeathers() const noexcept {
+vector<string> Service::getAllWeathers() const noexcept {
 	return fishRepository.findAllWeathers();
 }
 
-const vector<string> Service::getAllSeasons() const noexcept {
+vector<string> Service::getAllSeasons() const noexcept {
 	return fishRepository.findAllSeasons();
 }
 
-const vector<string> Service::getAllLocations() const noexcept {
+vector<string> Service::getAllLocations() const noexcept {
 	return fishRepository.findAllLocations();
 }
 
-const vector<Fish> Service::getAllFishBySeasonWeatherLocation(const long userId, const string& season, const string& weather, const string& location) const noexcept {
-	return fishRepository.findAllBySeasonWeatherLocation(userId, season == "All (No Filter)" ? "" : season, weather == "All (No Filter)" ? "" : weather, location == "All (No Filter)" ? "" : location);
+vector<Fish> Service::getAllFishBySeasonWeatherLocation(const long userId, const string& season, const string& weather, const string& location) const noexcept {
+	const string anySeason = season == "All (No Filter)" ? "" : season;
+	const string anyWeather = weather == "All (No Filter)" ? "" : weather;
+	const string anyLocation = location == "All (No Filter)" ? "" : location;
+
+	// The names are matched without case, so the keys are folded like the key of the search
+	const string key = "conditions\x1f" + CaseFolding::toLower(anySeason) + '\x1f' + CaseFolding::toLower(anyWeather) + '\x1f' + CaseFolding::toLower(anyLocation);
+	return cachedResult(userId, key, FishResultCache::DEPENDS_ON_ATTRIBUTES, [&]() {
+		return fishRepository.findAllBySeasonWeatherLocation(userId, anySeason, anyWeather, anyLocation);
+	});
+}
+
+vector<Fish> Service::getAllFishByWeather(const long userId, const string& weather) const noexcept {
+	return cachedResult(userId, "weather\x1f" + CaseFolding::toLower(weather), FishResultCache::DEPENDS_ON_ATTRIBUTES, [this, userId, &weather]() {
+		return fishRepository.findAllByWeather(userId, weather);
+	});
+}
+
+vector<Fish> Service::getAllFishBySeason(const long userId, const string& season) const noexcept {
+	return cachedResult(userId, "season\x1f" + CaseFolding::toLower(season), FishResultCache::DEPENDS_ON_ATTRIBUTES, [this, userId, &season]() {
+		return fishRepository.findAllBySeason(userId, season);
+	});
+}
+
+vector<Fish> Service::getAllFishByLocation(const long userId, const string& location) const noexcept {
+	return cachedResult(userId, "location\x1f" + CaseFolding::toLower(location), FishResultCache::DEPENDS_ON_ATTRIBUTES, [this, userId, &location]() {
+		return fishRepository.findAllByLocation(userId, location);
+	});
 }
 
-const vector<Fish> Service::getAllFishByWeather(const long userId, const string& weather) const noexcept {
-	return fishRepository.findAllByWeather(userId, weather);
+vector<Fish> Service::getAllFishCatchableAt(const long userId, const int minute) const noexcept {
+	return cachedResult(userId, "time\x1f" + to_string(minute), FishResultCache::DEPENDS_ON_ATTRIBUTES, [this, userId, minute]() {
+		return fishRepository.findAllCatchableAt(userId, minute);
+	});
 }
 
-const vector<Fish> Service::getAllFishBySeason(const long userId, const string& season) const noexcept {
-	return fishRepository.findAllBySeason(userId, season);
+vector<Fish> Service::getCatchableFish(const long userId, const string& season, const string& weather, const string& location, const int minute, const bool uncaughtOnly) const {
+	applyDataChanges();
+	lock_guard<mutex> lock(catchQueryMutex);
+	loadCatchQueryEngine(userId);
+	return catchQueryEngine.findCatchable(season, weather, location, minute, uncaughtOnly);
 }
 
-const vector<Fish> Service::getAllFishByLocation(const long userId, const string& location) const noexcept {
-	return fishRepository.findAllByLocation(userId, location);
+vector<Fish> Service::getFishMatching(const long userId, const FishQuery& query) const {
+	applyDataChanges();
+	lock_guard<mutex> lock(catchQueryMutex);
+	loadCatchQueryEngine(userId);
+	return query.filter(catchQueryEngine.getFishList());
+}
+
+void Service::loadCatchQueryEngine(const long userId) const {
+	if (userId != catchQueryUserId) {
+		catchQueryEngine.build(fishRepository.findAll(userId));
+		catchQueryUserId = userId;
+	}
+}
+
+vector<Fish> Service::cachedResult(const long userId, const string& filter, const uint8_t dependencies, const function<vector<Fish>()>& runFilter) const {
+	applyDataChanges();
+	vector<Fish> fishList;
+	if (resultCache.find(userId, filter, fishList)) {
+		return fishList;
+	}
+
+	// The generation is read first, so a result an update made stale while it was read is not kept
+	const uint64_t generation = resultCache.getGeneration();
+	fishList = runFilter();
+	resultCache.insert(userId, filter, dependencies, fishList, generation, [this, userId]() {
+		return fishRepository.findAll(userId);
+	});
+	return fishList;
+}
+
+void Service::applyDataChanges() const {
+	const DataChanges changes = fishRepository.takeDataChanges();
+	if (changes.empty()) {
+		return;
+	}
+	dataVersion++;
+
+	{
+		lock_guard<mutex> lock(catchQueryMutex);
+		if (changes.everything) {
+			catchQueryUserId = -1;
+		}
+		else if (catchQueryUserId != -1) {
+			vector<long> ids(changes.fishIds.begin(), changes.fishIds.end());
+			for (const auto& [userId, fishId] : changes.progress) {
+				if (userId == catchQueryUserId && changes.fishIds.count(fishId) == 0) {
+					ids.push_back(fishId);
+				}
+			}
+
+			// A fish that was added or removed is not found in the index or in the database, the index is then built again
+			const vector<Fish> reloaded = ids.empty() ? vector<Fish>() : fishRepository.findMany(ids, catchQueryUserId);
+			bool indexed = reloaded.size() == ids.size();
+			for (const Fish& fish : reloaded) {
+				indexed = catchQueryEngine.update(fish) && indexed;
+			}
+			if (!indexed) {
+				catchQueryUserId = -1;
+			}
+		}
+	}
+
+	// The catalogs of the result cache are patched like the index, the results are dropped only if their fish can change
+	if (changes.everything) {
+		resultCache.clear();
+	}
+	else {
+		for (const long catalogUserId : resultCache.getCatalogUsers()) {
+			vector<long> ids(changes.fishIds.begin(), changes.fishIds.end());
+			for (const auto& [userId, fishId] : changes.progress) {
+				if (userId == catalogUserId && changes.fishIds.count(fishId) == 0) {
+					ids.push_back(fishId);
+				}
+			}
+			if (ids.empty()) {
+				continue;
+			}
+
+			const vector<Fish> reloaded = fishRepository.findMany(ids, catalogUserId);
+			if (reloaded.size() != ids.size()) {
+				resultCache.clear();
+				break;
+			}
+			for (const Fish& fish : reloaded) {
+				resultCache.onFishUpdated(catalogUserId, fish);
+			}
+		}
+	}
+
+	// A plan depends on every fish of its user, so only the plans of the users whose progress alone changed are kept
+	if (changes.everything || !changes.fishIds.empty()) {
+		seasonPlanner.clear();
+	}
+	else {
+		for (const auto& [userId, fishId] : changes.progress) {
+			seasonPlanner.evict(userId);
+		}
+	}
+
+	lock_guard<mutex> lock(imageCacheMutex);
+	if (changes.everything) {
+		imageCache.clear();
+	}
+	else {
+		for (const string& name : changes.imageNames) {
+			imageCache.erase(name);
+		}
+	}
 }
 
-const vector<Fish> Service::getAllUncaughtFish(const long userId) const noexcept {
-	return fishRepository.findAllUncaught(userId);
+shared_ptr<const SeasonPlan> Service::getSeasonPlan(const long userId) const {
+	applyDataChanges();
+	return seasonPlanner.plan(userId, [this, userId]() {
+		return fishRepository.findAll(userId);
+	});
 }
 
-const vector<Fish> Service::getAllFavoriteFish(const long userId) const noexcept {
-	return fishRepository.findAllFavorite(userId);
+vector<Fish> Service::getAllUncaughtFish(const long userId) const noexcept {
+	return cachedResult(userId, "uncaught", FishResultCache::DEPENDS_ON_CAUGHT, [this, userId]() {
+		return fishRepository.findAllUncaught(userId);
+	});
+}
+
+vector<Fish> Service::getAllFavoriteFish(const long userId) const noexcept {
+	return cachedResult(userId, "favorite", FishResultCache::DEPENDS_ON_FAVORITE, [this, userId]() {
+		return fishRepository.findAllFavorite(userId);
+	});
 }
 
 const long Service::getCaughtFishNumber(const long userId) const noexcept {
@@ -64,14 +227,116 @@ const long Service::getFavoriteFishNumber(const long userId) const noexcept {
 	return fishRepository.getFavoriteFishNumber(userId);
 }
 
-const vector<char> Service::getImageByName(const string& name) const {
-	return fishRepository.getImageFromImages(name);
+vector<char> Service::getImageByName(const string& name) const {
+	applyDataChanges();
+	{
+		lock_guard<mutex> lock(imageCacheMutex);
+		auto cached = imageCache.find(name);
+		if (cached != imageCache.end()) {
+			return cached->second;
+		}
+	}
+
+	vector<char> image = fishRepository.getImageFromImages(name);
+	lock_guard<mutex> lock(imageCacheMutex);
+	imageCache[name] = image;
+	return image;
+}
+
+SpriteAtlas Service::loadSpriteAtlas() const {
+	return fishRepository.loadSpriteAtlas();
+}
+
+Fish Service::updateFish(const Fish& fish, const long userId) const {
+	vector<Fish> updated = updateAllFish(vector<Fish>{ fish }, userId);
+	return updated.empty() ? Fish() : updated.front();
+}
+
+vector<Fish> Service::getFishByIds(const vector<long>& ids, const long userId) const {
+	return fishRepository.findMany(ids, userId);
+}
+
+vector<Fish> Service::updateAllFish(const vector<Fish>& fishList, const long userId) const {
+	vector<FishFlags> previousFlags;
+	vector<Fish> updated = fishRepository.updateAll(fishList, userId, &previousFlags);
+	if (updated.empty()) {
+		return updated;
+	}
+	dataVersion++;
+	{
+		lock_guard<mutex> lock(catchQueryMutex);
+		if (userId == catchQueryUserId) {
+			for (const Fish& fish : updated) {
+				catchQueryEngine.update(fish);
+			}
+		}
+	}
+
+	// The changes are published once the caches are up to date, so the windows can read from them right away
+	QList<long> fishIds;
+	fishIds.reserve(static_cast<qsizetype>(updated.size()));
+	for (size_t i = 0; i < updated.size(); i++) {
+		const Fish& fish = updated[i];
+		seasonPlanner.onFishUpdated(userId, fish);
+		resultCache.onFishUpdated(userId, fish);
+		fishIds.append(fish.getId());
+		if (fish.getIsCaught() != previousFlags[i].caught || fish.getIsFavorite() != previousFlags[i].favorite) {
+			emit changeBus.fishFlagsChanged(userId, fish, previousFlags[i].caught, previousFlags[i].favorite);
+		}
+	}
+	emit changeBus.catalogChanged(userId, fishIds);
+	return updated;
+}
+
+SaveFileImport Service::importSaveFile(const long userId, const string& path) const {
+	const vector<Fish> fishList = fishRepository.findAll(userId);
+	SaveFileImport saveImport = SaveFileImporter(fishList).readFile(path);
+
+	unordered_map<long, const Fish*> fishById;
+	for (const Fish& fish : fishList) {
+		fishById[fish.getId()] = &fish;
+	}
+
+	// Only the fish that were not caught yet are written, all of them in the same transaction
+	vector<Fish> newlyCaught;
+	for (const long fishId : saveImport.caughtFishIds) {
+		auto fish = fishById.find(fishId);
+		if (fish != fishById.end() && !fish->second->getIsCaught()) {
+			Fish caught = *fish->second;
+			caught.setIsCaught(true);
+			newlyCaught.push_back(caught);
+		}
+	}
+
+	if (!newlyCaught.empty()) {
+		saveImport.newlyCaught = updateAllFish(newlyCaught, userId).size();
+	}
+	return saveImport;
+}
+
+uint64_t Service::getDataVersion() const noexcept {
+	applyDataChanges();
+	return dataVersion.load();
+}
+
+FishResultCacheStats Service::getResultCacheStats() const {
+	return resultCache.getStats();
+}
+
+vector<ConnectionPoolStats> Service::getConnectionStats() const {
+	return fishRepository.getConnectionStats();
+}
+
+BackupReport Service::backupDatabase(const string& destinationPath, const int pagesPerStep, const chrono::milliseconds pause, const atomic<bool>* cancelled) const {
+	return fishRepository.backupTo(destinationPath, pagesPerStep, pause, cancelled);
 }
 
-const QMap<QString, QPixmap> Service::populateImagesCacheMap() const {
-	return fishRepository.getAllImages();
+bool Service::restoreDatabase(const string& snapshotPath) const {
+	const bool restored = fishRepository.restoreFrom(snapshotPath);
+	applyDataChanges();
+	return restored;
 }
 
-const Fish Service::updateFish(const Fish& fish, const long userId) const {
-	return fishRepository.update(fish, userId);
+ChangeBus& Service::getChangeBus() const noexcept {
+	return changeBus;
 }
\ No newline at end of file
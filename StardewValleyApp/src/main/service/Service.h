@@ -2,8 +2,19 @@
 
 #include "../model/Fish.h"
 #include "../repository/FishDBRepository.h"
+#include "../utils/CaseFolding.h"
+#include "CatchQueryEngine.h"
+#include "ChangeBus.h"
+#include "FishQuery.h"
+#include "FishResultCache.h"
+#include "SaveFileImporter.h"
+#include "SeasonPlanner.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <string>
 #include <sstream>
+#include <unordered_map>
 
 using namespace std;
 
@@ -12,6 +23,53 @@ class Service {
 private:
 	FishDBRepository& fishRepository;
 
+	// Built from the fish of a user on the first catchable or filter query, and kept up to date by the fish updates
+	mutable CatchQueryEngine catchQueryEngine;
+	mutable long catchQueryUserId = -1;
+
+	// Guards the in-memory index, which is queried and updated from the windows and from the HTTP server thread
+	mutable mutex catchQueryMutex;
+
+	// Incremented by every update of the fish and every change found by applyDataChanges, so the copies of the fish kept elsewhere know when they are stale
+	mutable atomic<uint64_t> dataVersion{ 1 };
+
+	// Publishes the changes of every update, after they are committed
+	mutable ChangeBus changeBus;
+
+	// Caches the plan of every user, the caught fish are removed from it as they are updated
+	mutable SeasonPlanner seasonPlanner;
+
+	// Caches the ids of the fish found by the filters, the fish themselves are kept once for every user
+	mutable FishResultCache resultCache;
+
+	// Caches the images of the Images table read by name
+	mutable unordered_map<string, vector<char>> imageCache;
+	mutable mutex imageCacheMutex;
+
+	/*
+	* Build the in-memory index from the fish of a user, if it was built for another user
+	* The caller must hold catchQueryMutex
+	* @param userId - the id of the logged user
+	*/
+	void loadCatchQueryEngine(const long userId) const;
+
+	/*
+	* Evict from the caches the fish, progress and images changed since the last call, by writes that did not go through
+	* updateAllFish: the other repository writes, and other processes
+	* The changed fish of the in-memory index are read again, so only a fish that was added or removed rebuilds it
+	*/
+	void applyDataChanges() const;
+
+	/*
+	* Get the result of a filter from the result cache, or run the filter and keep its result
+	* @param userId - the id of the logged user
+	* @param filter - the normalized filter, holding every value the result depends on
+	* @param dependencies - the FishResultCache::DEPENDS_ON values of the fish the filter reads
+	* @param runFilter - called to read the result from the repository when it is not cached
+	* @return the fish found by the filter
+	*/
+	vector<Fish> cachedResult(const long userId, const string& filter, const uint8_t dependencies, const function<vector<Fish>()>& runFilter) const;
+
 public:
 	
 	/*
@@ -31,7 +89,7 @@ public:
 	* @param userId - the id of the logged user
 	* @return the fish with the given id
 	*/
-	const Fish getFishById(const long id, const long userId) const;
+	Fish getFishById(const long id, const long userId) const;
 
 
 	/*
@@ -39,7 +97,34 @@ public:
 	* @param userId - the id of the logged user
 	* @return a vector of all the fish
 	*/
-	const vector<Fish> getAllFish(const long userId) const noexcept;
+	vector<Fish> getAllFish(const long userId) const noexcept;
+
+
+	/*
+	* Stream all fish, one at a time, without collecting them
+	* @param userId - the id of the logged user
+	* @param visitor - called with every fish, the fish must be copied to be kept after the call
+	*/
+	void forEachFish(const long userId, const function<void(const Fish&)>& visitor) const;
+
+
+	/*
+	* Get one page of fish, sorted by the key of the request
+	* @param userId - the id of the logged user
+	* @param request - the sort key, direction, size and cursor of the page
+	* @return the fish of the page and the cursor of the next page
+	*/
+	FishPage getFishPage(const long userId, const FishPageRequest& request) const;
+
+
+	/*
+	* Stream one page of fish, sorted by the key of the request, without collecting them
+	* @param userId - the id of the logged user
+	* @param request - the sort key, direction, size and cursor of the page
+	* @param visitor - called with every fish of the page, the fish must be copied to be kept after the call
+	* @return the cursor of the next page, or an empty string if this is the last page
+	*/
+	string forEachFishInPage(const long userId, const FishPageRequest& request, const function<void(const Fish&)>& visitor) const;
 
 
 	/*
@@ -53,7 +138,7 @@ public:
 	* Get all users
 	* @return a vector of all the users
 	*/
-	const vector<User> getAllUsers() const noexcept;
+	vector<User> getAllUsers() const noexcept;
 
 
 	/*
@@ -62,28 +147,28 @@ public:
 	* @param input - the input to filter by
 	* @return a vector of all the fish filtered by the input
 	*/
-	const vector<Fish> getAllFishFiltered(const long userId, const string& input) const noexcept;
+	vector<Fish> getAllFishFiltered(const long userId, const string& input) const noexcept;
 
 
 	/*
 	* Get all weathers
 	* @return a vector of all the weathers
 	*/
-	const vector<string> getAllWeathers() const noexcept;
+	vector<string> getAllWeathers() const noexcept;
 
 
 	/*
 	* Get all seasons
 	* @return a vector of all the seasons
 	*/
-	const vector<string> getAllSeasons() const noexcept;
+	vector<string> getAllSeasons() const noexcept;
 
 
 	/*
 	* Get all locations
 	* @return a vector of all the locations
 	*/
-	const vector<string> getAllLocations() const noexcept;
+	vector<string> getAllLocations() const noexcept;
 
 
 	/*
@@ -94,7 +179,7 @@ public:
 	* @param location - the location to filter by
 	* @return a vector of all the fish filtered by the season, weather and location
 	*/
-	const vector<Fish> getAllFishBySeasonWeatherLocation(const long userId, const string& season, const string& weather, const string& location) const noexcept;
+	vector<Fish> getAllFishBySeasonWeatherLocation(const long userId, const string& season, const string& weather, const string& location) const noexcept;
 
 	/*
 	* Get all fish by weather
@@ -102,7 +187,7 @@ public:
 	* @param weather - the weather to filter by
 	* @return a vector of all the fish filtered by the weather
 	*/
-	const vector<Fish> getAllFishByWeather(const long userId, const string& weather) const noexcept;
+	vector<Fish> getAllFishByWeather(const long userId, const string& weather) const noexcept;
 
 
 	/*
@@ -111,7 +196,7 @@ public:
 	* @param season - the season to filter by
 	* @return a vector of all the fish filtered by the season
 	*/
-	const vector<Fish> getAllFishBySeason(const long userId, const string& season) const noexcept;
+	vector<Fish> getAllFishBySeason(const long userId, const string& season) const noexcept;
 
 
 	/*
@@ -120,7 +205,46 @@ public:
 	* @param location - the location to filter by
 	* @return a vector of all the fish filtered by the location
 	*/
-	const vector<Fish> getAllFishByLocation(const long userId, const string& location) const noexcept;
+	vector<Fish> getAllFishByLocation(const long userId, const string& location) const noexcept;
+
+
+	/*
+	* Get all fish that can be caught at a time of the day
+	* @param userId - the id of the logged user
+	* @param minute - the minute of the day, from 0 (12am) to 1439 (11:59pm)
+	* @return a vector of all the fish catchable at the given time
+	*/
+	vector<Fish> getAllFishCatchableAt(const long userId, const int minute) const noexcept;
+
+
+	/*
+	* Get the fish that can be caught in a season, weather, location and time of the day, from the in-memory index
+	* @param userId - the id of the logged user
+	* @param season - the season, or an empty string for any season
+	* @param weather - the weather, or an empty string for any weather
+	* @param location - the location, or an empty string for any location
+	* @param minute - the minute of the day, or CatchQueryEngine::ANY_TIME for any time
+	* @param uncaughtOnly - true to leave out the fish the user already caught
+	* @return a vector of the fish catchable in the given conditions
+	*/
+	vector<Fish> getCatchableFish(const long userId, const string& season, const string& weather, const string& location, const int minute, const bool uncaughtOnly) const;
+
+
+	/*
+	* Get the fish that match a compiled filter query, from the fish kept in memory
+	* @param userId - the id of the logged user
+	* @param query - the compiled query
+	* @return a vector of the matching fish
+	*/
+	vector<Fish> getFishMatching(const long userId, const FishQuery& query) const;
+
+
+	/*
+	* Get the plan of the fishing sessions that catch the most fish the user has not caught yet
+	* @param userId - the id of the logged user
+	* @return the plan, cached until the fish of the user change
+	*/
+	shared_ptr<const SeasonPlan> getSeasonPlan(const long userId) const;
 
 
 	/*
@@ -128,7 +252,7 @@ public:
 	* @param userId - the id of the logged user
 	* @return a vector of all the uncaught fish
 	*/
-	const vector<Fish> getAllUncaughtFish(const long userId) const noexcept;
+	vector<Fish> getAllUncaughtFish(const long userId) const noexcept;
 
 
 	/*
@@ -136,7 +260,7 @@ public:
 	* @param userId - the id of the logged user
 	* @return a vector of all the favorite fish
 	*/
-	const vector<Fish> getAllFavoriteFish(const long userId) const noexcept;
+	vector<Fish> getAllFavoriteFish(const long userId) const noexcept;
 
 
 	/*
@@ -160,14 +284,14 @@ public:
 	* @param name - the name of the image
 	* @return a vector of the image
 	*/
-	const vector<char> getImageByName(const string& name) const;
+	vector<char> getImageByName(const string& name) const;
 
 
 	/*
-	* Populate the QMap with all the images from the database (Images and Fish table)
-	* @return a QMap containing all the images
+	* Load the images from the database (Images table) as a sprite atlas
+	* @return the sprite atlas holding all the images by name
 	*/
-	const QMap<QString, QPixmap> populateImagesCacheMap() const;
+	SpriteAtlas loadSpriteAtlas() const;
 
 
 	/*
@@ -176,7 +300,82 @@ public:
 	* @param userId - the id of the logged user
 	* @return the fish updated
 	*/
-	const Fish updateFish(const Fish& fish, const long userId) const;
+	Fish updateFish(const Fish& fish, const long userId) const;
+
+
+	/*
+	* Get the fish with the given ids, read in a single transaction
+	* @param ids - the ids of the fish
+	* @param userId - the id of the logged user
+	* @return the fish that were found, in the order of the ids
+	*/
+	vector<Fish> getFishByIds(const vector<long>& ids, const long userId) const;
+
+
+	/*
+	* Update many fish in a single transaction, either all of them or none
+	* @param fishList - the fish to update
+	* @param userId - the id of the logged user
+	* @return the fish updated, or an empty vector if the update failed
+	*/
+	vector<Fish> updateAllFish(const vector<Fish>& fishList, const long userId) const;
+
+
+	/*
+	* Mark as caught the fish the player of a Stardew Valley save file caught, in one transaction
+	* @param userId - the id of the logged user
+	* @param path - the path to the save file
+	* @return the import, with the number of fish that were not caught before
+	*/
+	SaveFileImport importSaveFile(const long userId, const string& path) const;
+
+
+	/*
+	* Get the version of the fish data, which changes every time a fish is updated through the service,
+	* or the database is changed by another write or another process
+	* @return the current data version
+	*/
+	uint64_t getDataVersion() const noexcept;
+
+
+	/*
+	* Get the counters of the result cache of the filters, to tune its capacity
+	* @return the hits, misses, invalidations and bytes of the cache
+	*/
+	FishResultCacheStats getResultCacheStats() const;
+
+
+	/*
+	* Get the counters of the writer and readers connection pools of the database
+	* @return the queue depth, wait and hold times of every pool
+	*/
+	vector<ConnectionPoolStats> getConnectionStats() const;
+
+
+	/*
+	* Copy the database into a snapshot while it keeps being used, a few pages at a time, with the image pack next to it
+	* @param destinationPath - the path of the snapshot
+	* @param pagesPerStep - the number of pages copied by every step
+	* @param pause - the time the writes get between two steps
+	* @param cancelled - if not null, stops the backup once it is true
+	* @return the pages, bytes, time and longest writer stall of the backup
+	*/
+	BackupReport backupDatabase(const string& destinationPath, const int pagesPerStep, const chrono::milliseconds pause, const atomic<bool>* cancelled = nullptr) const;
+
+
+	/*
+	* Replace the database with a snapshot, add the images of the pack next to it, and drop everything the caches hold
+	* @param snapshotPath - the path of the snapshot
+	* @return true if the database was restored
+	*/
+	bool restoreDatabase(const string& snapshotPath) const;
+
+
+	/*
+	* Get the bus the changes of the fish are published on
+	* @return the change bus, to connect the windows to
+	*/
+	ChangeBus& getChangeBus() const noexcept;
 
 
 	~Service() {}
@@ -19,40 +19,40 @@ public:
 
     /*
     * @brief A widget that displays a background image.
-    * @param originalPixmap - the original pixmap to display
-    * @param hoveredPixmap - the pixmap to display when the widget is hovered
+    * @param originalSprite - the original image to display
+    * @param hoveredSprite - the image to display when the widget is hovered
     * @param parent - the parent widget
     */
-    BackgroundHoverWidget(const QPixmap& originalPixmap, const QPixmap& hoveredPixmap, QWidget* parent = nullptr)
-        : BackgroundWidget(originalPixmap, parent), cornerRadius(0), hoveredPixmap(hoveredPixmap), originalPixmap(originalPixmap) {
+    BackgroundHoverWidget(const Sprite& originalSprite, const Sprite& hoveredSprite, QWidget* parent = nullptr)
+        : BackgroundWidget(originalSprite, parent), cornerRadius(0), hoveredSprite(hoveredSprite), originalSprite(originalSprite) {
         setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
         setAttribute(Qt::WA_Hover);
-        currentPixmap = originalPixmap;
+        currentSprite = originalSprite;
     }
 
-    BackgroundHoverWidget(const QPixmap& originalPixmap, QWidget* parent = nullptr)
-        : BackgroundWidget(originalPixmap, parent), cornerRadius(0), hoveredPixmap(originalPixmap), originalPixmap(originalPixmap) {
+    BackgroundHoverWidget(const Sprite& originalSprite, QWidget* parent = nullptr)
+        : BackgroundWidget(originalSprite, parent), cornerRadius(0), hoveredSprite(originalSprite), originalSprite(originalSprite) {
         setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
         setAttribute(Qt::WA_Hover);
-        currentPixmap = originalPixmap;
+        currentSprite = originalSprite;
     }
 
 
     /*
     * Set the background image of the widget.
-    * @param pixmap - the pixmap to set
+    * @param sprite - the image to set
     */
-    void setBackgroundImage(const QPixmap& pixmap) {
-        currentPixmap = pixmap;
+    void setBackgroundImage(const Sprite& sprite) {
+        currentSprite = sprite;
         update();
     }
 
     /*
     * Set the background image of the widget when the widget is hovered.
-    * @param pixmap - the pixmap to set
+    * @param sprite - the image to set
     */
-    void setHoveredStateImage(const QPixmap& pixmap) {
-        hoveredPixmap = pixmap;
+    void setHoveredStateImage(const Sprite& sprite) {
+        hoveredSprite = sprite;
     }
 
     /*
@@ -73,8 +73,8 @@ protected:
         painter.setClipPath(path);
 
         // => DRAWING THE BACKGROUND IMAGE
-        if (!currentPixmap.isNull()) {
-            painter.drawPixmap(rect(), currentPixmap);
+        if (!currentSprite.isNull()) {
+            currentSprite.draw(painter, rect());
         }
         else {
             qWarning() << "Background pixmap is null!";
@@ -86,11 +86,11 @@ protected:
     bool event(QEvent* e) override {
         if (e->type() == QEvent::Enter) {
             emit hoverEnter();
-            setBackgroundImage(hoveredPixmap);
+            setBackgroundImage(hoveredSprite);
         }
         else if (e->type() == QEvent::Leave) {
             emit hoverLeave();
-            setBackgroundImage(originalPixmap);
+            setBackgroundImage(originalSprite);
         }
         return QWidget::event(e);
     }
@@ -100,9 +100,9 @@ protected:
     }
 
 private:
-    QPixmap originalPixmap;
-    QPixmap hoveredPixmap;
-    QPixmap currentPixmap;
+    Sprite originalSprite;
+    Sprite hoveredSprite;
+    Sprite currentSprite;
     int cornerRadius;
 
 signals:
@@ -7,6 +7,7 @@
 #include <QImage>
 #include <QSizePolicy>
 #include <vector>
+#include "../repository/SpriteAtlas.h"
 
 using namespace std;
 
@@ -17,21 +18,21 @@ public:
 
     /*
     * @brief A widget that displays a background image.
-    * @param imageData - the raw image data to display
+    * @param sprite - the image to display, drawn straight from the sprite atlas
     * @param parent - the parent widget
     */
-    BackgroundWidget(const QPixmap& pixmap, QWidget* parent = nullptr)
-        : QWidget(parent), cornerRadius(0), backgroundPixmap(pixmap) {
+    BackgroundWidget(const Sprite& sprite, QWidget* parent = nullptr)
+        : QWidget(parent), cornerRadius(0), backgroundSprite(sprite) {
         setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     }
 
 
     /*
     * Set the background image of the widget.
-    * @param pixmap - the pixmap to set
+    * @param sprite - the image to set
     */
-    void setBackgroundImage(const QPixmap& pixmap) {
-        backgroundPixmap = pixmap;
+    void setBackgroundImage(const Sprite& sprite) {
+        backgroundSprite = sprite;
         update();
     }
 
@@ -53,8 +54,8 @@ protected:
         painter.setClipPath(path);
 
         // => DRAWING THE BACKGROUND IMAGE
-        if (!backgroundPixmap.isNull()) {
-            painter.drawPixmap(rect(), backgroundPixmap);
+        if (!backgroundSprite.isNull()) {
+            backgroundSprite.draw(painter, rect());
         }
         else {
             qWarning() << "Background pixmap is null!";
@@ -63,6 +64,6 @@ protected:
     }
 
 private:
-    QPixmap backgroundPixmap;
+    Sprite backgroundSprite;
     int cornerRadius;
 };
\ No newline at end of file
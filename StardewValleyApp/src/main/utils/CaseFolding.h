@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+class CaseFolding {
+public:
+
+	/*
+	* @brief - Returns a text with its ASCII letters in lower case, the same folding the NOCASE collation of SQLite does
+	* The text is folded 8 bytes at a time, and the bytes that are not ASCII are copied as they are
+	* @param text - the text to fold
+	* @return - the folded text
+	*/
+	static string toLower(const string_view text) {
+		string lower(text);
+		size_t i = 0;
+		for (; i + 8 <= lower.size(); i += 8) {
+			uint64_t word;
+			memcpy(&word, lower.data() + i, 8);
+			word = foldWord(word);
+			memcpy(lower.data() + i, &word, 8);
+		}
+		for (; i < lower.size(); i++) {
+			lower[i] = toLower(lower[i]);
+		}
+		return lower;
+	}
+
+
+	/*
+	* @brief - Returns a character in lower case if it is an ASCII upper case letter
+	* @param character - the character to fold
+	* @return - the folded character
+	*/
+	static char toLower(const char character) {
+		return static_cast<unsigned char>(character - 'A') < 26 ? static_cast<char>(character | 0x20) : character;
+	}
+
+
+	/*
+	* @brief - Checks if a text contains a value, without case
+	* @param text - the text
+	* @param value - the value, already folded with toLower
+	* @return - true if the value is found in the text
+	*/
+	static bool containsNoCase(const string_view text, const string_view value) {
+		if (value.empty()) {
+			return true;
+		}
+		for (size_t start = 0; start + value.size() <= text.size(); start++) {
+			if (toLower(text[start]) != value[0]) {
+				continue;
+			}
+			size_t i = 1;
+			while (i < value.size() && toLower(text[start + i]) == value[i]) {
+				i++;
+			}
+			if (i == value.size()) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+
+	/*
+	* @brief - Checks if a text is a value, without case
+	* @param text - the text
+	* @param value - the value, already folded with toLower
+	* @return - true if the text folds to the value
+	*/
+	static bool equalsNoCase(const string_view text, const string_view value) {
+		return text.size() == value.size() && containsNoCase(text, value);
+	}
+
+private:
+
+	// Folds the 8 bytes of a word at once: every byte in 'A'..'Z' gets its 0x20 bit set
+	static uint64_t foldWord(const uint64_t word) {
+		constexpr uint64_t ONES = 0x0101010101010101ULL;
+		constexpr uint64_t HIGH_BITS = 0x8080808080808080ULL;
+
+		// The low 7 bits of every byte, so adding to them never carries into the next byte
+		const uint64_t low = word & ~HIGH_BITS;
+		const uint64_t aboveZ = low + ONES * (0x7F - 'Z');
+		const uint64_t fromA = low + ONES * (0x80 - 'A');
+		const uint64_t upper = (fromA ^ aboveZ) & ~word & HIGH_BITS;
+		return word | (upper >> 2);
+	}
+};
@@ -8,6 +8,7 @@
 #include <QVBoxLayout>
 #include <vector>
 #include <string>
+#include "../repository/SpriteAtlas.h"
 
 using namespace std;
 
@@ -26,8 +27,8 @@ public:
     * @param parent - the parent widget
     * @return an instance of CustomButton
     */
-    CustomButton(const QPixmap imageData, const QString& text, int width, int height, QWidget* parent = nullptr)
-        : QPushButton(text, parent), width(width), height(height), pixmap(imageData) {
+    CustomButton(const Sprite& imageData, const QString& text, int width, int height, QWidget* parent = nullptr)
+        : QPushButton(text, parent), width(width), height(height), sprite(imageData) {
         setAttribute(Qt::WA_TranslucentBackground, true);
         setFixedSize(width, height);
     }
@@ -43,9 +44,8 @@ protected:
         painter.setRenderHint(QPainter::SmoothPixmapTransform);
 
         // => LOAD THE BACKGROUND IMAGE
-        if (!pixmap.isNull()) {
-            QPixmap scaledPixmap = pixmap.scaled(size().width(), size().height(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-            painter.drawPixmap(0, 0, scaledPixmap);
+        if (!sprite.isNull()) {
+            sprite.draw(painter, rect());
         } else {
             painter.fillRect(rect(), Qt::gray);
         }
@@ -59,7 +59,7 @@ protected:
     }
 
 private:
-    QPixmap pixmap;
+    Sprite sprite;
     int width;
     int height;
 };
\ No newline at end of file
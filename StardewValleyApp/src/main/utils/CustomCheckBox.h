@@ -25,7 +25,7 @@ public:
 	* @param parent - the parent widget
 	* @param imageData - the image data to display in the tooltip
 	*/
-	CustomCheckBox(QWidget* parent, QPixmap& imageData)
+	CustomCheckBox(QWidget* parent, const Sprite& imageData)
 		: QCheckBox(parent), toolTip(new ToolTip(imageData, this)) {
 		setMouseTracking(true);
 		toolTip->hide();
@@ -46,10 +46,10 @@ public:
 	* @param checkedImage - the image to display when the checkbox is checked
 	* @param uncheckedImage - the image to display when the checkbox is unchecked
 	*/
-	void setImages(const QPixmap& checkedImage, const QPixmap& uncheckedImage)
+	void setImages(const Sprite& checkedImage, const Sprite& uncheckedImage)
 	{
-		this->checkedPixmap = checkedImage;
-		this->uncheckedPixmap = uncheckedImage;
+		this->checkedSprite = checkedImage;
+		this->uncheckedSprite = uncheckedImage;
 		update();
 	}
 
@@ -73,11 +73,12 @@ protected:
 		QStyleOptionButton option;
 		initStyleOption(&option);
 		
-		QPixmap pixmap = isChecked() ? checkedPixmap : uncheckedPixmap;
+		const Sprite& sprite = isChecked() ? checkedSprite : uncheckedSprite;
 		QRect iconRect = option.rect;
 
 		iconRect.setSize(QSize(height(), height()));
-		painter.drawPixmap(iconRect, pixmap);
+		painter.setRenderHint(QPainter::SmoothPixmapTransform);
+		sprite.draw(painter, iconRect);
 
 		QRect textRect = option.rect;
 		textRect.setLeft(iconRect.right() + 5);
@@ -121,8 +122,8 @@ protected:
 private:
 	ToolTip* toolTip;
 
-	QPixmap checkedPixmap;
-	QPixmap uncheckedPixmap;
+	Sprite checkedSprite;
+	Sprite uncheckedSprite;
 
 
 	/*
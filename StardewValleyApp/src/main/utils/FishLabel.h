@@ -2,6 +2,7 @@
 
 #include "../model/Fish.h"
 #include "FishToolTip.h"
+#include "ThumbnailCache.h"
 #include <QWidget>
 #include <QLabel>
 #include <QPixmap>
@@ -19,7 +20,7 @@ public:
 	* @param imageData - the image data for the fish image
 	* @param parent - the parent widget
 	*/
-	explicit FishLabel(QPixmap& imageData, QWidget* parent = nullptr)
+	explicit FishLabel(const Sprite& imageData, QWidget* parent = nullptr)
 		: QLabel(parent), fishDetailsBox(new FishToolTip(imageData, this)) {
 		setMouseTracking(true);
 		fishDetailsBox->hide();
@@ -33,30 +34,18 @@ public:
 	* @param checkmarkImage - the image data for the checkmark image
 	* @param favoriteImage - the image data for the favorite image
 	*/
-	void setFishDetails(const Fish& fish, QPixmap& checkmarkImage, QPixmap& favoriteImage) {
+	void setFishDetails(const Fish& fish, const Sprite& checkmarkImage, const Sprite& favoriteImage) {
 		this->fish = fish;
 
 		fishDetailsBox->setFishDetails(fish);
 		//qDebug() << "Setting fish details for " + this->fish.toString();
 
-		QPixmap fishPixmap;
-		fishPixmap.loadFromData(reinterpret_cast<const uchar*>(fish.getImage().data()), fish.getImage().size());
-		QPixmap finalPixmap = fishPixmap;
-
-		if (fish.getIsCaught()) {
-			QPixmap caughtPixmap = checkmarkImage;
-			finalPixmap = overlayPixmap(finalPixmap, caughtPixmap, QPoint(0, 0));
-		}
-
-		if (fish.getIsFavorite()) {
-			QPixmap favoritePixmap = favoriteImage;
-			finalPixmap = overlayPixmap(finalPixmap, favoritePixmap, QPoint(0, 0));
-		}
-
-		setPixmap(finalPixmap);
-		setScaledContents(true);
 		setFixedSize(60, 60);
 		setContentsMargins(5, 5, 5, 5);
+		setAlignment(Qt::AlignCenter);
+
+		// The thumbnail is already sized for the label and has the marks drawn on it, so painting only blits it
+		setPixmap(ThumbnailCache::composed(fish, ThumbnailCache::GRID_SIZE, devicePixelRatioF(), checkmarkImage, favoriteImage));
 		setProperty("fishId", QVariant::fromValue(fish.getId()));
 	}
 
@@ -128,28 +117,6 @@ private:
         }
 	}
 
-
-	/*
-	* @brief - Overlays an image on top of another image
-	* The overlay image is scaled to the size of the base image and drawn on top of it
-	* @param basePixmap - the base image
-	* @param overlayPixmap - the image to overlay
-	* @param position - the position to overlay the image
-	* @return - the resulting image
-	*/
-	QPixmap overlayPixmap(const QPixmap& basePixmap, const QPixmap& overlayPixmap, const QPoint& position) {
-		QPixmap scaledOverlay = overlayPixmap.scaled(basePixmap.size(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
-
-		QPixmap result(basePixmap.size());
-		result.fill(Qt::transparent);
-
-		QPainter painter(&result);
-		painter.drawPixmap(0, 0, basePixmap);
-		painter.drawPixmap(position, scaledOverlay);
-
-		return result;
-	}
-
 signals:
 	void clicked(QMouseEvent* event);
 };
\ No newline at end of file
@@ -2,11 +2,13 @@
 
 #include "../model/Fish.h"
 #include "BackgroundWidget.h"
+#include "ThumbnailCache.h"
 #include <QWidget>
 #include <QLabel>
 #include <QPixmap>
 #include <QMouseEvent>
 #include <QVBoxLayout>
+#include <QHBoxLayout>
 
 class FishToolTip : public BackgroundWidget {
 	Q_OBJECT
@@ -17,8 +19,8 @@ public:
 	* @param imageData - the image data for the background of the tooltip
 	* @param parent - the parent widget
 	*/
-	explicit FishToolTip(QPixmap& imageData, QWidget* parent = nullptr)
-		: BackgroundWidget(imageData, parent), backgroundPixmap(imageData), titleWidget(new QWidget(this)) {
+	explicit FishToolTip(const Sprite& imageData, QWidget* parent = nullptr)
+		: BackgroundWidget(imageData, parent), titleWidget(new QWidget(this)) {
 		setWindowFlags(Qt::ToolTip | Qt::WindowStaysOnTopHint | Qt::FramelessWindowHint);
 		setAttribute(Qt::WA_TranslucentBackground, true);
 		setAttribute(Qt::WA_StyledBackground, true);
@@ -31,13 +33,19 @@ public:
 		// => TITLE WIDGET
 		titleWidget->setFixedSize(290, 80);
 		titleWidget->setStyleSheet("background: transparent;");
-		QVBoxLayout* titleLayout = new QVBoxLayout(titleWidget);
+		QHBoxLayout* titleImageLayout = new QHBoxLayout(titleWidget);
+		titleImageLayout->setAlignment(Qt::AlignLeft | Qt::AlignTop);
+		imageLabel = new QLabel(titleWidget);
+		imageLabel->setFixedSize(ThumbnailCache::TOOLTIP_SIZE, ThumbnailCache::TOOLTIP_SIZE);
+		QVBoxLayout* titleLayout = new QVBoxLayout();
 		titleLayout->setAlignment(Qt::AlignTop);
 		titleLabel = new QLabel(titleWidget);
 		categoryLabel = new QLabel(titleWidget);
 		categoryLabel->setStyleSheet("color: blue;");
 		titleLayout->addWidget(titleLabel);
 		titleLayout->addWidget(categoryLabel);
+		titleImageLayout->addWidget(imageLabel);
+		titleImageLayout->addLayout(titleLayout);
 		// <= END
 
 
@@ -88,11 +96,21 @@ public:
 	}
 
 
+	/*
+	* @brief - Sets the image of the tooltip
+	* Uses the tooltip-sized thumbnail of the fish, so the full image is never scaled while hovering
+	* @param fish - the fish whose image is shown
+	*/
+	void setImage(const Fish& fish) {
+		imageLabel->setPixmap(ThumbnailCache::thumbnail(fish, ThumbnailCache::TOOLTIP_SIZE, devicePixelRatioF()));
+	}
+
+
 	/*
 	* @brief - Sets the seasons of the tooltip
 	* @param seasons - the seasons of the tooltip
 	*/
-	void setSeasons(const vector<string>& seasons) {
+	void setSeasons(const SeasonSet& seasons) {
 		QString seasonText = "<span style=\"color:red;\">Seasons: </span>";
 		for (const auto& season : seasons) {
 			seasonText += QString::fromStdString(season) + ", ";
@@ -107,7 +125,7 @@ public:
 	* @brief - Sets the weather of the tooltip
 	* @param weathers - the weathers of the tooltip
 	*/
-	void setWeather(const vector<string>& weathers) {
+	void setWeather(const WeatherSet& weathers) {
 		QString weatherText = "<span style=\"color:blue;\">Weather: </span>";
 		for (const auto& weather : weathers) {
 			weatherText += QString::fromStdString(weather) + ", ";
@@ -122,7 +140,7 @@ public:
 	* @brief - Sets the locations of the tooltip
 	* @param locations - the locations of the tooltip
 	*/
-	void setLocations(const vector<string>& locations) {
+	void setLocations(const LocationSet& locations) {
 		QString locationText = "<span style=\"color:green;\">Locations: </span>";
 		for (const auto& location : locations) {
 			locationText += QString::fromStdString(location) + ", ";
@@ -135,27 +153,11 @@ public:
 
 	/*
 	* @brief - Sets the time of the tooltip
-	* @param start - the start time of the tooltip
-	* @param end - the end time of the tooltip
+	* @param catchTimes - the times of the day when the fish can be caught
 	*/
-	void setTime(const string& start, const string& end) {
+	void setTime(const CatchTimes& catchTimes) {
 		QString timeText = "<span style=\"color:white;\">Time: </span>";
-		if (start == "Any") {
-			timeLabel->setText(timeText + "Any");
-		}
-		else {
-			QStringList startSplit = QString::fromStdString(start).split(", ");
-			QStringList endSplit = QString::fromStdString(end).split(", ");
-			qDebug() << startSplit << endSplit;
-
-			if (startSplit.size() == 2 && endSplit.size() == 2) {
-				timeLabel->setText(timeText + startSplit[0] + "-" + endSplit[0] + " and " + startSplit[1] + "-" + endSplit[1]);
-			}
-			else {
-				timeLabel->setText(timeText + QString::fromStdString(start) + "-" + QString::fromStdString(end));
-			}
-
-		}
+		timeLabel->setText(timeText + QString::fromStdString(catchTimes.toString()));
 	}
 
 
@@ -178,10 +180,11 @@ public:
 	*/
 	void setFishDetails(const Fish& fish) {
 		setTitle(fish.getName(), fish.getCategory());
+		setImage(fish);
 		setSeasons(fish.getSeason());
 		setWeather(fish.getWeather());
 		setLocations(fish.getLocation());
-		setTime(fish.getStartCatchingHour(), fish.getEndCatchingHour());
+		setTime(fish.getCatchTimes());
 		setDifficulty(fish.getDifficulty(), fish.getMovement());
 	}
 
@@ -200,9 +203,8 @@ public:
 	}
 
 private:
-	QPixmap backgroundPixmap;
-
 	QWidget* titleWidget;
+	QLabel* imageLabel;
 	QLabel* titleLabel;
 	QLabel* categoryLabel;
 
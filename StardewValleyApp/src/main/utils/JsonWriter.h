@@ -0,0 +1,143 @@
+#pragma once
+
+#include "../model/Fish.h"
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+/*
+* Writes JSON to the end of a string, so a buffer can be cleared and reused for the next document
+* without giving back its memory. The commas between the members and the items are added as they are written.
+*/
+class JsonWriter {
+
+public:
+	explicit JsonWriter(string& buffer) : buffer(buffer) {}
+
+	JsonWriter& beginObject() {
+		separate();
+		buffer += '{';
+		needsComma = false;
+		return *this;
+	}
+
+	JsonWriter& endObject() {
+		buffer += '}';
+		needsComma = true;
+		return *this;
+	}
+
+	JsonWriter& beginArray() {
+		separate();
+		buffer += '[';
+		needsComma = false;
+		return *this;
+	}
+
+	JsonWriter& endArray() {
+		buffer += ']';
+		needsComma = true;
+		return *this;
+	}
+
+	JsonWriter& key(const string_view name) {
+		separate();
+		escape(buffer, name);
+		buffer += ':';
+		needsComma = false;
+		return *this;
+	}
+
+	JsonWriter& text(const string_view value) {
+		separate();
+		escape(buffer, value);
+		needsComma = true;
+		return *this;
+	}
+
+	JsonWriter& integer(const long long value) {
+		separate();
+		buffer += to_string(value);
+		needsComma = true;
+		return *this;
+	}
+
+	JsonWriter& decimal(const double value) {
+		char number[32];
+		snprintf(number, sizeof(number), "%.1f", value);
+		separate();
+		buffer += number;
+		needsComma = true;
+		return *this;
+	}
+
+	JsonWriter& boolean(const bool value) {
+		separate();
+		buffer += value ? "true" : "false";
+		needsComma = true;
+		return *this;
+	}
+
+	JsonWriter& textArray(const vector<string>& values) {
+		beginArray();
+		for (const string& value : values) {
+			text(value);
+		}
+		return endArray();
+	}
+
+	// Writes a fish as an object, with the user progress but without the image
+	JsonWriter& fish(const Fish& fish) {
+		return beginObject()
+			.key("id").integer(fish.getId())
+			.key("name").text(fish.getName())
+			.key("category").text(fish.getCategory())
+			.key("seasons").textArray(fish.getSeason().toStrings())
+			.key("weathers").textArray(fish.getWeather().toStrings())
+			.key("locations").textArray(fish.getLocation().toStrings())
+			.key("start").text(fish.getStartCatchingHour())
+			.key("end").text(fish.getEndCatchingHour())
+			.key("difficulty").integer(fish.getDifficulty())
+			.key("movement").text(fish.getMovement())
+			.key("caught").boolean(fish.getIsCaught())
+			.key("favorite").boolean(fish.getIsFavorite())
+			.endObject();
+	}
+
+	// Appends a text as a quoted JSON string
+	static void escape(string& out, const string_view text) {
+		out += '"';
+		for (const char c : text) {
+			switch (c) {
+			case '"': out += "\\\""; break;
+			case '\\': out += "\\\\"; break;
+			case '\n': out += "\\n"; break;
+			case '\r': out += "\\r"; break;
+			case '\t': out += "\\t"; break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20) {
+					char code[8];
+					snprintf(code, sizeof(code), "\\u%04x", c);
+					out += code;
+				}
+				else {
+					out += c;
+				}
+			}
+		}
+		out += '"';
+	}
+
+private:
+	string& buffer;
+	bool needsComma = false;
+
+	void separate() {
+		if (needsComma) {
+			buffer += ',';
+		}
+	}
+};
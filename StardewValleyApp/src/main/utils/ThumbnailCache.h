@@ -0,0 +1,207 @@
+#pragma once
+
+#include "../model/Fish.h"
+#include "../repository/ImageStore.h"
+#include "../repository/SpriteAtlas.h"
+#include <QPixmap>
+#include <QPixmapCache>
+#include <QImage>
+#include <QPainter>
+#include <QSize>
+#include <QDir>
+#include <QFile>
+#include <QString>
+#include <vector>
+
+using namespace std;
+
+class ThumbnailCache {
+public:
+
+	// Logical size of the fish images in the fish grid (the 60x60 label minus its 5px margins)
+	static constexpr int GRID_SIZE = 50;
+
+	// Logical size of the fish image shown in the fish tooltip
+	static constexpr int TOOLTIP_SIZE = 40;
+
+	// Directory where the rendered thumbnails are persisted between runs
+	static constexpr const char* THUMBNAIL_DIRECTORY = "thumbnails";
+
+
+	/*
+	* @brief - Returns the image of a fish pre-scaled to the given size for the given device pixel ratio
+	* The thumbnail is looked up in memory, then on disk, and is rendered from the full image only if both miss
+	* @param fish - the fish whose image is returned
+	* @param size - the logical size of the thumbnail
+	* @param devicePixelRatio - the device pixel ratio of the screen the thumbnail is shown on
+	* @return - the thumbnail, with its device pixel ratio set, or a null pixmap if the image cannot be decoded
+	*/
+	static QPixmap thumbnail(const Fish& fish, int size, qreal devicePixelRatio) {
+		return thumbnail(fish.getImageHash(), fish.getImage(), size, devicePixelRatio);
+	}
+
+
+	/*
+	* @brief - Returns an image pre-scaled to the given size for the given device pixel ratio
+	* @param imageHash - the hash of the image, as read with the fish; an empty string hashes the image bytes on every call
+	* @param image - the view over the full image bytes
+	* @param size - the logical size of the thumbnail
+	* @param devicePixelRatio - the device pixel ratio of the screen the thumbnail is shown on
+	* @return - the thumbnail, with its device pixel ratio set, or a null pixmap if the image cannot be decoded
+	*/
+	static QPixmap thumbnail(const string& imageHash, const ImageView& image, int size, qreal devicePixelRatio) {
+		if (image.empty()) {
+			return QPixmap();
+		}
+
+		const string hash = imageHash.empty() ? ImageStore::hashOf(image.data, image.size) : imageHash;
+		const QString key = thumbnailKey(hash, size, devicePixelRatio);
+
+		// => MEMORY CACHE
+		QPixmap pixmap;
+		if (QPixmapCache::find(key, &pixmap)) {
+			return pixmap;
+		}
+		// <= END
+
+
+		// => DISK CACHE
+		const QString filePath = QDir(THUMBNAIL_DIRECTORY).filePath(key + ".png");
+		QImage thumbnailImage;
+		if (!QFile::exists(filePath) || !thumbnailImage.load(filePath)) {
+			thumbnailImage = render(image, size, devicePixelRatio);
+			if (thumbnailImage.isNull()) {
+				qWarning() << "Failed to load image from given data!";
+				return QPixmap();
+			}
+
+			if (QDir().mkpath(THUMBNAIL_DIRECTORY) && !thumbnailImage.save(filePath, "PNG")) {
+				qWarning() << "Failed to save thumbnail: " << filePath;
+			}
+		}
+		// <= END
+
+
+		thumbnailImage.setDevicePixelRatio(devicePixelRatio);
+		pixmap = QPixmap::fromImage(thumbnailImage);
+		QPixmapCache::insert(key, pixmap);
+		return pixmap;
+	}
+
+
+	/*
+	* @brief - Returns the grid thumbnail of a fish with the caught and favorite marks already drawn on it
+	* The composed pixmap is cached as well, so the grid only blits it
+	* @param fish - the fish whose image is returned
+	* @param size - the logical size of the thumbnail
+	* @param devicePixelRatio - the device pixel ratio of the screen the thumbnail is shown on
+	* @param checkmarkImage - the mark drawn over caught fish
+	* @param favoriteImage - the mark drawn over favorite fish
+	* @return - the composed thumbnail
+	*/
+	static QPixmap composed(const Fish& fish, int size, qreal devicePixelRatio, const Sprite& checkmarkImage, const Sprite& favoriteImage) {
+		QPixmap basePixmap = thumbnail(fish, size, devicePixelRatio);
+		if (basePixmap.isNull() || (!fish.getIsCaught() && !fish.getIsFavorite())) {
+			return basePixmap;
+		}
+
+		const QString key = QString("composed_%1_%2_%3_%4")
+			.arg(basePixmap.cacheKey())
+			.arg(fish.getIsCaught() ? spriteKey(checkmarkImage) : QString())
+			.arg(fish.getIsFavorite() ? spriteKey(favoriteImage) : QString())
+			.arg(devicePixelRatio);
+
+		QPixmap result;
+		if (QPixmapCache::find(key, &result)) {
+			return result;
+		}
+
+		result = QPixmap(basePixmap.size());
+		result.setDevicePixelRatio(devicePixelRatio);
+		result.fill(Qt::transparent);
+
+		QPainter painter(&result);
+		painter.drawPixmap(0, 0, basePixmap);
+		if (fish.getIsCaught()) {
+			painter.drawPixmap(0, 0, overlay(checkmarkImage, basePixmap.size(), devicePixelRatio));
+		}
+		if (fish.getIsFavorite()) {
+			painter.drawPixmap(0, 0, overlay(favoriteImage, basePixmap.size(), devicePixelRatio));
+		}
+		painter.end();
+
+		QPixmapCache::insert(key, result);
+		return result;
+	}
+
+private:
+
+	/*
+	* @brief - Builds the key of a thumbnail, used both in memory and as the file name on disk
+	* @param hash - the hash of the full image
+	* @param size - the logical size of the thumbnail
+	* @param devicePixelRatio - the device pixel ratio of the thumbnail
+	* @return - the key of the thumbnail
+	*/
+	static QString thumbnailKey(const string& hash, int size, qreal devicePixelRatio) {
+		return QString("%1_%2x%2_%3x").arg(QString::fromStdString(hash)).arg(size).arg(devicePixelRatio);
+	}
+
+
+	/*
+	* @brief - Decodes a full image and scales it down to the physical size of the thumbnail
+	* @param image - the view over the full image bytes
+	* @param size - the logical size of the thumbnail
+	* @param devicePixelRatio - the device pixel ratio of the thumbnail
+	* @return - the scaled image, or a null image if the bytes cannot be decoded
+	*/
+	static QImage render(const ImageView& image, int size, qreal devicePixelRatio) {
+		QImage fullImage;
+		if (!fullImage.loadFromData(reinterpret_cast<const uchar*>(image.data), static_cast<int>(image.size))) {
+			return QImage();
+		}
+
+		const int physicalSize = qRound(size * devicePixelRatio);
+		return fullImage.scaled(physicalSize, physicalSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+	}
+
+
+	/*
+	* @brief - Builds a key identifying a sprite, from its texture and its rectangle in it
+	* @param sprite - the sprite
+	* @return - the key of the sprite
+	*/
+	static QString spriteKey(const Sprite& sprite) {
+		const QRect& source = sprite.getSource();
+		return QString("%1:%2,%3,%4,%5").arg(sprite.getTexture().cacheKey()).arg(source.x()).arg(source.y()).arg(source.width()).arg(source.height());
+	}
+
+
+	/*
+	* @brief - Returns a mark scaled to the physical size of a thumbnail, scaling it only once per size
+	* The mark is drawn straight out of the sprite atlas into a pixmap of the thumbnail size
+	* @param markImage - the mark to scale
+	* @param physicalSize - the size in device pixels of the thumbnail
+	* @param devicePixelRatio - the device pixel ratio of the thumbnail
+	* @return - the scaled mark
+	*/
+	static QPixmap overlay(const Sprite& markImage, const QSize& physicalSize, qreal devicePixelRatio) {
+		const QString key = QString("overlay_%1_%2x%3").arg(spriteKey(markImage)).arg(physicalSize.width()).arg(physicalSize.height());
+
+		QPixmap scaledMark;
+		if (!QPixmapCache::find(key, &scaledMark)) {
+			const QSize markSize = markImage.size().scaled(physicalSize, Qt::KeepAspectRatio);
+			scaledMark = QPixmap(markSize);
+			scaledMark.fill(Qt::transparent);
+
+			QPainter painter(&scaledMark);
+			painter.setRenderHint(QPainter::SmoothPixmapTransform);
+			markImage.draw(painter, QRectF(0, 0, markSize.width(), markSize.height()));
+			painter.end();
+
+			scaledMark.setDevicePixelRatio(devicePixelRatio);
+			QPixmapCache::insert(key, scaledMark);
+		}
+		return scaledMark;
+	}
+};
@@ -17,8 +17,8 @@ public:
 	* @param imageData - the image data for the background of the tooltip
 	* @param parent - the parent widget
 	*/
-	explicit ToolTip(QPixmap& imageData, QWidget* parent = nullptr)
-		: BackgroundWidget(imageData, parent), backgroundPixmap(imageData) {
+	explicit ToolTip(const Sprite& imageData, QWidget* parent = nullptr)
+		: BackgroundWidget(imageData, parent) {
 		setWindowFlags(Qt::ToolTip | Qt::WindowStaysOnTopHint | Qt::FramelessWindowHint);
 		setAttribute(Qt::WA_TranslucentBackground, true);
 		setAttribute(Qt::WA_StyledBackground, true);
@@ -52,5 +52,4 @@ public:
 
 private:
 	QLabel* textLabel;
-	QPixmap backgroundPixmap;
 };
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "../main/repository/FishDBRepository.h"
+#include "../resources/sqlite/sqlite3.h"
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// The tables the repository reads, as the application database has them before the repository adds its columns and indexes
+static const char* SCHEMA =
+    "CREATE TABLE Seasons(id integer primary key autoincrement, name text not null, image BLOB);"
+    "CREATE TABLE Weathers(id integer primary key autoincrement, name text not null, image BLOB);"
+    "CREATE TABLE FishLocations(id integer primary key autoincrement, name text not null, category text, image BLOB);"
+    "CREATE TABLE Fish(id integer primary key autoincrement, name text not null, category text, description text, start_catching_hour text, end_catching_hour text, difficulty integer, movement text, image BLOB);"
+    "CREATE TABLE Fish_Season(fish_id integer, season_id integer, primary key(fish_id, season_id));"
+    "CREATE TABLE Fish_Weather(fish_id integer, weather_id integer, primary key(fish_id, weather_id));"
+    "CREATE TABLE Fish_FishLocation(fish_id integer, location_id integer, primary key(fish_id, location_id));"
+    "CREATE TABLE Users(id integer primary key autoincrement, name text not null, image BLOB);"
+    "CREATE TABLE Users_Fish(user_id integer, fish_id integer, is_caught boolean not null default 0, is_favorite boolean not null default 0, primary key(user_id, fish_id));"
+    "CREATE TABLE Images(name text, image BLOB);"
+    "INSERT INTO Seasons(name) VALUES ('Spring'), ('Summer'), ('Fall'), ('Winter');"
+    "INSERT INTO Weathers(name) VALUES ('Sun'), ('Rain'), ('Wind'), ('All');"
+    "INSERT INTO FishLocations(name, category) VALUES ('Ocean', 'Ocean'), ('Town River', 'River'), ('Mountain Lake', 'Lake');"
+    "INSERT INTO Users(name) VALUES ('Farmer');"
+    "INSERT INTO Fish(name, category, description, start_catching_hour, end_catching_hour, difficulty, movement) VALUES"
+    " ('Sardine', 'Fish', 'A common ocean fish.', '6am', '7pm', 30, 'Dart'),"
+    " ('Catfish', 'Fish', 'An uncommon fish found in streams.', '6am', '12am', 75, 'Mixed'),"
+    " ('Bream', 'Fish', 'A fairly common river fish that becomes active at night.', '6pm', '2am', 35, 'Smooth');"
+    "INSERT INTO Fish_Season VALUES (1, 1), (1, 3), (1, 4), (2, 1), (2, 3), (3, 1), (3, 2), (3, 3), (3, 4);"
+    "INSERT INTO Fish_Weather VALUES (1, 4), (2, 2), (3, 4);"
+    "INSERT INTO Fish_FishLocation VALUES (1, 1), (2, 2), (3, 2);";
+
+// The names of the filters of a shape, in the order of their bits
+static string describeShape(const int shape) {
+    const char* names[] = { "season", "weather", "location" };
+    string description;
+    for (int i = 0; i < 3; i++) {
+        if (shape & (1 << i)) {
+            description += (description.empty() ? "" : ", ") + string(names[i]);
+        }
+    }
+    return description.empty() ? "no filter" : description;
+}
+
+int main()
+{
+    // => DATABASE CREATION
+    const filesystem::path databasePath = filesystem::temp_directory_path() / "stardewValleyQueryPlanTest.db";
+    error_code error;
+    filesystem::remove(databasePath, error);
+
+    sqlite3* db;
+    if (sqlite3_open(databasePath.string().c_str(), &db) != SQLITE_OK || sqlite3_exec(db, SCHEMA, nullptr, nullptr, nullptr) != SQLITE_OK) {
+        cerr << "Failed to create the test database: " << sqlite3_errmsg(db) << "\n";
+        sqlite3_close(db);
+        return 1;
+    }
+    sqlite3_close(db);
+    // <= END
+
+
+    // => QUERY PLANS CHECKING
+    // Every shape of findAllBySeasonWeatherLocation must search its tables by index and return the fish without a temporary sort.
+    // The shape without filters reads every fish, the scan of the fish table in id order is the only scan it may do.
+    int failures = 0;
+    {
+        FishDBRepository fishRepository(databasePath.string());
+        for (int shape = 0; shape < 8; shape++) {
+            const vector<string> plan = fishRepository.explainSeasonWeatherLocationQuery(shape);
+            bool passed = !plan.empty();
+            for (const string& detail : plan) {
+                const bool scan = detail.rfind("SCAN ", 0) == 0 && !(shape == 0 && detail == "SCAN f");
+                if (scan || detail.find("TEMP B-TREE") != string::npos) {
+                    passed = false;
+                }
+            }
+
+            cout << (passed ? "PASS " : "FAIL ") << shape << " (" << describeShape(shape) << ")\n";
+            for (const string& detail : plan) {
+                cout << "    " << detail << "\n";
+            }
+            failures += passed ? 0 : 1;
+        }
+
+
+        // => FILTER ENTRY POINTS CHECKING
+        // findAllBySeason, findAllByWeather and findAllByLocation run the statements of the shapes 1, 2 and 4 checked above,
+        // so they must find the fish of their name without case, in id order, and nothing for a name no fish has
+        const vector<pair<string, vector<Fish>>> lookups = {
+            { "season winter -> Sardine, Bream", fishRepository.findAllBySeason(1, "winter") },
+            { "weather RAIN -> Catfish", fishRepository.findAllByWeather(1, "RAIN") },
+            { "location town river -> Catfish, Bream", fishRepository.findAllByLocation(1, "town river") },
+            { "weather Snow -> no fish", fishRepository.findAllByWeather(1, "Snow") }
+        };
+        for (const auto& [description, found] : lookups) {
+            string names;
+            for (const Fish& fish : found) {
+                names += (names.empty() ? "" : ", ") + fish.getName();
+            }
+            const string expected = description.substr(description.find("-> ") + 3);
+            const bool passed = names == expected || (found.empty() && expected == "no fish");
+
+            cout << (passed ? "PASS " : "FAIL ") << description << (passed ? "" : " (found " + names + ")") << "\n";
+            failures += passed ? 0 : 1;
+        }
+        // <= END
+    }
+    // <= END
+
+
+    for (const char* suffix : { "", "-wal", "-shm" }) {
+        filesystem::remove(databasePath.string() + suffix, error);
+    }
+
+    cout << (failures == 0 ? "All the query plans search by index and the filters find their fish\n" : to_string(failures) + " checks failed\n");
+    return failures == 0 ? 0 : 1;
+}